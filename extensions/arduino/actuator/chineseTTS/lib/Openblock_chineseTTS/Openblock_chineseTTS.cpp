@@ -3,6 +3,14 @@
 OB_ChineseTTS::OB_ChineseTTS(uint8_t rx, uint8_t tx)
 {
     serial = new SoftwareSerial(rx, tx);
+    state = TTS_IDLE;
+    head = 0;
+    count = 0;
+    currentCommand = 0;
+    timeout = false;
+    stateTime = 0;
+    gapTime = 0;
+    finishCallback = NULL;
 }
 
 void OB_ChineseTTS::begin()
@@ -19,18 +27,6 @@ void OB_ChineseTTS::clearSerial()
     }
 }
 
-void OB_ChineseTTS::waitAllReturned()
-{
-    // waiting to receive all returned data
-    while (serial->available() == 0)
-        ;
-    delay(100);
-    while (serial->available() > 0)
-    {
-        serial->read();
-    }
-}
-
 void OB_ChineseTTS::say(char *fmt)
 {
     serial->print(fmt);
@@ -38,35 +34,15 @@ void OB_ChineseTTS::say(char *fmt)
 
 void OB_ChineseTTS::sayUnitllFinish(char *fmt)
 {
-    clearSerial();
-
-    serial->print(fmt);
-
-    // rx 0x41 for start
-    while (1)
+    // wait for queued items first, then for this one
+    while (!enqueue(fmt))
     {
-        if (serial->available() > 0)
-        {
-            uint8_t code = serial->read();
-            if (code == 0x41)
-            {
-                break;
-            }
-        }
-    };
-
-    // rx 0x4f for finish
-    while (1)
+        poll();
+    }
+    while (busy())
     {
-        if (serial->available() > 0)
-        {
-            uint8_t code = serial->read();
-            if (code == 0x4f)
-            {
-                break;
-            }
-        }
-    };
+        poll();
+    }
 }
 
 void OB_ChineseTTS::playSound(uint8_t no)
@@ -77,66 +53,163 @@ void OB_ChineseTTS::playSound(uint8_t no)
 
 void OB_ChineseTTS::playSoundUnitllFinish(uint8_t no)
 {
-    clearSerial();
-
-    serial->print("<Z>");
-    serial->print(no);
-
-    // rx 0x41 for start
-    while (1)
+    while (!enqueueSound(no))
     {
-        if (serial->available() > 0)
-        {
-            uint8_t code = serial->read();
-            if (code == 0x41)
-            {
-                break;
-            }
-        }
-    };
-
-    // rx 0x4f for finish
-    while (1)
+        poll();
+    }
+    while (busy())
     {
-        if (serial->available() > 0)
-        {
-            uint8_t code = serial->read();
-            if (code == 0x4f)
-            {
-                break;
-            }
-        }
-    };
+        poll();
+    }
+}
 
-    delay(1000);
+// settings go through the queue too, so they keep their order with the
+// utterances, and wait for the reply as before, so text that say() or
+// playSound() send next is not mixed into the setting
+void OB_ChineseTTS::sendSetting(char command, uint8_t no)
+{
+    while (!enqueueItem(NULL, command, no))
+    {
+        poll();
+    }
+    while (busy())
+    {
+        poll();
+    }
 }
 
 void OB_ChineseTTS::setVolume(uint8_t volume)
 {
-    clearSerial();
+    sendSetting('V', volume);
+}
+
+void OB_ChineseTTS::setSpeechRate(uint8_t rate)
+{
+    sendSetting('S', rate);
+}
 
-    serial->print("<V>");
-    serial->print(volume);
+void OB_ChineseTTS::setPrompt(uint8_t no)
+{
+    sendSetting('I', no);
+}
 
-    waitAllReturned();
+bool OB_ChineseTTS::enqueue(const char *text)
+{
+    return enqueueItem(text, 0, 0);
 }
 
-void OB_ChineseTTS::setSpeechRate(uint8_t rate)
+bool OB_ChineseTTS::enqueueSound(uint8_t no)
 {
-    clearSerial();
+    return enqueueItem(NULL, 'Z', no);
+}
 
-    serial->print("<S>");
-    serial->print(rate);
+bool OB_ChineseTTS::enqueueItem(const char *text, char command, uint8_t no)
+{
+    if (count >= TTS_QUEUE_SIZE)
+    {
+        return false;
+    }
+    Item &item = queue[(head + count) % TTS_QUEUE_SIZE];
+    item.text = text;
+    item.command = command;
+    item.no = no;
+    count++;
+    poll();
+    return true;
+}
 
-    waitAllReturned();
+void OB_ChineseTTS::onFinish(OB_ChineseTTSCallback callback)
+{
+    finishCallback = callback;
 }
 
-void OB_ChineseTTS::setPrompt(uint8_t no)
+void OB_ChineseTTS::sendItem(const Item &item)
 {
     clearSerial();
 
-    serial->print("<I>");
-    serial->print(no);
+    if (item.text != NULL)
+    {
+        serial->print(item.text);
+    }
+    else
+    {
+        serial->print('<');
+        serial->print(item.command);
+        serial->print('>');
+        serial->print(item.no);
+    }
+    currentCommand = (item.text == NULL) ? item.command : 0;
+    state = (currentCommand == 0 || currentCommand == 'Z') ? TTS_WAIT_START : TTS_WAIT_REPLY;
+    stateTime = millis();
+}
+
+void OB_ChineseTTS::enterGap(unsigned long ms)
+{
+    state = TTS_GAP;
+    gapTime = ms;
+    stateTime = millis();
+}
+
+void OB_ChineseTTS::finishItem(bool timedOut)
+{
+    state = TTS_IDLE;
+    timeout = timedOut;
+    if (finishCallback != NULL)
+    {
+        finishCallback(count);
+    }
+}
 
-    waitAllReturned();
+void OB_ChineseTTS::poll()
+{
+    // consume the status bytes that arrived, never wait for more
+    while (serial->available() > 0 && (state == TTS_WAIT_START || state == TTS_WAIT_FINISH || state == TTS_WAIT_REPLY))
+    {
+        uint8_t code = serial->read();
+        if (state == TTS_WAIT_REPLY)
+        {
+            // the rest of the reply is dropped when the next item is sent
+            enterGap(TTS_REPLY_GAP);
+        }
+        else if (state == TTS_WAIT_START && code == 0x41)
+        {
+            // rx 0x41 for start
+            state = TTS_WAIT_FINISH;
+            stateTime = millis();
+        }
+        else if (state == TTS_WAIT_FINISH && code == 0x4f)
+        {
+            // rx 0x4f for finish
+            if (currentCommand == 'Z')
+            {
+                enterGap(TTS_SOUND_GAP);
+            }
+            else
+            {
+                finishItem(false);
+            }
+        }
+    }
+
+    // a lost or garbled status byte must not keep the queue busy forever
+    if ((state == TTS_WAIT_START || state == TTS_WAIT_REPLY) && millis() - stateTime > TTS_START_TIMEOUT)
+    {
+        finishItem(true);
+    }
+    else if (state == TTS_WAIT_FINISH && millis() - stateTime > TTS_FINISH_TIMEOUT)
+    {
+        finishItem(true);
+    }
+    else if (state == TTS_GAP && millis() - stateTime >= gapTime)
+    {
+        finishItem(false);
+    }
+
+    if (state == TTS_IDLE && count > 0)
+    {
+        Item item = queue[head];
+        head = (head + 1) % TTS_QUEUE_SIZE;
+        count--;
+        sendItem(item);
+    }
 }
@@ -1,13 +1,61 @@
 #include "Arduino.h"
 #include <SoftwareSerial.h>
 
+// number of utterances that can wait in the queue
+#ifndef TTS_QUEUE_SIZE
+#define TTS_QUEUE_SIZE 4
+#endif
+
+// give up on an utterance the module did not start within this time (ms)
+#ifndef TTS_START_TIMEOUT
+#define TTS_START_TIMEOUT 2000
+#endif
+// give up on an utterance whose finish byte never came (ms)
+#ifndef TTS_FINISH_TIMEOUT
+#define TTS_FINISH_TIMEOUT 30000
+#endif
+// pause after a sound before the next item, as playSoundUnitllFinish does (ms)
+#define TTS_SOUND_GAP 1000
+// time left for the rest of a setting reply to arrive (ms)
+#define TTS_REPLY_GAP 100
+
+// called when a queued item finished, with the number of items still queued
+typedef void (*OB_ChineseTTSCallback)(uint8_t remaining);
+
 class OB_ChineseTTS
 {
 private:
     SoftwareSerial *serial;
 
+    enum
+    {
+        TTS_IDLE,
+        TTS_WAIT_START,
+        TTS_WAIT_FINISH,
+        TTS_WAIT_REPLY,
+        TTS_GAP
+    } state;
+
+    struct Item
+    {
+        const char *text; // NULL for a sound or a setting
+        char command;     // 'Z' sound, 'V' volume, 'S' rate, 'I' prompt
+        uint8_t no;
+    } queue[TTS_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    char currentCommand;
+    bool timeout;
+    unsigned long stateTime;
+    unsigned long gapTime;
+    OB_ChineseTTSCallback finishCallback;
+
     void clearSerial();
-    void waitAllReturned();
+    bool enqueueItem(const char *text, char command, uint8_t no);
+    void sendItem(const Item &item);
+    void finishItem(bool timedOut);
+    void enterGap(unsigned long ms);
+    void sendSetting(char command, uint8_t no);
 
 public:
     OB_ChineseTTS(uint8_t rx, uint8_t tx);
@@ -20,4 +68,14 @@ public:
     void setVolume(uint8_t volume);
     void setSpeechRate(uint8_t rate);
     void setPrompt(uint8_t no);
+
+    // non-blocking queue, text must stay valid until it has been spoken
+    bool enqueue(const char *text);
+    bool enqueueSound(uint8_t no);
+    void poll();
+    void onFinish(OB_ChineseTTSCallback callback);
+    uint8_t queueDepth() { return count; }
+    // true when the module never confirmed the last finished item
+    bool timedOut() { return timeout; }
+    bool busy() { return state != TTS_IDLE || count > 0; }
 };
@@ -12,6 +12,7 @@
 Buzzer::Buzzer(int pin)
 {
   this->buzzer_pin = pin;
+  this->_song = NULL;
 }
 
 /**
@@ -125,122 +126,296 @@ void Buzzer::bendTones(uint16_t frequency, uint16_t finalFrequency, float step,
   }
 }
 
+static const BuzzerSegment ringtone_connection[] PROGMEM = {BUZZER_NOTE(659, 50, 30), BUZZER_NOTE(1318, 55, 25), BUZZER_NOTE(1760, 60, 10)};
+static const BuzzerSegment ringtone_disconnection[] PROGMEM = {BUZZER_NOTE(659, 50, 30), BUZZER_NOTE(1760, 55, 25), BUZZER_NOTE(1318, 50, 10)};
+static const BuzzerSegment ringtone_buttonPushed[] PROGMEM = {BUZZER_SWEEP(1318, 1568, 3, 20, 2), BUZZER_REST(30), BUZZER_SWEEP(1318, 2350, 4, 10, 2)};
+static const BuzzerSegment ringtone_mode1[] PROGMEM = {BUZZER_SWEEP(1318, 1760, 2, 30, 10)};
+static const BuzzerSegment ringtone_mode2[] PROGMEM = {BUZZER_SWEEP(1567, 2350, 3, 30, 10)};
+static const BuzzerSegment ringtone_mode3[] PROGMEM = {BUZZER_NOTE(1318, 50, 100), BUZZER_NOTE(1567, 50, 80), BUZZER_NOTE(2349, 300, 0)};
+static const BuzzerSegment ringtone_surprise[] PROGMEM = {BUZZER_SWEEP(800, 2150, 2, 10, 1), BUZZER_SWEEP(2149, 800, 3, 7, 1)};
+static const BuzzerSegment ringtone_OhOoh[] PROGMEM = {BUZZER_SWEEP(880, 2000, 4, 8, 3), BUZZER_REST(200), BUZZER_REPEAT(987, 22, 5, 10)};
+static const BuzzerSegment ringtone_OhOoh2[] PROGMEM = {BUZZER_SWEEP(1880, 3000, 3, 8, 3), BUZZER_REST(200), BUZZER_REPEAT(1046, 16, 10, 10)};
+static const BuzzerSegment ringtone_cuddly[] PROGMEM = {BUZZER_SWEEP(700, 900, 3, 16, 4), BUZZER_SWEEP(899, 650, 1, 18, 7)};
+static const BuzzerSegment ringtone_sleeping[] PROGMEM = {BUZZER_SWEEP(100, 500, 4, 10, 10), BUZZER_REST(500), BUZZER_SWEEP(400, 100, 4, 10, 1)};
+static const BuzzerSegment ringtone_happy[] PROGMEM = {BUZZER_SWEEP(1500, 2500, 5, 20, 8), BUZZER_SWEEP(2499, 1500, 5, 25, 8)};
+static const BuzzerSegment ringtone_superHappy[] PROGMEM = {BUZZER_SWEEP(2000, 6000, 5, 8, 3), BUZZER_REST(50), BUZZER_SWEEP(5999, 2000, 5, 13, 2)};
+static const BuzzerSegment ringtone_happy_short[] PROGMEM = {BUZZER_SWEEP(1500, 2000, 5, 15, 8), BUZZER_REST(100), BUZZER_SWEEP(1900, 2500, 5, 10, 8)};
+static const BuzzerSegment ringtone_sad[] PROGMEM = {BUZZER_SWEEP(880, 669, 2, 20, 200)};
+static const BuzzerSegment ringtone_confused[] PROGMEM = {BUZZER_SWEEP(1000, 1700, 3, 8, 2), BUZZER_SWEEP(1699, 500, 4, 8, 3), BUZZER_SWEEP(1000, 1700, 5, 9, 10)};
+static const BuzzerSegment ringtone_fart1[] PROGMEM = {BUZZER_SWEEP(1600, 3000, 2, 2, 15)};
+static const BuzzerSegment ringtone_fart2[] PROGMEM = {BUZZER_SWEEP(2000, 6000, 2, 2, 20)};
+static const BuzzerSegment ringtone_fart3[] PROGMEM = {BUZZER_SWEEP(1600, 4000, 2, 2, 20), BUZZER_SWEEP(4000, 3000, 2, 2, 20)};
+
+#define RINGTONE(song) play(song, sizeof(song) / sizeof(BuzzerSegment), done)
+
 /**
  * \par Function
- *    playMelody
+ *    playRingtone
  * \par Description
- *    Play customized melody.
+ *    Play one of the ringtones and wait until it is over.
  * \param[in]
- *    melodyName - Name of the customized melody.
+ *    ringtone - R_connection to R_fart3.
  */
 void Buzzer::playRingtone(uint16_t ringtone)
+{
+  startRingtone(ringtone);
+  while (poll())
+  {
+#if defined(__AVR__)
+    wdt_reset();
+#endif
+    yield();
+  }
+}
+
+/**
+ * \par Function
+ *    startRingtone
+ * \par Description
+ *    Start one of the ringtones and return, poll() plays it.
+ * \param[in]
+ *    ringtone - R_connection to R_fart3.
+ * \param[in]
+ *    done - Called from poll() when the ringtone is over, may be NULL.
+ */
+void Buzzer::startRingtone(uint16_t ringtone, void (*done)(void))
 {
   switch (ringtone)
   {
   case R_connection:
-    tone(this->buzzer_pin, note_E5, 50, 30);
-    tone(this->buzzer_pin, note_E6, 55, 25);
-    tone(this->buzzer_pin, note_A6, 60, 10);
+    RINGTONE(ringtone_connection);
     break;
-
   case R_disconnection:
-    tone(this->buzzer_pin, note_E5, 50, 30);
-    tone(this->buzzer_pin, note_A6, 55, 25);
-    tone(this->buzzer_pin, note_E6, 50, 10);
+    RINGTONE(ringtone_disconnection);
     break;
-
   case R_buttonPushed:
-    bendTones(note_E6, note_G6, 1.03, 20, 2);
-    delay(30);
-    bendTones(note_E6, note_D7, 1.04, 10, 2);
+    RINGTONE(ringtone_buttonPushed);
     break;
-
   case R_mode1:
-    bendTones(note_E6, note_A6, 1.02, 30, 10); //1318.51 to 1760
+    RINGTONE(ringtone_mode1);
     break;
-
   case R_mode2:
-    bendTones(note_G6, note_D7, 1.03, 30, 10); //1567.98 to 2349.32
+    RINGTONE(ringtone_mode2);
     break;
-
   case R_mode3:
-    tone(this->buzzer_pin, note_E6, 50, 100); //D6
-    tone(this->buzzer_pin, note_G6, 50, 80);  //E6
-    tone(this->buzzer_pin, note_D7, 300, 0);  //G6
+    RINGTONE(ringtone_mode3);
     break;
-
   case R_surprise:
-    bendTones(800, 2150, 1.02, 10, 1);
-    bendTones(2149, 800, 1.03, 7, 1);
+    RINGTONE(ringtone_surprise);
     break;
-
   case R_OhOoh:
-    bendTones(880, 2000, 1.04, 8, 3); //A5 = 880
-    delay(200);
-    for (int i = 880; i < 2000; i = i * 1.04)
-    {
-      tone(this->buzzer_pin, note_B5, 5, 10);
-    }
+    RINGTONE(ringtone_OhOoh);
     break;
-
   case R_OhOoh2:
-    bendTones(1880, 3000, 1.03, 8, 3);
-    delay(200);
-    for (int i = 1880; i < 3000; i = i * 1.03)
-    {
-      tone(this->buzzer_pin, note_C6, 10, 10);
-    }
+    RINGTONE(ringtone_OhOoh2);
     break;
-
   case R_cuddly:
-    bendTones(700, 900, 1.03, 16, 4);
-    bendTones(899, 650, 1.01, 18, 7);
+    RINGTONE(ringtone_cuddly);
     break;
-
   case R_sleeping:
-    bendTones(100, 500, 1.04, 10, 10);
-    delay(500);
-    bendTones(400, 100, 1.04, 10, 1);
+    RINGTONE(ringtone_sleeping);
     break;
-
   case R_happy:
-    bendTones(1500, 2500, 1.05, 20, 8);
-    bendTones(2499, 1500, 1.05, 25, 8);
+    RINGTONE(ringtone_happy);
     break;
-
   case R_superHappy:
-    bendTones(2000, 6000, 1.05, 8, 3);
-    delay(50);
-    bendTones(5999, 2000, 1.05, 13, 2);
+    RINGTONE(ringtone_superHappy);
     break;
-
   case R_happy_short:
-    bendTones(1500, 2000, 1.05, 15, 8);
-    delay(100);
-    bendTones(1900, 2500, 1.05, 10, 8);
+    RINGTONE(ringtone_happy_short);
     break;
-
   case R_sad:
-    bendTones(880, 669, 1.02, 20, 200);
+    RINGTONE(ringtone_sad);
     break;
-
   case R_confused:
-    bendTones(1000, 1700, 1.03, 8, 2);
-    bendTones(1699, 500, 1.04, 8, 3);
-    bendTones(1000, 1700, 1.05, 9, 10);
+    RINGTONE(ringtone_confused);
     break;
-
   case R_fart1:
-    bendTones(1600, 3000, 1.02, 2, 15);
+    RINGTONE(ringtone_fart1);
     break;
-
   case R_fart2:
-    bendTones(2000, 6000, 1.02, 2, 20);
+    RINGTONE(ringtone_fart2);
     break;
-
   case R_fart3:
-    bendTones(1600, 4000, 1.02, 2, 20);
-    bendTones(4000, 3000, 1.02, 2, 20);
+    RINGTONE(ringtone_fart3);
     break;
   }
 }
+
+/**
+ * \par Function
+ *    play
+ * \par Description
+ *    Start a sequence of BuzzerSegment from PROGMEM and return at once.
+ *    The tone comes from the core tone() or LEDC on ESP32.
+ * \param[in]
+ *    song - Segments in PROGMEM.
+ * \param[in]
+ *    count - Number of segments.
+ * \param[in]
+ *    done - Called from poll() when the sequence is over, may be NULL.
+ */
+void Buzzer::play(const BuzzerSegment *song, uint8_t count, void (*done)(void))
+{
+  stop();
+  this->_song = song;
+  this->_count = count;
+  this->_index = 0;
+  this->_started = false;
+  this->_done = done;
+  if (!advance())
+  {
+    stop();
+    return;
+  }
+  startTone(this->_frequency);
+  this->_silent = false;
+  this->_wait = this->_segment.duration;
+  this->_last = millis();
+}
+
+/**
+ * \par Function
+ *    poll
+ * \par Description
+ *    Advance the sequence started by play(), call it from loop().
+ *    Deadlines follow each other, a late poll does not stretch the song.
+ * \par Return
+ *    true while the sequence is playing.
+ */
+bool Buzzer::poll(void)
+{
+  while (this->_song != NULL && millis() - this->_last >= this->_wait)
+  {
+    this->_last += this->_wait;
+    if (!this->_silent)
+    {
+      stopTone();
+      this->_silent = true;
+      this->_wait = this->_segment.silent;
+    }
+    else if (advance())
+    {
+      startTone(this->_frequency);
+      this->_silent = false;
+      this->_wait = this->_segment.duration;
+    }
+    else
+    {
+      void (*done)(void) = this->_done;
+      stop();
+      if (done != NULL)
+      {
+        done();
+      }
+    }
+  }
+  return this->_song != NULL;
+}
+
+bool Buzzer::isPlaying(void)
+{
+  return this->_song != NULL;
+}
+
+void Buzzer::stop(void)
+{
+  if (this->_song != NULL)
+  {
+    stopTone();
+  }
+  this->_song = NULL;
+  this->_done = NULL;
+}
+
+// load the next tone into _frequency, false at the end of the song
+bool Buzzer::advance(void)
+{
+  if (this->_started)
+  {
+    if (this->_segment.from != this->_segment.to)
+    {
+      // like bendTones(), the last tone is the first one at or past to
+      if (this->_segment.from < this->_segment.to ? this->_frequency < this->_segment.to : this->_frequency > this->_segment.to)
+      {
+        this->_frequency = sweepStep(this->_frequency);
+        return true;
+      }
+    }
+    else if (--this->_left > 0)
+    {
+      return true;
+    }
+    this->_index++;
+  }
+  this->_started = true;
+  for (; this->_index < this->_count; this->_index++)
+  {
+    memcpy_P(&this->_segment, &this->_song[this->_index], sizeof(BuzzerSegment));
+    this->_left = this->_segment.repeat;
+    if (this->_segment.from == this->_segment.to)
+    {
+      this->_frequency = this->_segment.from;
+      if (this->_left > 0)
+      {
+        return true;
+      }
+    }
+    else if (this->_segment.ratio > 0)
+    {
+      // bendTones() steps before its first tone, from itself is not played
+      this->_frequency = sweepStep(this->_segment.from);
+      return true;
+    }
+  }
+  return false;
+}
+
+// one sweep step from frequency towards the end of the segment, in float
+// like bendTones() so that the truncated tones come out the same
+uint16_t Buzzer::sweepStep(uint16_t frequency)
+{
+  float step = (float)(100 + this->_segment.ratio) / 100;
+  uint32_t f;
+  if (this->_segment.from < this->_segment.to)
+  {
+    f = frequency * step;
+    if (f == frequency)
+      f++;
+    if (f > 0xFFFF)
+      f = 0xFFFF;
+  }
+  else
+  {
+    f = frequency / step;
+    if (f == frequency && f > 0)
+      f--;
+  }
+  return f;
+}
+
+void Buzzer::startTone(uint16_t frequency)
+{
+  if (frequency == 0)
+  {
+    return;
+  }
+#if defined(ESP32)
+  ledcAttachPin(this->buzzer_pin, BUZZER_LEDC_CHANNEL);
+  ledcWriteTone(BUZZER_LEDC_CHANNEL, frequency);
+#else
+  ::tone(this->buzzer_pin, frequency);
+#endif
+}
+
+void Buzzer::stopTone(void)
+{
+#if defined(ESP32)
+  ledcWrite(BUZZER_LEDC_CHANNEL, 0);
+  ledcDetachPin(this->buzzer_pin);
+#else
+  ::noTone(this->buzzer_pin);
+#endif
+  pinMode(this->buzzer_pin, OUTPUT);
+  digitalWrite(this->buzzer_pin, LOW);
+}
@@ -4,6 +4,31 @@
 #include <Arduino.h>
 #include "Sounds.h"
 
+#if defined(ESP32)
+#define BUZZER_LEDC_CHANNEL 15
+#endif
+
+/**
+ * One step of a sequence played by Buzzer::play(), kept in PROGMEM.
+ * A note plays repeat times. A sweep steps from `from` by ratio percent
+ * per tone and stops on the first tone at or past to, from itself is not
+ * played, the same tones as bendTones(). Each tone sounds for
+ * duration ms followed by silent ms, a rest is a note of 0 Hz.
+ */
+typedef struct {
+  uint16_t from;
+  uint16_t to;
+  uint8_t ratio;
+  uint8_t repeat;
+  uint16_t duration;
+  uint16_t silent;
+} BuzzerSegment;
+
+#define BUZZER_NOTE(freq, duration, silent)               {freq, freq, 0, 1, duration, silent}
+#define BUZZER_REPEAT(freq, times, duration, silent)      {freq, freq, 0, times, duration, silent}
+#define BUZZER_SWEEP(from, to, ratio, duration, silent)   {from, to, ratio, 1, duration, silent}
+#define BUZZER_REST(ms)                                   {0, 0, 0, 1, 0, ms}
+
 /**
  * Class: Buzzer
  * \par Description
@@ -18,7 +43,24 @@ public:
   void tone(uint16_t frequency, uint32_t duration = 0);
   void bendTones(uint16_t frequency, uint16_t finalFrequency, float step, uint32_t duration, uint32_t silentDuration);
   void playRingtone(uint16_t ringtone);
+  // non-blocking playback, call poll() from loop() until it returns false
+  void startRingtone(uint16_t ringtone, void (*done)(void) = NULL);
+  void play(const BuzzerSegment *song, uint8_t count, void (*done)(void) = NULL);
+  bool poll(void);
+  bool isPlaying(void);
+  void stop(void);
 private:
+  bool advance(void);
+  uint16_t sweepStep(uint16_t frequency);
+  void startTone(uint16_t frequency);
+  void stopTone(void);
   uint8_t buzzer_pin;
+  const BuzzerSegment *_song;
+  BuzzerSegment _segment;
+  uint8_t _count, _index, _left;
+  uint16_t _frequency;
+  bool _started, _silent;
+  unsigned long _last, _wait;
+  void (*_done)(void);
 };
 #endif
@@ -33,7 +33,7 @@ function addGenerator (Blockly) {
     Blockly.Arduino.fourDigitClockDisplay_displayString = function (block) {
         const data = Blockly.Arduino.valueToCode(block, 'DATA', Blockly.Arduino.ORDER_ATOMIC);
 
-        return `fourDigitClockDisplay.displayStr(${data});\n`;
+        return `fourDigitClockDisplay.displayStr(${data});\nwhile (fourDigitClockDisplay.poll());\n`;
     };
 
     Blockly.Arduino.fourDigitClockDisplay_display = function (block) {
@@ -121,9 +121,14 @@ TM1637::TM1637(uint8_t clk, uint8_t data) {
     datapin = data;
     pinMode(clkpin, OUTPUT);
     pinMode(datapin, OUTPUT);
+    set();
+    _PointFlag = POINT_OFF;
+    synced = false;
+    scrolling = false;
 }
 
 void TM1637::init(void) {
+    synced = false; // Resend everything, the display may have been powered up after us
     clearDisplay();
 }
 
@@ -179,45 +184,68 @@ void TM1637::stop(void) {
 
 // Display function.Write to full-screen.
 void TM1637::display(int8_t disp_data[]) {
-    int8_t seg_data[DIGITS];
-    uint8_t i;
+    scrolling = false;
+    for (uint8_t i = 0; i < DIGITS; i++) {
+        setDigit(i, disp_data[i]);
+    }
+
+    update();
+}
+
+//******************************************
+void TM1637::display(uint8_t bit_addr, int8_t disp_data) {
+    scrolling = false;
+    setDigit(bit_addr, disp_data);
+    update();
+}
 
-    for (i = 0; i < DIGITS; i++) {
-        seg_data[i] = disp_data[i];
+void TM1637::setDigit(uint8_t bit_addr, int8_t disp_data) {
+    if (bit_addr < DIGITS) {
+        seg_data[bit_addr] = coding(disp_data);
     }
+}
 
-    coding(seg_data);
-    start();              // Start signal sent to TM1637 from MCU
-    writeByte(ADDR_AUTO); // Command1: Set data
-    stop();
-    start();
-    writeByte(cmd_set_addr); // Command2: Set address (automatic address adding)
+// Only the span from the first to the last changed digit is sent, in one
+// transfer with automatic address adding. The display control is sent when
+// set() changed it.
+void TM1637::update(void) {
+    int first = 0;
+    int last = DIGITS - 1;
 
-    for (i = 0; i < DIGITS; i++) {
-        writeByte(seg_data[i]);    // Transfer display data (8 bits x num_of_digits)
+    if (synced) {
+        while (first < DIGITS && seg_data[first] == seg_shown[first]) {
+            first++;
+        }
+        while (last >= first && seg_data[last] == seg_shown[last]) {
+            last--;
+        }
     }
 
-    stop();
-    start();
-    writeByte(cmd_disp_ctrl); // Control display
-    stop();
-}
+    if (first <= last) {
+        if (!synced) {
+            start();              // Start signal sent to TM1637 from MCU
+            writeByte(ADDR_AUTO); // Command1: Set data, kept by the TM1637
+            stop();
+        }
+        start();
+        writeByte(cmd_set_addr + first); // Command2: Set address (automatic address adding)
 
-//******************************************
-void TM1637::display(uint8_t bit_addr, int8_t disp_data) {
-    int8_t seg_data;
-
-    seg_data = coding(disp_data);
-    start();               // Start signal sent to TM1637 from MCU
-    writeByte(ADDR_FIXED); // Command1: Set data
-    stop();
-    start();
-    writeByte(bit_addr | 0xc0); // Command2: Set data (fixed address)
-    writeByte(seg_data);        // Transfer display data 8 bits
-    stop();
-    start();
-    writeByte(cmd_disp_ctrl); // Control display
-    stop();
+        for (int i = first; i <= last; i++) {
+            writeByte(seg_data[i]);    // Transfer display data (8 bits x changed digits)
+            seg_shown[i] = seg_data[i];
+        }
+
+        stop();
+    }
+
+    if (!synced || cmd_disp_ctrl != disp_ctrl_shown) {
+        start();
+        writeByte(cmd_disp_ctrl); // Control display
+        stop();
+        disp_ctrl_shown = cmd_disp_ctrl;
+    }
+
+    synced = true;
 }
 
 //--------------------------------------------------------
@@ -229,6 +257,8 @@ void TM1637::displayNum(float num, int decimal, bool show_minus) {
 
     int number = round(fabs(num) * pow(10, decimal));
 
+    scrolling = false;
+
     // if (decimal == 2) {
     //     point(true);
     // } else {
@@ -239,54 +269,99 @@ void TM1637::displayNum(float num, int decimal, bool show_minus) {
         int j = DIGITS - i - 1;
 
         if (number != 0) {
-            display(j, number % 10);
+            setDigit(j, number % 10);
         } else {
-            display(j, 0x7f);    // display nothing
+            setDigit(j, 0x7f);    // display nothing
         }
 
         number /= 10;
     }
 
     if (show_minus && num < 0) {
-        display(0, '-');    // Display '-'
+        setDigit(0, '-');    // Display '-'
     }
+
+    update();
 }
 
+// Text that fits is shown at once. Longer text scrolls in from the right and
+// out to the left, one step each loop_delay ms while poll() is called. Text
+// longer than SCROLL_MAX is not copied, it scrolls before returning as it
+// always did.
 void TM1637::displayStr(char str[], uint16_t loop_delay) {
 		int end = strlen(str);
 		if(end <= DIGITS){
+			scrolling = false;
 			for (int i = 0; i < DIGITS; i++) {
-				if(i<0 || i>=end){ // display nothing on the remaining display
-						display(i,0x7f);
+				if(i>=end){ // display nothing on the remaining display
+						setDigit(i,0x7f);
 				}
 				else{
-        	display(i, str[i]);
+        	setDigit(i, str[i]);
         }
     	}
+			update();
+			return;
 		}
-		else{
-			int offset=-DIGITS;
-
-			for (int i = 0; i <= end+DIGITS; i++) {
-				for (int j = offset, k=0; j < DIGITS+offset; j++,k++) {
-					if(j<0 || j>=end){
-						display(k,0x7f);
-					}
-					else{
-        		display(k, str[j]);
-        	}
-    		}
-    		offset++;
-    		delay(loop_delay); //loop delay
+
+		if(end > SCROLL_MAX){
+			scrolling = false;
+			for (int offset = -DIGITS; offset <= end; offset++) {
+				scrollFrame(str, end, offset);
+				delay(loop_delay);
 			}
+			return;
 		}
+		if(scrolling && end == scroll_len && strncmp(str, scroll_str, end) == 0){
+			poll(); // same text called again from loop(), keep scrolling
+			return;
+		}
+
+		memcpy(scroll_str, str, end);
+		scroll_str[end] = '\0';
+		scroll_len = end;
+		scroll_offset = -DIGITS;
+		scroll_delay = loop_delay;
+		scrolling = true;
+		scrollFrame(scroll_str, scroll_len, scroll_offset);
+		scroll_time = millis();
+}
+
+bool TM1637::poll(void) {
+    if (!scrolling) {
+        return false;
+    }
+    if (millis() - scroll_time < scroll_delay) {
+        return true;
+    }
+    if (scroll_offset >= scroll_len) { // last frame is blank, shown for one delay too
+        scrolling = false;
+        return false;
+    }
+    scroll_offset++;
+    scrollFrame(scroll_str, scroll_len, scroll_offset);
+    scroll_time = millis();
+    return true;
+}
+
+void TM1637::scrollFrame(const char *text, int len, int offset) {
+    for (int k = 0; k < DIGITS; k++) {
+        int j = offset + k;
+        if (j < 0 || j >= len) {
+            setDigit(k, 0x7f);
+        } else {
+            setDigit(k, text[j]);
+        }
+    }
+    update();
 }
 
 void TM1637::clearDisplay(void) {
-    display(0x00, 0x7f);
-    display(0x01, 0x7f);
-    display(0x02, 0x7f);
-    display(0x03, 0x7f);
+    scrolling = false;
+    for (uint8_t i = 0; i < DIGITS; i++) {
+        setDigit(i, 0x7f);
+    }
+    update();
 }
 
 // To take effect the next time it displays.
@@ -48,6 +48,8 @@
 #define BRIGHT_DARKEST 0
 #define BRIGHT_TYPICAL 2
 #define BRIGHTEST 7
+/**************Definitions for scrolling**********************/
+#define SCROLL_MAX 32 // longest string displayStr() scrolls from poll(), longer ones block until scrolled
 
 class TM1637 {
   public:
@@ -55,7 +57,8 @@ class TM1637 {
     void init(void);               // To clear the display
     void display(uint8_t BitAddr, int8_t DispData);
     void displayNum(float num, int decimal = 0, bool show_minus = true);
-    void displayStr(char str[],  uint16_t loop_delay = 500);
+    void displayStr(char str[],  uint16_t loop_delay = 500); // Strings longer than the display scroll while poll() is called
+    bool poll(void);               // Advance scrolling text, returns true while it scrolls
     void clearDisplay(void);
     void set(uint8_t = BRIGHT_TYPICAL, uint8_t = 0x40, uint8_t = 0xc0); //To take effect the next time it displays.
     void point(boolean PointFlag); //whether to light the clock point ":".To take effect the next time it displays.
@@ -72,10 +75,25 @@ class TM1637 {
     void coding(int8_t DispData[]);
     int8_t coding(int8_t DispData);
     void bitDelay(void);
+    void setDigit(uint8_t BitAddr, int8_t DispData); // Change a digit without sending it
+    void update(void);             // Send the digits that changed since the last update
+    void scrollFrame(const char *text, int len, int offset); // Show text from offset on the first digit
 
-    const int DIGITS = 4; // Number of digits on display
+    static const int DIGITS = 4; // Number of digits on display
     uint8_t clkpin;
     uint8_t datapin;
     boolean _PointFlag;            //_PointFlag=1:the clock point on
+
+    int8_t seg_data[DIGITS];       // Segments to show
+    int8_t seg_shown[DIGITS];      // Segments the TM1637 holds
+    uint8_t disp_ctrl_shown;       // Display control the TM1637 holds
+    boolean synced;                // seg_shown and disp_ctrl_shown are known
+
+    char scroll_str[SCROLL_MAX + 1];
+    int scroll_len;
+    int scroll_offset;             // String index shown on the first digit
+    uint16_t scroll_delay;
+    unsigned long scroll_time;     // millis() when the current frame was shown
+    boolean scrolling;
 };
 #endif
@@ -29,6 +29,8 @@ LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t lcd_addr, uint8_t lcd_cols, uint8_t
 	_rows = lcd_rows;
 	_charsize = charsize;
 	_backlightval = LCD_BACKLIGHT;
+	_shadow = NULL;
+	_ddram = 0xFF;
 }
 
 void LiquidCrystal_I2C::begin() {
@@ -93,21 +95,39 @@ void LiquidCrystal_I2C::begin() {
 
 /********** high level commands, for the user! */
 void LiquidCrystal_I2C::clear(){
+	if (_shadow) {
+		memset(_shadow, ' ', _cols * _rows);
+		_shadowCol = _shadowRow = 0;
+		return;
+	}
 	command(LCD_CLEARDISPLAY);// clear display, set cursor position to zero
 	delayMicroseconds(2000);  // this command takes a long time!
 }
 
 void LiquidCrystal_I2C::home(){
+	if (_shadow) {
+		_shadowCol = _shadowRow = 0;
+		return;
+	}
 	command(LCD_RETURNHOME);  // set cursor position to zero
 	delayMicroseconds(2000);  // this command takes a long time!
 }
 
+uint8_t LiquidCrystal_I2C::rowOffset(uint8_t row){
+	static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+	return row_offsets[row & 3];
+}
+
 void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row){
-	int row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
-	if (row > _rows) {
+	if (row >= _rows) {
 		row = _rows-1;    // we count rows starting w/0
 	}
-	command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
+	if (_shadow) {
+		_shadowCol = col;
+		_shadowRow = row;
+		return;
+	}
+	command(LCD_SETDDRAMADDR | (col + rowOffset(row)));
 }
 
 // Turn the display on/off (quickly)
@@ -178,8 +198,9 @@ void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[]) {
 	location &= 0x7; // we only have 8 locations 0-7
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i=0; i<8; i++) {
-		write(charmap[i]);
+		send(charmap[i], Rs);
 	}
+	_ddram = 0xFF;	// the address counter now points into CGRAM
 }
 
 // Turn the (optional) backlight off/on
@@ -201,27 +222,137 @@ bool LiquidCrystal_I2C::getBacklight() {
 
 inline void LiquidCrystal_I2C::command(uint8_t value) {
 	send(value, 0);
+	_ddram = 0xFF;
 }
 
 inline size_t LiquidCrystal_I2C::write(uint8_t value) {
+	if (_shadow) {
+		if (_shadowCol < _cols) {
+			_shadow[_shadowRow * _cols + _shadowCol] = value;
+			_shadowCol++;
+		}
+		return 1;
+	}
 	send(value, Rs);
+	if (_ddram != 0xFF) {
+		_ddram++;
+	}
 	return 1;
 }
 
+size_t LiquidCrystal_I2C::write(const uint8_t *buffer, size_t size) {
+	if (_shadow) {
+		for (size_t i = 0; i < size; i++) {
+			write(buffer[i]);
+		}
+		return size;
+	}
+	for (size_t i = 0; i < size; i += 255) {
+		sendRun(buffer + i, size - i > 255 ? 255 : size - i);
+	}
+	return size;
+}
+
+bool LiquidCrystal_I2C::beginShadow() {
+	if (_shadow) {
+		return true;
+	}
+	_shadow = (uint8_t *)malloc(2 * _cols * _rows);
+	if (!_shadow) {
+		return false;
+	}
+	command(LCD_CLEARDISPLAY);
+	delayMicroseconds(2000);
+	memset(_shadow, ' ', 2 * _cols * _rows);
+	_shadowCol = _shadowRow = 0;
+	_ddram = 0;
+	return true;
+}
+
+void LiquidCrystal_I2C::endShadow() {
+	free(_shadow);
+	_shadow = NULL;
+	_ddram = 0xFF;
+}
+
+void LiquidCrystal_I2C::flush() {
+	if (!_shadow) {
+		return;
+	}
+	for (uint8_t row = 0; row < _rows; row++) {
+		uint8_t *want = _shadow + row * _cols;
+		uint8_t *shown = want + _cols * _rows;
+		uint8_t col = 0;
+		while (col < _cols) {
+			if (want[col] == shown[col]) {
+				col++;
+				continue;
+			}
+			// extend the run over changed cells and short unchanged gaps
+			uint8_t end = col + 1;
+			for (uint8_t next = end; next < _cols && next - end <= LCD_FLUSH_GAP; next++) {
+				if (want[next] != shown[next]) {
+					end = next + 1;
+				}
+			}
+			uint8_t addr = rowOffset(row) + col;
+			if (_ddram != addr) {
+				command(LCD_SETDDRAMADDR | addr);
+			}
+			sendRun(want + col, end - col);
+			memcpy(shown + col, want + col, end - col);
+			_ddram = addr + end - col;
+			col = end;
+		}
+	}
+}
+
 
 /************ low level data pushing commands **********/
 
-// write either command or data
+// write either command or data, both nibbles in one transaction
 void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode) {
 	uint8_t highnib=value&0xf0;
 	uint8_t lownib=(value<<4)&0xf0;
-	write4bits((highnib)|mode);
-	write4bits((lownib)|mode);
+	Wire.beginTransmission(_addr);
+	queueNibble((highnib)|mode);
+	queueNibble((lownib)|mode);
+	Wire.endTransmission();
+}
+
+// write characters, LCD_TX_CHARS per transaction
+void LiquidCrystal_I2C::sendRun(const uint8_t *data, uint8_t len) {
+	if (_ddram != 0xFF) {
+		_ddram += len;
+	}
+	while (len) {
+		uint8_t n = len < LCD_TX_CHARS ? len : LCD_TX_CHARS;
+		Wire.beginTransmission(_addr);
+		for (uint8_t i = 0; i < n; i++) {
+			queueNibble((data[i] & 0xf0) | Rs);
+			queueNibble(((data[i] << 4) & 0xf0) | Rs);
+		}
+		Wire.endTransmission();
+		data += n;
+		len -= n;
+	}
+}
+
+// Data, enable high, enable low. The expander latches every byte at its
+// acknowledge, at 100kHz one byte takes 90us so the enable pulse (>450ns)
+// and the settle time before the next pulse (>37us) are met on the bus.
+void LiquidCrystal_I2C::queueNibble(uint8_t value) {
+	value |= _backlightval;
+	Wire.write(value);
+	Wire.write(value | En);
+	Wire.write(value & ~En);
 }
 
 void LiquidCrystal_I2C::write4bits(uint8_t value) {
-	expanderWrite(value);
-	pulseEnable(value);
+	Wire.beginTransmission(_addr);
+	queueNibble(value);
+	Wire.endTransmission();
+	delayMicroseconds(50);		// commands need > 37us to settle
 }
 
 void LiquidCrystal_I2C::expanderWrite(uint8_t _data){
@@ -230,14 +361,6 @@ void LiquidCrystal_I2C::expanderWrite(uint8_t _data){
 	Wire.endTransmission();
 }
 
-void LiquidCrystal_I2C::pulseEnable(uint8_t _data){
-	expanderWrite(_data | En);	// En high
-	delayMicroseconds(1);		// enable pulse must be >450ns
-
-	expanderWrite(_data & ~En);	// En low
-	delayMicroseconds(50);		// commands need > 37us to settle
-}
-
 void LiquidCrystal_I2C::load_custom_character(uint8_t char_num, uint8_t *rows){
 	createChar(char_num, rows);
 }
@@ -50,6 +50,15 @@
 #define Rw B00000010  // Read/Write bit
 #define Rs B00000001  // Register select bit
 
+// characters per I2C transaction, each takes 6 expander bytes and
+// 30 bytes fit the 32 byte Wire buffer of the AVR core
+#ifndef LCD_TX_CHARS
+#define LCD_TX_CHARS 5
+#endif
+
+// unchanged cells flush() rewrites rather than moving the cursor
+#define LCD_FLUSH_GAP 1
+
 /**
  * This is the driver for the Liquid Crystal LCD displays that use the I2C bus.
  *
@@ -135,8 +144,31 @@ public:
 	void createChar(uint8_t, uint8_t[]);
 	void setCursor(uint8_t, uint8_t);
 	virtual size_t write(uint8_t);
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	using Print::write;
 	void command(uint8_t);
 
+	/**
+	 * Keep a copy of the screen in RAM. From then on print(), write(), setCursor(),
+	 * clear() and home() only change the copy and flush() sends the cells that
+	 * differ from what the display shows. The display is cleared to start from a
+	 * known state. The copy assumes left to right text without autoscroll.
+	 *
+	 * @return false when there is not enough memory for the copy.
+	 */
+	bool beginShadow();
+
+	/**
+	 * Free the copy, print() and friends write to the display directly again.
+	 */
+	void endShadow();
+
+	/**
+	 * Send the changed cells of the copy to the display. Nearby changes are
+	 * written in one go, characters are packed LCD_TX_CHARS per I2C transaction.
+	 */
+	void flush();
+
 	inline void blink_on() { blink(); }
 	inline void blink_off() { noBlink(); }
 	inline void cursor_on() { cursor(); }
@@ -149,9 +181,15 @@ public:
 
 private:
 	void send(uint8_t, uint8_t);
+	void sendRun(const uint8_t *data, uint8_t len);
+	void queueNibble(uint8_t);
 	void write4bits(uint8_t);
 	void expanderWrite(uint8_t);
-	void pulseEnable(uint8_t);
+	uint8_t rowOffset(uint8_t row);
+	uint8_t *_shadow;		// _cols * _rows wanted, followed by _cols * _rows shown
+	uint8_t _shadowCol;
+	uint8_t _shadowRow;
+	uint8_t _ddram;			// address counter of the display, 0xFF when unknown
 	uint8_t _addr;
 	uint8_t _displayfunction;
 	uint8_t _displaycontrol;
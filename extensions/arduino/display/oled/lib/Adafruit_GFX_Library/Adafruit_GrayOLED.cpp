@@ -151,6 +151,10 @@ Adafruit_GrayOLED::~Adafruit_GrayOLED(void) {
     free(buffer);
     buffer = NULL;
   }
+  if (dirty_x1) {
+    free(dirty_x1);
+    dirty_x1 = dirty_x2 = NULL;
+  }
   if (spi_dev)
     delete spi_dev;
   if (i2c_dev)
@@ -227,6 +231,13 @@ bool Adafruit_GrayOLED::_init(uint8_t addr, bool reset) {
       !(buffer = (uint8_t *)malloc(_bpp * WIDTH * ((HEIGHT + 7) / 8)))) {
     return false;
   }
+  if (!dirty_x1) {
+    if (!(dirty_x1 = (uint8_t *)malloc(2 * dirtyRows()))) {
+      return false;
+    }
+    dirty_x2 = dirty_x1 + dirtyRows();
+    clearDirty();
+  }
 
   // Reset OLED if requested and reset pin specified in constructor
   if (reset && (rstPin >= 0)) {
@@ -255,12 +266,6 @@ bool Adafruit_GrayOLED::_init(uint8_t addr, bool reset) {
 
   clearDisplay();
 
-  // set max dirty window
-  window_x1 = 0;
-  window_y1 = 0;
-  window_x2 = WIDTH - 1;
-  window_y2 = HEIGHT - 1;
-
   return true; // Success
 }
 
@@ -299,11 +304,12 @@ void Adafruit_GrayOLED::drawPixel(int16_t x, int16_t y, uint16_t color) {
       break;
     }
 
-    // adjust dirty window
-    window_x1 = min(window_x1, x);
-    window_y1 = min(window_y1, y);
-    window_x2 = max(window_x2, x);
-    window_y2 = max(window_y2, y);
+    // widen the dirty span of the buffer row
+    uint16_t row = (_bpp == 1) ? y / 8 : y;
+    if (x < dirty_x1[row])
+      dirty_x1[row] = x;
+    if (x > dirty_x2[row])
+      dirty_x2[row] = x;
 
     if (_bpp == 1) {
       switch (color) {
@@ -342,11 +348,222 @@ void Adafruit_GrayOLED::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 void Adafruit_GrayOLED::clearDisplay(void) {
   memset(buffer, 0, _bpp * WIDTH * ((HEIGHT + 7) / 8));
-  // set max dirty window
-  window_x1 = 0;
-  window_y1 = 0;
-  window_x2 = WIDTH - 1;
-  window_y2 = HEIGHT - 1;
+  markDirty(0, 0, WIDTH - 1, HEIGHT - 1);
+}
+
+/*!
+    @brief  Draw a horizontal line, filling whole buffer bytes where it can.
+    @param  x
+            Leftmost column, in the current rotation.
+    @param  y
+            Row of the line.
+    @param  w
+            Width in pixels, nothing is drawn unless positive.
+    @param  color
+            Line color, as for drawPixel().
+*/
+void Adafruit_GrayOLED::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                      uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+/*!
+    @brief  Draw a vertical line, filling whole buffer bytes where it can.
+    @param  x
+            Column of the line, in the current rotation.
+    @param  y
+            Topmost row.
+    @param  h
+            Height in pixels, nothing is drawn unless positive.
+    @param  color
+            Line color, as for drawPixel().
+*/
+void Adafruit_GrayOLED::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                      uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+/*!
+    @brief  Fill a rectangle. The rectangle is clipped and rotated once, then
+            filled a buffer row at a time instead of pixel by pixel.
+    @param  x
+            Leftmost column, in the current rotation.
+    @param  y
+            Topmost row.
+    @param  w
+            Width in pixels, nothing is drawn unless positive.
+    @param  h
+            Height in pixels, nothing is drawn unless positive.
+    @param  color
+            Fill color, as for drawPixel().
+    @note   The GFX writeFastHLine(), writeFastVLine() and writeFillRect()
+            end up here as well.
+*/
+void Adafruit_GrayOLED::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                 uint16_t color) {
+  if ((w <= 0) || (h <= 0))
+    return;
+
+  int16_t x1 = x, y1 = y, x2 = x + w - 1, y2 = y + h - 1;
+  if (rotateRect(x1, y1, x2, y2))
+    fillRaw(x1, y1, x2, y2, color);
+}
+
+/*!
+    @brief  Clip a rectangle to the screen and map it to buffer coordinates.
+    @return false if nothing of it is on screen.
+*/
+bool Adafruit_GrayOLED::rotateRect(int16_t &x1, int16_t &y1, int16_t &x2,
+                                   int16_t &y2) {
+  if (x1 < 0)
+    x1 = 0;
+  if (y1 < 0)
+    y1 = 0;
+  if (x2 >= width())
+    x2 = width() - 1;
+  if (y2 >= height())
+    y2 = height() - 1;
+  if ((x1 > x2) || (y1 > y2))
+    return false;
+
+  int16_t ox1 = x1, oy1 = y1, ox2 = x2, oy2 = y2;
+  switch (getRotation()) {
+  case 1:
+    x1 = WIDTH - oy2 - 1;
+    x2 = WIDTH - oy1 - 1;
+    y1 = ox1;
+    y2 = ox2;
+    break;
+  case 2:
+    x1 = WIDTH - ox2 - 1;
+    x2 = WIDTH - ox1 - 1;
+    y1 = HEIGHT - oy2 - 1;
+    y2 = HEIGHT - oy1 - 1;
+    break;
+  case 3:
+    x1 = oy1;
+    x2 = oy2;
+    y1 = HEIGHT - ox2 - 1;
+    y2 = HEIGHT - ox1 - 1;
+    break;
+  }
+  return true;
+}
+
+/*!
+    @brief  Fill a clipped rectangle in buffer coordinates. At 1 bpp each
+            8-row page gets a bit mask per column and fully covered pages
+            are set with memset(). At 4 bpp only odd first and even last
+            columns need a nibble update, the rest of each row is memset().
+*/
+void Adafruit_GrayOLED::fillRaw(int16_t x1, int16_t y1, int16_t x2,
+                                int16_t y2, uint16_t color) {
+  int16_t w = x2 - x1 + 1;
+
+  if (_bpp == 1) {
+    if (color > MONOOLED_INVERSE)
+      return;
+    for (int16_t page = y1 / 8; page <= y2 / 8; page++) {
+      uint8_t mask = 0xFF;
+      if (page == y1 / 8)
+        mask &= 0xFF << (y1 & 7);
+      if (page == y2 / 8)
+        mask &= 0xFF >> (7 - (y2 & 7));
+
+      uint8_t *ptr = &buffer[x1 + page * WIDTH];
+      if ((mask == 0xFF) && (color != MONOOLED_INVERSE)) {
+        memset(ptr, (color == MONOOLED_WHITE) ? 0xFF : 0x00, w);
+        continue;
+      }
+      switch (color) {
+      case MONOOLED_WHITE:
+        for (int16_t i = 0; i < w; i++)
+          ptr[i] |= mask;
+        break;
+      case MONOOLED_BLACK:
+        for (int16_t i = 0; i < w; i++)
+          ptr[i] &= ~mask;
+        break;
+      case MONOOLED_INVERSE:
+        for (int16_t i = 0; i < w; i++)
+          ptr[i] ^= mask;
+        break;
+      }
+    }
+  }
+  if (_bpp == 4) {
+    uint8_t c = color & 0xF;
+    for (int16_t y = y1; y <= y2; y++) {
+      uint8_t *row = &buffer[y * WIDTH / 2];
+      int16_t a = x1, b = x2;
+      if (a & 1) { // odd start, right lower nibble
+        row[a / 2] = (row[a / 2] & 0xF0) | c;
+        a++;
+      }
+      if ((b >= a) && !(b & 1)) { // even end, left nibble
+        row[b / 2] = (row[b / 2] & 0x0F) | (c << 4);
+        b--;
+      }
+      if (b >= a)
+        memset(&row[a / 2], c * 0x11, (b - a + 1) / 2);
+    }
+  }
+  markDirty(x1, y1, x2, y2);
+}
+
+// DIRTY TRACKING ----------------------------------------------------------
+
+/*!
+    @brief  Number of buffer rows with a dirty span: 8-pixel pages at 1 bpp,
+            pixel rows at 4 bpp.
+*/
+uint8_t Adafruit_GrayOLED::dirtyRows(void) {
+  return (_bpp == 1) ? (HEIGHT + 7) / 8 : HEIGHT;
+}
+
+/*!
+    @brief  Get the columns changed in a buffer row since clearDirty(), so a
+            subclass display() can send only those.
+    @param  row
+            Buffer row, see dirtyRows().
+    @param  x1
+            Set to the first changed column.
+    @param  x2
+            Set to the last changed column.
+    @return false if the row is unchanged.
+*/
+bool Adafruit_GrayOLED::getDirtySpan(uint8_t row, uint8_t *x1, uint8_t *x2) {
+  if ((row >= dirtyRows()) || (dirty_x1[row] > dirty_x2[row]))
+    return false;
+  *x1 = dirty_x1[row];
+  *x2 = dirty_x2[row];
+  return true;
+}
+
+/*!
+    @brief  Mark a rectangle of buffer pixels as changed. Coordinates are
+            unrotated and must be on screen.
+*/
+void Adafruit_GrayOLED::markDirty(int16_t x1, int16_t y1, int16_t x2,
+                                  int16_t y2) {
+  if (_bpp == 1) {
+    y1 /= 8;
+    y2 /= 8;
+  }
+  for (int16_t row = y1; row <= y2; row++) {
+    if (x1 < dirty_x1[row])
+      dirty_x1[row] = x1;
+    if (x2 > dirty_x2[row])
+      dirty_x2[row] = x2;
+  }
+}
+
+/*!
+    @brief  Forget all changes, typically once display() sent them.
+*/
+void Adafruit_GrayOLED::clearDirty(void) {
+  memset(dirty_x1, 0xFF, dirtyRows());
+  memset(dirty_x2, 0x00, dirtyRows());
 }
 
 /*!
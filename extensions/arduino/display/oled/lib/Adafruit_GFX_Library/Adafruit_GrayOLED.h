@@ -67,6 +67,9 @@ public:
   void invertDisplay(bool i);
   void setContrast(uint8_t contrastlevel);
   void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   bool getPixel(int16_t x, int16_t y);
   uint8_t *getBuffer(void);
 
@@ -76,16 +79,20 @@ public:
 protected:
   bool _init(uint8_t i2caddr = 0x3C, bool reset = true);
 
+  uint8_t dirtyRows(void);
+  bool getDirtySpan(uint8_t row, uint8_t *x1, uint8_t *x2);
+  void markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+  void clearDirty(void);
+
   Adafruit_SPIDevice *spi_dev = NULL; ///< The SPI interface BusIO device
   Adafruit_I2CDevice *i2c_dev = NULL; ///< The I2C interface BusIO device
   int32_t i2c_preclk = 400000,        ///< Configurable 'high speed' I2C rate
       i2c_postclk = 100000;           ///< Configurable 'low speed' I2C rate
   uint8_t *buffer = NULL; ///< Internal 1:1 framebuffer of display mem
 
-  int16_t window_x1, ///< Dirty tracking window minimum x
-      window_y1,     ///< Dirty tracking window minimum y
-      window_x2,     ///< Dirty tracking window maximum x
-      window_y2;     ///< Dirty tracking window maximum y
+  // Spans are bytes, so they cover at most 256 columns and 255 buffer rows
+  uint8_t *dirty_x1 = NULL, ///< Dirty span first column of each buffer row
+      *dirty_x2 = NULL;      ///< Dirty span last column, below x1 when clean
 
   int dcPin,  ///< The Arduino pin connected to D/C (for SPI)
       csPin,  ///< The Arduino pin connected to CS (for SPI)
@@ -93,6 +100,9 @@ protected:
 
   uint8_t _bpp = 1; ///< Bits per pixel color for this display
 private:
+  void fillRaw(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  bool rotateRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2);
+
   TwoWire *_theWire = NULL; ///< The underlying hardware I2C
 };
 
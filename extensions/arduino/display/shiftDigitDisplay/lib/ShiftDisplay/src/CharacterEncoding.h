@@ -57,7 +57,7 @@ const byte MINUS = B00000010;
 const byte BLANK = B00000000;
 
 // encoding for each index in display (common anode with LSBFIRST)
-const byte INDEXES[] = {
+SHIFTDISPLAY_ISR_DATA const byte INDEXES[] = {
 	B10000000, // 0
 	B01000000, // 1
 	B00100000, // 2
@@ -34,6 +34,17 @@ void ShiftDisplay::initPins(int latchPin, int clockPin, int dataPin) {
 	pinMode(_latchPin, OUTPUT);
 	pinMode(_clockPin, OUTPUT);
 	pinMode(_dataPin, OUTPUT);
+#if defined(__AVR__)
+	_latchOut = portOutputRegister(digitalPinToPort(_latchPin));
+	_clockOut = portOutputRegister(digitalPinToPort(_clockPin));
+	_dataOut = portOutputRegister(digitalPinToPort(_dataPin));
+	_latchMask = digitalPinToBitMask(_latchPin);
+	_clockMask = digitalPinToBitMask(_clockPin);
+	_dataMask = digitalPinToBitMask(_dataPin);
+#endif
+	_refreshing = false;
+	_refreshRate = DEFAULT_REFRESH_RATE;
+	_brightness = MAX_BRIGHTNESS;
 	clearDisplay(); // clear asap so junk doesnt show while initiating
 }
 
@@ -78,28 +89,86 @@ void ShiftDisplay::constructSectionedDisplay(int latchPin, int clockPin, int dat
 
 void ShiftDisplay::showDisplay() {
 	for (int i = 0; i < _displaySize; i++) {
-		digitalWrite(_latchPin, LOW);
-
-		// data for first shift register
-		shiftOut(_dataPin, _clockPin, LSBFIRST, _buffer[_displaySize - i - 1]);
-
-		// data for last shift register
-		byte out = _displayType ? ~INDEXES[i] : INDEXES[i];
-		shiftOut(_dataPin, _clockPin, LSBFIRST, out);
-
-		digitalWrite(_latchPin, HIGH);
-
+		showCharacter(i, _buffer[_displaySize - i - 1]);
 		delay(POV);
 	}
 }
 
-void ShiftDisplay::clearDisplay() {
+void SHIFTDISPLAY_ISR_ATTR ShiftDisplay::clearDisplay() {
+#if defined(__AVR__)
+	uint8_t oldSREG = SREG; // pins may share a port with pins written by interrupts
+	cli();
+	*_latchOut &= ~_latchMask;
+	shiftByte(0); // both ends of led with same value
+	shiftByte(0);
+	*_latchOut |= _latchMask;
+	SREG = oldSREG;
+#else
+	digitalWrite(_latchPin, LOW);
+	shiftByte(0); // both ends of led with same value
+	shiftByte(0);
+	digitalWrite(_latchPin, HIGH);
+#endif
+}
+
+void SHIFTDISPLAY_ISR_ATTR ShiftDisplay::showCharacter(int index, byte code) {
+	byte out = _displayType ? ~INDEXES[index] : INDEXES[index];
+#if defined(__AVR__)
+	uint8_t oldSREG = SREG;
+	cli();
+	*_latchOut &= ~_latchMask;
+	shiftByte(code); // data for first shift register
+	shiftByte(out); // data for last shift register
+	*_latchOut |= _latchMask;
+	SREG = oldSREG;
+#else
 	digitalWrite(_latchPin, LOW);
-	shiftOut(_dataPin, _clockPin, MSBFIRST, 0); // both ends of led with same value
-	shiftOut(_dataPin, _clockPin, MSBFIRST, 0);
+	shiftByte(code); // data for first shift register
+	shiftByte(out); // data for last shift register
 	digitalWrite(_latchPin, HIGH);
+#endif
+}
+
+void SHIFTDISPLAY_ISR_ATTR ShiftDisplay::shiftByte(byte value) {
+	for (int i = 0; i < 8; i++, value >>= 1) {
+#if defined(__AVR__)
+		if (value & 1)
+			*_dataOut |= _dataMask;
+		else
+			*_dataOut &= ~_dataMask;
+		*_clockOut |= _clockMask;
+		*_clockOut &= ~_clockMask;
+#else
+		digitalWrite(_dataPin, value & 1);
+		digitalWrite(_clockPin, HIGH);
+		digitalWrite(_clockPin, LOW);
+#endif
+	}
 }
 
+void ShiftDisplay::publishBuffer() {
+	if (!_refreshing)
+		return;
+	noInterrupts();
+	memcpy(_frames[!_shown], _buffer, MAX_DISPLAY_SIZE); // interrupt swaps frames when a whole iteration was shown
+	_pending = true;
+	interrupts();
+}
+
+void ShiftDisplay::updateRefreshTiming() {
+	unsigned long period = 1000000UL / ((unsigned long) _refreshRate * _displaySize);
+	if (period < 2 * MIN_REFRESH_TICK)
+		period = 2 * MIN_REFRESH_TICK;
+	unsigned long on = period * _brightness / MAX_BRIGHTNESS;
+	if (on > 0 && on < MIN_REFRESH_TICK)
+		on = MIN_REFRESH_TICK;
+	if (period - on < MIN_REFRESH_TICK) // too short to turn off, keep lit until next character
+		on = period;
+	noInterrupts();
+	_onTime = on;
+	_offTime = period - on;
+	interrupts();
+}
 void ShiftDisplay::modifyBuffer(int index, byte code) {
 	_buffer[index] = _displayType ? code : ~code;
 }
@@ -275,6 +344,7 @@ void ShiftDisplay::setAt(int section, long value, char alignment) {
 		byte encodedCharacters[sectionSize];
 		encodeCharacters(sectionSize, formattedCharacters, encodedCharacters);
 		modifyBuffer(_sectionBegins[section], sectionSize, encodedCharacters);
+		publishBuffer();
 	}
 }
 
@@ -300,6 +370,7 @@ void ShiftDisplay::setAt(int section, double valueReal, int decimalPlaces, char
 		byte encodedCharacters[sectionSize];
 		encodeCharacters(sectionSize, formattedCharacters, encodedCharacters, dotIndex);
 		modifyBuffer(_sectionBegins[section], sectionSize, encodedCharacters);
+		publishBuffer();
 	}
 }
 
@@ -316,6 +387,7 @@ void ShiftDisplay::setAt(int section, char value, char alignment) {
 		byte encodedCharacters[sectionSize];
 		encodeCharacters(sectionSize, formattedCharacters, encodedCharacters);
 		modifyBuffer(_sectionBegins[section], sectionSize, encodedCharacters);
+		publishBuffer();
 	}
 }
 
@@ -328,6 +400,7 @@ void ShiftDisplay::setAt(int section, const char value[], char alignment) {
 		byte encodedCharacters[sectionSize];
 		encodeCharacters(sectionSize, formattedCharacters, encodedCharacters);
 		modifyBuffer(_sectionBegins[section], sectionSize, encodedCharacters);
+		publishBuffer();
 	}
 }
 
@@ -351,6 +424,7 @@ void ShiftDisplay::setAt(int section, const byte customs[]) {
 	if (section >= 0 && section < _sectionCount) { // valid section
 		int sectionSize = _sectionSizes[section];
 		modifyBuffer(_sectionBegins[section], sectionSize, customs);
+		publishBuffer();
 	}
 }
 
@@ -363,6 +437,7 @@ void ShiftDisplay::setAt(int section, const char characters[], bool dots[]) {
 		modifyBuffer(begin, sectionSize, encodedCharacters);
 		for (int i = 0; i < sectionSize; i++)
 			modifyBufferDot(i+begin, dots[i]);
+		publishBuffer();
 	}
 }
 
@@ -371,6 +446,7 @@ void ShiftDisplay::setDotAt(int section, int relativeIndex, bool dot) {
 		if (relativeIndex >= 0 && relativeIndex < _sectionSizes[section]) { // valid index in display
 			int index = _sectionBegins[section] + relativeIndex;
 			modifyBufferDot(index, dot);
+			publishBuffer();
 		}
 	}
 }
@@ -380,16 +456,29 @@ void ShiftDisplay::setCustomAt(int section, int relativeIndex, byte custom) {
 		if (relativeIndex >= 0 && relativeIndex < _sectionSizes[section]) { // valid index in display
 			int index = _sectionBegins[section] + relativeIndex;
 			modifyBuffer(index, custom);
+			publishBuffer();
 		}
 	}
 }
 
+void ShiftDisplay::setBrightness(int brightness) {
+	_brightness = constrain(brightness, 0, MAX_BRIGHTNESS);
+	if (_refreshing)
+		updateRefreshTiming();
+}
+
 void ShiftDisplay::show() {
+	if (_refreshing) // already shown by interrupt
+		return;
 	showDisplay();
 	clearDisplay();
 }
 
 void ShiftDisplay::show(unsigned long time) {
+	if (_refreshing) { // already shown by interrupt
+		delay(time);
+		return;
+	}
     if(time < POV * _displaySize){
         time = POV * _displaySize;
     }
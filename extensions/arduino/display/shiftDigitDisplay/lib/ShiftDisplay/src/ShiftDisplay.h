@@ -9,6 +9,18 @@ https://miguelpynto.github.io/ShiftDisplay/
 #define ShiftDisplay_h
 #include "Arduino.h"
 
+// functions and data reached from the refresh interrupt must not be read from flash on ESP boards
+#if defined(ESP32)
+#define SHIFTDISPLAY_ISR_ATTR IRAM_ATTR
+#define SHIFTDISPLAY_ISR_DATA DRAM_ATTR
+#elif defined(ESP8266)
+#define SHIFTDISPLAY_ISR_ATTR ICACHE_RAM_ATTR
+#define SHIFTDISPLAY_ISR_DATA
+#else
+#define SHIFTDISPLAY_ISR_ATTR
+#define SHIFTDISPLAY_ISR_DATA
+#endif
+
 const char ALIGN_LEFT = 'L';
 const char ALIGN_RIGHT = 'R';
 const char ALIGN_CENTER = 'C';
@@ -22,6 +34,9 @@ const char DEFAULT_ALIGN_TEXT = ALIGN_LEFT;
 const char DEFAULT_ALIGN_NUMBER = ALIGN_RIGHT;
 const int MAX_DISPLAY_SIZE = 8;
 const int POV = 1; // milliseconds showing each character when iterating
+const int DEFAULT_REFRESH_RATE = 100; // frames per second when refreshing in background
+const int MAX_BRIGHTNESS = 255;
+const int MIN_REFRESH_TICK = 50; // microseconds, shortest on or off time of a character in background refresh
 
 class ShiftDisplay {
 
@@ -37,12 +52,42 @@ class ShiftDisplay {
 		int _sectionBegins[MAX_DISPLAY_SIZE]; // index where each section begins on whole display
 		byte _buffer[MAX_DISPLAY_SIZE]; // value to show on display (encoded in abcdefgp format)
 
+		// background refresh, the interrupt shows _frames[_shown] and swaps to the other frame between iterations
+		byte _frames[2][MAX_DISPLAY_SIZE]; // copies of buffer published for the interrupt
+		volatile byte _shown; // index of frame being shown
+		volatile bool _pending; // other frame holds a newer value
+		volatile bool _refreshing; // timer interrupt is showing the display
+		volatile unsigned long _onTime; // microseconds each character is lit
+		volatile unsigned long _offTime; // microseconds each character is dark after being lit
+		int _refreshRate;
+		int _brightness;
+		int _refreshIndex; // display index shown next by the interrupt
+		bool _lit; // a character is lit by the interrupt
+
+#if defined(__AVR__)
+		volatile uint8_t *_latchOut; // direct port access for shifting
+		volatile uint8_t *_clockOut;
+		volatile uint8_t *_dataOut;
+		uint8_t _latchMask;
+		uint8_t _clockMask;
+		uint8_t _dataMask;
+#endif
+
+		static ShiftDisplay *_refreshDisplay; // display shown by the refresh interrupt
+
 		void initPins(int latchPin, int clockPin, int dataPin); // initialize shift register pins and clears it
 		void constructSingleDisplay(int latchPin, int clockPin, int dataPin, int displayType, int displaySize); // common instructions to be called by single display constructors
 		void constructSectionedDisplay(int latchPin, int clockPin, int dataPin, int displayType, int sectionCount, int sectionSizes[]); // common instructions to be called by sectioned display constructors
 
 		void showDisplay(); // iterate buffer value on each display index, achieving persistence of vision
 		void clearDisplay(); // clear shift registers
+		void showCharacter(int index, byte code); // shift one character to its display index
+		void shiftByte(byte value); // shift a byte LSB first to shift registers
+		void publishBuffer(); // hand buffer to the refresh interrupt
+		void updateRefreshTiming(); // calculate on and off times from refresh rate and brightness
+		unsigned long refreshStep(); // show next character or turn current one off, returns microseconds until next step
+		bool startRefreshTimer(); // platform timer calling refreshTick()
+		void stopRefreshTimer();
 		void modifyBuffer(int index, byte code); // change buffer content in a single position
 		void modifyBuffer(int beginIndex, int size, byte codes[]); // change buffer content in defined interval
 		void modifyBufferDot(int index, bool dot); // change buffer dot in a single position
@@ -105,6 +150,14 @@ class ShiftDisplay {
 		void show(const byte customs[], unsigned long time); // custom characters (encoded in abcdefgp format), array length must match display size
 		void show(const char characters[], bool dots[], unsigned long time); // arrays length must match display size
 
+		// show buffer value from a timer interrupt, set() functions then update the display by themselves
+		// the timer is taken from other libraries while refreshing: on AVR Timer1 (Servo, analogWrite on pins 9 and 10),
+		// on ESP8266 timer1 (analogWrite, tone and Servo, which stop working and also stop the refresh), on ESP32 timer 3
+		bool startRefresh(int refreshRate = DEFAULT_REFRESH_RATE); // returns false if board has no supported timer
+		void stopRefresh();
+		void setBrightness(int brightness); // 0 to MAX_BRIGHTNESS, duty cycle of each character
+		static unsigned long refreshTick(); // called by the refresh timer interrupt, returns microseconds until next call
+
 		// duplicates to retain compatibility with old versions
 		void insertPoint(int index); // deprecated by setDot()
 		void removePoint(int index); // deprecated by setDot()
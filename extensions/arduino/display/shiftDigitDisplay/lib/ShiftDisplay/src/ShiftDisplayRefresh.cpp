@@ -0,0 +1,192 @@
+/*
+ShiftDisplay
+by MiguelPynto
+Arduino library for driving multiple-digit 7-segment LED displays using 74HC595 shift registers
+https://miguelpynto.github.io/ShiftDisplay/
+*/
+
+// Background refresh lives in its own file so the timer and its interrupt are
+// only linked into sketches calling startRefresh() (see dot_a_linkage in
+// library.properties), leaving the timer free for Servo and others otherwise.
+// AVR uses Timer1, ESP8266 uses timer1 and ESP32 uses hardware timer 3.
+
+#include "Arduino.h"
+#include "ShiftDisplay.h"
+
+#ifndef SHIFTDISPLAY_ESP32_TIMER
+#define SHIFTDISPLAY_ESP32_TIMER 3
+#endif
+
+ShiftDisplay *ShiftDisplay::_refreshDisplay = NULL;
+
+// TIMERS **********************************************************************
+
+#if defined(__AVR__) && defined(OCR1A)
+
+// clock select bits and log2 of the matching prescaler, smallest first
+static const uint8_t refreshClocks[][2] = {
+	{_BV(CS10), 0}, // clk/1
+	{_BV(CS11), 3}, // clk/8
+	{_BV(CS11) | _BV(CS10), 6}, // clk/64
+	{_BV(CS12), 8}, // clk/256
+	{_BV(CS12) | _BV(CS10), 10} // clk/1024
+};
+static uint8_t refreshShift;
+
+// timer counts for a time in microseconds, clamped to the 16 bit counter
+static unsigned long refreshCounts(unsigned long us) {
+	unsigned long counts = (us * (F_CPU / 1000000UL) + ((1UL << refreshShift) >> 1)) >> refreshShift;
+	if (counts == 0)
+		return 1;
+	return counts > 65536UL ? 65536UL : counts;
+}
+
+ISR(TIMER1_COMPA_vect) {
+	OCR1A = refreshCounts(ShiftDisplay::refreshTick()) - 1; // counter was already cleared, new top applies to this period
+}
+
+bool ShiftDisplay::startRefreshTimer() {
+	// the finest prescaler fitting a whole character period, no step is longer
+	unsigned long period = (_onTime + _offTime) * (F_CPU / 1000000UL);
+	uint8_t clock = 0;
+	while (clock < 4 && (period >> refreshClocks[clock][1]) > 65536UL)
+		clock++;
+
+	noInterrupts();
+	refreshShift = refreshClocks[clock][1];
+	TCCR1A = 0;
+	TCCR1B = _BV(WGM12) | refreshClocks[clock][0]; // CTC mode
+	TCNT1 = 0;
+	OCR1A = refreshCounts(_onTime + _offTime) - 1;
+	TIFR1 = _BV(OCF1A);
+	TIMSK1 |= _BV(OCIE1A);
+	interrupts();
+	return true;
+}
+
+void ShiftDisplay::stopRefreshTimer() {
+	TIMSK1 &= ~_BV(OCIE1A);
+	TCCR1B = 0;
+}
+
+#elif defined(ESP8266)
+
+static void ICACHE_RAM_ATTR refreshInterrupt() {
+	timer1_write(ShiftDisplay::refreshTick() * 5); // TIM_DIV16 counts 5 per microsecond
+}
+
+bool ShiftDisplay::startRefreshTimer() {
+	timer1_attachInterrupt(refreshInterrupt);
+	timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+	timer1_write((_onTime + _offTime) * 5);
+	return true;
+}
+
+void ShiftDisplay::stopRefreshTimer() {
+	timer1_disable();
+	timer1_detachInterrupt();
+}
+
+#elif defined(ESP32)
+
+static hw_timer_t *refreshTimer = NULL;
+
+static void IRAM_ATTR refreshInterrupt() {
+	timerAlarmWrite(refreshTimer, ShiftDisplay::refreshTick(), true);
+}
+
+bool ShiftDisplay::startRefreshTimer() {
+	if (refreshTimer == NULL) {
+		refreshTimer = timerBegin(SHIFTDISPLAY_ESP32_TIMER, 80, true); // 1 microsecond per count
+		if (refreshTimer == NULL)
+			return false;
+		timerAttachInterrupt(refreshTimer, refreshInterrupt, true);
+	}
+	timerWrite(refreshTimer, 0);
+	timerAlarmWrite(refreshTimer, _onTime + _offTime, true);
+	timerAlarmEnable(refreshTimer);
+	return true;
+}
+
+void ShiftDisplay::stopRefreshTimer() {
+	if (refreshTimer != NULL)
+		timerAlarmDisable(refreshTimer);
+}
+
+#else
+
+bool ShiftDisplay::startRefreshTimer() {
+	return false; // no supported timer, keep calling show()
+}
+
+void ShiftDisplay::stopRefreshTimer() {
+}
+
+#endif
+
+// REFRESH *********************************************************************
+
+unsigned long SHIFTDISPLAY_ISR_ATTR ShiftDisplay::refreshTick() {
+	if (_refreshDisplay == NULL)
+		return 1000;
+	return _refreshDisplay->refreshStep();
+}
+
+unsigned long SHIFTDISPLAY_ISR_ATTR ShiftDisplay::refreshStep() {
+
+	// turn lit character off for the rest of its period
+	if (_lit && _offTime) {
+		clearDisplay();
+		_lit = false;
+		return _offTime;
+	}
+
+	// swap to a newer value only between iterations, so a value is never shown half updated
+	if (_refreshIndex == 0 && _pending) {
+		_shown = !_shown;
+		_pending = false;
+	}
+
+	int index = _refreshIndex;
+	if (++_refreshIndex >= _displaySize) // no division, ESP8266 has no divide instruction
+		_refreshIndex = 0;
+	if (_onTime == 0) { // brightness 0
+		clearDisplay();
+		return _offTime;
+	}
+	showCharacter(index, _frames[_shown][_displaySize - index - 1]);
+	_lit = true;
+	return _onTime;
+}
+
+bool ShiftDisplay::startRefresh(int refreshRate) {
+	if (_refreshDisplay != NULL && _refreshDisplay != this)
+		_refreshDisplay->stopRefresh(); // a single timer, one display at a time
+	stopRefresh();
+
+	_refreshRate = max(refreshRate, 1);
+	memcpy(_frames[0], _buffer, MAX_DISPLAY_SIZE);
+	_shown = 0;
+	_pending = false;
+	_refreshIndex = 0;
+	_lit = false;
+	updateRefreshTiming();
+
+	_refreshDisplay = this;
+	_refreshing = true;
+	if (!startRefreshTimer()) {
+		_refreshing = false;
+		_refreshDisplay = NULL;
+		return false;
+	}
+	return true;
+}
+
+void ShiftDisplay::stopRefresh() {
+	if (!_refreshing)
+		return;
+	stopRefreshTimer();
+	_refreshing = false;
+	_refreshDisplay = NULL;
+	clearDisplay();
+}
@@ -3,16 +3,80 @@
 /* eslint-disable require-jsdoc */
 function addGenerator (Blockly) {
 
+    // Hardware bus pins of the supported boards, as the pin menus name them.
+    // ESP boards route hardware I2C to any pins, their SPI is fixed.
+    const hwBusPins = [
+        {
+            cond: 'defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__)',
+            scl: ['A5', '19'], sda: ['A4', '18'], sck: ['13'], mosi: ['11']
+        },
+        {
+            cond: 'defined(__AVR_ATmega32U4__)',
+            scl: ['3'], sda: ['2'], sck: [], mosi: []
+        },
+        {
+            cond: 'defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)',
+            scl: ['21'], sda: ['20'], sck: ['52'], mosi: ['51']
+        },
+        {
+            cond: 'defined(ESP32)',
+            scl: null, sda: null, sck: ['18'], mosi: ['23']
+        },
+        {
+            cond: 'defined(ESP8266)',
+            scl: null, sda: null, sck: ['14'], mosi: ['13']
+        }
+    ];
+
+    // The blocks draw a whole frame then call sendBuffer(), which only works
+    // with the full _F buffer. The page buffered _1 and _2 variants need a
+    // firstPage()/nextPage() loop, so they are not used even on small boards.
+    const u8g2Constructor = (controller, bus, isHwBus, hwArgs, swArgs) => {
+        const branches = [];
+
+        hwBusPins.filter(isHwBus).forEach(board => {
+            const args = hwArgs(board);
+            const branch = branches.find(b => b.args === args);
+            if (branch) {
+                branch.conds.push(board.cond);
+            } else {
+                branches.push({args: args, conds: [board.cond]});
+            }
+        });
+
+        const sw = `U8G2_${controller}_F_SW_${bus} u8g2(${swArgs});`;
+        if (branches.length === 0) {
+            return sw;
+        }
+        return branches.map((b, i) => `#${i === 0 ? 'if' : 'elif'} ${b.conds.join(' || ')}\n` +
+            `U8G2_${controller}_F_HW_${bus} u8g2(${b.args});\n`)
+            .join('') + `#else\n${sw}\n#endif`;
+    };
+
+    // ESP boards get the pins for Wire.begin(), AVR boards must not have
+    // them set or u8g2 drives them as plain outputs.
+    const i2cConstructor = (controller, scl, sda) => {
+        const isHwBus = board => board.scl === null ||
+            (board.scl.indexOf(scl) !== -1 && board.sda.indexOf(sda) !== -1);
+        const hwArgs = board => (board.scl === null ?
+            `U8G2_R0, U8X8_PIN_NONE, ${scl}, ${sda}` : `U8G2_R0, U8X8_PIN_NONE`);
+
+        return u8g2Constructor(controller, 'I2C', isHwBus, hwArgs, `U8G2_R0, ${scl}, ${sda}, U8X8_PIN_NONE`);
+    };
+
     Blockly.Arduino.u8g2_12864LCD_init = function (block) {
         const rs = block.getFieldValue('RS');
         const rw = block.getFieldValue('R/W');
         const e = block.getFieldValue('E');
 
+        const isHwBus = board => board.sck.indexOf(e) !== -1 && board.mosi.indexOf(rw) !== -1;
+
         Blockly.Arduino.includes_.u8g2_init = `#include <U8g2lib.h>`;
-        Blockly.Arduino.definitions_.u8g2_12864LCD_init =
-            `U8G2_ST7920_128X64_F_SW_SPI u8g2(U8G2_R0, ${e}, ${rw}, ${rs}, U8X8_PIN_NONE);`;
+        Blockly.Arduino.definitions_.u8g2_12864LCD_init = u8g2Constructor('ST7920_128X64', 'SPI', isHwBus,
+            () => `U8G2_R0, ${rs}, U8X8_PIN_NONE`, `U8G2_R0, ${e}, ${rw}, ${rs}, U8X8_PIN_NONE`);
 
-        return `u8g2.begin();\n`;
+        // ST7920 timing limits the serial clock, software SPI ignores it
+        return `u8g2.setBusClock(1000000);\nu8g2.begin();\n`;
     };
 
     Blockly.Arduino.u8g2_12864Oled_init = function (block) {
@@ -21,20 +85,21 @@ function addGenerator (Blockly) {
 
         Blockly.Arduino.includes_.u8g2_init = `#include <U8g2lib.h>`;
         Blockly.Arduino.definitions_.u8g2_12864Oled_init =
-            `U8G2_SSD1306_128X64_NONAME_F_SW_I2C u8g2(U8G2_R0, ${scl}, ${sda}, U8X8_PIN_NONE);`;
+            i2cConstructor('SSD1306_128X64_NONAME', scl, sda);
 
-        return `u8g2.begin();\n`;
+        // SSD1306 fast mode, software I2C ignores it
+        return `u8g2.setBusClock(400000);\nu8g2.begin();\n`;
     };
 
-    Blockly.Arduino.u8g2_12832Oled_init = function (block) {
+    Blockly.Arduino.u8g2_12832oled_init = function (block) {
         const scl = block.getFieldValue('SCL');
         const sda = block.getFieldValue('SDA');
 
         Blockly.Arduino.includes_.u8g2_init = `#include <U8g2lib.h>`;
         Blockly.Arduino.definitions_.u8g2_12864Oled_init =
-            `U8G2_SSD1306_128X32_UNIVISION_F_SW_I2C u8g2(U8G2_R0, ${scl}, ${sda}, U8X8_PIN_NONE);`;
+            i2cConstructor('SSD1306_128X32_UNIVISION', scl, sda);
 
-        return `u8g2.begin();\n`;
+        return `u8g2.setBusClock(400000);\nu8g2.begin();\n`;
     };
 
     Blockly.Arduino.u8g2_setDrawColor = function (block) {
@@ -0,0 +1,149 @@
+/* eslint-disable func-style */
+/* eslint-disable max-len */
+/* eslint-disable require-jsdoc */
+// Checks the constructor the init blocks emit for every supported board and
+// pin combination of its menus: the preprocessor branch the board takes
+// must be the hardware bus exactly when the pins are that bus.
+//
+//     node extensions/arduino/display/u8g2/generator.test.js
+
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const range = (prefix, from, to) => Array.from({length: to - from + 1}, (v, i) => `${prefix}${from + i}`);
+
+// The digital pin menus of the devices in index.js, and their bus pins from
+// the datasheets. i2cAny routes hardware I2C to any pins.
+const boards = [
+    {
+        name: 'arduinoUno', defines: ['__AVR_ATmega328P__'], pins: [...range('', 0, 13), ...range('A', 0, 5)],
+        scl: 'A5', sda: 'A4', sck: '13', mosi: '11'
+    },
+    {
+        name: 'arduinoNano', defines: ['__AVR_ATmega328P__'], pins: [...range('', 0, 13), ...range('A', 0, 5)],
+        scl: 'A5', sda: 'A4', sck: '13', mosi: '11'
+    },
+    {
+        name: 'arduinoMini', defines: ['__AVR_ATmega168__'], pins: [...range('', 0, 13), ...range('A', 0, 5)],
+        scl: 'A5', sda: 'A4', sck: '13', mosi: '11'
+    },
+    {
+        // SPI is on the ICSP header only
+        name: 'arduinoLeonardo', defines: ['__AVR_ATmega32U4__'], pins: [...range('', 0, 13), ...range('A', 0, 5)],
+        scl: '3', sda: '2', sck: null, mosi: null
+    },
+    {
+        name: 'arduinoMega2560', defines: ['__AVR_ATmega2560__'], pins: [...range('', 0, 53), ...range('A', 0, 15)],
+        scl: '21', sda: '20', sck: '52', mosi: '51'
+    },
+    {
+        name: 'arduinoEsp8266', defines: ['ESP8266'], pins: ['16', '5', '4', '0', '2', '14', '12', '13', '15', '3', '1'],
+        i2cAny: true, sck: '14', mosi: '13'
+    },
+    {
+        name: 'arduinoEsp32', defines: ['ESP32'],
+        pins: ['0', '2', '4', '5', '12', '13', '14', '15', '16', '17', '18', '19', '21', '22', '23', '25', '26', '27', '32', '33'],
+        i2cAny: true, sck: '18', mosi: '23'
+    }
+];
+
+const loadGenerator = () => {
+    const source = fs.readFileSync(path.join(__dirname, 'generator.js'), 'utf8');
+    const Blockly = {Arduino: {includes_: {}, definitions_: {}, setups_: {}}};
+    vm.runInNewContext(`${source}\naddGenerator(Blockly);`, {Blockly: Blockly, exports: {}});
+    return Blockly;
+};
+
+// The lines of the definition the board compiles, only #if, #elif, #else
+// and #endif on ORs of defined() are expected
+const preprocess = (code, defines) => {
+    const taken = [];
+    let state = null; // null outside a conditional, else 'before', 'in', 'after'
+    const test = cond => cond.split('||').some(term => {
+        const m = term.trim().match(/^defined\((\w+)\)$/);
+        assert(m, `unexpected condition ${cond}`);
+        return defines.indexOf(m[1]) !== -1;
+    });
+    code.split('\n').forEach(line => {
+        const m = line.match(/^#(\w+)\s*(.*)$/);
+        if (!m) {
+            if (state === null || state === 'in') taken.push(line);
+            return;
+        }
+        if (m[1] === 'if') {
+            assert.strictEqual(state, null, 'nested #if');
+            state = test(m[2]) ? 'in' : 'before';
+        } else if (m[1] === 'elif') {
+            assert.notStrictEqual(state, null, '#elif without #if');
+            state = state === 'before' && test(m[2]) ? 'in' : (state === 'before' ? 'before' : 'after');
+        } else if (m[1] === 'else') {
+            assert.notStrictEqual(state, null, '#else without #if');
+            state = state === 'before' ? 'in' : 'after';
+        } else if (m[1] === 'endif') {
+            assert.notStrictEqual(state, null, '#endif without #if');
+            state = null;
+        } else {
+            assert.fail(`unexpected directive ${line}`);
+        }
+    });
+    assert.strictEqual(state, null, 'missing #endif');
+    return taken.filter(line => line !== '');
+};
+
+const block = fields => ({getFieldValue: name => fields[name]});
+
+const Blockly = loadGenerator();
+let combinations = 0;
+
+const generate = (type, fields, key) => {
+    Blockly.Arduino.includes_ = {};
+    Blockly.Arduino.definitions_ = {};
+    const code = Blockly.Arduino[type](block(fields));
+    assert.strictEqual(Blockly.Arduino.includes_.u8g2_init, '#include <U8g2lib.h>');
+    return {code: code, definition: Blockly.Arduino.definitions_[key]};
+};
+
+const oleds = [
+    {type: 'u8g2_12864Oled_init', controller: 'SSD1306_128X64_NONAME'},
+    {type: 'u8g2_12832oled_init', controller: 'SSD1306_128X32_UNIVISION'}
+];
+
+boards.forEach(board => {
+    oleds.forEach(oled => {
+        board.pins.forEach(scl => board.pins.forEach(sda => {
+            const {code, definition} = generate(oled.type, {SCL: scl, SDA: sda}, 'u8g2_12864Oled_init');
+            const hw = board.i2cAny || (scl === board.scl && sda === board.sda);
+            let expected = `U8G2_${oled.controller}_F_SW_I2C u8g2(U8G2_R0, ${scl}, ${sda}, U8X8_PIN_NONE);`;
+            if (hw && board.i2cAny) {
+                expected = `U8G2_${oled.controller}_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE, ${scl}, ${sda});`;
+            } else if (hw) {
+                // an AVR TWI must not get its pins or u8g2 drives them as outputs
+                expected = `U8G2_${oled.controller}_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);`;
+            }
+            assert.deepStrictEqual(preprocess(definition, board.defines), [expected],
+                `${board.name} ${oled.type} SCL ${scl} SDA ${sda}`);
+            assert.strictEqual(code, 'u8g2.setBusClock(400000);\nu8g2.begin();\n');
+            combinations++;
+        }));
+    });
+
+    // RS is a plain output on either bus, E and R/W are the clock and data
+    board.pins.forEach(e => board.pins.forEach(rw => ['2', board.pins[board.pins.length - 1]].forEach(rs => {
+        const {code, definition} = generate('u8g2_12864LCD_init', {'RS': rs, 'R/W': rw, 'E': e}, 'u8g2_12864LCD_init');
+        const hw = e === board.sck && rw === board.mosi;
+        const expected = hw ?
+            `U8G2_ST7920_128X64_F_HW_SPI u8g2(U8G2_R0, ${rs}, U8X8_PIN_NONE);` :
+            `U8G2_ST7920_128X64_F_SW_SPI u8g2(U8G2_R0, ${e}, ${rw}, ${rs}, U8X8_PIN_NONE);`;
+        assert.deepStrictEqual(preprocess(definition, board.defines), [expected],
+            `${board.name} LCD E ${e} R/W ${rw} RS ${rs}`);
+        assert.strictEqual(code, 'u8g2.setBusClock(1000000);\nu8g2.begin();\n');
+        combinations++;
+    })));
+});
+
+// the refresh block needs the full frame buffer
+assert.strictEqual(Blockly.Arduino.u8g2_refresh(), 'u8g2.sendBuffer();\n');
+
+console.log(`u8g2 generator: ok, ${combinations} combinations`);
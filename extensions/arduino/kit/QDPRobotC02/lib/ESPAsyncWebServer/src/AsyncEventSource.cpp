@@ -104,25 +104,64 @@ static String generateEventMessage(const char *message, const char *event, uint3
   return ev;
 }
 
-// Message
+// Message Buffer
 
-AsyncEventSourceMessage::AsyncEventSourceMessage(const char * data, size_t len)
-: _data(nullptr), _len(len), _sent(0), _acked(0)
+AsyncEventSourceMessageBuffer::AsyncEventSourceMessageBuffer(const char * data, size_t len, const char * event)
+: _data(nullptr), _len(len), _event(nullptr), _count(1)
 {
-  _data = (uint8_t*)malloc(_len+1);
+  size_t eventLen = (event != NULL) ? strlen(event) + 1 : 0;
+  // payload and event name share a single allocation
+  _data = (uint8_t*)malloc(_len + 1 + eventLen);
   if(_data == nullptr){
     _len = 0;
   } else {
     memcpy(_data, data, len);
     _data[_len] = 0;
+    if(eventLen){
+      _event = (char *)_data + _len + 1;
+      memcpy(_event, event, eventLen);
+    }
   }
 }
 
-AsyncEventSourceMessage::~AsyncEventSourceMessage() {
+AsyncEventSourceMessageBuffer::~AsyncEventSourceMessageBuffer() {
      if(_data != NULL)
         free(_data);
 }
 
+// Message
+
+AsyncEventSourceMessage::AsyncEventSourceMessage(const char * data, size_t len)
+: _buffer(nullptr), _data(nullptr), _len(0), _sent(0), _acked(0)
+{
+  _buffer = new AsyncEventSourceMessageBuffer(data, len);
+  _data = _buffer->get();
+  _len = _buffer->length();
+}
+
+AsyncEventSourceMessage::AsyncEventSourceMessage(AsyncEventSourceMessageBuffer * buffer)
+: _buffer(buffer), _data(buffer->get()), _len(buffer->length()), _sent(0), _acked(0)
+{
+  _buffer->retain();
+}
+
+AsyncEventSourceMessage::~AsyncEventSourceMessage() {
+     if(_buffer != NULL)
+        _buffer->release();
+}
+
+bool AsyncEventSourceMessage::replace(AsyncEventSourceMessageBuffer * buffer) {
+  // only a message that has not been handed to the socket yet can be swapped
+  if(_sent != 0)
+    return false;
+  buffer->retain();
+  _buffer->release();
+  _buffer = buffer;
+  _data = buffer->get();
+  _len = buffer->length();
+  return true;
+}
+
 size_t AsyncEventSourceMessage::ack(size_t len, uint32_t time) {
   (void)time;
   // If the whole message is now acked...
@@ -153,6 +192,7 @@ size_t AsyncEventSourceMessage::send(AsyncClient *client) {
 
 AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest *request, AsyncEventSource *server)
 : _messageQueue(LinkedList<AsyncEventSourceMessage *>([](AsyncEventSourceMessage *m){ delete  m; }))
+, _messageQueueLength(0)
 {
   _client = request->client();
   _server = server;
@@ -174,6 +214,7 @@ AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest *request, A
 
 AsyncEventSourceClient::~AsyncEventSourceClient(){
    _messageQueue.free();
+   _messageQueueLength = 0;
   close();
 }
 
@@ -184,27 +225,46 @@ void AsyncEventSourceClient::_queueMessage(AsyncEventSourceMessage *dataMessage)
     delete dataMessage;
     return;
   }
-  if(_messageQueue.length() >= SSE_MAX_QUEUED_MESSAGES){
+  if(_messageQueueLength >= SSE_MAX_QUEUED_MESSAGES){
       ets_printf("ERROR: Too many messages queued\n");
       delete dataMessage;
   } else {
       _messageQueue.add(dataMessage);
+      _messageQueueLength++;
   }
   if(_client->canSend())
     _runQueue();
 }
 
+bool AsyncEventSourceClient::_coalesceMessage(AsyncEventSourceMessageBuffer *buffer){
+  const char * event = buffer->event();
+  if(event == NULL)
+    return false;
+  for(const auto &m: _messageQueue){
+    if(m->event() != NULL && strcmp(m->event(), event) == 0 && m->replace(buffer))
+      return true;
+  }
+  return false;
+}
+
+void AsyncEventSourceClient::_removeFront(){
+  _messageQueue.remove(_messageQueue.front());
+  _messageQueueLength--;
+}
+
 void AsyncEventSourceClient::_onAck(size_t len, uint32_t time){
+  AsyncWebLockGuard l(_server->_lock);
   while(len && !_messageQueue.isEmpty()){
     len = _messageQueue.front()->ack(len, time);
     if(_messageQueue.front()->finished())
-      _messageQueue.remove(_messageQueue.front());
+      _removeFront();
   }
 
   _runQueue();
 }
 
 void AsyncEventSourceClient::_onPoll(){
+  AsyncWebLockGuard l(_server->_lock);
   if(!_messageQueue.isEmpty()){
     _runQueue();
   }
@@ -226,17 +286,31 @@ void AsyncEventSourceClient::close(){
 }
 
 void AsyncEventSourceClient::write(const char * message, size_t len){
+  AsyncWebLockGuard l(_server->_lock);
   _queueMessage(new AsyncEventSourceMessage(message, len));
 }
 
 void AsyncEventSourceClient::send(const char *message, const char *event, uint32_t id, uint32_t reconnect){
   String ev = generateEventMessage(message, event, id, reconnect);
-  _queueMessage(new AsyncEventSourceMessage(ev.c_str(), ev.length()));
+  AsyncEventSourceMessageBuffer * buffer = new AsyncEventSourceMessageBuffer(ev.c_str(), ev.length(), event);
+  {
+    AsyncWebLockGuard l(_server->_lock);
+    _write(buffer);
+  }
+  buffer->release();
+}
+
+void AsyncEventSourceClient::_write(AsyncEventSourceMessageBuffer *buffer){
+  if(!connected())
+    return;
+  if(_server->coalesce() && _coalesceMessage(buffer))
+    return;
+  _queueMessage(new AsyncEventSourceMessage(buffer));
 }
 
 void AsyncEventSourceClient::_runQueue(){
   while(!_messageQueue.isEmpty() && _messageQueue.front()->finished()){
-    _messageQueue.remove(_messageQueue.front());
+    _removeFront();
   }
 
   for(auto i = _messageQueue.begin(); i != _messageQueue.end(); ++i)
@@ -253,6 +327,7 @@ AsyncEventSource::AsyncEventSource(const String& url)
   : _url(url)
   , _clients(LinkedList<AsyncEventSourceClient *>([](AsyncEventSourceClient *c){ delete c; }))
   , _connectcb(NULL)
+  , _coalesce(false)
 {}
 
 AsyncEventSource::~AsyncEventSource(){
@@ -277,16 +352,21 @@ void AsyncEventSource::_addClient(AsyncEventSourceClient * client){
     free(temp);
   }*/
   
-  _clients.add(client);
+  {
+    AsyncWebLockGuard l(_lock);
+    _clients.add(client);
+  }
   if(_connectcb)
     _connectcb(client);
 }
 
 void AsyncEventSource::_handleDisconnect(AsyncEventSourceClient * client){
+  AsyncWebLockGuard l(_lock);
   _clients.remove(client);
 }
 
 void AsyncEventSource::close(){
+  AsyncWebLockGuard l(_lock);
   for(const auto &c: _clients){
     if(c->connected())
       c->close();
@@ -295,6 +375,7 @@ void AsyncEventSource::close(){
 
 // pmb fix
 size_t AsyncEventSource::avgPacketsWaiting() const {
+  AsyncWebLockGuard l(_lock);
   if(_clients.isEmpty())
     return 0;
   
@@ -312,17 +393,24 @@ size_t AsyncEventSource::avgPacketsWaiting() const {
 }
 
 void AsyncEventSource::send(const char *message, const char *event, uint32_t id, uint32_t reconnect){
-
-
   String ev = generateEventMessage(message, event, id, reconnect);
-  for(const auto &c: _clients){
-    if(c->connected()) {
-      c->write(ev.c_str(), ev.length());
+  // format once, every client queue references the same buffer
+  AsyncEventSourceMessageBuffer * buffer = new AsyncEventSourceMessageBuffer(ev.c_str(), ev.length(), event);
+  {
+    // coalescing swaps buffers of queued messages, which must not happen
+    // while the async_tcp task is handing one of them to the socket
+    AsyncWebLockGuard l(_lock);
+    for(const auto &c: _clients){
+      if(c->connected()) {
+        c->_write(buffer);
+      }
     }
   }
+  buffer->release();
 }
 
 size_t AsyncEventSource::count() const {
+  AsyncWebLockGuard l(_lock);
   return _clients.count_if([](AsyncEventSourceClient *c){
     return c->connected();
   });
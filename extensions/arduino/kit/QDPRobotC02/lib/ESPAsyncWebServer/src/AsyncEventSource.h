@@ -32,6 +32,10 @@
 
 #include "AsyncWebSynchronization.h"
 
+#ifdef ESP32
+#include <atomic>
+#endif
+
 #ifdef ESP8266
 #include <Hash.h>
 #ifdef CRYPTO_HASH_h // include Hash.h from espressif framework if the first include was from the crypto library
@@ -50,18 +54,44 @@ class AsyncEventSourceResponse;
 class AsyncEventSourceClient;
 typedef std::function<void(AsyncEventSourceClient *client)> ArEventHandlerFunction;
 
+// Formatted event text shared by every client queue it was sent to.
+// The buffer deletes itself when the last message referencing it is released.
+class AsyncEventSourceMessageBuffer {
+  private:
+    uint8_t * _data;
+    size_t _len;
+    char * _event;
+#ifdef ESP32
+    std::atomic<uint32_t> _count;
+#else
+    uint32_t _count;
+#endif
+    ~AsyncEventSourceMessageBuffer();
+  public:
+    AsyncEventSourceMessageBuffer(const char * data, size_t len, const char * event=NULL);
+    void retain() { _count++; }
+    void release() { if(--_count == 0) delete this; }
+    const uint8_t * get() const { return _data; }
+    size_t length() const { return _len; }
+    const char * event() const { return _event; }
+};
+
 class AsyncEventSourceMessage {
   private:
-    uint8_t * _data; 
+    AsyncEventSourceMessageBuffer * _buffer;
+    const uint8_t * _data; 
     size_t _len;
     size_t _sent;
     //size_t _ack;
     size_t _acked; 
   public:
     AsyncEventSourceMessage(const char * data, size_t len);
+    AsyncEventSourceMessage(AsyncEventSourceMessageBuffer * buffer);
     ~AsyncEventSourceMessage();
     size_t ack(size_t len, uint32_t time __attribute__((unused)));
     size_t send(AsyncClient *client);
+    bool replace(AsyncEventSourceMessageBuffer * buffer);
+    const char * event() const { return _buffer ? _buffer->event() : NULL; }
     bool finished(){ return _acked == _len; }
     bool sent() { return _sent == _len; }
 };
@@ -72,7 +102,10 @@ class AsyncEventSourceClient {
     AsyncEventSource *_server;
     uint32_t _lastId;
     LinkedList<AsyncEventSourceMessage *> _messageQueue;
+    size_t _messageQueueLength;
     void _queueMessage(AsyncEventSourceMessage *dataMessage);
+    bool _coalesceMessage(AsyncEventSourceMessageBuffer *buffer);
+    void _removeFront();
     void _runQueue();
 
   public:
@@ -86,13 +119,14 @@ class AsyncEventSourceClient {
     void send(const char *message, const char *event=NULL, uint32_t id=0, uint32_t reconnect=0);
     bool connected() const { return (_client != NULL) && _client->connected(); }
     uint32_t lastId() const { return _lastId; }
-    size_t  packetsWaiting() const { return _messageQueue.length(); }
+    size_t  packetsWaiting() const { return _messageQueueLength; }
 
     //system callbacks (do not call)
     void _onAck(size_t len, uint32_t time);
     void _onPoll(); 
     void _onTimeout(uint32_t time);
     void _onDisconnect();
+    void _write(AsyncEventSourceMessageBuffer *buffer);
 };
 
 class AsyncEventSource: public AsyncWebHandler {
@@ -100,6 +134,11 @@ class AsyncEventSource: public AsyncWebHandler {
     String _url;
     LinkedList<AsyncEventSourceClient *> _clients;
     ArEventHandlerFunction _connectcb;
+    bool _coalesce;
+    // guards the client list and every client queue, loop() sends while
+    // the async_tcp task acks, polls and disconnects
+    AsyncWebLock _lock;
+    friend class AsyncEventSourceClient;
   public:
     AsyncEventSource(const String& url);
     ~AsyncEventSource();
@@ -110,6 +149,9 @@ class AsyncEventSource: public AsyncWebHandler {
     void send(const char *message, const char *event=NULL, uint32_t id=0, uint32_t reconnect=0);
     size_t count() const; //number clinets connected
     size_t  avgPacketsWaiting() const;
+    // when enabled, a named event replaces a queued, not yet sent event of the same name
+    void setCoalesce(bool coalesce){ _coalesce = coalesce; }
+    bool coalesce() const { return _coalesce; }
 
     //system callbacks (do not call)
     void _addClient(AsyncEventSourceClient * client);
@@ -56,6 +56,7 @@ class AsyncWebHandler;
 class AsyncStaticWebHandler;
 class AsyncCallbackWebHandler;
 class AsyncResponseStream;
+class AsyncWebTemplate;
 
 #ifndef WEBSERVER_H
 typedef enum {
@@ -242,6 +243,7 @@ class AsyncWebServerRequest {
     void sendChunked(const String& contentType, AwsResponseFiller callback, AwsTemplateProcessor templateCallback=nullptr);
     void send_P(int code, const String& contentType, const uint8_t * content, size_t len, AwsTemplateProcessor callback=nullptr);
     void send_P(int code, const String& contentType, PGM_P content, AwsTemplateProcessor callback=nullptr);
+    void send(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType=String());
 
     AsyncWebServerResponse *beginResponse(int code, const String& contentType=String(), const String& content=String());
     AsyncWebServerResponse *beginResponse(FS &fs, const String& path, const String& contentType=String(), bool download=false, AwsTemplateProcessor callback=nullptr);
@@ -252,6 +254,7 @@ class AsyncWebServerRequest {
     AsyncResponseStream *beginResponseStream(const String& contentType, size_t bufferSize=1460);
     AsyncWebServerResponse *beginResponse_P(int code, const String& contentType, const uint8_t * content, size_t len, AwsTemplateProcessor callback=nullptr);
     AsyncWebServerResponse *beginResponse_P(int code, const String& contentType, PGM_P content, AwsTemplateProcessor callback=nullptr);
+    AsyncWebServerResponse *beginResponse(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType=String());
 
     size_t headers() const;                     // get header count
     bool hasHeader(const String& name) const;   // check if header exists
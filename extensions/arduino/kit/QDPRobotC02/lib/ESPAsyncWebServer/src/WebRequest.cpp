@@ -768,6 +768,12 @@ AsyncWebServerResponse * AsyncWebServerRequest::beginResponse_P(int code, const
   return beginResponse_P(code, contentType, (const uint8_t *)content, strlen_P(content), callback);
 }
 
+AsyncWebServerResponse * AsyncWebServerRequest::beginResponse(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType){
+  if(tpl.compiled() || tpl.compile())
+    return new AsyncTemplateResponse(tpl, callback, contentType);
+  return NULL;
+}
+
 void AsyncWebServerRequest::send(int code, const String& contentType, const String& content){
   send(beginResponse(code, contentType, content));
 }
@@ -804,6 +810,12 @@ void AsyncWebServerRequest::send_P(int code, const String& contentType, PGM_P co
   send(beginResponse_P(code, contentType, content, callback));
 }
 
+void AsyncWebServerRequest::send(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType){
+  if(tpl.compiled() || tpl.compile()){
+    send(beginResponse(tpl, callback, contentType));
+  } else send(404);
+}
+
 void AsyncWebServerRequest::redirect(const String& url){
   AsyncWebServerResponse * response = beginResponse(302);
   response->addHeader("Location",url);
@@ -27,6 +27,7 @@
 #undef max
 #endif
 #include <vector>
+#include <memory>
 // It is possible to restore these defines, but one can use _min and _max instead. Or std::min, std::max.
 
 class AsyncBasicResponse: public AsyncWebServerResponse {
@@ -118,6 +119,69 @@ class AsyncProgmemResponse: public AsyncAbstractResponse {
     virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
 };
 
+#ifndef TEMPLATE_COMPILE_BUFFER_SIZE
+#define TEMPLATE_COMPILE_BUFFER_SIZE 128
+#endif
+
+/*
+ * Template that is parsed once into literal spans and placeholder slots.
+ * Literal spans are either kept in RAM or referenced by their offset in the file.
+ * A recompile builds a new table, responses in progress keep the one they started with.
+ * */
+
+class AsyncWebTemplate {
+  using File = fs::File;
+  using FS = fs::FS;
+  friend class AsyncTemplateResponse;
+  private:
+    typedef struct {
+      size_t offset; // into literals (RAM) or into the file
+      size_t length;
+      int slot;      // index into names, -1 for a literal span
+    } Segment;
+
+    struct Compiled {
+      size_t size;
+      std::vector<Segment> segments;
+      std::vector<String> names;
+      std::vector<uint8_t> literals;
+    };
+
+    FS *_fs;
+    String _path;
+    bool _inRam;
+    std::shared_ptr<const Compiled> _compiled;
+    void _addLiteral(Compiled &c, size_t offset, const uint8_t *data, size_t len);
+    void _addSlot(Compiled &c, const char *name);
+  public:
+    AsyncWebTemplate(FS &fs, const String& path, bool inRam=true);
+    bool compile();
+    void invalidate(){ _compiled.reset(); }
+    bool compiled() const { return !!_compiled; }
+    bool inRam() const { return _inRam; }
+    const String& path() const { return _path; }
+    size_t segments() const { return _compiled ? _compiled->segments.size() : 0; }
+};
+
+class AsyncTemplateResponse: public AsyncAbstractResponse {
+  using File = fs::File;
+  private:
+    AsyncWebTemplate *_template;
+    std::shared_ptr<const AsyncWebTemplate::Compiled> _compiled;
+    AwsTemplateProcessor _processor;
+    File _content;
+    size_t _filePos;
+    size_t _segment;
+    size_t _segmentSent;
+    String _value;
+    bool _valueReady;
+  public:
+    AsyncTemplateResponse(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType=String());
+    ~AsyncTemplateResponse();
+    bool _sourceValid() const { return _compiled && (_template->inRam() || !!(_content)); }
+    virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
+};
+
 class cbuf;
 
 class AsyncResponseStream: public AsyncAbstractResponse, public Print {
@@ -573,6 +573,193 @@ size_t AsyncFileResponse::_fillBuffer(uint8_t *data, size_t len){
   return _content.read(data, len);
 }
 
+/*
+ * Compiled Template
+ * */
+
+AsyncWebTemplate::AsyncWebTemplate(FS &fs, const String& path, bool inRam)
+  : _fs(&fs)
+  , _path(path)
+  , _inRam(inRam)
+{}
+
+void AsyncWebTemplate::_addLiteral(Compiled &c, size_t offset, const uint8_t *data, size_t len){
+  if(!len)
+    return;
+  if(_inRam){
+    offset = c.literals.size();
+    c.literals.insert(c.literals.end(), data, data + len);
+  }
+  // merge with the previous span when it is contiguous
+  if(!c.segments.empty() && c.segments.back().slot < 0 && c.segments.back().offset + c.segments.back().length == offset){
+    c.segments.back().length += len;
+    return;
+  }
+  c.segments.push_back({offset, len, -1});
+}
+
+void AsyncWebTemplate::_addSlot(Compiled &c, const char *name){
+  int slot;
+  for(slot = 0; slot < (int)c.names.size(); slot++){
+    if(c.names[slot] == name)
+      break;
+  }
+  if(slot == (int)c.names.size())
+    c.names.push_back(String(name));
+  c.segments.push_back({0, 0, slot});
+}
+
+bool AsyncWebTemplate::compile(){
+  _compiled.reset();
+
+  File f = _fs->open(_path, "r");
+  if(!f)
+    return false;
+  // built aside, responses still using the previous table keep their reference
+  std::shared_ptr<Compiled> c = std::make_shared<Compiled>();
+  c->size = f.size();
+  if(_inRam)
+    c->literals.reserve(c->size);
+
+  const uint8_t placeholder = TEMPLATE_PLACEHOLDER;
+  uint8_t buf[TEMPLATE_COMPILE_BUFFER_SIZE];
+  char name[TEMPLATE_PARAM_NAME_LENGTH + 1];
+  size_t nameLen = 0;
+  size_t nameStart = 0;
+  bool inName = false;
+  size_t offset = 0;
+  size_t len;
+  while((len = f.read(buf, sizeof(buf))) > 0){
+    size_t i = 0;
+    while(i < len){
+      if(!inName){
+        // copy everything up to the next placeholder in one span
+        uint8_t *p = (uint8_t*)memchr(&buf[i], placeholder, len - i);
+        size_t run = (p ? (size_t)(p - &buf[i]) : len - i);
+        _addLiteral(*c, offset + i, &buf[i], run);
+        i += run;
+        if(p){
+          inName = true;
+          nameLen = 0;
+          nameStart = offset + i;
+          i++;
+        }
+        continue;
+      }
+      uint8_t ch = buf[i];
+      if(ch == placeholder){
+        inName = false;
+        if(nameLen){
+          name[nameLen] = 0;
+          _addSlot(*c, name);
+        } else { // double percent sign is a single percent sign escaped
+          _addLiteral(*c, nameStart, &placeholder, 1);
+        }
+        i++;
+      } else if(nameLen < TEMPLATE_PARAM_NAME_LENGTH){
+        name[nameLen++] = ch;
+        i++;
+      } else {
+        // no closing placeholder within the name length, keep the text as is
+        inName = false;
+        _addLiteral(*c, nameStart, &placeholder, 1);
+        _addLiteral(*c, nameStart + 1, (const uint8_t*)name, nameLen);
+      }
+    }
+    offset += len;
+  }
+  if(inName){
+    _addLiteral(*c, nameStart, &placeholder, 1);
+    _addLiteral(*c, nameStart + 1, (const uint8_t*)name, nameLen);
+  }
+  f.close();
+  _compiled = c;
+  return true;
+}
+
+/*
+ * Compiled Template Response
+ * */
+
+AsyncTemplateResponse::AsyncTemplateResponse(AsyncWebTemplate &tpl, AwsTemplateProcessor callback, const String& contentType)
+  : AsyncAbstractResponse(nullptr)
+  , _template(&tpl)
+  , _processor(callback)
+  , _filePos(0)
+  , _segment(0)
+  , _segmentSent(0)
+  , _valueReady(false)
+{
+  _code = 200;
+  _contentType = contentType.length() ? contentType : String("text/html");
+  // The size after template processing is unknown
+  _contentLength = 0;
+  _sendContentLength = false;
+  _chunked = true;
+
+  if(!_template->inRam()){
+    _content = _template->_fs->open(_template->_path, "r");
+    // offsets are only valid for the file they were compiled from
+    if(_content && (!_template->_compiled || _content.size() != _template->_compiled->size))
+      _template->compile();
+  }
+  // the segment indexes below refer to this table only
+  _compiled = _template->_compiled;
+}
+
+AsyncTemplateResponse::~AsyncTemplateResponse(){
+  if(_content)
+    _content.close();
+}
+
+size_t AsyncTemplateResponse::_fillBuffer(uint8_t *data, size_t len){
+  if(!_compiled)
+    return 0;
+  const std::vector<AsyncWebTemplate::Segment>& segments = _compiled->segments;
+  size_t outLen = 0;
+  while(outLen < len && _segment < segments.size()){
+    const AsyncWebTemplate::Segment& s = segments[_segment];
+    size_t segmentLen;
+    size_t n;
+    if(s.slot >= 0){
+      if(!_valueReady){
+        _value = _processor ? _processor(_compiled->names[s.slot]) : String();
+        _valueReady = true;
+      }
+      segmentLen = _value.length();
+      n = std::min(len - outLen, segmentLen - _segmentSent);
+      memcpy(data + outLen, _value.c_str() + _segmentSent, n);
+    } else if(_template->inRam()){
+      segmentLen = s.length;
+      n = std::min(len - outLen, segmentLen - _segmentSent);
+      memcpy(data + outLen, &_compiled->literals[s.offset + _segmentSent], n);
+    } else {
+      segmentLen = s.length;
+      const size_t pos = s.offset + _segmentSent;
+      if(_filePos != pos){
+        _content.seek(pos);
+        _filePos = pos;
+      }
+      n = _content.read(data + outLen, std::min(len - outLen, segmentLen - _segmentSent));
+      if(!n){
+        // the file got shorter, end the response
+        _segment = segments.size();
+        break;
+      }
+      _filePos += n;
+    }
+    outLen += n;
+    _segmentSent += n;
+    if(_segmentSent == segmentLen){
+      _segment++;
+      _segmentSent = 0;
+      _value = String();
+      _valueReady = false;
+    }
+  }
+  return outLen;
+}
+
 /*
  * Stream Response
  * */
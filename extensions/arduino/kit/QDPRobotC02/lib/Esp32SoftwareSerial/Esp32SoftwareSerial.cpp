@@ -30,6 +30,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 constexpr uint8_t BYTE_ALL_BITS_SET = ~static_cast<uint8_t>(0);
 
+#ifdef ESP32
+// TX chunk size, one RMT memory block less the end marker
+constexpr size_t RMT_TX_ITEMS = 63;
+// Longest bit time in RMT ticks, runs of a whole frame must fit in 15 bits
+constexpr uint32_t RMT_MAX_BIT_TICKS = 2000;
+#endif
+
 Esp32SoftwareSerial::Esp32SoftwareSerial() {
     m_isrOverflow = false;
 }
@@ -70,6 +77,12 @@ void Esp32SoftwareSerial::begin(uint32_t baud, Esp32SoftwareSerialConfig config,
     m_pduBits = m_dataBits + static_cast<bool>(m_parityMode) + m_stopBits;
     m_bitCycles = (ESP.getCpuFreqMHz() * 1000000UL + baud / 2) / baud;
     m_intTxEnabled = true;
+#ifdef ESP32
+    if (m_rmtTx || m_rmtRx) { end(); }
+    uint32_t clkDiv = (APB_CLK_FREQ / RMT_MAX_BIT_TICKS + baud - 1) / baud;
+    m_rmtClkDiv = constrain(clkDiv, 1, 255);
+    m_rmtBitTicks = (APB_CLK_FREQ / m_rmtClkDiv + baud / 2) / baud;
+#endif
     if (isValidGPIOpin(m_rxPin)) {
         std::unique_ptr<circular_queue<uint8_t> > buffer(new circular_queue<uint8_t>((bufCapacity > 0) ? bufCapacity : 64));
         m_buffer = move(buffer);
@@ -79,9 +92,17 @@ void Esp32SoftwareSerial::begin(uint32_t baud, Esp32SoftwareSerialConfig config,
             m_parityBuffer = move(parityBuffer);
             m_parityInPos = m_parityOutPos = 1;
         }
-        std::unique_ptr<circular_queue<uint32_t> > isrBuffer(new circular_queue<uint32_t>((isrBufCapacity > 0) ? isrBufCapacity : (sizeof(uint8_t) * 8 + 2) * bufCapacity));
-        m_isrBuffer = move(isrBuffer);
-        if (m_buffer && (!m_parityMode || m_parityBuffer) && m_isrBuffer) {
+        if (isrBufCapacity <= 0) { isrBufCapacity = (sizeof(uint8_t) * 8 + 2) * bufCapacity; }
+#ifdef ESP32
+        // RMT items carry the edges, the ISR bit buffer is not needed then
+        if (m_rmtRxChannel >= 0 && !m_oneWire) { m_rmtRx = rmtBegin(isrBufCapacity); }
+        if (!m_rmtRx)
+#endif
+        {
+            std::unique_ptr<circular_queue<uint32_t> > isrBuffer(new circular_queue<uint32_t>(isrBufCapacity));
+            m_isrBuffer = move(isrBuffer);
+        }
+        if (m_buffer && (!m_parityMode || m_parityBuffer) && (m_isrBuffer || m_rmtRx)) {
             m_rxValid = true;
             pinMode(m_rxPin, INPUT_PULLUP);
         }
@@ -93,6 +114,21 @@ void Esp32SoftwareSerial::begin(uint32_t baud, Esp32SoftwareSerialConfig config,
         ) {
 #endif
         m_txValid = true;
+#ifdef ESP32
+        if (m_rmtTxChannel >= 0 && !m_oneWire) {
+            rmt_config_t config = {};
+            config.rmt_mode = RMT_MODE_TX;
+            config.channel = static_cast<rmt_channel_t>(m_rmtTxChannel);
+            config.gpio_num = static_cast<gpio_num_t>(m_txPin);
+            config.clk_div = m_rmtClkDiv;
+            config.mem_block_num = 1;
+            config.tx_config.idle_output_en = true;
+            config.tx_config.idle_level = m_invert ? RMT_IDLE_LEVEL_LOW : RMT_IDLE_LEVEL_HIGH;
+            m_rmtTx = rmt_config(&config) == ESP_OK &&
+                rmt_driver_install(config.channel, 0, 0) == ESP_OK;
+        }
+        if (!m_rmtTx)
+#endif
         if (!m_oneWire) {
             pinMode(m_txPin, OUTPUT);
             digitalWrite(m_txPin, !m_invert);
@@ -104,6 +140,9 @@ void Esp32SoftwareSerial::begin(uint32_t baud, Esp32SoftwareSerialConfig config,
 void Esp32SoftwareSerial::end()
 {
     enableRx(false);
+#ifdef ESP32
+    rmtEnd();
+#endif
     m_txValid = false;
     if (m_buffer) {
         m_buffer.reset();
@@ -134,6 +173,24 @@ void Esp32SoftwareSerial::enableIntTx(bool on) {
     m_intTxEnabled = on;
 }
 
+bool Esp32SoftwareSerial::enableRmt(int8_t txChannel, int8_t rxChannel) {
+    if (txChannel < 0) txChannel = -1;
+    if (rxChannel < 0) rxChannel = -1;
+#ifdef ESP32
+    if (txChannel >= RMT_CHANNEL_MAX) return false;
+    if (rxChannel >= 0) {
+        if (rxChannel + SWSERIAL_RMT_RX_BLOCKS > RMT_CHANNEL_MAX) return false;
+        // RX also uses the memory blocks of the channels after its own
+        if (txChannel >= rxChannel && txChannel < rxChannel + SWSERIAL_RMT_RX_BLOCKS) return false;
+    }
+    m_rmtTxChannel = txChannel;
+    m_rmtRxChannel = rxChannel;
+    return true;
+#else
+    return txChannel < 0 && rxChannel < 0;
+#endif
+}
+
 void Esp32SoftwareSerial::enableTx(bool on) {
     if (m_txValid && m_oneWire) {
         if (on) {
@@ -152,6 +209,13 @@ void Esp32SoftwareSerial::enableRx(bool on) {
     if (m_rxValid) {
         if (on) {
             m_rxCurBit = m_pduBits - 1;
+#ifdef ESP32
+            if (m_rmtRx) {
+                rmt_rx_start(static_cast<rmt_channel_t>(m_rmtRxChannel), true);
+                m_rxEnabled = on;
+                return;
+            }
+#endif
             // Init to stop bit level and current cycle
             m_isrLastCycle = (ESP.getCycleCount() | 1) ^ m_invert;
             if (m_bitCycles >= (ESP.getCpuFreqMHz() * 1000000UL) / 74880UL)
@@ -160,6 +224,10 @@ void Esp32SoftwareSerial::enableRx(bool on) {
                 attachInterruptArg(digitalPinToInterrupt(m_rxPin), reinterpret_cast<void (*)(void*)>(rxBitSyncISR), this, m_invert ? RISING : FALLING);
         }
         else {
+#ifdef ESP32
+            if (m_rmtRx) rmt_rx_stop(static_cast<rmt_channel_t>(m_rmtRxChannel));
+            else
+#endif
             detachInterrupt(digitalPinToInterrupt(m_rxPin));
         }
         m_rxEnabled = on;
@@ -277,9 +345,56 @@ size_t Esp32SoftwareSerial::write(const uint8_t * buffer, size_t size) {
     return write(buffer, size, m_parityMode);
 }
 
+uint32_t ICACHE_RAM_ATTR Esp32SoftwareSerial::txWord(uint8_t byte, Esp32SoftwareSerialParity parity) {
+    const uint32_t dataMask = ((1UL << m_dataBits) - 1);
+    byte &= dataMask;
+    // push LSB start-data-parity-stop bit pattern into uint32_t
+    // Stop bits: HIGH
+    uint32_t word = ~0UL;
+    // parity bit, if any
+    if (parity && m_parityMode)
+    {
+        uint32_t parityBit;
+        switch (parity)
+        {
+        case SWSERIAL_PARITY_EVEN:
+            // toggles the HIGH bit below, so set when the count of ones is even
+            parityBit = byte;
+            parityBit ^= parityBit >> 4;
+            parityBit &= 0xf;
+            parityBit = (0x9669 >> parityBit) & 1;
+            break;
+        case SWSERIAL_PARITY_ODD:
+            // toggles the HIGH bit below, so set when the count of ones is odd
+            parityBit = byte;
+            parityBit ^= parityBit >> 4;
+            parityBit &= 0xf;
+            parityBit = (0x6996 >> parityBit) & 1;
+            break;
+        case SWSERIAL_PARITY_MARK:
+            parityBit = false;
+            break;
+        case SWSERIAL_PARITY_SPACE:
+            // suppresses warning parityBit uninitialized
+        default:
+            parityBit = true;
+            break;
+        }
+        word ^= parityBit << m_dataBits;
+    }
+    word ^= ~byte & dataMask;
+    // Stop bit: LOW
+    word <<= 1;
+    if (m_invert) word = ~word;
+    return word;
+}
+
 size_t ICACHE_RAM_ATTR Esp32SoftwareSerial::write(const uint8_t * buffer, size_t size, Esp32SoftwareSerialParity parity) {
     if (m_rxValid) { rxBits(); }
     if (!m_txValid) { return -1; }
+#ifdef ESP32
+    if (m_rmtTx) { return rmtWrite(buffer, size, parity); }
+#endif
 
     if (m_txEnableValid) {
         digitalWrite(m_txEnablePin, HIGH);
@@ -292,50 +407,11 @@ size_t ICACHE_RAM_ATTR Esp32SoftwareSerial::write(const uint8_t * buffer, size_t
         // Disable interrupts in order to get a clean transmit timing
         m_savedPS = xt_rsil(15);
     }
-    const uint32_t dataMask = ((1UL << m_dataBits) - 1);
     bool withStopBit = true;
     m_periodDuration = 0;
     m_periodStart = ESP.getCycleCount();
     for (size_t cnt = 0; cnt < size; ++cnt) {
-        uint8_t byte = ~buffer[cnt] & dataMask;
-        // push LSB start-data-parity-stop bit pattern into uint32_t
-        // Stop bits: HIGH
-        uint32_t word = ~0UL;
-        // parity bit, if any
-        if (parity && m_parityMode)
-        {
-            uint32_t parityBit;
-            switch (parity)
-            {
-            case SWSERIAL_PARITY_EVEN:
-                // from inverted, so use odd parity
-                parityBit = byte;
-                parityBit ^= parityBit >> 4;
-                parityBit &= 0xf;
-                parityBit = (0x9669 >> parityBit) & 1;
-                break;
-            case SWSERIAL_PARITY_ODD:
-                // from inverted, so use even parity
-                parityBit = byte;
-                parityBit ^= parityBit >> 4;
-                parityBit &= 0xf;
-                parityBit = (0x6996 >> parityBit) & 1;
-                break;
-            case SWSERIAL_PARITY_MARK:
-                parityBit = false;
-                break;
-            case SWSERIAL_PARITY_SPACE:
-                // suppresses warning parityBit uninitialized
-            default:
-                parityBit = true;
-                break;
-            }
-            word ^= parityBit << m_dataBits;
-        }
-        word ^= byte;
-        // Stop bit: LOW
-        word <<= 1;
-        if (m_invert) word = ~word;
+        uint32_t word = txWord(buffer[cnt], parity);
         for (int i = 0; i <= m_pduBits; ++i) {
             bool pb = b;
             b = word & (1UL << i);
@@ -392,6 +468,17 @@ int Esp32SoftwareSerial::peek() {
 }
 
 void Esp32SoftwareSerial::rxBits() {
+#ifdef ESP32
+    if (m_rmtRx) {
+        size_t size;
+        rmt_item32_t* items;
+        while ((items = static_cast<rmt_item32_t*>(xRingbufferReceive(m_rmtRxRing, &size, 0))) != nullptr) {
+            rmtRxBits(items, size / sizeof(rmt_item32_t));
+            vRingbufferReturnItem(m_rmtRxRing, items);
+        }
+        return;
+    }
+#endif
     int isrAvail = m_isrBuffer->available();
 #ifdef ESP8266
     if (m_isrOverflow.load()) {
@@ -426,8 +513,14 @@ void Esp32SoftwareSerial::rxBits(const uint32_t & isrCycle) {
     int32_t cycles = isrCycle - m_isrLastCycle;
     m_isrLastCycle = isrCycle;
 
-    uint8_t bits = cycles / m_bitCycles;
+    uint32_t bits = cycles / m_bitCycles;
     if (cycles % m_bitCycles > (m_bitCycles >> 1)) ++bits;
+    // a longer run than a whole frame decodes the same
+    if (bits > m_pduBits + 1U) bits = m_pduBits + 1U;
+    rxBits(level, bits);
+}
+
+void Esp32SoftwareSerial::rxBits(bool level, uint8_t bits) {
     while (bits > 0) {
         // start bit detection
         if (m_rxCurBit >= (m_pduBits - 1)) {
@@ -528,6 +621,113 @@ void ICACHE_RAM_ATTR Esp32SoftwareSerial::rxBitSyncISR(Esp32SoftwareSerial * sel
     }
 }
 
+#ifdef ESP32
+bool Esp32SoftwareSerial::rmtBegin(int isrBufCapacity) {
+    pinMode(m_rxPin, INPUT_PULLUP);
+    rmt_config_t config = {};
+    config.rmt_mode = RMT_MODE_RX;
+    config.channel = static_cast<rmt_channel_t>(m_rmtRxChannel);
+    config.gpio_num = static_cast<gpio_num_t>(m_rxPin);
+    config.clk_div = m_rmtClkDiv;
+    config.mem_block_num = SWSERIAL_RMT_RX_BLOCKS;
+    // glitches under an eighth of a bit are dropped, the filter counts APB cycles
+    config.rx_config.filter_en = true;
+    uint32_t filterTicks = m_rmtBitTicks * m_rmtClkDiv / 8;
+    config.rx_config.filter_ticks_thresh = (filterTicks > 255) ? 255 : filterTicks;
+    // reception ends and items are handed over once the line idles longer than a frame
+    config.rx_config.idle_threshold = (m_pduBits + 2) * m_rmtBitTicks;
+    // an item holds two edges, the ring buffer also needs room for a full RMT memory
+    size_t ringSize = isrBufCapacity / 2 * sizeof(rmt_item32_t) + SWSERIAL_RMT_RX_BLOCKS * 64 * sizeof(rmt_item32_t);
+    if (rmt_config(&config) != ESP_OK ||
+        rmt_driver_install(config.channel, ringSize, 0) != ESP_OK) {
+        return false;
+    }
+    if (rmt_get_ringbuf_handle(config.channel, &m_rmtRxRing) != ESP_OK) {
+        rmt_driver_uninstall(config.channel);
+        return false;
+    }
+    return true;
+}
+
+void Esp32SoftwareSerial::rmtEnd() {
+    if (m_rmtRx) {
+        rmt_driver_uninstall(static_cast<rmt_channel_t>(m_rmtRxChannel));
+        m_rmtRxRing = nullptr;
+        m_rmtRx = false;
+        m_rxValid = false;
+        m_rxEnabled = false;
+    }
+    if (m_rmtTx) {
+        rmt_driver_uninstall(static_cast<rmt_channel_t>(m_rmtTxChannel));
+        m_rmtTx = false;
+    }
+}
+
+size_t Esp32SoftwareSerial::rmtWrite(const uint8_t * buffer, size_t size, Esp32SoftwareSerialParity parity) {
+    const rmt_channel_t channel = static_cast<rmt_channel_t>(m_rmtTxChannel);
+    // a frame has up to m_pduBits + 1 runs, plus the half item left by the previous one
+    const size_t frameItems = (m_pduBits + 4) / 2;
+    rmt_item32_t items[RMT_TX_ITEMS];
+    size_t count = 0;
+    bool half = false;
+
+    if (m_txEnableValid) {
+        digitalWrite(m_txEnablePin, HIGH);
+    }
+    for (size_t cnt = 0; cnt < size; ++cnt) {
+        if (count + frameItems > RMT_TX_ITEMS) {
+            // The driver copies a chunk that fits its memory before returning, so the
+            // next one is encoded while this one is sent. A short idle gap between
+            // chunks only stretches the stop bit.
+            rmt_write_items(channel, items, count + half, false);
+            count = 0;
+            half = false;
+        }
+        uint32_t word = txWord(buffer[cnt], parity);
+        for (int i = 0; i <= m_pduBits;) {
+            bool level = word & (1UL << i);
+            int run = 1;
+            while (i + run <= m_pduBits && static_cast<bool>(word & (1UL << (i + run))) == level) ++run;
+            i += run;
+            if (!half) {
+                // a zero duration1 doubles as the end marker if nothing follows
+                items[count].level0 = level;
+                items[count].duration0 = run * m_rmtBitTicks;
+                items[count].level1 = level;
+                items[count].duration1 = 0;
+            }
+            else {
+                items[count].level1 = level;
+                items[count].duration1 = run * m_rmtBitTicks;
+                ++count;
+            }
+            half = !half;
+        }
+    }
+    if (count + half) {
+        rmt_write_items(channel, items, count + half, false);
+    }
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+    if (m_txEnableValid) {
+        digitalWrite(m_txEnablePin, LOW);
+    }
+    return size;
+}
+
+void Esp32SoftwareSerial::rmtRxBits(const rmt_item32_t * items, size_t count) {
+    for (size_t i = 0; i < count * 2; ++i) {
+        uint32_t ticks = (i & 1) ? items[i / 2].duration1 : items[i / 2].duration0;
+        bool level = (i & 1) ? items[i / 2].level1 : items[i / 2].level0;
+        if (!ticks) break;
+        uint32_t bits = (ticks + m_rmtBitTicks / 2) / m_rmtBitTicks;
+        if (bits > m_pduBits + 1U) bits = m_pduBits + 1U;
+        rxBits(level ^ m_invert, bits);
+    }
+    // Reception ended on an idle line, which may be the stop bit of the last byte
+    rxBits(true, m_pduBits + 1);
+}
+#endif
+
 void Esp32SoftwareSerial::onReceive(Delegate<void(int available), void*> handler) {
     receiveHandler = handler;
 }
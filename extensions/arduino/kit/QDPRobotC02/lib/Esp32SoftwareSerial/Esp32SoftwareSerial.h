@@ -26,6 +26,16 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "circular_queue/circular_queue.h"
 #include <Stream.h>
+#ifdef ESP32
+#include <driver/rmt.h>
+#endif
+
+/// RMT memory blocks of 64 items used by the RX channel, borrowed from the channels that follow it.
+/// A burst of bytes without an idle line between them has to fit, each byte takes up to
+/// (start, data, parity and stop bit count + 1) / 2 items.
+#ifndef SWSERIAL_RMT_RX_BLOCKS
+#define SWSERIAL_RMT_RX_BLOCKS 4
+#endif
 
 enum Esp32SoftwareSerialParity : uint8_t {
     SWSERIAL_PARITY_NONE = 000,
@@ -124,6 +134,14 @@ public:
     void setTransmitEnablePin(int8_t txEnablePin);
     /// Enable or disable interrupts during tx.
     void enableIntTx(bool on);
+    /// Use ESP32 RMT channels instead of bit banging and pin interrupts. TX waveforms are played
+    /// by the RMT and RX edges are captured by it and decoded in bulk, which keeps the CPU free
+    /// at high bitrates. Call before begin(). Not used for onewire.
+    /// @param txChannel -1 or the RMT channel for TX, it takes one memory block
+    /// @param rxChannel -1 or the RMT channel for RX, it takes SWSERIAL_RMT_RX_BLOCKS memory blocks,
+    /// those of the channels from rxChannel on, so txChannel must not be one of them
+    /// @return false, and nothing changed, for channels out of range or sharing memory blocks
+    bool enableRmt(int8_t txChannel, int8_t rxChannel);
 
     bool overflow();
 
@@ -208,9 +226,18 @@ private:
     void writePeriod(
         uint32_t dutyCycle, uint32_t offCycle, bool withStopBit);
     bool isValidGPIOpin(int8_t pin);
+    /// @returns The line levels of a whole frame, LSB is the start bit.
+    uint32_t txWord(uint8_t byte, Esp32SoftwareSerialParity parity);
     /* check m_rxValid that calling is safe */
     void rxBits();
     void rxBits(const uint32_t& isrCycle);
+    void rxBits(bool level, uint8_t bits);
+#ifdef ESP32
+    bool rmtBegin(int isrBufCapacity);
+    void rmtEnd();
+    size_t rmtWrite(const uint8_t* buffer, size_t size, Esp32SoftwareSerialParity parity);
+    void rmtRxBits(const rmt_item32_t* items, size_t count);
+#endif
 
     static void rxBitISR(Esp32SoftwareSerial* self);
     static void rxBitSyncISR(Esp32SoftwareSerial* self);
@@ -250,6 +277,15 @@ private:
     uint32_t m_isrLastCycle;
     bool m_rxCurParity = false;
     Delegate<void(int available), void*> receiveHandler;
+    int8_t m_rmtTxChannel = -1;
+    int8_t m_rmtRxChannel = -1;
+    bool m_rmtTx = false;
+    bool m_rmtRx = false;
+#ifdef ESP32
+    uint8_t m_rmtClkDiv;
+    uint32_t m_rmtBitTicks;
+    RingbufHandle_t m_rmtRxRing = nullptr;
+#endif
 };
 
 #endif // __Esp32SoftwareSerial_h
@@ -0,0 +1,291 @@
+/*
+ * I2CBus.cpp
+ *
+ * Shared queue for the I2C bus.
+ *
+ * Released into the MIT License.
+ */
+
+#include "I2CBus.h"
+
+I2CBus::I2CBus(TwoWire &w) {
+  wire = &w;
+}
+
+/*
+ * Wire itself must already be started. On ESP32 this starts the task that
+ * runs the queue.
+ */
+void I2CBus::begin() {
+  if (running)
+    return;
+  running = true;
+#ifdef I2CBUS_TASK
+  xTaskCreatePinnedToCore(task, "I2CBus", I2CBUS_TASK_STACK, this,
+                          I2CBUS_TASK_PRIORITY, (TaskHandle_t *)&worker, I2CBUS_TASK_CORE);
+#endif
+}
+
+/*
+ * Waits for the transaction on the bus, if any. Queued ones stay queued
+ * and run after the next begin().
+ */
+void I2CBus::end() {
+  if (!running)
+    return;
+  running = false;
+#ifdef I2CBUS_TASK
+  xTaskNotifyGive(worker);
+  while (worker != NULL)
+    delay(1);
+#endif
+}
+
+/*
+ * Returns false when the bus is not started, the transaction is still
+ * pending or a length is over I2CBUS_MAX_LENGTH. Lengths of 0 for both the
+ * write and the read probe the address.
+ */
+bool I2CBus::submit(I2CTransaction &t) {
+  if (!running || t.pending() || t.address > 0x7F
+      || t.writeLength > I2CBUS_MAX_LENGTH || t.readLength > I2CBUS_MAX_LENGTH)
+    return false;
+
+  t.error = I2CBUS_OK;
+  t.queued = micros();
+  lock();
+  I2CTransaction **p = &queue;
+  while (*p != NULL && (*p)->priority >= t.priority)
+    p = &(*p)->next;
+  t.next = *p;
+  *p = &t;
+  t.status = I2CBUS_QUEUED;
+  unlock();
+#ifdef I2CBUS_TASK
+  if (worker != NULL)
+    xTaskNotifyGive(worker);
+#endif
+  return true;
+}
+
+/*
+ * Only a transaction still waiting in the queue can be cancelled, its
+ * callback is not called.
+ */
+bool I2CBus::cancel(I2CTransaction &t) {
+  bool found = false;
+
+  lock();
+  if (t.status == I2CBUS_QUEUED) {
+    for (I2CTransaction **p = &queue; *p != NULL; p = &(*p)->next) {
+      if (*p == &t) {
+        *p = t.next;
+        found = true;
+        break;
+      }
+    }
+  }
+  unlock();
+  if (found) {
+    t.next = NULL;
+    t.error = I2CBUS_CANCELLED;
+    t.status = I2CBUS_DONE;
+  }
+  return found;
+}
+
+/*
+ * Call from loop(). Outside ESP32 this runs the queue first, stopping once
+ * the time budget is spent, if one is set. Finished transactions become
+ * done() and their callbacks are called here, so callbacks never run in an
+ * interrupt or in the bus task. A transaction submitted again from its
+ * callback runs on the next poll().
+ */
+void I2CBus::poll() {
+#ifndef I2CBUS_TASK
+  if (running) {
+    unsigned long start = micros();
+    I2CTransaction *t;
+    while ((t = take()) != NULL) {
+      execute(t);
+      if (budget != 0 && micros() - start >= budget)
+        break;
+    }
+  }
+#endif
+
+  for (;;) {
+    lock();
+    I2CTransaction *t = finishedHead;
+    if (t != NULL) {
+      finishedHead = t->next;
+      if (finishedHead == NULL)
+        finishedTail = NULL;
+    }
+    unlock();
+    if (t == NULL)
+      break;
+    t->next = NULL;
+    t->status = I2CBUS_DONE;
+    if (t->callback != NULL)
+      t->callback(*t);
+  }
+}
+
+/*
+ * True while a transaction is queued, on the bus or waiting for poll()
+ */
+bool I2CBus::busy() {
+  lock();
+  bool b = queue != NULL || current != NULL || finishedHead != NULL;
+  unlock();
+  return b;
+}
+
+I2CTransaction *I2CBus::take() {
+  lock();
+  I2CTransaction *t = queue;
+  if (t != NULL) {
+    queue = t->next;
+    t->next = NULL;
+    t->status = I2CBUS_ACTIVE;
+    current = t;
+  }
+  unlock();
+  return t;
+}
+
+void I2CBus::execute(I2CTransaction *t) {
+  uint8_t err = I2CBUS_OK;
+
+  t->started = micros();
+  if (t->writeLength != 0 || t->readLength == 0) {
+    wire->beginTransmission(t->address);
+    if (t->writeLength != 0)
+      wire->write(t->writeBuffer, t->writeLength);
+    err = wire->endTransmission(t->readLength == 0 || t->stopAfterWrite);
+  }
+  if (err == I2CBUS_OK && t->readLength != 0) {
+    uint8_t n = wire->requestFrom(t->address, t->readLength);
+    if (n < t->readLength)
+      err = I2CBUS_SHORT_READ;
+    for (uint8_t i = 0; i < n && i < t->readLength; i++)
+      t->readBuffer[i] = wire->read();
+  }
+  t->finished = micros();
+  t->error = err;
+
+  lock();
+  account(t);
+  if (finishedTail != NULL)
+    finishedTail->next = t;
+  else
+    finishedHead = t;
+  finishedTail = t;
+  current = NULL;
+  unlock();
+}
+
+void I2CBus::account(I2CTransaction *t) {
+  I2CBusStats *s = NULL;
+
+  for (uint8_t i = 0; i < devices; i++) {
+    if (device[i].address == t->address) {
+      s = &device[i];
+      break;
+    }
+  }
+  if (s == NULL) {
+    if (devices >= I2CBUS_MAX_DEVICES)
+      return;
+    s = &device[devices++];
+    memset(s, 0, sizeof(*s));
+    s->address = t->address;
+  }
+
+  uint32_t bus = t->finished - t->started;
+  uint32_t wait = t->finished - t->queued;
+  s->transactions++;
+  if (t->error != I2CBUS_OK)
+    s->errors++;
+  s->bytes += t->writeLength + t->readLength;
+  s->busTime += bus;
+  if (bus > s->maxBusTime)
+    s->maxBusTime = bus;
+  if (wait > s->maxLatency)
+    s->maxLatency = wait;
+}
+
+/*
+ * Copies the statistics of a device, false when it has not used the bus
+ */
+bool I2CBus::stats(uint8_t address, I2CBusStats &out) {
+  bool found = false;
+
+  lock();
+  for (uint8_t i = 0; i < devices; i++) {
+    if (device[i].address == address) {
+      out = device[i];
+      found = true;
+      break;
+    }
+  }
+  unlock();
+  return found;
+}
+
+/*
+ * Same as stats() by index, devices are listed in order of first use
+ */
+bool I2CBus::statsAt(uint8_t index, I2CBusStats &out) {
+  bool found = false;
+
+  lock();
+  if (index < devices) {
+    out = device[index];
+    found = true;
+  }
+  unlock();
+  return found;
+}
+
+void I2CBus::resetStats() {
+  lock();
+  devices = 0;
+  unlock();
+}
+
+#ifdef I2CBUS_TASK
+
+void I2CBus::lock() {
+  portENTER_CRITICAL(&mux);
+}
+
+void I2CBus::unlock() {
+  portEXIT_CRITICAL(&mux);
+}
+
+void I2CBus::task(void *self) {
+  I2CBus *bus = (I2CBus *)self;
+
+  while (bus->running) {
+    I2CTransaction *t = bus->take();
+    if (t != NULL)
+      bus->execute(t);
+    else
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  bus->worker = NULL;
+  vTaskDelete(NULL);
+}
+
+#else
+
+/*
+ * Everything runs from loop(), no locking needed
+ */
+void I2CBus::lock() {}
+
+void I2CBus::unlock() {}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * I2CBus.h
+ *
+ * Shared queue for the I2C bus. Drivers describe a transfer (an optional
+ * write, then an optional read after a repeated start) and submit it with a
+ * priority instead of calling Wire themselves. Transfers run back to back in
+ * priority order and the requester is told through a callback, or by polling
+ * the transaction it owns.
+ *
+ * On ESP32 a background task runs the queue, so loop() only waits for the
+ * callbacks. Other boards have no non-blocking Wire, there poll() runs the
+ * queue with blocking Wire calls, optionally limited by a time budget.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef I2CBus_h
+#define I2CBus_h
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#if defined(ESP32)
+  #include "freertos/FreeRTOS.h"
+  #include "freertos/task.h"
+  #define I2CBUS_TASK 1
+#endif
+
+/*
+ * Devices with separate statistics, further addresses are not counted
+ */
+#ifndef I2CBUS_MAX_DEVICES
+#define I2CBUS_MAX_DEVICES 8
+#endif
+
+/*
+ * Largest write or read of one transaction, the Wire buffer size
+ */
+#ifndef I2CBUS_MAX_LENGTH
+  #if defined(I2C_BUFFER_LENGTH)
+    #define I2CBUS_MAX_LENGTH I2C_BUFFER_LENGTH
+  #elif defined(BUFFER_LENGTH)
+    #define I2CBUS_MAX_LENGTH BUFFER_LENGTH
+  #else
+    #define I2CBUS_MAX_LENGTH 32
+  #endif
+#endif
+
+#ifndef I2CBUS_TASK_STACK
+#define I2CBUS_TASK_STACK 2048
+#endif
+
+#ifndef I2CBUS_TASK_PRIORITY
+#define I2CBUS_TASK_PRIORITY 2
+#endif
+
+#ifndef I2CBUS_TASK_CORE
+  #ifdef CONFIG_ARDUINO_RUNNING_CORE
+    #define I2CBUS_TASK_CORE CONFIG_ARDUINO_RUNNING_CORE
+  #else
+    #define I2CBUS_TASK_CORE tskNO_AFFINITY
+  #endif
+#endif
+
+#define I2CBUS_IDLE 0
+#define I2CBUS_QUEUED 1
+#define I2CBUS_ACTIVE 2
+#define I2CBUS_DONE 3
+
+/*
+ * Errors 1..4 are the endTransmission() codes
+ */
+#define I2CBUS_OK 0
+#define I2CBUS_SHORT_READ 5
+#define I2CBUS_CANCELLED 6
+
+class I2CTransaction;
+
+typedef void (*I2CCallback)(I2CTransaction &t);
+
+/*
+ * One transfer. The submitter owns it and its buffers, they must stay valid
+ * until done() is true. A transaction can be submitted again once done.
+ */
+class I2CTransaction {
+  public:
+    I2CTransaction() {}
+    I2CTransaction(uint8_t addr, const uint8_t *wbuf, uint8_t wlen,
+                   uint8_t *rbuf, uint8_t rlen, uint8_t prio = 0,
+                   I2CCallback cb = NULL, void *userArg = NULL)
+      : address(addr), writeBuffer(wbuf), writeLength(wlen),
+        readBuffer(rbuf), readLength(rlen), priority(prio),
+        callback(cb), arg(userArg) {}
+
+    uint8_t address = 0;
+    const uint8_t *writeBuffer = NULL;
+    uint8_t writeLength = 0;
+    uint8_t *readBuffer = NULL;
+    uint8_t readLength = 0;
+    // higher runs first, equal priorities run in submit order
+    uint8_t priority = 0;
+    // the write ends with a stop instead of a repeated start
+    bool stopAfterWrite = false;
+    I2CCallback callback = NULL;
+    void *arg = NULL;
+
+    volatile uint8_t status = I2CBUS_IDLE;
+    uint8_t error = I2CBUS_OK;
+    // micros() stamps
+    unsigned long queued = 0;
+    unsigned long started = 0;
+    unsigned long finished = 0;
+
+    bool pending() {return status == I2CBUS_QUEUED || status == I2CBUS_ACTIVE;}
+    bool done() {return status == I2CBUS_DONE;}
+    bool ok() {return status == I2CBUS_DONE && error == I2CBUS_OK;}
+    unsigned long busTime() {return finished - started;}
+    unsigned long latency() {return finished - queued;}
+
+  private:
+    I2CTransaction *next = NULL;
+    friend class I2CBus;
+};
+
+struct I2CBusStats {
+  uint8_t address;
+  uint32_t transactions;
+  uint32_t errors;
+  uint32_t bytes;
+  // microseconds the device held the bus, in total and at most at once
+  uint32_t busTime;
+  uint32_t maxBusTime;
+  // microseconds from submit to completion, at most
+  uint32_t maxLatency;
+};
+
+class I2CBus {
+  public:
+    I2CBus(TwoWire &w = Wire);
+    void begin();
+    void end();
+    bool submit(I2CTransaction &t);
+    bool cancel(I2CTransaction &t);
+    void poll();
+    bool busy();
+    void setTimeBudget(unsigned long us) {budget = us;}
+    uint8_t deviceCount() {return devices;}
+    bool stats(uint8_t address, I2CBusStats &out);
+    bool statsAt(uint8_t index, I2CBusStats &out);
+    void resetStats();
+
+  private:
+    TwoWire *wire;
+    I2CTransaction *queue = NULL;
+    I2CTransaction *finishedHead = NULL;
+    I2CTransaction *finishedTail = NULL;
+    I2CTransaction *current = NULL;
+    unsigned long budget = 0;
+    volatile bool running = false;
+    I2CBusStats device[I2CBUS_MAX_DEVICES];
+    uint8_t devices = 0;
+
+    I2CTransaction *take();
+    void execute(I2CTransaction *t);
+    void account(I2CTransaction *t);
+    void lock();
+    void unlock();
+
+#ifdef I2CBUS_TASK
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t volatile worker = NULL;
+    static void task(void *self);
+#endif
+};
+
+#endif // I2CBus_h
@@ -52,6 +52,15 @@
 #define Rw B00000010  // Read/Write bit
 #define Rs B00000001  // Register select bit
 
+// characters per I2C transaction, each takes 6 expander bytes and
+// 30 bytes fit the 32 byte Wire buffer of the AVR core
+#ifndef LCD_TX_CHARS
+#define LCD_TX_CHARS 5
+#endif
+
+// unchanged cells flush() rewrites rather than moving the cursor
+#define LCD_FLUSH_GAP 1
+
 class LiquidCrystal_I2C : public Print {
 public:
   LiquidCrystal_I2C(uint8_t lcd_Addr,uint8_t lcd_cols,uint8_t lcd_rows);
@@ -83,12 +92,21 @@ public:
   void setCursor(uint8_t, uint8_t); 
 #if defined(ARDUINO) && ARDUINO >= 100
   virtual size_t write(uint8_t);
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
 #else
   virtual void write(uint8_t);
 #endif
   void command(uint8_t);
   void init();
 
+  // Keep a copy of the screen in RAM: print(), setCursor(), clear() and home()
+  // only change the copy and flush() sends the cells that differ from the
+  // display. The display is cleared first, left to right text is assumed.
+  bool beginShadow();
+  void endShadow();
+  void flush();
+
 ////compatibility API function aliases
 void blink_on();						// alias for blink()
 void blink_off();       					// alias for noBlink()
@@ -113,9 +131,16 @@ void draw_vertical_graph(uint8_t row, uint8_t column, uint8_t len,  uint8_t pixe
 private:
   void init_priv();
   void send(uint8_t, uint8_t);
+  void sendRun(const uint8_t *data, uint8_t len);
+  void queueNibble(uint8_t);
+  void putChar(uint8_t);
   void write4bits(uint8_t);
   void expanderWrite(uint8_t);
-  void pulseEnable(uint8_t);
+  uint8_t rowOffset(uint8_t row);
+  uint8_t *_shadow;	// _cols * _rows wanted, followed by _cols * _rows shown
+  uint8_t _shadowCol;
+  uint8_t _shadowRow;
+  uint8_t _ddram;	// address counter of the display, 0xFF when unknown
   uint8_t _Addr;
   uint8_t _displayfunction;
   uint8_t _displaycontrol;
@@ -3,8 +3,9 @@
 
 #define struct_member_size(type, member) sizeof(((type *)0)->member)
 
-NoiselessTouchESP32::NoiselessTouchESP32(uint8_t pin) {
-  NoiselessTouchESP32(pin, 6, 3);
+#define BASELINE_SHIFT 8 // baseline follows 1/256 of the difference per sample
+
+NoiselessTouchESP32::NoiselessTouchESP32(uint8_t pin) : NoiselessTouchESP32(pin, 6, 3) {
 }
 
 NoiselessTouchESP32::NoiselessTouchESP32(uint8_t pin, uint8_t history_length, uint8_t hysteresis) {
@@ -19,24 +20,66 @@ NoiselessTouchESP32::NoiselessTouchESP32(uint8_t pin, uint8_t history_length, ui
     last_event_ms : 0
   };
   _data = touch;
-  for( _data.hist_cur = 0; _data.hist_cur < _data.hist_len; _data.hist_cur++ ) {
-    _data.history[_data.hist_cur] = touchRead(_data.pin);
+  _data.threshold = 20;
+  _data.debounce = 2;
+  for( uint8_t i = 0; i < _data.hist_len; i++ ) {
+    push_sample(touchRead(_data.pin));
   }
-  _data.last = value_from_history();  
+  _data.last = value_from_history();
+  _data.baseline = (int32_t)_data.last << BASELINE_SHIFT;
+}
+
+// Replaces the oldest sample and keeps the window sum, minimum and maximum
+// up to date: each queue only holds samples that can still become the
+// minimum (or maximum) of a later window, so a sample costs O(1) amortised
+// instead of a pass over the whole history. The sample leaving the window
+// is dropped before the new one goes in, so a queue never holds more than
+// hist_len entries.
+void NoiselessTouchESP32::push_sample(uint8_t value) {
+  uint16_t seq = ++_data.samples;
+
+  _data.sum += value - _data.history[_data.hist_cur];
+  _data.history[_data.hist_cur] = value;
+  _data.hist_cur = (_data.hist_cur + 1) % _data.hist_len;
+
+  while( _data.min_size > 0 && _data.min_val[(_data.min_head + _data.min_size - 1) & 15] >= value ) {
+    _data.min_size--;
+  }
+  if( _data.min_size > 0 && (uint16_t)(seq - _data.min_seq[_data.min_head]) >= _data.hist_len ) {
+    _data.min_head = (_data.min_head + 1) & 15;
+    _data.min_size--;
+  }
+  _data.min_val[(_data.min_head + _data.min_size) & 15] = value;
+  _data.min_seq[(_data.min_head + _data.min_size) & 15] = seq;
+  _data.min_size++;
+
+  while( _data.max_size > 0 && _data.max_val[(_data.max_head + _data.max_size - 1) & 15] <= value ) {
+    _data.max_size--;
+  }
+  if( _data.max_size > 0 && (uint16_t)(seq - _data.max_seq[_data.max_head]) >= _data.hist_len ) {
+    _data.max_head = (_data.max_head + 1) & 15;
+    _data.max_size--;
+  }
+  _data.max_val[(_data.max_head + _data.max_size) & 15] = value;
+  _data.max_seq[(_data.max_head + _data.max_size) & 15] = seq;
+  _data.max_size++;
 }
 
 int NoiselessTouchESP32::value_from_history() {
-  uint8_t minimum = _data.history[0];
-  uint8_t maximum = _data.history[0];
-  uint8_t mean = 0;
-  uint32_t sum = 0;
-  for( int i = 0; i < _data.hist_len; i++) {
-    minimum = _min(minimum, _data.history[i]);
-    maximum = _max(maximum, _data.history[i]);
-    sum += _data.history[i];
-  }
-  mean = sum / _data.hist_len;
+  uint8_t minimum = _data.min_val[_data.min_head];
+  uint8_t maximum = _data.max_val[_data.max_head];
+  uint8_t mean = _data.sum / _data.hist_len;
   //Serial.printf("mean: %d\n", mean);
+  if( mean - minimum > _data.hysteresis || maximum - mean > _data.hysteresis ) {
+    return reject_outliers(minimum, maximum, mean);
+  }
+  return mean;
+}
+
+// Only a window spreading wider than the hysteresis needs the passes
+// narrowing it down to the samples around the mean.
+int NoiselessTouchESP32::reject_outliers(uint8_t minimum, uint8_t maximum, uint8_t mean) {
+  uint32_t sum;
   while( mean - minimum > _data.hysteresis || maximum - mean > _data.hysteresis ) {
     //Serial.printf("abs(%d - %d) = %d\n", maximum, minimum, abs(maximum - minimum));
     uint8_t ldelta = abs(mean - minimum);
@@ -70,8 +113,7 @@ int NoiselessTouchESP32::value_from_history() {
 }
 
 int NoiselessTouchESP32::read_raw_mean() {
-  _data.hist_cur = (_data.hist_cur + 1) % _data.hist_len;
-  _data.history[_data.hist_cur] = touchRead(_data.pin);
+  push_sample(touchRead(_data.pin));
   return value_from_history();
 }
 
@@ -142,3 +184,51 @@ bool NoiselessTouchESP32::touching() {
   return _data.last_event == 1;
 }
 
+// Takes one sample and tracks touches against a baseline that slowly
+// follows humidity and temperature drift while the pad is released, and
+// freezes while it is pressed. The pad is pressed once the filtered value
+// stays threshold percent below the baseline for debounce samples, and
+// released again above half the threshold. Returns true on an event.
+bool NoiselessTouchESP32::update() {
+  int32_t val = (int32_t)read_raw_mean() << BASELINE_SHIFT;
+  int32_t limit = _data.baseline / 100 * (_data.pressed ? 100 - _data.threshold / 2 : 100 - _data.threshold);
+  bool down = val < limit;
+
+  if( !_data.pressed && !down ) {
+    _data.baseline += (val - _data.baseline) / (1 << BASELINE_SHIFT);
+  }
+  if( down == _data.pressed ) {
+    _data.pending = 0;
+    return false;
+  }
+  if( ++_data.pending < _data.debounce ) {
+    return false;
+  }
+  _data.pending = 0;
+  _data.pressed = down;
+  _data.event = down ? TOUCH_EVENT_PRESSED : TOUCH_EVENT_RELEASED;
+  return true;
+}
+
+// Returns and clears the last event of update(), 0 when there was none.
+int NoiselessTouchESP32::event() {
+  int e = _data.event;
+  _data.event = 0;
+  return e;
+}
+
+bool NoiselessTouchESP32::pressed() {
+  return _data.pressed;
+}
+
+int NoiselessTouchESP32::baseline() {
+  return _data.baseline >> BASELINE_SHIFT;
+}
+
+void NoiselessTouchESP32::set_threshold(uint8_t percent) {
+  _data.threshold = _max(_min(percent, 90), 1);
+}
+
+void NoiselessTouchESP32::set_debounce(uint8_t samples) {
+  _data.debounce = _max(samples, 1);
+}
@@ -3,6 +3,9 @@
 
 #include "Arduino.h"
 
+#define TOUCH_EVENT_PRESSED 1
+#define TOUCH_EVENT_RELEASED -1
+
 typedef struct Touchdata {
   uint8_t pin;
   uint8_t history[16];
@@ -12,13 +15,26 @@ typedef struct Touchdata {
   uint8_t last;
   int8_t last_event;
   uint32_t last_event_ms;
+  // running window statistics, min and max are monotonic queues of (value, sample)
+  uint16_t sum;
+  uint16_t samples;
+  uint8_t min_val[16], max_val[16];
+  uint16_t min_seq[16], max_seq[16];
+  uint8_t min_head, min_size, max_head, max_size;
+  // adaptive baseline and debounced touch state used by update()
+  int32_t baseline;
+  uint8_t threshold;
+  uint8_t debounce;
+  uint8_t pending;
+  bool pressed;
+  int8_t event;
 } Touchdata;
 
 class NoiselessTouchESP32 {
   public:
     NoiselessTouchESP32(uint8_t pin);
     NoiselessTouchESP32(uint8_t pin, uint8_t history_length, uint8_t hysteresis);
-    
+
     int value_from_history();
     int read_raw_mean();
     int read_with_hysteresis();
@@ -28,10 +44,19 @@ class NoiselessTouchESP32 {
     bool touching();
     int last_value();
 
+    bool update();
+    int event();
+    bool pressed();
+    int baseline();
+    void set_threshold(uint8_t percent);
+    void set_debounce(uint8_t samples);
+
   private:
     Touchdata _data;
+
+    void push_sample(uint8_t value);
+    int reject_outliers(uint8_t minimum, uint8_t maximum, uint8_t mean);
 };
 
 #endif
 
-
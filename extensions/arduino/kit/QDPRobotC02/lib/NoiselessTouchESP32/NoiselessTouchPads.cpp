@@ -0,0 +1,53 @@
+#include "Arduino.h"
+#include "NoiselessTouchPads.h"
+
+NoiselessTouchPads::NoiselessTouchPads(const uint8_t *pins, uint8_t count, uint8_t history_length, uint8_t hysteresis) {
+  _count = _min(count, TOUCH_PADS_MAX);
+  _next = 0;
+  for( uint8_t i = 0; i < _count; i++ ) {
+    _pads[i] = new NoiselessTouchESP32(pins[i], history_length, hysteresis);
+  }
+}
+
+NoiselessTouchPads::~NoiselessTouchPads() {
+  for( uint8_t i = 0; i < _count; i++ ) {
+    delete _pads[i];
+  }
+}
+
+// Samples every pad once, returns true if any of them changed state.
+bool NoiselessTouchPads::scan() {
+  bool any = false;
+  for( uint8_t i = 0; i < _count; i++ ) {
+    any |= _pads[i]->update();
+  }
+  return any;
+}
+
+// Returns the next pending TOUCH_EVENT_PRESSED or TOUCH_EVENT_RELEASED and
+// the pad it happened on, or 0 once all events of the last scan are read.
+int NoiselessTouchPads::next_event(uint8_t *index) {
+  for( ; _next < _count; _next++ ) {
+    int e = _pads[_next]->event();
+    if( e != 0 ) {
+      if( index ) {
+        *index = _next;
+      }
+      return e;
+    }
+  }
+  _next = 0;
+  return 0;
+}
+
+bool NoiselessTouchPads::pressed(uint8_t index) {
+  return index < _count && _pads[index]->pressed();
+}
+
+uint8_t NoiselessTouchPads::count() {
+  return _count;
+}
+
+NoiselessTouchESP32 &NoiselessTouchPads::pad(uint8_t index) {
+  return *_pads[_min(index, (uint8_t)(_count - 1))];
+}
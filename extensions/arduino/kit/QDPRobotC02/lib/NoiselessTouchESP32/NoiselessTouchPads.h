@@ -0,0 +1,27 @@
+#ifndef NoiselessTouchPads_h
+#define NoiselessTouchPads_h
+
+#include "Arduino.h"
+#include "NoiselessTouchESP32.h"
+
+#define TOUCH_PADS_MAX 10 // touch channels of the ESP32
+
+class NoiselessTouchPads {
+  public:
+    NoiselessTouchPads(const uint8_t *pins, uint8_t count, uint8_t history_length = 6, uint8_t hysteresis = 3);
+    ~NoiselessTouchPads();
+
+    bool scan();
+    int next_event(uint8_t *index);
+    bool pressed(uint8_t index);
+    uint8_t count();
+    NoiselessTouchESP32 &pad(uint8_t index);
+
+  private:
+    NoiselessTouchESP32 *_pads[TOUCH_PADS_MAX];
+    uint8_t _count;
+    uint8_t _next;
+};
+
+#endif
+
@@ -5,11 +5,41 @@
 
 #include <Arduino.h>
 
+#if defined(ESP32)
+#ifndef QDPBUZZER_LEDC_CHANNEL
+#define QDPBUZZER_LEDC_CHANNEL 14
+#endif
+#endif
+
+// The tone comes from the core tone(), Timer2 on an Uno, or LEDC on ESP32.
+// tone() and startMusic() return at once, poll() from loop() moves the
+// song on and ends the tone. A tone or song replaces the one playing.
 class QDPBuzzer {
   public:
+    QDPBuzzer();
     void tone(uint8_t pin, uint16_t frequency, uint32_t duration);
     void noTone(uint8_t pin);
+    // plays song num to the end before it returns
     void buzzer_music(uint8_t pin, uint8_t num);
+    void startMusic(uint8_t pin, uint8_t num, void (*done)(void) = NULL);
+    // true while a tone or song plays
+    bool poll(void);
+    bool isPlaying(void);
+    void stop(void);
+
+  private:
+    void startNote(void);
+    void startTone(uint16_t frequency, uint32_t duration);
+    void stopTone(void);
+    uint8_t _pin;
+    const int *_music;
+    const float *_rhythm;
+    uint8_t _index;
+    // 0 a note, 1 the gap after it, 2 the pause after the song
+    uint8_t _step;
+    bool _playing;
+    unsigned long _last, _wait;
+    void (*_done)(void);
 };
 
-#endif
\ No newline at end of file
+#endif
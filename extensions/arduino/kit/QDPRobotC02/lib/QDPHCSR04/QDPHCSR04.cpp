@@ -34,7 +34,8 @@ long UltraSonicDistanceSensor::measureDistance() {
     delayMicroseconds(10);
     digitalWrite(triggerPin, LOW);
     // Measure the length of echo signal, which is equal to the time needed for sound to go there and back.
-    unsigned long durationMicroSec = pulseIn(echoPin, HIGH);
+    // Stop waiting past the 888cm reported as out of range instead of pulseIn's one second default.
+    unsigned long durationMicroSec = pulseIn(echoPin, HIGH, 52000UL);
     return durationMicroSec;
 
 }
\ No newline at end of file
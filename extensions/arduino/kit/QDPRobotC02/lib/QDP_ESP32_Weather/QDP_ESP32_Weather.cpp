@@ -1,17 +1,48 @@
 #include "QDP_ESP32_Weather.h"
 
+static void copyField(char *dst, size_t size, const char *src){
+  if (src == NULL) {
+    dst[0] = 0;
+    return;
+  }
+  strncpy(dst, src, size - 1);
+  dst[size - 1] = 0;
+}
+
+QDP_ESP32_Weather::QDP_ESP32_Weather(uint32_t cacheTime){
+  memset(&Today, 0, sizeof(Today));
+  memset(Forecast, 0, sizeof(Forecast));
+  _cacheTime = cacheTime;
+  _lastRefresh = 0;
+  _valid = false;
+}
+
+String QDP_ESP32_Weather::getToday(uint8_t i){
+  switch (i) {
+    case 0: return Today.shidu;
+    case 1: return String(Today.pm25);
+    case 2: return String(Today.pm10);
+    case 3: return Today.quality;
+    case 4: return Today.wendu;
+  }
+  return String();
+}
+
 boolean QDP_ESP32_Weather::RefreshData(String CityCode){
+  // serve from the cache while the last result is fresh
+  if (_valid && _cacheTime && CityCode == _city && millis() - _lastRefresh < _cacheTime) {
+    return true;
+  }
 	boolean result;
 	if (WiFi.status() == WL_CONNECTED) {
     HTTPClient http;
+    // HTTP/1.0 avoids chunked transfer encoding so the body can be parsed from the stream
+    http.useHTTP10(true);
         http.begin("\u0068\u0074\u0074\u0070\u003A\u002F\u002F\u0074\u002E\u0077\u0065\u0061\u0074\u0068\u0065\u0072\u002E\u0069\u0074\u0062\u006F\u0079\u002E\u006E\u0065\u0074\u002F\u0061\u0070\u0069\u002F\u0077\u0065\u0061\u0074\u0068\u0065\u0072\u002F\u0063\u0069\u0074\u0079\u002F"+CityCode);
 
     int httpCode = http.GET();
     if (httpCode > 0) {
-      String Request_result = http.getString();
-      // Serial.println(Request_result);
-      //Serial.println("-------------------");
-      result = ParseJson(Request_result);
+      result = ParseJson(http.getStream());
     }
     else {
       Serial.println("Invalid response!");
@@ -20,13 +51,52 @@ boolean QDP_ESP32_Weather::RefreshData(String CityCode){
     http.end();
   }else{
   	result = false;
-  }  
+  }
+  if (result) {
+    _city = CityCode;
+    _lastRefresh = millis();
+    _valid = true;
+  }
   return result;
 }
 
+void QDP_ESP32_Weather::_buildFilter(JsonDocument &filter){
+  JsonObject data = filter.createNestedObject("data");
+  data["shidu"] = true;
+  data["pm25"] = true;
+  data["pm10"] = true;
+  data["quality"] = true;
+  data["wendu"] = true;
+  // the first element of an array filter applies to all elements
+  JsonObject elem = data.createNestedArray("forecast").createNestedObject();
+  elem["date"] = true;
+  elem["high"] = true;
+  elem["low"] = true;
+  elem["ymd"] = true;
+  elem["week"] = true;
+  elem["aqi"] = true;
+  elem["fx"] = true;
+  elem["fl"] = true;
+  elem["type"] = true;
+}
+
 boolean QDP_ESP32_Weather::ParseJson(String json) {
-  StaticJsonDocument<6144> doc;
-  DeserializationError error = deserializeJson(doc, json);
+  StaticJsonDocument<WEATHER_FILTER_DOC_SIZE> filter;
+  _buildFilter(filter);
+  StaticJsonDocument<WEATHER_JSON_DOC_SIZE> doc;
+  DeserializationError error = deserializeJson(doc, json, DeserializationOption::Filter(filter));
+  return _parse(doc, error);
+}
+
+boolean QDP_ESP32_Weather::ParseJson(Stream &stream) {
+  StaticJsonDocument<WEATHER_FILTER_DOC_SIZE> filter;
+  _buildFilter(filter);
+  StaticJsonDocument<WEATHER_JSON_DOC_SIZE> doc;
+  DeserializationError error = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+  return _parse(doc, error);
+}
+
+boolean QDP_ESP32_Weather::_parse(JsonDocument &doc, DeserializationError error) {
   if (error) {
     Serial.print(F("deserializeJson() failed: "));
     Serial.println(error.f_str());
@@ -34,44 +104,28 @@ boolean QDP_ESP32_Weather::ParseJson(String json) {
   }
 
   JsonObject data = doc["data"];
-	const char* data_shidu = data["shidu"]; // "61%"
-	int data_pm25 = data["pm25"]; // 31
-	int data_pm10 = data["pm10"]; // 66
-	const char* data_quality = data["quality"]; // "良"
-	const char* data_wendu = data["wendu"]; // "31"
-	Today[0] = data_shidu;
-	Today[1] = String(data_pm25);
-	Today[2] = String(data_pm10);
-	Today[3] = data_quality;
-	Today[4] = data_wendu;
+  copyField(Today.shidu, sizeof(Today.shidu), data["shidu"]); // "61%"
+  Today.pm25 = data["pm25"]; // 31
+  Today.pm10 = data["pm10"]; // 66
+  copyField(Today.quality, sizeof(Today.quality), data["quality"]); // "良"
+  copyField(Today.wendu, sizeof(Today.wendu), data["wendu"]); // "31"
 
   int i=0;
   for (JsonObject elem : data["forecast"].as<JsonArray>()) {
-
-  const char* date = elem["date"]; // "06", "07", "08", "09", "10", "11", "12", "13", "14", "15", "16", ...
-  const char* high = elem["high"]; // "高温 31℃", "高温 31℃", "高温 31℃", "高温 30℃", "高温 30℃", "高温 29℃", "高温 ...
-  const char* low = elem["low"]; // "低温 23℃", "低温 25℃", "低温 26℃", "低温 25℃", "低温 25℃", "低温 26℃", "低温 27℃", ...
-  const char* ymd = elem["ymd"]; // "2021-05-06", "2021-05-07", "2021-05-08", "2021-05-09", "2021-05-10", ...
-  const char* week = elem["week"]; // "星期四", "星期五", "星期六", "星期日", "星期一", "星期二", "星期三", "星期四", "星期五", ...
-  // const char* sunrise = elem["sunrise"]; // "05:48", "05:48", "05:47", "05:46", "05:46", "05:45", "05:45", ...
-  // const char* sunset = elem["sunset"]; // "18:53", "18:53", "18:54", "18:54", "18:54", "18:55", "18:55", ...
-  int aqi = elem["aqi"]; // 29, 38, 40, 37, 42, 17, 16, 18, 27, 35, 53, 34, 26, 31, 37
-  const char* fx = elem["fx"]; // "东南风", "南风", "南风", "南风", "南风", "南风", "南风", "南风", "东南风", "南风", "东南风", ...
-  const char* fl = elem["fl"]; // "3级", "2级", "2级", "2级", "3级", "3级", "2级", "2级", "3级", "2级", "2级", "2级", ...
-  const char* type = elem["type"]; // "晴", "晴", "多云", "多云", "多云", "阵雨", "阵雨", "多云", "多云", "晴", "阴", "多云", ...
-  // const char* notice = elem["notice"]; // "愿你拥有比阳光明媚的心情", "愿你拥有比阳光明媚的心情", "阴晴之间，谨防紫外线侵扰", "阴晴之间，谨防紫外线侵扰", ...
-  ForecastDate[i] = date;
-  ForecastHigh[i] = high;
-  ForecastLow[i] = low;
-  ForecastYmd[i] = ymd;
-  ForecastWeek[i] = week;
-  ForecastAqi[i] = String(aqi);
-  ForecastFx[i] = fx;
-  ForecastFl[i] = fl;
-  ForecastType[i] = type;
-  i++;
-
-}
+    if (i >= WEATHER_FORECAST_DAYS)
+      break;
+    QDP_WeatherForecast &f = Forecast[i];
+    copyField(f.date, sizeof(f.date), elem["date"]); // "06"
+    copyField(f.high, sizeof(f.high), elem["high"]); // "高温 31℃"
+    copyField(f.low, sizeof(f.low), elem["low"]); // "低温 23℃"
+    copyField(f.ymd, sizeof(f.ymd), elem["ymd"]); // "2021-05-06"
+    copyField(f.week, sizeof(f.week), elem["week"]); // "星期四"
+    f.aqi = elem["aqi"]; // 29
+    copyField(f.fx, sizeof(f.fx), elem["fx"]); // "东南风"
+    copyField(f.fl, sizeof(f.fl), elem["fl"]); // "3级"
+    copyField(f.type, sizeof(f.type), elem["type"]); // "多云"
+    i++;
+  }
 
   return true;
-}
\ No newline at end of file
+}
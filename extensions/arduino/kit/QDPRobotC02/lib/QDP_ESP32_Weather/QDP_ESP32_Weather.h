@@ -11,26 +11,63 @@
 
 #include <ArduinoJson.h>
 #include <Arduino.h>
+
+#define WEATHER_FORECAST_DAYS 15
+// filtered document: "data" with 5 values and 15 forecast objects of 9 values
+#define WEATHER_JSON_DOC_SIZE 5120
+#define WEATHER_FILTER_DOC_SIZE 384
+// default time a successful refresh is served from the cache
+#define WEATHER_CACHE_TTL 600000UL
+
+typedef struct {
+	char shidu[8];
+	int pm25;
+	int pm10;
+	char quality[16];
+	char wendu[8];
+} QDP_WeatherToday;
+
+typedef struct {
+	char date[4];
+	char high[20];
+	char low[20];
+	char ymd[12];
+	char week[12];
+	int aqi;
+	char fx[20];
+	char fl[16];
+	char type[24];
+} QDP_WeatherForecast;
+
 class QDP_ESP32_Weather
 {
 	public:
-		String getToday(uint8_t i){return Today[i];};
-		String getForecastDate(uint8_t i){return ForecastDate[i];};
-		String getForecastHigh(uint8_t i){return ForecastHigh[i];};
-		String getForecastLow(uint8_t i){return ForecastLow[i];};
-		String getForecastYmd(uint8_t i){return ForecastYmd[i];};
-		String getForecastWeek(uint8_t i){return ForecastWeek[i];};
-		String getForecastAqi(uint8_t i){return ForecastAqi[i];};
-		String getForecastFx(uint8_t i){return ForecastFx[i];};
-		String getForecastFl(uint8_t i){return ForecastFl[i];};
-		String getForecastType(uint8_t i){return ForecastType[i];};
+		QDP_ESP32_Weather(uint32_t cacheTime = WEATHER_CACHE_TTL);
+		String getToday(uint8_t i);
+		String getForecastDate(uint8_t i){return Forecast[i].date;};
+		String getForecastHigh(uint8_t i){return Forecast[i].high;};
+		String getForecastLow(uint8_t i){return Forecast[i].low;};
+		String getForecastYmd(uint8_t i){return Forecast[i].ymd;};
+		String getForecastWeek(uint8_t i){return Forecast[i].week;};
+		String getForecastAqi(uint8_t i){return String(Forecast[i].aqi);};
+		String getForecastFx(uint8_t i){return Forecast[i].fx;};
+		String getForecastFl(uint8_t i){return Forecast[i].fl;};
+		String getForecastType(uint8_t i){return Forecast[i].type;};
+		// time in ms a successful refresh is reused for the same city, 0 disables the cache
+		void setCacheTime(uint32_t cacheTime){_cacheTime = cacheTime;};
+		void invalidate(){_valid = false;};
 		boolean RefreshData(String CityCode);
 		boolean ParseJson(String json);
+		boolean ParseJson(Stream &stream);
 
 	private:
-		String Today[5],ForecastDate[15],ForecastHigh[15],ForecastLow[15],ForecastYmd[15],ForecastWeek[15],ForecastAqi[15],ForecastFx[15],ForecastFl[15],ForecastType[15];
-		
-
-
+		QDP_WeatherToday Today;
+		QDP_WeatherForecast Forecast[WEATHER_FORECAST_DAYS];
+		String _city;
+		uint32_t _cacheTime;
+		uint32_t _lastRefresh;
+		boolean _valid;
+		void _buildFilter(JsonDocument &filter);
+		boolean _parse(JsonDocument &doc, DeserializationError error);
 };
-#endif
\ No newline at end of file
+#endif
@@ -240,6 +240,7 @@ static uint32_t nextSyncTime = 0;
 static timeStatus_t Status = timeNotSet;
 
 getExternalTime getTimePtr;  // pointer to external sync function
+getExternalTimeMs getTimeMsPtr;  // same, also reporting milliseconds
 //setExternalTime setTimePtr; // not used in this version
 
 #ifdef TIME_DRIFT_INFO   // define this to get drift data
@@ -258,10 +259,11 @@ time_t now() {
 #endif
   }
   if (nextSyncTime <= sysTime) {
-    if (getTimePtr != 0) {
-      time_t t = getTimePtr();
+    if (getTimePtr != 0 || getTimeMsPtr != 0) {
+      uint16_t ms = 0;
+      time_t t = getTimeMsPtr != 0 ? getTimeMsPtr(&ms) : getTimePtr();
       if (t != 0) {
-        setTime(t);
+        setTime(t, ms);
       } else {
         nextSyncTime = sysTime + syncInterval;
         Status = (Status == timeNotSet) ?  timeNotSet : timeNeedsSync;
@@ -272,6 +274,10 @@ time_t now() {
 }
 
 void setTime(time_t t) { 
+  setTime(t, 0);
+}
+
+void setTime(time_t t, uint16_t ms) { 
 #ifdef TIME_DRIFT_INFO
  if(sysUnsyncedTime == 0) 
    sysUnsyncedTime = t;   // store the time of the first call to set a valid Time   
@@ -280,7 +286,7 @@ void setTime(time_t t) {
   sysTime = (uint32_t)t;  
   nextSyncTime = (uint32_t)t + syncInterval;
   Status = timeSet;
-  prevMillis = millis();  // restart counting from now (thanks to Korman for this fix)
+  prevMillis = millis() - ms;  // restart counting from now (thanks to Korman for this fix)
 } 
 
 void setTime(int hr,int min,int sec,int dy, int mnth, int yr){
@@ -311,6 +317,14 @@ timeStatus_t timeStatus() {
 
 void setSyncProvider( getExternalTime getTimeFunction){
   getTimePtr = getTimeFunction;  
+  getTimeMsPtr = 0;
+  nextSyncTime = sysTime;
+  now(); // this will sync the clock
+}
+
+void setSyncProviderMs( getExternalTimeMs getTimeFunction){
+  getTimeMsPtr = getTimeFunction;  
+  getTimePtr = 0;
   nextSyncTime = sysTime;
   now(); // this will sync the clock
 }
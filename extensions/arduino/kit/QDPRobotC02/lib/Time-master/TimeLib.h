@@ -59,6 +59,7 @@ typedef struct  {
 #define  y2kYearToTm(Y)      ((Y) + 30)   
 
 typedef time_t(*getExternalTime)();
+typedef time_t(*getExternalTimeMs)(uint16_t *ms); // also reports the milliseconds into the second
 //typedef void  (*setExternalTime)(const time_t); // not used in this version
 
 
@@ -119,6 +120,7 @@ int     year(time_t t);    // the year for the given time
 
 time_t now();              // return the current time as seconds since Jan 1 1970 
 void    setTime(time_t t);
+void    setTime(time_t t, uint16_t ms); // ms already elapsed in second t
 void    setTime(int hr,int min,int sec,int day, int month, int yr);
 void    adjustTime(long adjustment);
 
@@ -132,6 +134,7 @@ char* dayShortStr(uint8_t day);
 /* time sync functions	*/
 timeStatus_t timeStatus(); // indicates if time has been set and recently synchronized
 void    setSyncProvider( getExternalTime getTimeFunction); // identify the external time provider
+void    setSyncProviderMs( getExternalTimeMs getTimeFunction); // provider with millisecond resolution
 void    setSyncInterval(time_t interval); // set the number of seconds between re-sync
 
 /* low level functions to convert to and from system time                     */
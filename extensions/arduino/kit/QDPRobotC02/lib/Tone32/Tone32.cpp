@@ -45,7 +45,7 @@ void noTone(uint8_t pin, uint8_t channel)
 }
 
 
-void buzzer_music(uint8_t pin, uint8_t num,uint8_t channel)
+static bool music_select(uint8_t num, const int **music, const float **rhythm)
 {
   const int *p1;
   const float *p2  ;
@@ -90,9 +90,21 @@ void buzzer_music(uint8_t pin, uint8_t num,uint8_t channel)
       p1 = music_10;
       p2 = rhythm_10;
       break;
+    default:
+      return false;
   }
+  *music = p1;
+  *rhythm = p2;
+  return true;
+}
 
-
+void buzzer_music(uint8_t pin, uint8_t num,uint8_t channel)
+{
+  const int *p1;
+  const float *p2  ;
+  if (!music_select(num, &p1, &p2)) {
+    return;
+  }
 
   for (int a = 0; p1[a] != 0; a++) {
     int time = int(p2[a] * 300);
@@ -108,4 +120,70 @@ void buzzer_music(uint8_t pin, uint8_t num,uint8_t channel)
   }
   delay(1000);
 
+}
+
+// state of the music started by buzzer_music_start()
+static const int *music_notes = NULL;
+static const float *music_rhythm;
+static uint8_t music_pin, music_channel;
+static int music_index;
+static bool music_gap;
+static unsigned long music_last, music_wait;
+static void (*music_done)(void);
+
+static void music_note(void)
+{
+  int note = music_notes[music_index];
+  music_wait = int(music_rhythm[music_index] * 300);
+  if (note != 22) {
+    ledcAttachPin(music_pin, music_channel);
+    ledcWriteTone(music_channel, tone_list[note - 1]);
+  }
+  music_gap = false;
+}
+
+void buzzer_music_start(uint8_t pin, uint8_t num, uint8_t channel, void (*done)(void))
+{
+  buzzer_music_stop();
+  if (!music_select(num, &music_notes, &music_rhythm) || music_notes[0] == 0) {
+    music_notes = NULL;
+    return;
+  }
+  music_pin = pin;
+  music_channel = channel;
+  music_done = done;
+  music_index = 0;
+  music_last = millis();
+  music_note();
+}
+
+// each note is followed by 30 ms of silence, the 1 s pause that
+// buzzer_music() makes at the end is left to the caller
+bool buzzer_music_poll(void)
+{
+  while (music_notes != NULL && millis() - music_last >= music_wait) {
+    music_last += music_wait;
+    if (!music_gap) {
+      noTone(music_pin, music_channel);
+      music_gap = true;
+      music_wait = 30;
+    } else if (music_notes[++music_index] != 0) {
+      music_note();
+    } else {
+      void (*done)(void) = music_done;
+      music_notes = NULL;
+      if (done != NULL) {
+        done();
+      }
+    }
+  }
+  return music_notes != NULL;
+}
+
+void buzzer_music_stop(void)
+{
+  if (music_notes != NULL) {
+    noTone(music_pin, music_channel);
+    music_notes = NULL;
+  }
 }
\ No newline at end of file
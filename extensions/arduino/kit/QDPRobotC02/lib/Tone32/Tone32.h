@@ -8,6 +8,10 @@
 void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0, uint8_t channel = TONE_CHANNEL);
 void noTone(uint8_t pin, uint8_t channel = TONE_CHANNEL);
 void buzzer_music(uint8_t pin, uint8_t num,uint8_t channel);
+// non-blocking buzzer_music(), call buzzer_music_poll() from loop()
+void buzzer_music_start(uint8_t pin, uint8_t num, uint8_t channel = TONE_CHANNEL, void (*done)(void) = NULL);
+bool buzzer_music_poll(void);
+void buzzer_music_stop(void);
 #endif
 
 
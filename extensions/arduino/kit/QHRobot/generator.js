@@ -342,7 +342,9 @@ function addGenerator (Blockly) {
         Blockly.Arduino.definitions_['define_qdportqdpbuzzer2'+dropdown_pin] = 'QDPBuzzer QDPBuzzer'+dropdown_pin+';';
 
         Blockly.Arduino.setups_['setup_output_'+dropdown_pin] = '';
-        var code='QDPBuzzer'+dropdown_pin+'.tone(QDPport['+dropdown_pin+'][1],'+dropdown_pin2+','+dur+');\n';
+        Blockly.Arduino.loops_['QDPBuzzer_poll'+dropdown_pin] = 'QDPBuzzer'+dropdown_pin+'.poll();';
+        var code='while (QDPBuzzer'+dropdown_pin+'.poll()) {}\n';
+        code+='QDPBuzzer'+dropdown_pin+'.tone(QDPport['+dropdown_pin+'][1],'+dropdown_pin2+','+dur+');\n';
         return code; 
     };
     //蜂鸣器音乐
@@ -354,7 +356,9 @@ function addGenerator (Blockly) {
         Blockly.Arduino.definitions_['define_qdportqdpbuzzer2'+dropdown_pin] = 'QDPBuzzer QDPBuzzer'+dropdown_pin+';';
 
         Blockly.Arduino.setups_['setup_output_'+dropdown_pin] = '';
-        var code='QDPBuzzer'+dropdown_pin+'.buzzer_music(QDPport['+dropdown_pin+'][1],'+dropdown_pin2+');\n';
+        Blockly.Arduino.loops_['QDPBuzzer_poll'+dropdown_pin] = 'QDPBuzzer'+dropdown_pin+'.poll();';
+        var code='while (QDPBuzzer'+dropdown_pin+'.poll()) {}\n';
+        code+='QDPBuzzer'+dropdown_pin+'.startMusic(QDPport['+dropdown_pin+'][1],'+dropdown_pin2+');\n';
         return code; 
     };
     //直流电机
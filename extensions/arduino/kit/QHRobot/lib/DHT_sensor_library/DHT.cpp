@@ -30,6 +30,18 @@
   UINT32_MAX /**< Used programmatically for timeout.                           \
                    Not a timeout duration. Type: uint32_t. */
 
+#ifndef NOT_AN_INTERRUPT
+#define NOT_AN_INTERRUPT -1 /**< digitalPinToInterrupt() of a pin without */
+#endif
+
+#define DHT_STATE_IDLE 0    /**< no reading running */
+#define DHT_STATE_START 1   /**< start signal, data line held low */
+#define DHT_STATE_CAPTURE 2 /**< pin interrupt is timing the bits */
+
+volatile uint16_t DHT::_edges[DHT_EDGES];
+volatile uint8_t DHT::_edgeCount;
+DHT *DHT::_capturing = NULL;
+
 /*!
  *  @brief  Instantiates a new DHT class
  *  @param  pin
@@ -47,6 +59,9 @@ DHT::DHT(uint8_t pin, uint8_t type, uint8_t count) {
   _bit = digitalPinToBitMask(pin);
   _port = digitalPinToPort(pin);
 #endif
+  _state = DHT_STATE_IDLE;
+  _status = DHT_ERROR_TIMEOUT;
+  _lastresult = false;
   _maxcycles =
       microsecondsToClockCycles(1000); // 1 millisecond timeout for
                                        // reading pulses from DHT sensor.
@@ -235,37 +250,161 @@ bool DHT::read(bool force) {
   if (!force && ((currenttime - _lastreadtime) < MIN_INTERVAL)) {
     return _lastresult; // return last correct measurement
   }
-  _lastreadtime = currenttime;
-
-  // Reset 40 bits of received data to zero.
-  data[0] = data[1] = data[2] = data[3] = data[4] = 0;
+  if (!startRead()) {
+    return false;
+  }
 
+  while (poll() == DHT_BUSY) {
 #if defined(ESP8266)
-  yield(); // Handle WiFi / reset software watchdog
+    yield(); // Handle WiFi / reset software watchdog
 #endif
+  }
+  return _lastresult;
+}
+
+/*!
+ *  @brief  Start a reading without waiting for it, call poll() until it is
+ *          no longer DHT_BUSY
+ *	@return false if a reading is already running
+ */
+bool DHT::startRead(void) {
+  if (_state != DHT_STATE_IDLE || _capturing != NULL) {
+    return false;
+  }
+  _lastreadtime = millis();
+
+  // Reset 40 bits of received data to zero.
+  data[0] = data[1] = data[2] = data[3] = data[4] = 0;
 
   // Send start signal.  See DHT datasheet for full signal diagram:
   //   http://www.adafruit.com/datasheets/Digital%20humidity%20and%20temperature%20sensor%20AM2302.pdf
 
-  // Go into high impedence state to let pull-up raise data line level and
-  // start the reading process.
-  pinMode(_pin, INPUT_PULLUP);
-  delay(1);
-
-  // First set data line low for a period according to sensor type
+  // The pull-up has kept the data line high since begin() or the last
+  // reading. Set data line low for a period according to sensor type,
+  // poll() ends it.
   pinMode(_pin, OUTPUT);
   digitalWrite(_pin, LOW);
-  switch (_type) {
-  case DHT22:
-  case DHT21:
-    delayMicroseconds(1100); // data sheet says "at least 1ms"
-    break;
-  case DHT11:
-  default:
-    delay(20); // data sheet says at least 18ms, 20ms just to be safe
-    break;
+  _starttime = micros();
+  _state = DHT_STATE_START;
+  _status = DHT_BUSY;
+  return true;
+}
+
+/*!
+ *  @brief  Advance a reading started by startRead()
+ *	@return DHT_BUSY while reading, then DHT_OK or a DHT_ERROR_ value
+ */
+uint8_t DHT::poll(void) {
+  if (_state == DHT_STATE_START) {
+    uint32_t lowTime;
+    switch (_type) {
+    case DHT22:
+    case DHT21:
+      lowTime = 1100; // data sheet says "at least 1ms"
+      break;
+    case DHT11:
+    default:
+      lowTime = 20000; // data sheet says at least 18ms, 20ms just to be safe
+      break;
+    }
+    if (micros() - _starttime < lowTime) {
+      return DHT_BUSY;
+    }
+
+    int irq = digitalPinToInterrupt(_pin);
+    if (irq == NOT_AN_INTERRUPT) {
+      // No interrupt on this pin, time the bits with interrupts off.
+      _state = DHT_STATE_IDLE;
+      _status = readPulses();
+      _lastresult = _status == DHT_OK;
+      return _status;
+    }
+    _capturing = this;
+    attachInterrupt(irq, captureEdge, FALLING);
+    // End the start signal, the interrupt timestamps the answer. A flag left
+    // from the falling edge of the start signal fires right after attaching
+    // on AVR. The sensor answers 20-40us after the release, so forget what
+    // was captured while releasing the line.
+    noInterrupts();
+    pinMode(_pin, INPUT_PULLUP);
+    _edgeCount = 0;
+    _starttime = micros();
+    interrupts();
+    _state = DHT_STATE_CAPTURE;
+    return DHT_BUSY;
+  }
+
+  if (_state == DHT_STATE_CAPTURE) {
+    if (_edgeCount < DHT_EDGES &&
+        micros() - _starttime < DHT_CAPTURE_TIMEOUT) {
+      return DHT_BUSY;
+    }
+    detachInterrupt(digitalPinToInterrupt(_pin));
+    _capturing = NULL;
+    _state = DHT_STATE_IDLE;
+    _status = decode(_edges, _edgeCount, data);
+    if (_status != DHT_OK) {
+      DEBUG_PRINT(F("DHT capture failed: "));
+      DEBUG_PRINTLN(_status);
+    }
+    _lastresult = _status == DHT_OK;
+    return _status;
+  }
+
+  return _status;
+}
+
+/*!
+ *  @brief  Pin interrupt, timestamps falling edges of a reading
+ */
+void DHT_ISR_ATTR DHT::captureEdge(void) {
+  if (_edgeCount < DHT_EDGES) {
+    _edges[_edgeCount] = micros();
+    _edgeCount++;
+  }
+}
+
+/*!
+ *  @brief  Decode falling edge timestamps of a reading
+ *          The sensor answers with 80us low and 80us high, then sends each
+ *          bit as 50us low followed by 26-28us high for 0 or 70us high for 1,
+ *          and ends with 50us low. After the first edge, the 41 gaps between
+ *          falling edges are the answer and the 40 bit periods.
+ *  @param  edges
+ *          micros() of each falling edge
+ *  @param  count
+ *          number of edges
+ *  @param  bytes
+ *          receives the 5 data bytes
+ *	@return DHT_OK or a DHT_ERROR_ value
+ */
+uint8_t DHT::decode(const volatile uint16_t *edges, uint8_t count,
+                    uint8_t *bytes) {
+  if (count < DHT_EDGES) {
+    return DHT_ERROR_TIMEOUT;
   }
 
+  bytes[0] = bytes[1] = bytes[2] = bytes[3] = bytes[4] = 0;
+  for (uint8_t i = 0; i < 40; i++) {
+    uint16_t period = edges[i + 2] - edges[i + 1];
+    if (period < DHT_BIT_MIN || period > DHT_BIT_MAX) {
+      return DHT_ERROR_PULSE;
+    }
+    bytes[i / 8] <<= 1;
+    if (period > DHT_BIT_ONE) {
+      bytes[i / 8] |= 1;
+    }
+  }
+
+  if (bytes[4] != ((bytes[0] + bytes[1] + bytes[2] + bytes[3]) & 0xFF)) {
+    return DHT_ERROR_CHECKSUM;
+  }
+  return DHT_OK;
+}
+
+// Reading for pins without an external interrupt: times the pulses with
+// interrupts off once the start signal is over.
+uint8_t DHT::readPulses(void) {
   uint32_t cycles[80];
   {
     // End the start signal by setting data line high for 40 microseconds.
@@ -284,13 +423,11 @@ bool DHT::read(bool force) {
     // for ~80 microseconds again.
     if (expectPulse(LOW) == TIMEOUT) {
       DEBUG_PRINTLN(F("DHT timeout waiting for start signal low pulse."));
-      _lastresult = false;
-      return _lastresult;
+      return DHT_ERROR_TIMEOUT;
     }
     if (expectPulse(HIGH) == TIMEOUT) {
       DEBUG_PRINTLN(F("DHT timeout waiting for start signal high pulse."));
-      _lastresult = false;
-      return _lastresult;
+      return DHT_ERROR_TIMEOUT;
     }
 
     // Now read the 40 bits sent by the sensor.  Each bit is sent as a 50
@@ -314,8 +451,7 @@ bool DHT::read(bool force) {
     uint32_t highCycles = cycles[2 * i + 1];
     if ((lowCycles == TIMEOUT) || (highCycles == TIMEOUT)) {
       DEBUG_PRINTLN(F("DHT timeout waiting for pulse."));
-      _lastresult = false;
-      return _lastresult;
+      return DHT_ERROR_TIMEOUT;
     }
     data[i / 8] <<= 1;
     // Now compare the low and high cycle times to see if the bit is a 0 or 1.
@@ -343,12 +479,10 @@ bool DHT::read(bool force) {
 
   // Check we read 40 bits and that the checksum matches.
   if (data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) {
-    _lastresult = true;
-    return _lastresult;
+    return DHT_OK;
   } else {
     DEBUG_PRINTLN(F("DHT checksum failure!"));
-    _lastresult = false;
-    return _lastresult;
+    return DHT_ERROR_CHECKSUM;
   }
 }
 
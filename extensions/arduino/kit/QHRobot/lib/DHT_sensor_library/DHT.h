@@ -47,6 +47,27 @@
 #define DHT21 21  /**< DHT TYPE 21 */
 #define AM2301 21 /**< AM2301 */
 
+/* poll() results. */
+#define DHT_OK 0             /**< reading done */
+#define DHT_BUSY 1           /**< reading running */
+#define DHT_ERROR_TIMEOUT 2  /**< fewer edges than a reading has */
+#define DHT_ERROR_PULSE 3    /**< an edge was missed or the line glitched */
+#define DHT_ERROR_CHECKSUM 4 /**< checksum mismatch */
+
+#define DHT_EDGES                                                              \
+  42 /**< falling edges of a reading: answer, start of 40 bits, end */
+#define DHT_BIT_MIN 60  /**< shortest bit period in microseconds */
+#define DHT_BIT_ONE 100 /**< bit periods above this are 1 */
+#define DHT_BIT_MAX 140 /**< longest bit period, two bits are longer */
+#define DHT_CAPTURE_TIMEOUT                                                    \
+  10000 /**< microseconds, a reading takes less than 5ms */
+
+#if defined(ESP32) || defined(ESP8266)
+#define DHT_ISR_ATTR IRAM_ATTR /**< pin interrupt runs from IRAM */
+#else
+#define DHT_ISR_ATTR /**< no placement needed */
+#endif
+
 #if defined(TARGET_NAME) && (TARGET_NAME == ARDUINO_NANO33BLE)
 #ifndef microsecondsToClockCycles
 /*!
@@ -72,6 +93,10 @@ public:
                          bool isFahrenheit = true);
   float readHumidity(bool force = false);
   bool read(bool force = false);
+  bool startRead(void);
+  uint8_t poll(void);
+  static uint8_t decode(const volatile uint16_t *edges, uint8_t count,
+                        uint8_t *bytes);
 
 private:
   uint8_t data[5];
@@ -85,7 +110,17 @@ private:
   uint32_t _lastreadtime, _maxcycles;
   bool _lastresult;
   uint8_t pullTime; // Time (in usec) to pull up data line before reading
+  uint8_t _state, _status;
+  uint32_t _starttime;
+
+  // micros() of falling edges taken by the pin interrupt, one reading at a
+  // time for all sensors
+  static volatile uint16_t _edges[DHT_EDGES];
+  static volatile uint8_t _edgeCount;
+  static DHT *_capturing;
+  static void DHT_ISR_ATTR captureEdge(void);
 
+  uint8_t readPulses(void);
   uint32_t expectPulse(bool level);
 };
 
@@ -8,16 +8,29 @@
 
 #define printIIC(args)	Wire.write(args)
 inline size_t LiquidCrystal_I2C::write(uint8_t value) {
-	send(value, Rs);
+	putChar(value);
 	return 1;
 }
 
+size_t LiquidCrystal_I2C::write(const uint8_t *buffer, size_t size) {
+	if (_shadow) {
+		for (size_t i = 0; i < size; i++) {
+			putChar(buffer[i]);
+		}
+		return size;
+	}
+	for (size_t i = 0; i < size; i += 255) {
+		sendRun(buffer + i, size - i > 255 ? 255 : size - i);
+	}
+	return size;
+}
+
 #else
 #include "WProgram.h"
 
 #define printIIC(args)	Wire.send(args)
 inline void LiquidCrystal_I2C::write(uint8_t value) {
-	send(value, Rs);
+	putChar(value);
 }
 
 #endif
@@ -50,6 +63,8 @@ LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t lcd_Addr,uint8_t lcd_cols,uint8_t l
   _cols = lcd_cols;
   _rows = lcd_rows;
   _backlightval = LCD_NOBACKLIGHT;
+  _shadow = NULL;
+  _ddram = 0xFF;
 }
 
 void LiquidCrystal_I2C::init(){
@@ -125,21 +140,39 @@ void LiquidCrystal_I2C::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
 
 /********** high level commands, for the user! */
 void LiquidCrystal_I2C::clear(){
+	if (_shadow) {
+		memset(_shadow, ' ', _cols * _rows);
+		_shadowCol = _shadowRow = 0;
+		return;
+	}
 	command(LCD_CLEARDISPLAY);// clear display, set cursor position to zero
 	delayMicroseconds(2000);  // this command takes a long time!
 }
 
 void LiquidCrystal_I2C::home(){
+	if (_shadow) {
+		_shadowCol = _shadowRow = 0;
+		return;
+	}
 	command(LCD_RETURNHOME);  // set cursor position to zero
 	delayMicroseconds(2000);  // this command takes a long time!
 }
 
+uint8_t LiquidCrystal_I2C::rowOffset(uint8_t row){
+	static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+	return row_offsets[row & 3];
+}
+
 void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row){
-	int row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
-	if ( row > _numlines ) {
+	if ( row >= _numlines ) {
 		row = _numlines-1;    // we count rows starting w/0
 	}
-	command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
+	if (_shadow) {
+		_shadowCol = col;
+		_shadowRow = row < _rows ? row : _rows-1;
+		return;
+	}
+	command(LCD_SETDDRAMADDR | (col + rowOffset(row)));
 }
 
 // Turn the display on/off (quickly)
@@ -210,8 +243,9 @@ void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[]) {
 	location &= 0x7; // we only have 8 locations 0-7
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i=0; i<8; i++) {
-		write(charmap[i]);
+		send(charmap[i], Rs);
 	}
+	_ddram = 0xFF;	// the address counter now points into CGRAM
 }
 
 //createChar with PROGMEM input
@@ -219,8 +253,9 @@ void LiquidCrystal_I2C::createChar(uint8_t location, const char *charmap) {
 	location &= 0x7; // we only have 8 locations 0-7
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i=0; i<8; i++) {
-	    	write(pgm_read_byte_near(charmap++));
+	    	send(pgm_read_byte_near(charmap++), Rs);
 	}
+	_ddram = 0xFF;
 }
 
 // Turn the (optional) backlight off/on
@@ -240,22 +275,124 @@ void LiquidCrystal_I2C::backlight(void) {
 
 inline void LiquidCrystal_I2C::command(uint8_t value) {
 	send(value, 0);
+	_ddram = 0xFF;
+}
+
+void LiquidCrystal_I2C::putChar(uint8_t value) {
+	if (_shadow) {
+		if (_shadowCol < _cols) {
+			_shadow[_shadowRow * _cols + _shadowCol] = value;
+			_shadowCol++;
+		}
+		return;
+	}
+	send(value, Rs);
+	if (_ddram != 0xFF) {
+		_ddram++;
+	}
+}
+
+bool LiquidCrystal_I2C::beginShadow() {
+	if (_shadow) {
+		return true;
+	}
+	_shadow = (uint8_t *)malloc(2 * _cols * _rows);
+	if (!_shadow) {
+		return false;
+	}
+	command(LCD_CLEARDISPLAY);
+	delayMicroseconds(2000);
+	memset(_shadow, ' ', 2 * _cols * _rows);
+	_shadowCol = _shadowRow = 0;
+	_ddram = 0;
+	return true;
+}
+
+void LiquidCrystal_I2C::endShadow() {
+	free(_shadow);
+	_shadow = NULL;
+	_ddram = 0xFF;
+}
+
+// send the changed cells, nearby changes go out as one run
+void LiquidCrystal_I2C::flush() {
+	if (!_shadow) {
+		return;
+	}
+	for (uint8_t row = 0; row < _rows; row++) {
+		uint8_t *want = _shadow + row * _cols;
+		uint8_t *shown = want + _cols * _rows;
+		uint8_t col = 0;
+		while (col < _cols) {
+			if (want[col] == shown[col]) {
+				col++;
+				continue;
+			}
+			// extend the run over changed cells and short unchanged gaps
+			uint8_t end = col + 1;
+			for (uint8_t next = end; next < _cols && next - end <= LCD_FLUSH_GAP; next++) {
+				if (want[next] != shown[next]) {
+					end = next + 1;
+				}
+			}
+			uint8_t addr = rowOffset(row) + col;
+			if (_ddram != addr) {
+				command(LCD_SETDDRAMADDR | addr);
+			}
+			sendRun(want + col, end - col);
+			memcpy(shown + col, want + col, end - col);
+			_ddram = addr + end - col;
+			col = end;
+		}
+	}
 }
 
 
 /************ low level data pushing commands **********/
 
-// write either command or data
+// write either command or data, both nibbles in one transaction
 void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode) {
 	uint8_t highnib=value&0xf0;
 	uint8_t lownib=(value<<4)&0xf0;
-       write4bits((highnib)|mode);
-	write4bits((lownib)|mode); 
+	Wire.beginTransmission(_Addr);
+	queueNibble((highnib)|mode);
+	queueNibble((lownib)|mode);
+	Wire.endTransmission();
+}
+
+// write characters, LCD_TX_CHARS per transaction
+void LiquidCrystal_I2C::sendRun(const uint8_t *data, uint8_t len) {
+	if (_ddram != 0xFF) {
+		_ddram += len;
+	}
+	while (len) {
+		uint8_t n = len < LCD_TX_CHARS ? len : LCD_TX_CHARS;
+		Wire.beginTransmission(_Addr);
+		for (uint8_t i = 0; i < n; i++) {
+			queueNibble((data[i] & 0xf0) | Rs);
+			queueNibble(((data[i] << 4) & 0xf0) | Rs);
+		}
+		Wire.endTransmission();
+		data += n;
+		len -= n;
+	}
+}
+
+// Data, enable high, enable low. The expander latches every byte at its
+// acknowledge, at 100kHz one byte takes 90us so the enable pulse (>450ns)
+// and the settle time before the next pulse (>37us) are met on the bus.
+void LiquidCrystal_I2C::queueNibble(uint8_t value) {
+	value |= _backlightval;
+	printIIC(value);
+	printIIC(value | En);
+	printIIC(value & ~En);
 }
 
 void LiquidCrystal_I2C::write4bits(uint8_t value) {
-	expanderWrite(value);
-	pulseEnable(value);
+	Wire.beginTransmission(_Addr);
+	queueNibble(value);
+	Wire.endTransmission();
+	delayMicroseconds(50);		// commands need > 37us to settle
 }
 
 void LiquidCrystal_I2C::expanderWrite(uint8_t _data){                                        
@@ -264,13 +401,6 @@ void LiquidCrystal_I2C::expanderWrite(uint8_t _data){
 	Wire.endTransmission();   
 }
 
-void LiquidCrystal_I2C::pulseEnable(uint8_t _data){
-	expanderWrite(_data | En);	// En high
-	delayMicroseconds(1);		// enable pulse must be >450ns
-	
-	expanderWrite(_data & ~En);	// En low
-	delayMicroseconds(50);		// commands need > 37us to settle
-} 
 
 
 // Alias functions
@@ -94,18 +94,46 @@ void MPU6050::calcGyroOffsets(bool console, uint16_t delayBefore, uint16_t delay
 }
 
 void MPU6050::update(){
+  uint8_t data[14];
+
 	wire->beginTransmission(MPU6050_ADDR);
 	wire->write(0x3B);
 	wire->endTransmission(false);
 	wire->requestFrom((int)MPU6050_ADDR, 14);
+  for(int i = 0; i < 14; i++){
+    data[i] = wire->read();
+  }
+  applyRaw(data);
+}
+
+/*
+ * Queues the same read as update() on a shared bus and returns at once,
+ * readings change when bus.poll() reports it done. False while the previous
+ * request is still pending.
+ */
+bool MPU6050::requestUpdate(I2CBus &bus, uint8_t priority){
+  if(busRead.pending()){
+    return false;
+  }
+  busReg = 0x3B;
+  busRead = I2CTransaction(MPU6050_ADDR, &busReg, 1, busData, 14, priority, busDone, this);
+  return bus.submit(busRead);
+}
+
+void MPU6050::busDone(I2CTransaction &t){
+  if(t.ok()){
+    ((MPU6050 *)t.arg)->applyRaw(((MPU6050 *)t.arg)->busData);
+  }
+}
 
-  rawAccX = wire->read() << 8 | wire->read();
-  rawAccY = wire->read() << 8 | wire->read();
-  rawAccZ = wire->read() << 8 | wire->read();
-  rawTemp = wire->read() << 8 | wire->read();
-  rawGyroX = wire->read() << 8 | wire->read();
-  rawGyroY = wire->read() << 8 | wire->read();
-  rawGyroZ = wire->read() << 8 | wire->read();
+void MPU6050::applyRaw(const uint8_t *data){
+  rawAccX = data[0] << 8 | data[1];
+  rawAccY = data[2] << 8 | data[3];
+  rawAccZ = data[4] << 8 | data[5];
+  rawTemp = data[6] << 8 | data[7];
+  rawGyroX = data[8] << 8 | data[9];
+  rawGyroY = data[10] << 8 | data[11];
+  rawGyroZ = data[12] << 8 | data[13];
 
   temp = (rawTemp + 12412.0) / 340.0;
 
@@ -3,6 +3,7 @@
 
 #include "Arduino.h"
 #include "Wire.h"
+#include "I2CBus.h"
 
 #define MPU6050_ADDR         0x68
 #define MPU6050_SMPLRT_DIV   0x19
@@ -54,6 +55,8 @@ class MPU6050{
   float getGyroZoffset(){ return gyroZoffset; };
 
   void update();
+  bool requestUpdate(I2CBus &bus, uint8_t priority = 0);
+  bool updatePending(){ return busRead.pending(); };
 
   float getAccAngleX(){ return angleAccX; };
   float getAccAngleY(){ return angleAccY; };
@@ -87,6 +90,13 @@ class MPU6050{
   long preInterval;
 
   float accCoef, gyroCoef;
+
+  uint8_t busReg;
+  uint8_t busData[14];
+  I2CTransaction busRead;
+
+  void applyRaw(const uint8_t *data);
+  static void busDone(I2CTransaction &t);
 };
 
 #endif
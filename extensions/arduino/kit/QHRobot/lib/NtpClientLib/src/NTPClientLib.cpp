@@ -34,6 +34,8 @@ or implied, of German Martin
 #define DEBUGLOG(...)
 #endif
 
+#define SEVENTY_YEARS 2208988800UL
+
 NTPClient::NTPClient () {
 }
 
@@ -89,7 +91,7 @@ bool NTPClient::setTimeZone (int8_t timeZone, int8_t minutes) {
         if (_lastSyncd > 0) {
             int8_t timeDiff = timeZone - _timeZone;
             int8_t minDiff = minutes - _minutesOffset;
-            setTime (now () + timeDiff * SECS_PER_HOUR + minDiff * SECS_PER_MIN);
+            adjustTime (timeDiff * SECS_PER_HOUR + minDiff * SECS_PER_MIN);
         }
         _timeZone = timeZone;
         _minutesOffset = minutes;
@@ -100,97 +102,55 @@ bool NTPClient::setTimeZone (int8_t timeZone, int8_t minutes) {
 }
 
 #if NETWORK_TYPE == NETWORK_W5100 || NETWORK_TYPE == NETWORK_WIFI101
-boolean sendNTPpacket (IPAddress address, UDP *udp) {
+boolean NTPClient::sendRequest () {
     uint8_t ntpPacketBuffer[NTP_PACKET_SIZE]; //Buffer to store request message
 
-                                           // set all bytes in the buffer to 0
-    memset (ntpPacketBuffer, 0, NTP_PACKET_SIZE);
-    // Initialize values needed to form NTP request
-    // (see URL above for details on the packets)
-    ntpPacketBuffer[0] = 0b11100011;   // LI, Version, Mode
-    ntpPacketBuffer[1] = 0;     // Stratum, or type of clock
-    ntpPacketBuffer[2] = 6;     // Polling Interval
-    ntpPacketBuffer[3] = 0xEC;  // Peer Clock Precision
-                                // 8 bytes of zero for Root Delay & Root Dispersion
-    ntpPacketBuffer[12] = 49;
-    ntpPacketBuffer[13] = 0x4E;
-    ntpPacketBuffer[14] = 49;
-    ntpPacketBuffer[15] = 52;
-    // all NTP fields have been given values, now
-    // you can send a packet requesting a timestamp:
-    udp->beginPacket (address, DEFAULT_NTP_PORT); //NTP requests are to port 123
+    if (_burst == 1) {
+        DEBUGLOG ("Starting UDP\n");
+        udp->begin (DEFAULT_NTP_PORT);
+        //DEBUGLOG ("UDP port: %d\n",udp->localPort());
+#if NETWORK_TYPE == NETWORK_W5100
+        DNSClient dns;
+        dns.begin (Ethernet.dnsServerIP ());
+        int8_t dnsResult = dns.getHostByName (getNtpServerName ().c_str (), ntpServerIPAddress);
+        if (dnsResult <= 0) {
+            if (onSyncEvent)
+                onSyncEvent (invalidAddress);
+            return false;
+        }
+#else
+        WiFi.hostByName (getNtpServerName ().c_str (), ntpServerIPAddress);
+#endif
+        DEBUGLOG ("NTP Server IP: %s\r\n", ntpServerIPAddress.toString ().c_str ());
+    }
+    while (udp->parsePacket () > 0); // discard any previously received packets
+    buildRequest (ntpPacketBuffer);
+    udp->beginPacket (ntpServerIPAddress, DEFAULT_NTP_PORT); //NTP requests are to port 123
     udp->write (ntpPacketBuffer, NTP_PACKET_SIZE);
     udp->endPacket ();
+    _requestMillis = millis ();
+    _waiting = true;
     return true;
 }
 
-time_t NTPClient::getTime () {
-    IPAddress timeServerIP; //NTP server IP address
+void NTPClient::pollResponse () {
     uint8_t ntpPacketBuffer[NTP_PACKET_SIZE]; //Buffer to store response message
 
-
-    DEBUGLOG ("Starting UDP\n");
-    udp->begin (DEFAULT_NTP_PORT);
-    //DEBUGLOG ("UDP port: %d\n",udp->localPort());
-    while (udp->parsePacket () > 0); // discard any previously received packets
-#if NETWORK_TYPE == NETWORK_W5100
-    DNSClient dns;
-    dns.begin (Ethernet.dnsServerIP ());
-    int8_t dnsResult = dns.getHostByName (getNtpServerName ().c_str (), timeServerIP);
-    if (dnsResult <= 0) {
-        if (onSyncEvent)
-            onSyncEvent (invalidAddress);
-        return 0; // return 0 if unable to get the time
-    }
-#else
-    WiFi.hostByName (getNtpServerName ().c_str (), timeServerIP);
-#endif
-    DEBUGLOG ("NTP Server IP: %s\r\n", timeServerIP.toString ().c_str ());
-    sendNTPpacket (timeServerIP, udp);
-    uint32_t beginWait = millis ();
-    while (millis () - beginWait < ntpTimeout) {
-        int size = udp->parsePacket ();
-        if (size >= NTP_PACKET_SIZE) {
-            DEBUGLOG ("-- Receive NTP Response\n");
-            udp->read (ntpPacketBuffer, NTP_PACKET_SIZE);  // read packet into the buffer
-            time_t timeValue = decodeNtpMessage (ntpPacketBuffer);
-            if (timeValue != 0) {
-                setSyncInterval (getLongInterval ());
-                if (!_firstSync) {
-                    //    if (timeStatus () == timeSet)
-                    _firstSync = timeValue;
-                }
-                //getFirstSync (); // Set firstSync value if not set before
-                DEBUGLOG ("Sync frequency set low\n");
-                udp->stop ();
-                setLastNTPSync (timeValue);
-                DEBUGLOG ("Successful NTP sync at %s\n", getTimeDateString (getLastNTPSync ()).c_str ());
-
-                if (onSyncEvent)
-                    onSyncEvent (timeSyncd);
-                return timeValue;
-            } else {
-                DEBUGLOG ("-- No valid NTP data :-(\n");
-                udp->stop ();
-                setSyncInterval (getShortInterval ()); // Retry connection more often
-                if (onSyncEvent)
-                    onSyncEvent (noResponse);
-                return 0; // return 0 if unable to get the time
-            }
+    int size = udp->parsePacket ();
+    if (size >= NTP_PACKET_SIZE) {
+        int64_t received = clockMicros (millis ());
+        DEBUGLOG ("-- Receive NTP Response\n");
+        udp->read (ntpPacketBuffer, NTP_PACKET_SIZE);  // read packet into the buffer
+        if (processResponse (ntpPacketBuffer, NTP_PACKET_SIZE, received)) {
+            _waiting = false;
+            return;
         }
-#ifdef ARDUINO_ARCH_ESP8266
-        ESP.wdtFeed ();
-        yield ();
-#endif
+        DEBUGLOG ("-- No valid NTP data :-(\n");
     }
-    DEBUGLOG ("-- No NTP Response :-(\n");
-    udp->stop ();
-    if (timeStatus () != timeSet) {
-        setSyncInterval (getShortInterval ()); // Retry connection more often if sync is needed and we get no response
+    if (millis () - _requestMillis >= ntpTimeout) {
+        DEBUGLOG ("-- No NTP Response :-(\n");
+        _waiting = false;
     }
-    if (onSyncEvent)
-        onSyncEvent (noResponse);
-    return 0; // return 0 if unable to get the time
 }
 #elif NETWORK_TYPE == NETWORK_ESP8266 || NETWORK_TYPE == NETWORK_ESP32
 void NTPClient::s_dnsFound (const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
@@ -223,9 +183,16 @@ void NTPClient::dnsFound (const ip_addr_t *ipaddr) {
     ntpServerIPAddress = getIPClass (ipaddr);
     DEBUGLOG ("%s - %s\n", __FUNCTION__, ntpServerIPAddress.toString ().c_str ());
     if (ipaddr != NULL && ntpServerIPAddress != (uint32_t)(0)) {
-       time_t newTime = getTime();
-       DEBUGLOG ("%s - Get time\n", __FUNCTION__);
-       if (newTime) setTime(newTime);
+        DEBUGLOG ("%s - Send request\n", __FUNCTION__);
+        if (!sendRequest ()) {
+            _abort = true;
+            _waiting = false;
+        }
+    } else {
+        _abort = true;
+        _waiting = false;
+        if (onSyncEvent)
+            onSyncEvent (invalidAddress);
     }
 }
 
@@ -235,6 +202,8 @@ void  NTPClient::processDNSTimeout () {
     //timer1_disable ();
     responseTimer2.detach ();
     DEBUGLOG ("%s - DNS response Timeout\n", __FUNCTION__);
+    _abort = true;
+    _waiting = false;
     if (onSyncEvent)
         onSyncEvent (invalidAddress);
 }
@@ -244,7 +213,7 @@ void ICACHE_RAM_ATTR NTPClient::s_processDNSTimeout (void* arg) {
 }
 #endif
 
-time_t NTPClient::getTime () {
+boolean NTPClient::sendRequest () {
     //IPAddress ntpServerIPAddress; //NTP server IP address
 
 #if NETWORK_TYPE == NETWORK_ESP8266
@@ -255,6 +224,8 @@ time_t NTPClient::getTime () {
     DEBUGLOG ("%s\n", __FUNCTION__);
     //timeServerIP = IPAddress (ipaddress.addr); // ip address format conversion test
     //ipaddress.addr = (uint32_t)timeServerIP;
+    if (_burst > 1)
+        dnsStatus = DNS_SOLVED; // Server address is solved once per burst
     if (dnsStatus == DNS_IDLE)
     {
         DEBUGLOG ("%s - Resolving DNS of %s\n", __FUNCTION__, getNtpServerName ().c_str ());
@@ -264,20 +235,25 @@ time_t NTPClient::getTime () {
             dnsStatus = DNS_REQUESTED;
             DEBUGLOG ("%s - DNS Resolution in progress\n", __FUNCTION__);
             responseTimer2.once_ms (dnsTimeout, &NTPClient::s_processDNSTimeout, static_cast<void*>(this));
-            return 0;
+            _waiting = true; // Request is sent when address is solved
+            return true;
         } else if (error == ERR_OK) {
             dnsStatus = DNS_SOLVED;
             ntpServerIPAddress = getIPClass (&ipaddress);
         } else {
             DEBUGLOG ("%s - DNS Resolution error\n", __FUNCTION__);
-            return 0;
+            if (onSyncEvent)
+                onSyncEvent (invalidAddress);
+            return false;
         }
     }
     DEBUGLOG ("%s - DNS name IP solved: %s\n", __FUNCTION__, ntpServerIPAddress.toString ().c_str ());
     if (error == ERR_OK && dnsStatus == DNS_SOLVED) {
         dnsStatus = DNS_IDLE;
 #elif NETWORK_TYPE == NETWORK_ESP32
-    int error = WiFi.hostByName (getNtpServerName ().c_str (), ntpServerIPAddress);
+    int error = 1;
+    if (_burst == 1) // Server address is solved once per burst
+        error = WiFi.hostByName (getNtpServerName ().c_str (), ntpServerIPAddress);
     if (error) {
 #endif
         DEBUGLOG ("%s - Starting UDP. IP: %s\n", __FUNCTION__, ntpServerIPAddress.toString ().c_str ());
@@ -292,29 +268,30 @@ time_t NTPClient::getTime () {
             if (sendNTPpacket (udp)) {
                 DEBUGLOG ("%s - NTP request sent\n", __FUNCTION__);
                 status = ntpRequested;
+                _waiting = true;
                 responseTimer.once_ms (ntpTimeout, &NTPClient::s_processRequestTimeout, static_cast<void*>(this));
                 /*timer1_attachInterrupt (s_processRequestTimeout);
                 timer1_enable (TIM_DIV256, TIM_EDGE, TIM_SINGLE);
                 timer1_write ((uint32_t)(312.5*ntpTimeout));*/
-                if (onSyncEvent)
+                if (onSyncEvent && _burst == 1)
                     onSyncEvent (requestSent);
-                return 0;
+                return true;
             } else {
                 DEBUGLOG ("%s - NTP request error\n", __FUNCTION__);
                 if (onSyncEvent)
                     onSyncEvent (errorSending);
-                return 0;
+                return false;
             }
         } else {
             if (onSyncEvent)
                 onSyncEvent (noResponse);
-            return 0; // return 0 if unable to get the time
+            return false;
         }
     } else {
         DEBUGLOG ("%s - HostByName error %d\n", __FUNCTION__, (int)error);
         if (onSyncEvent)
             onSyncEvent (invalidAddress);
-        return 0; // return 0 if unable to get the time
+        return false;
     }
 
 }
@@ -337,21 +314,8 @@ boolean NTPClient::sendNTPpacket (AsyncUDP *udp) {
     AsyncUDPMessage ntpPacket = AsyncUDPMessage ();
 
     uint8_t ntpPacketBuffer[NTP_PACKET_SIZE]; //Buffer to store request message
-                                              // set all bytes in the buffer to 0
-    memset (ntpPacketBuffer, 0, NTP_PACKET_SIZE);
-    // Initialize values needed to form NTP request
-    // (see URL above for details on the packets)
-    ntpPacketBuffer[0] = 0b11100011;   // LI, Version, Mode
-    ntpPacketBuffer[1] = 0;     // Stratum, or type of clock
-    ntpPacketBuffer[2] = 6;     // Polling Interval
-    ntpPacketBuffer[3] = 0xEC;  // Peer Clock Precision
-                                // 8 bytes of zero for Root Delay & Root Dispersion
-    ntpPacketBuffer[12] = 49;
-    ntpPacketBuffer[13] = 0x4E;
-    ntpPacketBuffer[14] = 49;
-    ntpPacketBuffer[15] = 52;
-    // all NTP fields have been given values, now
-    // you can send a packet requesting a timestamp:
+
+    buildRequest (ntpPacketBuffer);
     ntpPacket.write (ntpPacketBuffer, NTP_PACKET_SIZE);
     if (udp->send (ntpPacket)) {
         DEBUGLOG ("\n");
@@ -368,28 +332,17 @@ void NTPClient::processPacket (AsyncUDPPacket& packet) {
     int size;
 
     if (status == ntpRequested) {
+        int64_t received = clockMicros (millis ()); // Take T4 before anything else
         size = packet.length ();
-        if (size >= NTP_PACKET_SIZE) {
+        ntpPacketBuffer = packet.data ();
+        if (processResponse (ntpPacketBuffer, size, received)) {
             //timer1_disable ();
             responseTimer.detach ();
-            ntpPacketBuffer = packet.data ();
-            time_t timeValue = decodeNtpMessage (ntpPacketBuffer);
-            setTime (timeValue);
             status = syncd;
-            setSyncInterval (getLongInterval ());
-            if (!_firstSync) {
-                //    if (timeStatus () == timeSet)
-                _firstSync = timeValue;
-            }
-            setLastNTPSync (timeValue);
-            DEBUGLOG ("Sync frequency set low\n");
-            DEBUGLOG ("Successful NTP sync at %s\n", getTimeDateString (getLastNTPSync ()).c_str ());
-
-            if (onSyncEvent)
-                onSyncEvent (timeSyncd);
+            _waiting = false;
         } else {
+            // Keep waiting for the right response until timeout
             DEBUGLOG ("Response Error\n");
-            status = unsyncd;
             if (onSyncEvent)
                 onSyncEvent (responseError);
         }
@@ -416,8 +369,7 @@ void ICACHE_RAM_ATTR NTPClient::processRequestTimeout () {
     //timer1_disable ();
     responseTimer.detach ();
     DEBUGLOG ("NTP response Timeout\n");
-    if (onSyncEvent)
-        onSyncEvent (noResponse);
+    _waiting = false;
 }
 
 void ICACHE_RAM_ATTR NTPClient::s_processRequestTimeout (void* arg) {
@@ -426,6 +378,226 @@ void ICACHE_RAM_ATTR NTPClient::s_processRequestTimeout (void* arg) {
 }
 #endif
 
+void NTPClient::buildRequest (uint8_t *ntpPacketBuffer) {
+    // set all bytes in the buffer to 0
+    memset (ntpPacketBuffer, 0, NTP_PACKET_SIZE);
+    // Initialize values needed to form NTP request
+    // (see URL above for details on the packets)
+    ntpPacketBuffer[0] = 0b11100011;   // LI, Version, Mode
+    ntpPacketBuffer[1] = 0;     // Stratum, or type of clock
+    ntpPacketBuffer[2] = 6;     // Polling Interval
+    ntpPacketBuffer[3] = 0xEC;  // Peer Clock Precision
+                                // 8 bytes of zero for Root Delay & Root Dispersion
+    ntpPacketBuffer[12] = 49;
+    ntpPacketBuffer[13] = 0x4E;
+    ntpPacketBuffer[14] = 49;
+    ntpPacketBuffer[15] = 52;
+    // Transmit timestamp is T1. Server copies it to originate timestamp so
+    // responses to older requests can be told apart
+    _requestSent = clockMicros (millis ());
+    uint32_t secs = (uint32_t)(_requestSent / 1000000) + SEVENTY_YEARS;
+    uint32_t frac = (uint32_t)((((uint64_t)(_requestSent % 1000000)) << 32) / 1000000);
+    for (uint8_t i = 0; i < 4; i++) {
+        ntpPacketBuffer[40 + i] = secs >> (24 - 8 * i);
+        ntpPacketBuffer[44 + i] = frac >> (24 - 8 * i);
+    }
+    memcpy (_requestStamp, ntpPacketBuffer + 40, sizeof (_requestStamp));
+}
+
+/**
+* Converts a 64 bit NTP timestamp to microseconds since 1970. Seconds below
+* 2^31 are taken as NTP era 1, that starts in 2036.
+*/
+static int64_t ntpToMicros (const uint8_t *timestamp) {
+    uint32_t secs = 0;
+    uint32_t frac = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        secs = (secs << 8) | timestamp[i];
+        frac = (frac << 8) | timestamp[4 + i];
+    }
+    int64_t unixSecs = (int64_t)secs - SEVENTY_YEARS;
+    if (secs < 0x80000000UL)
+        unixSecs += 0x100000000LL;
+    return unixSecs * 1000000 + (int64_t)(((uint64_t)frac * 1000000) >> 32);
+}
+
+boolean NTPClient::processResponse (const uint8_t *ntpPacketBuffer, size_t size, int64_t received) {
+    if (size < NTP_PACKET_SIZE)
+        return false;
+    if ((ntpPacketBuffer[0] & 0x07) != 4 // Not a server response
+        || (ntpPacketBuffer[0] >> 6) == 3 // Server clock not synchronized
+        || ntpPacketBuffer[1] == 0 // Kiss-o'-Death
+        || memcmp (ntpPacketBuffer + 24, _requestStamp, sizeof (_requestStamp))) // Response to an older request
+        return false;
+
+    int64_t serverReceived = ntpToMicros (ntpPacketBuffer + 32); // T2
+    int64_t serverSent = ntpToMicros (ntpPacketBuffer + 40); // T3
+    int64_t offset = ((serverReceived - _requestSent) + (serverSent - received)) / 2;
+    int64_t delay = (received - _requestSent) - (serverSent - serverReceived);
+    if (delay < 0) // Local clock resolution is 1 ms
+        delay = 0;
+    DEBUGLOG ("Offset: %ld us, delay: %ld us\n", (long)offset, (long)delay);
+
+    if (!_replies || delay < _sampleDelay) {
+        _sampleOffset = offset;
+        _sampleDelay = delay;
+    }
+    _replies++;
+    return true;
+}
+
+int64_t NTPClient::clockMicros (uint32_t ms) {
+    uint32_t elapsed = ms - _clockMillis;
+    return _clockBase + (int64_t)elapsed * 1000 + (int64_t)elapsed * _drift / 1000000;
+}
+
+void NTPClient::handle () {
+    if (!udp)
+        return;
+#if NETWORK_TYPE == NETWORK_W5100 || NETWORK_TYPE == NETWORK_WIFI101
+    if (_waiting)
+        pollResponse ();
+#endif
+    if (_waiting)
+        return;
+
+    if (_burst == 0) {
+        if (millis () - _lastBurst < _nextSyncWait)
+            return;
+        DEBUGLOG ("Starting NTP burst\n");
+        _replies = 0;
+        _abort = false;
+        _burst++;
+        updateSyncInterval ();
+    } else if (_burst < NTP_BURST_SAMPLES && !_abort) {
+        _burst++;
+    } else {
+        finishBurst ();
+        return;
+    }
+    if (!sendRequest ())
+        _abort = true;
+}
+
+void NTPClient::finishBurst () {
+    uint32_t ms = millis ();
+
+#if NETWORK_TYPE == NETWORK_W5100 || NETWORK_TYPE == NETWORK_WIFI101
+    udp->stop ();
+#endif
+    _burst = 0;
+    _lastBurst = ms;
+    if (!_replies) {
+        DEBUGLOG ("-- No valid NTP response in burst\n");
+        _nextSyncWait = _shortInterval * 1000UL; // Retry connection more often
+        updateSyncInterval ();
+        if (onSyncEvent && !_abort) // Errors were already notified
+            onSyncEvent (noResponse);
+        return;
+    }
+
+    int64_t offset = _sampleOffset;
+    // The offset was measured against the clock as it ran, a new drift
+    // estimate only applies from now on
+    int64_t local = clockMicros (ms);
+    if (!_synced) {
+        _pollInterval = NTP_MIN_POLL;
+    } else if (offset > NTP_STEP_THRESHOLD * 1000LL || offset < -NTP_STEP_THRESHOLD * 1000LL) {
+        DEBUGLOG ("Clock stepped\n");
+        _pollInterval = NTP_MIN_POLL;
+    } else {
+        // Offset accumulated since last correction is the residual frequency
+        // error. First estimate is taken as is, later ones are averaged in
+        uint32_t elapsed = ms - _lastCorrection;
+        if (elapsed > 0) {
+            int64_t drift = offset * 1000000 / elapsed;
+            drift = _driftValid ? _drift + drift / 2 : _drift + drift;
+            if (drift > NTP_MAX_DRIFT)
+                drift = NTP_MAX_DRIFT;
+            if (drift < -NTP_MAX_DRIFT)
+                drift = -NTP_MAX_DRIFT;
+            _drift = drift;
+            _driftValid = true;
+        }
+        if (offset < NTP_STABLE_OFFSET * 1000L && offset > -NTP_STABLE_OFFSET * 1000L) {
+            _pollInterval *= 2;
+        } else if (_pollInterval > NTP_MIN_POLL) {
+            _pollInterval /= 2;
+        }
+    }
+    if (_pollInterval > _longInterval)
+        _pollInterval = _longInterval;
+
+    _clockBase = local + offset;
+    _clockMillis = ms;
+    _lastCorrection = ms;
+    _lastOffset = offset;
+    _lastDelay = _sampleDelay;
+    _synced = true;
+    _nextSyncWait = _pollInterval * 1000UL;
+    DEBUGLOG ("Drift: %ld ppb, next sync in %d s\n", (long)_drift, _pollInterval);
+
+    int64_t utc = clockMicros (ms);
+    time_t timeValue = utcToLocal (utc / 1000000);
+    setTime (timeValue, (utc / 1000) % 1000);
+    updateSyncInterval ();
+    if (!_firstSync) {
+        //    if (timeStatus () == timeSet)
+        _firstSync = timeValue;
+    }
+    setLastNTPSync (timeValue);
+    DEBUGLOG ("Successful NTP sync at %s\n", getTimeDateString (getLastNTPSync ()).c_str ());
+
+    if (onSyncEvent)
+        onSyncEvent (timeSyncd);
+}
+
+void NTPClient::updateSyncInterval () {
+    // now () asks for time every second during a burst so that it goes on
+    // even if handle () is not called from loop ()
+    if (_synced && !_burst) {
+        setSyncInterval (_longInterval < NTP_DISCIPLINE_INTERVAL ? _longInterval : NTP_DISCIPLINE_INTERVAL);
+    } else {
+        setSyncInterval (1);
+    }
+}
+
+time_t NTPClient::getTime () {
+    return getTime (NULL);
+}
+
+time_t NTPClient::getTime (uint16_t *ms) {
+    handle ();
+    if (!_synced)
+        return 0;
+    int64_t utc = clockMicros (millis ());
+    if (ms)
+        *ms = (utc / 1000) % 1000;
+    return utcToLocal (utc / 1000000);
+}
+
+int64_t NTPClient::getUTCTimeMs () {
+    if (!_synced)
+        return 0;
+    return clockMicros (millis ()) / 1000;
+}
+
+int64_t NTPClient::getLastOffset () {
+    return _lastOffset;
+}
+
+int32_t NTPClient::getLastDelay () {
+    return _lastDelay;
+}
+
+int32_t NTPClient::getDrift () {
+    return _drift;
+}
+
+int NTPClient::getPollInterval () {
+    return _pollInterval;
+}
+
 int8_t NTPClient::getTimeZone () {
     return _timeZone;
 }
@@ -438,8 +610,8 @@ int8_t NTPClient::getTimeZoneMinutes () {
     _lastSyncd = moment;
 }*/
 
-time_t NTPClient::s_getTime () {
-    return NTP.getTime ();
+time_t NTPClient::s_getTime (uint16_t *ms) {
+    return NTP.getTime (ms);
 }
 
 #if NETWORK_TYPE == NETWORK_W5100
@@ -481,8 +653,15 @@ bool NTPClient::begin (String ntpServerName, int8_t timeZone, bool daylight, int
     }
     DEBUGLOG ("Time sync started\r\n");
 
-    setSyncInterval (getShortInterval ());
-    setSyncProvider (s_getTime);
+    _synced = false;
+    _driftValid = false;
+    _drift = 0;
+    _burst = 0;
+    _waiting = false;
+    _nextSyncWait = 0;
+    _pollInterval = NTP_MIN_POLL;
+    updateSyncInterval ();
+    setSyncProviderMs (s_getTime); // First request burst is started here
 
     return true;
 }
@@ -493,6 +672,14 @@ NTPClient::~NTPClient () {
 
 bool NTPClient::stop () {
     setSyncProvider (NULL);
+#if NETWORK_TYPE == NETWORK_ESP8266 || NETWORK_TYPE == NETWORK_ESP32
+    responseTimer.detach ();
+    responseTimer2.detach ();
+    status = unsyncd;
+    dnsStatus = DNS_IDLE;
+#endif
+    _burst = 0;
+    _waiting = false;
     // Free up connection resources
     if (udp) {
 #if NETWORK_TYPE == NETWORK_ESP8266 || NETWORK_TYPE == NETWORK_ESP32
@@ -513,8 +700,9 @@ bool NTPClient::setInterval (int interval) {
         if (_longInterval != interval) {
             _longInterval = interval;
             DEBUGLOG ("Sync interval set to %d\n", interval);
-            if (timeStatus () == timeSet)
-                setSyncInterval (interval);
+            if (_pollInterval > interval)
+                _pollInterval = interval;
+            updateSyncInterval ();
         }
         return true;
     } else
@@ -525,11 +713,9 @@ bool NTPClient::setInterval (int shortInterval, int longInterval) {
     if (shortInterval >= 10 && longInterval >= 10) {
         _shortInterval = shortInterval;
         _longInterval = longInterval;
-        if (timeStatus () != timeSet) {
-            setSyncInterval (shortInterval);
-        } else {
-            setSyncInterval (longInterval);
-        }
+        if (_pollInterval > longInterval)
+            _pollInterval = longInterval;
+        updateSyncInterval ();
         DEBUGLOG ("Short sync interval set to %d\n", shortInterval);
         DEBUGLOG ("Long sync interval set to %d\n", longInterval);
         return true;
@@ -552,9 +738,9 @@ void NTPClient::setDayLight (bool daylight) {
     if (_lastSyncd > 0) {
         if ((_daylight != daylight) && isSummerTimePeriod (now ())) {
             if (daylight) {
-                setTime (now () + SECS_PER_HOUR);
+                adjustTime (SECS_PER_HOUR);
             } else {
-                setTime (now () - SECS_PER_HOUR);
+                adjustTime (-SECS_PER_HOUR);
             }
         }
     }
@@ -745,8 +931,11 @@ time_t NTPClient::decodeNtpMessage (uint8_t *messageBuffer) {
         DEBUGLOG ("--Timestamp is Zero\n");
         return 0;
     }
-#define SEVENTY_YEARS 2208988800UL
-    time_t timeTemp = secsSince1900 - SEVENTY_YEARS + _timeZone * SECS_PER_HOUR + _minutesOffset * SECS_PER_MIN;
+    return utcToLocal (secsSince1900 - SEVENTY_YEARS);
+}
+
+time_t NTPClient::utcToLocal (time_t utc) {
+    time_t timeTemp = utc + _timeZone * SECS_PER_HOUR + _minutesOffset * SECS_PER_MIN;
 
     if (_daylight) {
         if (summertime (year (timeTemp), month (timeTemp), day (timeTemp), hour (timeTemp), weekday (timeTemp), _timeZone)) {
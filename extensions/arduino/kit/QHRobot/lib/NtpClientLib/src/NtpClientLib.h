@@ -67,6 +67,12 @@ extern "C" {
 #define DEFAULT_NTP_SHORTINTERVAL 15 // Sync interval when sync has not been achieved. 15 seconds
 #define DEFAULT_NTP_TIMEZONE 0 // Select your local time offset. 0 if UTC time has to be used
 #define MIN_NTP_TIMEOUT 100 // Minumum admisible ntp timeout
+#define NTP_BURST_SAMPLES 4 // Requests sent on every sync. Reply with the shortest round trip is used
+#define NTP_MIN_POLL 64 // Seconds between syncs right after first one. Doubles up to sync interval while clock is stable
+#define NTP_STABLE_OFFSET 25 // Offset in ms under which clock is considered stable
+#define NTP_STEP_THRESHOLD 500 // Offset in ms over which clock is stepped without updating drift estimate
+#define NTP_MAX_DRIFT 500000 // Maximum drift correction, in parts per billion
+#define NTP_DISCIPLINE_INTERVAL 60 // Seconds between Time library updates from disciplined clock
 
 #define DST_ZONE_EU             (0)
 #define DST_ZONE_USA            (1)
@@ -213,12 +219,55 @@ public:
     }
 
     /**
-    * Starts a NTP time request to server. Returns a time in UNIX time format. Normally only called from library.
-    * Kept in public section to allow direct NTP request.
-    * @param[out] Time in UNIX time format.
+    * Gets local time from disciplined clock. Starts a NTP request burst if it is due, but never waits
+    * for the response. Normally only called from library. Kept in public section to allow direct NTP request.
+    * @param[out] Time in UNIX time format. 0 until first sync.
     */
     time_t getTime ();
 
+    /**
+    * Gets local time from disciplined clock with millisecond resolution.
+    * @param[in] Pointer to store milliseconds elapsed in current second. May be NULL.
+    * @param[out] Time in UNIX time format. 0 until first sync.
+    */
+    time_t getTime (uint16_t *ms);
+
+    /**
+    * Runs NTP request bursts. It is called from now() in Time library, but calling it in loop() improves
+    * accuracy on Ethernet and WiFi101 as responses are timestamped here.
+    */
+    void handle ();
+
+    /**
+    * Gets UTC time from disciplined clock.
+    * @param[out] Milliseconds since 1970-01-01 00:00:00 UTC. 0 until first sync.
+    */
+    int64_t getUTCTimeMs ();
+
+    /**
+    * Gets clock correction applied on last sync.
+    * @param[out] Offset in microseconds. Positive if local clock was behind server.
+    */
+    int64_t getLastOffset ();
+
+    /**
+    * Gets round trip delay of the sample used on last sync.
+    * @param[out] Delay in microseconds.
+    */
+    int32_t getLastDelay ();
+
+    /**
+    * Gets local clock frequency error estimated from successive syncs.
+    * @param[out] Drift in parts per billion. Positive if local clock runs slow.
+    */
+    int32_t getDrift ();
+
+    /**
+    * Gets current period between syncs. It starts in NTP_MIN_POLL and backs off up to sync interval.
+    * @param[out] Period in seconds.
+    */
+    int getPollInterval ();
+
     /**
     * Sets timezone.
     * @param[in] New time offset in hours (-11 <= timeZone <= +13).
@@ -440,8 +489,8 @@ protected:
     WiFiUDP *udp;
 #elif NETWORK_TYPE == NETWORK_ESP8266 || NETWORK_TYPE == NETWORK_ESP32
     AsyncUDP *udp;              ///< UDP connection object
-    IPAddress ntpServerIPAddress;
 #endif
+    IPAddress ntpServerIPAddress; ///< NTP server address solved at the beginning of each burst
     bool _daylight;             ///< Does this time zone have daylight saving?
     int8_t _timeZone = 0;       ///< Keep track of set time zone offset
     int8_t _minutesOffset = 0;   ///< Minutes offset for time zones with decimal numbers
@@ -455,6 +504,27 @@ protected:
     uint16_t ntpTimeout = 1500; ///< Response timeout for NTP requests
     onSyncEvent_t onSyncEvent;  ///< Event handler callback
 
+    int64_t _clockBase = 0;     ///< Disciplined UTC time in microseconds at _clockMillis
+    uint32_t _clockMillis = 0;  ///< millis () value when clock was last stepped
+    int32_t _drift = 0;         ///< Frequency correction in parts per billion
+    bool _driftValid = false;   ///< False until drift is measured for the first time
+    bool _synced = false;       ///< Disciplined clock has been set
+    uint32_t _lastCorrection = 0; ///< millis () value of last correction, to measure drift
+    int64_t _lastOffset = 0;    ///< Correction applied on last sync, in microseconds
+    int32_t _lastDelay = 0;     ///< Round trip delay on last sync, in microseconds
+    int _pollInterval = NTP_MIN_POLL; ///< Current period between syncs in seconds
+    uint32_t _lastBurst = 0;    ///< millis () value when last burst finished
+    uint32_t _nextSyncWait = 0; ///< Milliseconds from _lastBurst to next burst
+    uint8_t _burst = 0;         ///< Requests sent in current burst. 0 if idle
+    uint8_t _replies = 0;       ///< Valid responses received in current burst
+    volatile bool _waiting = false; ///< Request sent, waiting for response or timeout
+    volatile bool _abort = false; ///< Current burst has to be finished because of an error
+    int64_t _sampleOffset;      ///< Offset of best sample in current burst, in microseconds
+    int64_t _sampleDelay;       ///< Round trip delay of best sample in current burst, in microseconds
+    int64_t _requestSent;       ///< Local clock when last request was sent (T1), in microseconds
+    uint8_t _requestStamp[8];   ///< Transmit timestamp of last request, echoed by server
+    uint32_t _requestMillis;    ///< millis () value when last request was sent, for timeout
+
 #if NETWORK_TYPE == NETWORK_ESP8266 || NETWORK_TYPE == NETWORK_ESP32
     NTPStatus_t status = unsyncd; ///< Sync status
     DNSStatus_t dnsStatus = DNS_IDLE; ///< DNS request status
@@ -489,13 +559,65 @@ protected:
     static void ICACHE_RAM_ATTR s_processDNSTimeout (void* arg);
     void processDNSTimeout ();
 
+#else
+    /**
+    * Reads a pending response, if any, and checks response timeout.
+    */
+    void pollResponse ();
+
 #endif
 
+    /**
+    * Sends next request of current burst. Solves server address on first one.
+    * @param[out] false in case of any error.
+    */
+    boolean sendRequest ();
+
+    /**
+    * Fills a NTP request and stamps it with local clock (T1).
+    * @param[in] Buffer of NTP_PACKET_SIZE bytes.
+    */
+    void buildRequest (uint8_t *ntpPacketBuffer);
+
+    /**
+    * Calculates offset and round trip delay from a response and keeps it if it is the best one in the burst.
+    * @param[in] Response packet.
+    * @param[in] Packet length.
+    * @param[in] Local clock when response was received (T4), in microseconds.
+    * @param[out] false if it is not a valid response to last request.
+    */
+    boolean processResponse (const uint8_t *ntpPacketBuffer, size_t size, int64_t received);
+
+    /**
+    * Applies best sample of burst to local clock, updates drift estimate and poll interval.
+    */
+    void finishBurst ();
+
+    /**
+    * Sets Time library sync interval depending on burst state.
+    */
+    void updateSyncInterval ();
+
+    /**
+    * Local clock in UTC corrected with drift estimate.
+    * @param[in] millis () value to calculate clock at.
+    * @param[out] Microseconds since 1970.
+    */
+    int64_t clockMicros (uint32_t ms);
+
+    /**
+    * Converts UTC to local time using time zone and daylight saving settings.
+    * @param[in] UTC time.
+    * @param[out] Local time.
+    */
+    time_t utcToLocal (time_t utc);
+
     /**
     * Function that gets time from NTP server and convert it to Unix time format
+    * @param[in] Pointer to store milliseconds elapsed in current second.
     * @param[out] Time form NTP in Unix Time Format.
     */
-    static time_t s_getTime ();
+    static time_t s_getTime (uint16_t *ms);
 
     /**
     * Calculates the daylight saving for a given date.
@@ -1,6 +1,8 @@
 
 #include "QDPBuzzer.h"
+#if defined(__AVR__)
 #include <avr/wdt.h>
+#endif
 int  tone_list[] = {262, 294, 330, 349, 392, 440, 494, 523, 587, 659, 698, 784, 880, 988, 1046, 1175, 1318, 1397, 1568, 1760, 1967};
 const int PROGMEM music_1[] = {12, 10, 12, 10, 12, 10, 9, 10, 12, 12, 12, 10, 13, 12, 10, 12, 10, 9, 8, 9, 10, 12, 10, 9, 8, 9, 10, 0};
 const float PROGMEM rhythm_1[] = {1, 0.5, 1, 0.5, 0.5, 0.5, 0.5, 0.5, 2, 0.5, 1, 0.5, 1, 1, 0.5, 0.5, 0.5, 0.5, 1, 1, 1, 1, 0.5, 0.5, 0.5, 0.5, 2};
@@ -23,32 +25,52 @@ const float PROGMEM rhythm_9[] = {0.5, 0.5, 0.5, 0.5, 2, 0.5, 0.5, 0.5, 0.5, 2,
 const int PROGMEM music_10[] = {10, 10, 10, 8, 5, 5, 22, 10, 10, 10, 8, 10, 22, 12, 12, 10, 8, 5, 5, 5, 6, 7, 8, 10, 9, 0};
 const float PROGMEM rhythm_10[] = {0.5, 0.5, 0.5, 0.5, 1, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 1, 1, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 1, 0.5, 0.5, 0.5, 0.5, 1};
 
-void QDPBuzzer::tone(uint8_t pin, uint16_t frequency, uint32_t duration)
+QDPBuzzer::QDPBuzzer()
 {
+  _music = NULL;
+  _playing = false;
+  _done = NULL;
+}
 
-  int period = 1000000L / frequency;
-  int pulse = period / 2;
-  pinMode(pin, OUTPUT);
-  for (long i = 0; i < duration * 1000L; i += period)
+void QDPBuzzer::tone(uint8_t pin, uint16_t frequency, uint32_t duration)
+{
+  stop();
+  if (frequency == 0 || duration == 0)
   {
-    digitalWrite(pin, HIGH);
-    delayMicroseconds(pulse);
-    digitalWrite(pin, LOW);
-    delayMicroseconds(pulse);
-    wdt_reset();
+    return;
   }
+  _pin = pin;
+  startTone(frequency, duration);
+  _playing = true;
+  _last = millis();
+  _wait = duration;
 }
 
 void QDPBuzzer::noTone(uint8_t pin)
 {
+  if (_playing && pin == _pin)
+  {
+    stop();
+  }
   pinMode(pin, OUTPUT);
   digitalWrite(pin, LOW);
 }
 
 void QDPBuzzer::buzzer_music(uint8_t pin, uint8_t num)
 {
-  int *p1;
-  float *p2  ;
+  startMusic(pin, num);
+  while (poll())
+  {
+#if defined(__AVR__)
+    wdt_reset();
+#endif
+  }
+}
+
+void QDPBuzzer::startMusic(uint8_t pin, uint8_t num, void (*done)(void))
+{
+  const int *p1;
+  const float *p2;
   switch (num) {
     case 1:
       p1 = music_1;
@@ -90,22 +112,107 @@ void QDPBuzzer::buzzer_music(uint8_t pin, uint8_t num)
       p1 = music_10;
       p2 = rhythm_10;
       break;
+    default:
+      return;
   }
 
+  stop();
+  _pin = pin;
+  _music = p1;
+  _rhythm = p2;
+  _index = 0;
+  _done = done;
+  _playing = true;
+  _last = millis();
+  startNote();
+}
 
+// each note sounds for its beat, 22 is a rest, then 30ms of silence,
+// the song ends with a 1s pause
+void QDPBuzzer::startNote(void)
+{
+  int note = pgm_read_word_near(&_music[_index]);
+  if (note == 0)
+  {
+    _step = 2;
+    _wait = 1000;
+    return;
+  }
+  int time = int(pgm_read_float_near(&_rhythm[_index]) * 300);
+  if (note != 22)
+  {
+    startTone(tone_list[note - 1], time);
+  }
+  _step = 0;
+  _wait = time;
+}
 
-  for (int a = 0; pgm_read_word_near(&p1[a]) != 0; a++) {
-    int time = int(pgm_read_float_near(&p2[a]) * 300);
-    if (pgm_read_word_near(&p1[a]) != 22) {
-      tone(pin, tone_list[pgm_read_word_near(&p1[a]) - 1], time);
+// deadlines follow each other, a late poll does not stretch the song
+bool QDPBuzzer::poll(void)
+{
+  while (_playing && millis() - _last >= _wait)
+  {
+    _last += _wait;
+    if (_music != NULL && _step == 0)
+    {
+      stopTone();
+      _step = 1;
+      _wait = 30;
+    }
+    else if (_music != NULL && _step == 1)
+    {
+      _index++;
+      startNote();
     }
-    else {
-      noTone(pin);
-      delay(time);
+    else
+    {
+      void (*done)(void) = _done;
+      stop();
+      if (done != NULL)
+      {
+        done();
+      }
     }
-    noTone(pin);
-    delay(30);
   }
-  delay(1000);
+  return _playing;
+}
+
+bool QDPBuzzer::isPlaying(void)
+{
+  return _playing;
+}
+
+void QDPBuzzer::stop(void)
+{
+  if (_playing)
+  {
+    stopTone();
+  }
+  _playing = false;
+  _music = NULL;
+  _done = NULL;
+}
 
+// the core tone() ends the note by itself, even when poll() comes late
+void QDPBuzzer::startTone(uint16_t frequency, uint32_t duration)
+{
+#if defined(ESP32)
+  (void)duration;
+  ledcAttachPin(_pin, QDPBUZZER_LEDC_CHANNEL);
+  ledcWriteTone(QDPBUZZER_LEDC_CHANNEL, frequency);
+#else
+  ::tone(_pin, frequency, duration);
+#endif
+}
+
+void QDPBuzzer::stopTone(void)
+{
+#if defined(ESP32)
+  ledcWrite(QDPBUZZER_LEDC_CHANNEL, 0);
+  ledcDetachPin(_pin);
+#else
+  ::noTone(_pin);
+#endif
+  pinMode(_pin, OUTPUT);
+  digitalWrite(_pin, LOW);
 }
@@ -10,9 +10,17 @@
 class QDP_text_code
 {
 public:
+	QDP_text_code();
 	int GetUtf8ByteNumForWord(unsigned char firstCh);
 	unsigned short int SearchCodeTable(unsigned short int unicodeKey);
 	void Utf8ToGb2312(const unsigned char* utf8, int len,uint8_t* gbArray);
+	// streaming conversion, a UTF-8 character may be split between calls
+	size_t convert(const uint8_t* utf8, size_t len, uint8_t* gb, size_t size, size_t* used = NULL);
+	size_t convert(const uint8_t* utf8, size_t len, Print& out);
+	void reset();
+private:
+	uint32_t _code;
+	uint8_t _pending;
 };
 
 extern QDP_text_code Transform;
@@ -2,24 +2,58 @@
 
 QDProbotAI::QDProbotAI(/* args */)
 {
-
+    session_lock = xSemaphoreCreateMutex();
+    session_http.setReuse(true);
 }
 
 QDProbotAI::~QDProbotAI()
 {
+    if( request_task != NULL )
+    {
+        vTaskDelete(request_task);
+    }
+    if( request_queue != NULL )
+    {
+        vQueueDelete(request_queue);
+    }
+    session_http.end();
+    session_client.stop();
+    vSemaphoreDelete(session_lock);
+}
+
+void QDProbotAI::sessionBegin(const String &url)
+{
+    xSemaphoreTake(session_lock, portMAX_DELAY);
+    //all the urls are on the same host, HTTPClient reuses the open connection
+    session_http.begin(session_client, url);
+}
 
+void QDProbotAI::sessionEnd()
+{
+    //keeps the connection open when the server allows it
+    session_http.end();
+    xSemaphoreGive(session_lock);
 }
 
+bool QDProbotAI::tokenValid()
+{
+    if( api_token_str.length() == 0 )
+    {
+        return false;
+    }
+    return token_lifetime == 0 || ( millis() - token_time ) < token_lifetime;
+}
 
 int QDProbotAI::gettoken(void)
 {
-    HTTPClient gettoken;
+    if( tokenValid() )
+    {
+        return 0;
+    }
 
     String apiurl = "http://";
     apiurl.concat(TOKEN_GET_URL);
 
-    gettoken.begin(apiurl);
-
     char strbuff[128];
     int64_t chipid = ESP.getEfuseMac();
     sprintf(strbuff,"{\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\"}",
@@ -32,62 +66,80 @@ int QDProbotAI::gettoken(void)
 
     //Serial.printf("Size:%d\r\n",strlen(strbuff));
     Serial.println(strbuff);
-    if( gettoken.POST((uint8_t*)strbuff,strlen(strbuff)) == HTTP_CODE_OK )
+    sessionBegin(apiurl);
+    int ret = -1;
+    if( session_http.POST((uint8_t*)strbuff,strlen(strbuff)) == HTTP_CODE_OK )
     {
         String RePOSTStr;
-        RePOSTStr = gettoken.getString();
+        RePOSTStr = session_http.getString();
         if( RePOSTStr.indexOf("exist") != -1 )
         {
             Serial.println(RePOSTStr);
-            return -1;
-            
         }
-        RePOSTStr.replace("\"","");
-        RePOSTStr.trim();
-        api_token_str = RePOSTStr;
+        else if( RePOSTStr.indexOf("access_token") != -1 )
+        {
+            //{"access_token":"...","expires_in":2592000}
+            deserializeJson(rest_json_doc,RePOSTStr);
+            settoken(rest_json_doc["access_token"].as<String>(), rest_json_doc["expires_in"] | TOKEN_DEFAULT_EXPIRES);
+            ret = 0;
+        }
+        else
+        {
+            RePOSTStr.replace("\"","");
+            RePOSTStr.trim();
+            settoken(RePOSTStr, TOKEN_DEFAULT_EXPIRES);
+            ret = 0;
+        }
         Serial.println(api_token_str);
-        return 0;
-    }
-    else
-    {
-        return -1;
     }
+    sessionEnd();
+    return ret;
 }
 
-void QDProbotAI::settoken(String token_str)
+void QDProbotAI::settoken(String token_str, uint32_t expires_in)
 {
     api_token_str = token_str;
+    token_time = millis();
+    if( expires_in > TOKEN_EXPIRE_MARGIN )
+    {
+        expires_in -= TOKEN_EXPIRE_MARGIN;
+    }
+    //millis() based, keep it inside the 49 day wrap
+    if( expires_in > UINT32_MAX / 1000 )
+    {
+        expires_in = UINT32_MAX / 1000;
+    }
+    token_lifetime = expires_in * 1000;
 }
 
-String QDProbotAI::Str2UrlEncode(String str)
+void QDProbotAI::UrlEncode(const String &str, String &out, bool twice)
 {
-    String strout = "";
     size_t length = str.length();
+    const char *in = str.c_str();
 
-    //Serial.printf("length=%d\n",length);
-    //Serial.println(str);
-
-    for (int i = 0; i < length; i++)
+    //worst case, every byte becomes %25XX
+    out.reserve(out.length() + length * ( twice ? 5 : 3 ));
+    for (size_t i = 0; i < length; i++)
     {
-        if( isalnum(str.charAt(i)) )
+        uint8_t ch = in[i];
+        if( isalnum(ch) )
         {
-            if( str.charAt(i) == ' ')
-            {
-                strout += "%20";
-            }
-            else
-            {
-                strout +=  str.charAt(i);
-            }
+            out += (char)ch;
         }
         else
         {
-            strout += '%';
-            strout += ascii2hex_buff[ str.charAt(i) / 16 ];
-            strout += ascii2hex_buff[ str.charAt(i) % 16 ];
+            //encoding twice turns '%' into "%25"
+            out += twice ? "%25" : "%";
+            out += ascii2hex_buff[ ch / 16 ];
+            out += ascii2hex_buff[ ch % 16 ];
         }
     }
-    
+}
+
+String QDProbotAI::Str2UrlEncode(String str)
+{
+    String strout;
+    UrlEncode(str, strout);
     return strout;
 }
 
@@ -95,11 +147,11 @@ int QDProbotAI::Pcm2String(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid,
 {
     //if( gettoken() == -1 ) return -1;
 
-    HTTPClient resthttp;
     String apiurl = "http://";
 
     char strbuff[128];
 
+    apiurl.reserve(128 + api_token_str.length());
     apiurl.concat(REST_URL);
     apiurl.concat('?');
     //apiurl.concat("cuid=1A57");
@@ -116,15 +168,17 @@ int QDProbotAI::Pcm2String(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid,
     //Serial.println(apiurl);
 
     uint64_t time = micros();
-    resthttp.begin(apiurl);
-    resthttp.addHeader("Content-Type", "audio/pcm;rate=16000");
-    resthttp.POST((uint8_t*)pcm_buff,pcm_lan);
+    sessionBegin(apiurl);
+    session_http.addHeader("Content-Type", "audio/pcm;rate=16000");
+    session_http.POST((uint8_t*)pcm_buff,pcm_lan);
 
     Serial.printf("Time %dms\r\n",(micros() - time )/1000);
     
-    String response = resthttp.getString();
+    String response = session_http.getString();
     Serial.println(response);
 
+    //the shared json document is parsed while the session is still held
+    int ret = 0;
     deserializeJson(rest_json_doc,response);
 
     String err_msg =  rest_json_doc["err_msg"].as<String>();
@@ -135,32 +189,35 @@ int QDProbotAI::Pcm2String(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid,
         if( result.isNull())
         {
             Serial.println("isempty");
-            return -1;
+            ret = -1;
+        }
+        else
+        {
+            *results_str = result[0].as<String>();
         }
-        *results_str = result[0].as<String>();
     }
     else
     {
         Serial.println(err_msg);
-        return -1;
+        ret = -1;
     }
-    
-    return 0;
+    sessionEnd();
+
+    return ret;
 }
 
-int QDProbotAI::String2Pcm(String str, int spd, int pit, int vol, int per,uint8_t* pcm_buff, size_t* len)
+String QDProbotAI::buildT2AUrl(const String &str, int spd, int pit, int vol, int per)
 {
-
     spd = ( spd > 15 ) ? 15 : spd;
     pit = ( pit > 15 ) ? 15 : pit;
     vol = ( vol > 15 ) ? 15 : vol;
 
-    HTTPClient resthttp;
     String apiurl = "http://";
-    
+
+    apiurl.reserve(128 + api_token_str.length() + str.length() * 5);
     apiurl.concat(REST_URL_T2A);
     apiurl.concat("?tex=");
-    apiurl.concat(Str2UrlEncode( Str2UrlEncode(str)));
+    UrlEncode(str, apiurl, true);
     apiurl.concat("&lan=zh");
     apiurl.concat("&cuid=1A57");
     apiurl.concat("&ctp=1");
@@ -175,99 +232,196 @@ int QDProbotAI::String2Pcm(String str, int spd, int pit, int vol, int per,uint8_
     apiurl.concat("&per=");
     apiurl.concat(per);
     apiurl.concat("&aue=4");
+    return apiurl;
+}
+
+int QDProbotAI::String2Pcm(String str, int spd, int pit, int vol, int per,uint8_t* pcm_buff, size_t* len)
+{
+    return String2Pcm(str, spd, pit, vol, per, pcm_buff, PCM_BUFF_SIZE, len);
+}
+
+int QDProbotAI::String2Pcm(String str, int spd, int pit, int vol, int per,uint8_t* pcm_buff, size_t size, size_t* len)
+{
+    String apiurl = buildT2AUrl(str, spd, pit, vol, per);
 
     Serial.println(apiurl);
     const char *headerKeys[] = {"Content-Type"};
-    resthttp.begin(apiurl);
-    resthttp.collectHeaders(headerKeys,1);
+    sessionBegin(apiurl);
+    session_http.collectHeaders(headerKeys,1);
 
-    if( resthttp.GET() == HTTP_CODE_OK )
+    int ret = -1;
+    if( session_http.GET() == HTTP_CODE_OK )
     {
-        if( resthttp.hasHeader("Content-Type") == true )
-        {
-            //Serial.println(resthttp.header("Content-Type"));
-            if( resthttp.header("Content-Type").indexOf("json") != -1 )
-            {
-                Serial.println(resthttp.getString());
-                return -1;
-            }
-        }
-        else
+        size_t pcmsize = session_http.getSize();
+        if( session_http.hasHeader("Content-Type") == false )
         {
             Serial.println("can't find Content-Type");
-            return -1;
         }
-        
-        size_t pcmsize = resthttp.getSize();
-        *len = pcmsize;
-        if( pcmsize > 81919 )
+        else if( session_http.header("Content-Type").indexOf("json") != -1 )
         {
-            return -1;
+            Serial.println(session_http.getString());
         }
-        Serial.printf("Get Size = %d\n",pcmsize);
-        size_t getsize = 0;
-        WiFiClient* client = resthttp.getStreamPtr();
-
-        while( getsize < pcmsize )
+        else
         {
-            int clientsize = client->available();
-            if( clientsize != 0 )
+            *len = pcmsize;
+            if( pcmsize > size )
+            {
+                //the body is not read, the connection can't be reused
+                session_client.stop();
+            }
+            else
             {
-                client->read((pcm_buff + getsize),clientsize);
-                getsize += clientsize;
+                Serial.printf("Get Size = %d\n",pcmsize);
+                size_t getsize = 0;
+                WiFiClient* client = session_http.getStreamPtr();
+
+                while( getsize < pcmsize && session_http.connected() )
+                {
+                    int clientsize = client->available();
+                    if( clientsize != 0 )
+                    {
+                        getsize += client->read((pcm_buff + getsize),pcmsize - getsize);
+                    }
+                    else
+                    {
+                        delay(5);
+                    }
+                }
+                ret = ( getsize == pcmsize ) ? 0 : -1;
             }
-            delay(5);
         }
     }
-    else
-    {
-        return -1;
-    }
+    sessionEnd();
 
-    return 0;
+    return ret;
 }
 
 int QDProbotAI::String2Pcm(String str, int spd, int pit, int vol, int per)
 {
     //if( gettoken() == -1 ) return -1;
 
-    spd = ( spd > 15 ) ? 15 : spd;
-    pit = ( pit > 15 ) ? 15 : pit;
-    vol = ( vol > 15 ) ? 15 : vol;
-
-    HTTPClient resthttp;
-    String apiurl = "http://";
-    
-    apiurl.concat(REST_URL_T2A);
-    apiurl.concat("?tex=");
-    apiurl.concat(Str2UrlEncode( Str2UrlEncode(str)));
-    apiurl.concat("&lan=zh");
-    apiurl.concat("&cuid=1A57");
-    apiurl.concat("&ctp=1");
-    apiurl.concat("&tok=");
-    apiurl.concat(api_token_str);
-    apiurl.concat("&spd=");
-    apiurl.concat(spd);
-    apiurl.concat("&pit=");
-    apiurl.concat(pit);
-    apiurl.concat("&vol=");
-    apiurl.concat(vol);
-    apiurl.concat("&per=");
-    apiurl.concat(per);
-    apiurl.concat("&aue=4");
+    String apiurl = buildT2AUrl(str, spd, pit, vol, per);
 
     //Serial.println(apiurl);
 
-    resthttp.begin(apiurl);
+    sessionBegin(apiurl);
 
-    if( resthttp.GET() == HTTP_CODE_OK )
+    int ret = -1;
+    if( session_http.GET() == HTTP_CODE_OK )
     {
-        size_t pcmsize = resthttp.getSize();
+        //the audio is not kept, drop the connection instead of reading it
+        session_client.stop();
+        ret = 0;
+    }
+    sessionEnd();
+    return ret;
+}
 
-        size_t getsize = 0;
-        WiFiClient* client = resthttp.getStreamPtr();
+bool QDProbotAI::beginQueue(uint8_t depth)
+{
+    if( request_queue != NULL )
+    {
+        return true;
+    }
+    request_queue = xQueueCreate(depth, sizeof(aiRequest *));
+    if( request_queue == NULL )
+    {
+        return false;
+    }
+    if( xTaskCreate(requestTask, "QDProbotAI", REQUEST_TASK_STACK, this, 1, &request_task) != pdPASS )
+    {
+        vQueueDelete(request_queue);
+        request_queue = NULL;
+        return false;
+    }
+    return true;
+}
 
+void QDProbotAI::requestTask(void *arg)
+{
+    QDProbotAI *ai = (QDProbotAI *)arg;
+    aiRequest *req;
+
+    //requests run one after the other on the shared connection
+    while(1)
+    {
+        if( xQueueReceive(ai->request_queue, &req, portMAX_DELAY) != pdTRUE )
+        {
+            continue;
+        }
+        if( req->type == AI_REQUEST_PCM2STRING )
+        {
+            String result;
+            int code = ai->Pcm2String(req->buff, req->len, req->dev_pid, &result);
+            if( req->onRecognize )
+            {
+                req->onRecognize(code, result);
+            }
+        }
+        else
+        {
+            size_t len = 0;
+            int code = ai->String2Pcm(req->text, req->spd, req->pit, req->vol, req->per, req->buff, req->len, &len);
+            if( req->onSpeech )
+            {
+                req->onSpeech(code, len);
+            }
+        }
+        delete req;
+    }
+}
+
+bool QDProbotAI::Pcm2StringAsync(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid, AIRecognizeCallback callback)
+{
+    if( !beginQueue() )
+    {
+        return false;
+    }
+    aiRequest *req = new aiRequest();
+    req->type = AI_REQUEST_PCM2STRING;
+    req->buff = pcm_buff;
+    req->len = pcm_lan;
+    req->dev_pid = dev_pid;
+    req->onRecognize = callback;
+    if( xQueueSend(request_queue, &req, 0) != pdTRUE )
+    {
+        delete req;
+        return false;
+    }
+    return true;
+}
+
+bool QDProbotAI::String2PcmAsync(String str, int spd, int pit, int vol, int per, uint8_t* pcm_buff, size_t size, AISpeechCallback callback)
+{
+    if( !beginQueue() )
+    {
+        return false;
+    }
+    aiRequest *req = new aiRequest();
+    req->type = AI_REQUEST_STRING2PCM;
+    req->buff = pcm_buff;
+    req->len = size;
+    req->text = str;
+    req->spd = spd;
+    req->pit = pit;
+    req->vol = vol;
+    req->per = per;
+    req->onSpeech = callback;
+    if( xQueueSend(request_queue, &req, 0) != pdTRUE )
+    {
+        delete req;
+        return false;
+    }
+    return true;
+}
+
+size_t QDProbotAI::pendingRequests()
+{
+    if( request_queue == NULL )
+    {
+        return 0;
     }
+    return uxQueueMessagesWaiting(request_queue);
 }
 
 bool QDProbotAI::InitI2SSpeakOrMic(int mode)
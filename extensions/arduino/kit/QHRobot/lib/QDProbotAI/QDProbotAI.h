@@ -4,6 +4,7 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <driver/i2s.h>
+#include <functional>
 
 
 #define  TOKEN_GET_URL      "\u0066\u006C\u006F\u0077\u002E\u006D\u0035\u0073\u0074\u0061\u0063\u006B\u002E\u0063\u006F\u006D\u003A\u0035\u0030\u0030\u0033\u002F\u0074\u006F\u006B\u0065\u006E\u005F\u0067\u0065\u0074"
@@ -12,6 +13,15 @@
 
 #define  JSON_DOCSIZE   512
 
+// lifetime of a token when the server does not report expires_in (s)
+#define  TOKEN_DEFAULT_EXPIRES  2592000
+// refresh the token this long before it expires (s)
+#define  TOKEN_EXPIRE_MARGIN    60
+#define  REQUEST_QUEUE_DEPTH    4
+#define  REQUEST_TASK_STACK     8192
+//the largest audio String2Pcm() reads when no buffer size is given
+#define  PCM_BUFF_SIZE          81920
+
 #define  DEV_PID_MANDARIN   "\u0031\u0035\u0033\u0037"    
 #define  DEV_PID_M_AND_E    "\u0031\u0035\u0033\u0036"     
 #define  DEV_PID_ENGLISH    "\u0031\u0037\u0033\u0037"     
@@ -27,10 +37,40 @@ struct pcmPack
     uint32_t packsize;
 };
 
+// completion callbacks of queued requests, run on the request task
+typedef std::function<void(int code, String result)> AIRecognizeCallback;
+typedef std::function<void(int code, size_t len)> AISpeechCallback;
+
+enum
+{
+    AI_REQUEST_PCM2STRING,
+    AI_REQUEST_STRING2PCM,
+};
+
+struct aiRequest
+{
+    uint8_t type;
+    uint8_t *buff;
+    size_t len;
+    String text;
+    String dev_pid;
+    int spd, pit, vol, per;
+    AIRecognizeCallback onRecognize;
+    AISpeechCallback onSpeech;
+};
+
 class QDProbotAI
 {
 private:
     String  api_token_str;
+    uint32_t token_time = 0;
+    uint32_t token_lifetime = 0;    //ms, 0 never expires
+    //persistent session, the connection is kept alive between calls
+    WiFiClient session_client;
+    HTTPClient session_http;
+    SemaphoreHandle_t session_lock = NULL;
+    QueueHandle_t request_queue = NULL;
+    TaskHandle_t request_task = NULL;
     StaticJsonDocument<JSON_DOCSIZE>    rest_json_doc;
     char ascii2hex_buff[17] ="\u0030\u0031\u0032\u0033\u0034\u0035\u0036\u0037\u0038\u0039\u0061\u0062\u0063\u0064\u0065\u0066";
     //200825
@@ -43,6 +83,12 @@ private:
     uint8_t CONFIG_I2S_LRCK_PIN;
     uint8_t CONFIG_I2S_DATA_IN_PIN;
 
+    void sessionBegin(const String &url);
+    void sessionEnd();
+    bool tokenValid();
+    String buildT2AUrl(const String &str, int spd, int pit, int vol, int per);
+    static void requestTask(void *arg);
+
 public:
     QueueHandle_t xQ_i2sSteam = NULL;
 
@@ -51,12 +97,20 @@ public:
     ~QDProbotAI();
     int gettoken(void);
     int creattoken(void);
-    void settoken(String token_str);
+    void settoken(String token_str, uint32_t expires_in = 0);
     
     int Pcm2String(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid, String *results_str);
     int String2Pcm(String str, int spd, int pit, int vol, int per,uint8_t* pcm_buff, size_t* len);
+    //audio longer than size is not read, *len still gets its length
+    int String2Pcm(String str, int spd, int pit, int vol, int per,uint8_t* pcm_buff, size_t size, size_t* len);
     int String2Pcm(String str, int spd, int pit, int vol, int per);
     String Str2UrlEncode(String str);
+    void UrlEncode(const String &str, String &out, bool twice = false);
+    //queued requests, return false when the queue is full
+    bool beginQueue(uint8_t depth = REQUEST_QUEUE_DEPTH);
+    bool Pcm2StringAsync(uint8_t* pcm_buff, uint32_t pcm_lan, String dev_pid, AIRecognizeCallback callback);
+    bool String2PcmAsync(String str, int spd, int pit, int vol, int per, uint8_t* pcm_buff, size_t size, AISpeechCallback callback);
+    size_t pendingRequests();
     //200825
     bool InitI2SSpeakOrMic(int mode);
     String Speech_Recognition(String Language);
@@ -56,8 +56,9 @@ function addGenerator (Blockly) {
         Blockly.Arduino.includes_.ironKit_setBuzzer = '#include <Buzzer.h>\n#include <Sounds.h>';
         Blockly.Arduino.definitions_.ironKit_setBuzzer = 'Sensor *buzzer = mMotorDriver.getSensor(E_SENSOR_MAX);';
         Blockly.Arduino.setups_.md_buzzerinit = 'mMotorDriver.getSensor(E_BUZZER);';
+        Blockly.Arduino.loops_.ironKit_setBuzzer = 'buzzer->SingPoll();';
 
-        return `buzzer->Sing(${sound});\n`;
+        return `while (buzzer->SingPoll()) {}\nbuzzer->SingAsync(${sound});\n`;
     };
 
     Blockly.Arduino.ironKit_ps2ReadData = function () {
@@ -1,9 +1,19 @@
 
 #include "Buzzer.h"
+#include "TimerOne.h"
 #include <avr/wdt.h>
 
 uint8_t buzzer_pin;
 
+static volatile uint8_t *buzzer_out;
+static uint8_t buzzer_mask;
+
+// Timer1 overflow, runs twice per period of the tone
+static void buzzer_toggle(void)
+{
+  *buzzer_out ^= buzzer_mask;
+}
+
 #ifdef ME_PORT_DEFINED
 /**
  * Alternate Constructor which can call your own function to map the Buzzer to arduino port,
@@ -14,6 +24,7 @@ uint8_t buzzer_pin;
 Buzzer::Buzzer()
 {
   buzzer_pin = 9;
+  _song = NULL;
 }
 
 /**
@@ -25,6 +36,7 @@ Buzzer::Buzzer()
 Buzzer::Buzzer(uint8_t port):MePort(port)
 {
   buzzer_pin = port;
+  _song = NULL;
 }
 
 /**
@@ -46,6 +58,7 @@ Buzzer::Buzzer(uint8_t port, uint8_t slot):MePort(port)
   {
     buzzer_pin = s1;
   }
+  _song = NULL;
 }
 #else // ME_PORT_DEFINED
 /**
@@ -56,6 +69,7 @@ Buzzer::Buzzer(uint8_t port, uint8_t slot):MePort(port)
 Buzzer::Buzzer(int pin)
 {
   buzzer_pin = pin;
+  _song = NULL;
 }
 #endif // ME_PORT_DEFINED
 
@@ -220,3 +234,168 @@ void Buzzer::noTone()
   pinMode(buzzer_pin, OUTPUT);
   digitalWrite(buzzer_pin, LOW);
 }
+
+/**
+ * \par Function
+ *    play
+ * \par Description
+ *    Start a sequence of BuzzerSegment from PROGMEM and return at once.
+ * \param[in]
+ *    song - Segments in PROGMEM.
+ * \param[in]
+ *    count - Number of segments.
+ * \param[in]
+ *    done - Called from poll() when the sequence is over, may be NULL.
+ * \par Output
+ *    None
+ * \Return
+ *    None.
+ * \par Others
+ *    None
+ */
+void Buzzer::play(const BuzzerSegment *song, uint8_t count, void (*done)(void))
+{
+  stop();
+  _song = song;
+  _count = count;
+  _index = 0;
+  _started = false;
+  _done = done;
+  if (!advance())
+  {
+    stop();
+    return;
+  }
+  startTone(_frequency);
+  _silent = false;
+  _wait = _segment.duration;
+  _last = millis();
+}
+
+/**
+ * \par Function
+ *    poll
+ * \par Description
+ *    Advance the sequence started by play(), call it from loop().
+ * \par Output
+ *    None
+ * \Return
+ *    true while the sequence is playing.
+ * \par Others
+ *    Deadlines follow each other, a late poll does not stretch the song.
+ */
+bool Buzzer::poll(void)
+{
+  while (_song != NULL && millis() - _last >= _wait)
+  {
+    _last += _wait;
+    if (!_silent)
+    {
+      stopTone();
+      _silent = true;
+      _wait = _segment.silent;
+    }
+    else if (advance())
+    {
+      startTone(_frequency);
+      _silent = false;
+      _wait = _segment.duration;
+    }
+    else
+    {
+      void (*done)(void) = _done;
+      stop();
+      if (done != NULL)
+      {
+        done();
+      }
+    }
+  }
+  return _song != NULL;
+}
+
+bool Buzzer::isPlaying(void)
+{
+  return _song != NULL;
+}
+
+void Buzzer::stop(void)
+{
+  if (_song != NULL)
+  {
+    stopTone();
+  }
+  _song = NULL;
+  _done = NULL;
+}
+
+// load the next tone into _frequency, false at the end of the song
+bool Buzzer::advance(void)
+{
+  if (_started)
+  {
+    if (_segment.from != _segment.to)
+    {
+      uint16_t f;
+      if (_segment.from < _segment.to)
+      {
+        f = (uint32_t)_frequency * (100 + _segment.ratio) / 100;
+        if (f == _frequency)
+          f++;
+        if (f < _segment.to)
+        {
+          _frequency = f;
+          return true;
+        }
+      }
+      else
+      {
+        f = (uint32_t)_frequency * 100 / (100 + _segment.ratio);
+        if (f == _frequency)
+          f--;
+        if (f > _segment.to)
+        {
+          _frequency = f;
+          return true;
+        }
+      }
+    }
+    else if (--_left > 0)
+    {
+      return true;
+    }
+    _index++;
+  }
+  _started = true;
+  for (; _index < _count; _index++)
+  {
+    memcpy_P(&_segment, &_song[_index], sizeof(BuzzerSegment));
+    _frequency = _segment.from;
+    _left = _segment.repeat;
+    if (_segment.from == _segment.to ? _left > 0 : _segment.ratio > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Buzzer::startTone(uint16_t frequency)
+{
+  if (frequency == 0)
+  {
+    return;
+  }
+  pinMode(buzzer_pin, OUTPUT);
+  buzzer_out = portOutputRegister(digitalPinToPort(buzzer_pin));
+  buzzer_mask = digitalPinToBitMask(buzzer_pin);
+  Timer1.initialize(500000L / frequency);
+  Timer1.attachInterrupt(buzzer_toggle);
+}
+
+void Buzzer::stopTone(void)
+{
+  Timer1.detachInterrupt();
+  Timer1.stop();
+  digitalWrite(buzzer_pin, LOW);
+}
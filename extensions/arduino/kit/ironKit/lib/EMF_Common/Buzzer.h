@@ -51,6 +51,26 @@
 #include "MePort.h"
 #endif // ME_PORT_DEFINED
 
+/**
+ * One step of a sequence played by Buzzer::play(), kept in PROGMEM.
+ * A note plays repeat times, a sweep starts at from and steps by
+ * ratio percent per tone until it reaches to. Each tone sounds for
+ * duration ms followed by silent ms, a rest is a note of 0 Hz.
+ */
+typedef struct {
+  uint16_t from;
+  uint16_t to;
+  uint8_t ratio;
+  uint8_t repeat;
+  uint16_t duration;
+  uint16_t silent;
+} BuzzerSegment;
+
+#define BUZZER_NOTE(freq, duration, silent)               {freq, freq, 0, 1, duration, silent}
+#define BUZZER_REPEAT(freq, times, duration, silent)      {freq, freq, 0, times, duration, silent}
+#define BUZZER_SWEEP(from, to, ratio, duration, silent)   {from, to, ratio, 1, duration, silent}
+#define BUZZER_REST(ms)                                   {0, 0, 0, 1, 0, ms}
+
 /**
  * Class: Buzzer
  * \par Description
@@ -188,5 +208,54 @@ public:
  *    None
  */
   void noTone();
+
+/**
+ * \par Function
+ *    play
+ * \par Description
+ *    Start a sequence of BuzzerSegment from PROGMEM and return at once.
+ *    The tone comes from Timer1, poll() moves on to the next tone.
+ * \param[in]
+ *    song - Segments in PROGMEM.
+ * \param[in]
+ *    count - Number of segments.
+ * \param[in]
+ *    done - Called from poll() when the sequence is over, may be NULL.
+ * \par Output
+ *    None
+ * \Return
+ *    None.
+ * \par Others
+ *    A sequence already playing is replaced.
+ */
+  void play(const BuzzerSegment *song, uint8_t count, void (*done)(void) = NULL);
+
+/**
+ * \par Function
+ *    poll
+ * \par Description
+ *    Advance the sequence started by play(), call it from loop().
+ * \par Output
+ *    None
+ * \Return
+ *    true while the sequence is playing.
+ * \par Others
+ *    None
+ */
+  bool poll(void);
+  bool isPlaying(void);
+  void stop(void);
+
+private:
+  bool advance(void);
+  void startTone(uint16_t frequency);
+  void stopTone(void);
+  const BuzzerSegment *_song;
+  BuzzerSegment _segment;
+  uint8_t _count, _index, _left;
+  uint16_t _frequency;
+  bool _started, _silent;
+  unsigned long _last, _wait;
+  void (*_done)(void);
 };
 #endif
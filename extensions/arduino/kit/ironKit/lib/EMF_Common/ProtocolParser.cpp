@@ -18,6 +18,9 @@ ProtocolParser::ProtocolParser(byte startcode , byte endcode )
     m_PackageLength = 0;       // recevie all package length
     m_CheckSum = 0x0000;
     m_RecvDataIndex = 0;
+    m_frameHead = 0;
+    m_frameCount = 0;
+    recv = &m_recv;
     for (int i = 0; i < BUFFER_SIZE; i++) {
         buffer[i] = 0;
     }
@@ -30,143 +33,136 @@ ProtocolParser::~ProtocolParser(void)
 
 bool ProtocolParser::ParserPackage(byte *data = NULL)
 {
-    unsigned int check_sum = 0;
-    if (m_recv_flag) {
-        m_recv_flag = false;
-        if( data != NULL) {
-            m_pHeader = data;
-        } else {
-            m_pHeader = buffer;
+    if (m_frameCount == 0) {
+        return false;
+    }
+    // take the oldest complete frame, its check sum was verified on receive
+    m_PackageLength = m_frameLen[m_frameHead];
+    memcpy(buffer, m_frames[m_frameHead], m_PackageLength);
+    m_frameHead = (m_frameHead + 1) % PROTOCOL_FRAME_COUNT;
+    m_frameCount--;
+    if( data != NULL) {
+        m_pHeader = data;
+    } else {
+        m_pHeader = buffer;
+    }
+    recv->start_code = buffer[0];
+    recv->len = buffer[1];
+    recv->type = (E_TYPE)buffer[2];
+    recv->addr = buffer[3];
+    recv->function = buffer[4];
+    recv->data = &buffer[5];
+    recv->sum = GetCheckSum();
+    protocol_data_len = m_PackageLength - 8;
+    recv->end_code = buffer[m_PackageLength-1];
+    DEBUG_LOG(DEBUG_LEVEL_INFO, "\nRecevPackage end \n");
+    return true;
+}
+
+// returns false when the frame in m_rx is rejected, m_rx then holds its bytes
+bool ProtocolParser::FeedByte(byte dat)
+{
+    if (m_RecvDataIndex == 0) {
+        if (dat == m_StartCode) {
+            m_rx[m_RecvDataIndex++] = dat;
         }
-        recv->start_code = buffer[0];
-        recv->len = buffer[1];
-        for (byte i = 1; i < m_PackageLength - 3; i++) {
-            check_sum += buffer[i];
+        return true;
+    }
+    m_rx[m_RecvDataIndex++] = dat;
+    if (m_RecvDataIndex == 2) {
+        // len counts the bytes after the start code up to the check sum
+        // len, type, addr, function and 2 check sum bytes at least
+        if (dat < 6 || dat > BUFFER_SIZE - 2) {
+            DEBUG_ERR("preRecvLen \r\n");
+            return false;
         }
-        if ((check_sum & 0xFFFF) != GetCheckSum()) {
-            DEBUG_ERR("check sum error \n");
-            for (int i = 0; i < m_PackageLength; i++) {
-                DEBUG_LOG(DEBUG_LEVEL_ERR, "0x%x ", buffer[i]);
-            }
-        return false ;
-	    }
-        recv->function = buffer[4];
-        recv->data = &buffer[5];
-        protocol_data_len = m_PackageLength - 8;
-        recv->end_code = buffer[m_PackageLength-1];
-        DEBUG_LOG(DEBUG_LEVEL_INFO, "\nRecevPackage end \n");
         return true;
-	}
-    return false;
+    }
+    if (m_RecvDataIndex < m_rx[1] + 2) {
+        return true;
+    }
+    if (dat != m_EndCode) {
+        return false;
+    }
+    uint16_t check_sum = 0;
+    for (byte i = 1; i < m_RecvDataIndex - 3; i++) {
+        check_sum += m_rx[i];
+    }
+    if (check_sum != ((m_rx[m_RecvDataIndex - 3] << 8) | m_rx[m_RecvDataIndex - 2])) {
+        DEBUG_ERR("check sum error \n");
+        return false;
+    }
+    // keep the newest frames when the application falls behind
+    if (m_frameCount == PROTOCOL_FRAME_COUNT) {
+        m_frameHead = (m_frameHead + 1) % PROTOCOL_FRAME_COUNT;
+        m_frameCount--;
+    }
+    byte tail = (m_frameHead + m_frameCount) % PROTOCOL_FRAME_COUNT;
+    memcpy(m_frames[tail], m_rx, m_RecvDataIndex);
+    m_frameLen[tail] = m_RecvDataIndex;
+    m_frameCount++;
+    m_RecvDataIndex = 0;
+    DEBUG_LOG(DEBUG_LEVEL_INFO, "RecevData end \n");
+    return true;
 }
 
-bool ProtocolParser::RecevData(void)
+void ProtocolParser::PushByte(byte dat)
 {
-   // DEBUG_LOG(DEBUG_LEVEL_INFO, "RecevData start \n");
-    static bool avilable = false;
-    static byte preRecvLen = 0;
-    byte dat;
-    while (Serial.available() > 0) {
-        dat = Serial.read();
-        // DEBUG_LOG(DEBUG_LEVEL_INFO, "\n");
-        // Serial.println(dat, HEX);
-        delay(2);
-        if (avilable == false && dat == m_StartCode) {
-            memset(buffer, 0, BUFFER_SIZE);
-            preRecvLen = 0;
-            m_pHeader = buffer;
-            *m_pHeader++ = dat;
-            m_RecvDataIndex = 0;
-            avilable = true;
-            // Serial.println(dat, HEX);
-            DEBUG_LOG(DEBUG_LEVEL_INFO, "aviable\n");
-            // arduino_printf("aviable \n");
-            continue;
+    if (FeedByte(dat)) {
+        return;
+    }
+    // A rejected frame may hide the start of the next one, replay
+    // its bytes from the following start code. Bytes are only ever
+    // written at or below the position they are read from.
+    byte n = m_RecvDataIndex;
+    while (true) {
+        byte i = 1;
+        while (i < n && m_rx[i] != m_StartCode) {
+            i++;
+        }
+        m_RecvDataIndex = 0;
+        if (i >= n) {
+            return;
+        }
+        n -= i;
+        memmove(m_rx, &m_rx[i], n);
+        byte j = 0;
+        while (j < n && FeedByte(m_rx[j])) {
+            j++;
         }
-        if (avilable) {
-            if (dat == m_EndCode && preRecvLen == m_RecvDataIndex) {
-                avilable = false;
-                *m_pHeader = dat;
-                // m_RecvDataIndex++;
-                m_PackageLength = preRecvLen + 2;
-                m_recv_flag = true;
-                DEBUG_LOG(DEBUG_LEVEL_INFO, "RecevData end \n");
-                return true;
-           } else {
-                //Serial.println(dat, HEX);
-                *m_pHeader++ = dat;
-                m_RecvDataIndex++;
-                if (m_RecvDataIndex == 1) {
-                   preRecvLen = dat;
-                   if (preRecvLen > BUFFER_SIZE-2) goto error;
-                   DEBUG_LOG(DEBUG_LEVEL_INFO, "preRecvLen = %d\n", preRecvLen);
-                }
-                // arduino_printf("prelen= %d Index =%d \n",preRecvLen, m_RecvDataIndex);
-                if ((m_RecvDataIndex > preRecvLen) && (preRecvLen != 0)) {
-                    for (int i = m_RecvDataIndex; i > 0; i--) {
-                        //DEBUG_LOG(DEBUG_LEVEL_ERR, "%x ", buffer[i]);
-                        if (buffer[i] == m_StartCode) {
-                            m_pHeader = &buffer[i];
-                            preRecvLen = buffer[i+1];
-                            m_RecvDataIndex -= i;
-                            continue;
-                        }
-                    }
-                    DEBUG_LOG(DEBUG_LEVEL_ERR, "preRecvLen \r\n");
-                    goto error;
-                }
-
-                if (m_RecvDataIndex >= BUFFER_SIZE - 1) {
-                    for (int i = 0; i < BUFFER_SIZE; i++) {
-                        DEBUG_LOG(DEBUG_LEVEL_ERR, "%x ", buffer[i]);
-                    }
-                    DEBUG_LOG(DEBUG_LEVEL_ERR, "buffer is over\r\n");
-                    goto error;
-                 }
-            }
+        if (j == n) {
+            return;
         }
+        // rejected again, the frame is at the start of m_rx, append the unread bytes
+        memmove(&m_rx[m_RecvDataIndex], &m_rx[j + 1], n - j - 1);
+        n = m_RecvDataIndex + n - j - 1;
     }
-    return avilable;
-error :
-    preRecvLen = 0;
-    m_pHeader = buffer;
-    avilable = false;
-    m_recv_flag = false;
-    return false;
+}
+
+uint8_t ProtocolParser::AvailableFrames(void)
+{
+    return m_frameCount;
+}
+
+bool ProtocolParser::RecevData(void)
+{
+    // consume what has arrived, frames complete over several calls
+    while (Serial.available() > 0) {
+        PushByte(Serial.read());
+    }
+    return m_frameCount > 0;
 }
 
 bool ProtocolParser::RecevData(byte *data, size_t len)
 {
     DEBUG_LOG(DEBUG_LEVEL_INFO, "RecevData start \n");
-    bool avilable = false;
     if (data == NULL || len > BUFFER_SIZE)
     {
         DEBUG_ERR("len > BUFFER_SIZE \n");
         return false;
     }
-    m_PackageLength = 0;
-    memset(buffer, 0, BUFFER_SIZE);
-    m_pHeader = buffer;
-
     while (len--) {
-        if(!avilable && *data == m_StartCode)  {
-            avilable = true;
-        }
-
-        if (avilable) {
-            if ((*m_pHeader = *data) == m_EndCode) {
-                m_recv_flag = true;
-                m_PackageLength++;
-                DEBUG_LOG(DEBUG_LEVEL_INFO, "%x ", *m_pHeader);
-                //Serial.println("m_PackageLength ");
-                //Serial.print(m_PackageLength);
-                break;
-            }
-            DEBUG_LOG(DEBUG_LEVEL_INFO, "%x ", *m_pHeader);
-            m_pHeader++;
-            m_PackageLength++;
-        }
-        data++;
+        PushByte(*data++);
     }
     DEBUG_LOG(DEBUG_LEVEL_INFO, "\nRecevPackage done\n");
     return true;
@@ -8,6 +8,10 @@
 #include<stdint.h>
 
 #define BUFFER_SIZE 32
+// complete frames buffered until ParserPackage() takes them
+#ifndef PROTOCOL_FRAME_COUNT
+#define PROTOCOL_FRAME_COUNT 4
+#endif
 
 class ProtocolParser
 {
@@ -16,6 +20,8 @@ class ProtocolParser
     ~ProtocolParser();
     bool RecevData(byte *data, size_t len);
     bool RecevData(void);
+    void PushByte(byte dat);
+    uint8_t AvailableFrames(void);
     bool ParserPackage(byte *data = NULL);
     E_TYPE GetRobotType(void);
     uint8_t GetRobotAddr(void);
@@ -41,7 +47,12 @@ class ProtocolParser
   private:
     byte buffer[BUFFER_SIZE];
     byte m_StartCode, m_EndCode;
+    ST_PROTOCOL m_recv;
     ST_PROTOCOL *recv;
+    byte m_rx[BUFFER_SIZE];             // frame being received
+    byte m_frames[PROTOCOL_FRAME_COUNT][BUFFER_SIZE];
+    uint8_t m_frameLen[PROTOCOL_FRAME_COUNT];
+    uint8_t m_frameHead, m_frameCount;
     uint8_t protocol_data_len;
     bool m_recv_flag, m_send_success;   // recevive flag
     byte *m_pHeader;                    // protocol header
@@ -51,6 +62,7 @@ class ProtocolParser
     char GetHeader(size_t index);
     uint8_t GetPackageLength(void);
     uint16_t GetCheckSum(void);             // get package check sum
+    bool FeedByte(byte dat);
 };
 
 #endif // _PROTOCOLPARSER_H_
@@ -111,6 +111,9 @@ TM1637::TM1637(uint8_t pinClk, uint8_t pinDIO) :
   digitalHigh(_pinClk);
   digitalHigh(_pinDIO);
 
+  _shownMask = 0;
+  _scrolling = false;
+
   // setup defaults
   setCursor(0, TM1637_DEFAULT_CURSOR_POS);
   setPrintDelay(TM1637_DEFAULT_PRINT_DELAY);
@@ -145,38 +148,36 @@ size_t  TM1637::write(uint8_t byte) {
     printRaw( _rawBuffer, _cursorPos + 1, 0);
     setCursor(1, _cursorPos + 1);
   };
-
+  return 1;
 }
 
 // null terminated char array
 size_t  TM1637::write(const char* str) {
   TM1637_DEBUG_PRINT(F("write char*:\t")); TM1637_DEBUG_PRINTLN(str);
-  uint8_t encodedBytes[4];
-
-  encode(encodedBytes, str, 4);
-  uint8_t i = 4;
-  while ( str[i] != '\0' ) {
-    printRaw(encodedBytes);
-    shiftLeft(encodedBytes, 4);
-    encodedBytes[3] = encode( str[i] );
-    i++;
-    if ( i == TM1637_MAX_CHARS) {
-      break;
-    }
+  size_t length = strlen(str);
+
+  if ( length > TM1637_PRINT_BUFFER_SIZE ) {
+    _scrolling = false;
+    scrollNow((const uint8_t*)str, length, 0, true);
+    return length;
   }
+  encode(_scrollBuffer, str, length);   // encoded in place, kept for poll()
+  printRaw(_scrollBuffer, length, 0);
+  return length;
 };
 
 // byte array with length
 size_t  TM1637::write(const uint8_t* buffer, size_t size) {
-  TM1637_DEBUG_PRINT(F("write uint8_t*:\t")); TM1637_DEBUG_PRINT(buffer[0]);
-  uint8_t encodedBytes[TM1637_MAX_CHARS];
+  TM1637_DEBUG_PRINT(F("write uint8_t*:\t")); TM1637_DEBUG_PRINTLN(buffer[0]);
 
-  if ( size > TM1637_MAX_CHARS) {
-    size = TM1637_MAX_CHARS;
+  if ( size > TM1637_PRINT_BUFFER_SIZE ) {
+    _scrolling = false;
+    scrollNow(buffer, size, _cursorPos, true);
+    return size;
   }
-  size_t length = encode(encodedBytes, buffer, size);
-  TM1637_DEBUG_PRINT(F(" ")); TM1637_DEBUG_PRINTLN(encodedBytes[0], BIN);
-  printRaw(encodedBytes, length, _cursorPos);
+  size_t length = encode(_scrollBuffer, buffer, size);
+  printRaw(_scrollBuffer, length, _cursorPos);
+  return length;
 };
 
 // Liquid cristal API
@@ -286,56 +287,108 @@ bool  TM1637::getColonOn(void) {
 void  TM1637::setColonOn(bool setToOn) {
   _colonOn = setToOn;
 }
+bool  TM1637::poll(void) {
+  if ( !_scrolling ) {
+    return false;
+  }
+  if ( millis() - _scrollTime < _printDelay ) {
+    return true;
+  }
+  // the last step is shown for one print delay too
+  if ( _scrollPos + _numCols >= _scrollLength ) {
+    _scrolling = false;
+    return false;
+  }
+  _scrollPos++;
+  sendRaw(&_scrollBuffer[_scrollPos], _numCols, 0);
+  _scrollTime = millis();
+  return true;
+};
+
 void  TM1637::printRaw(uint8_t rawByte, uint8_t position) {
-  uint8_t cmd[2];
-  cmd[0] = TM1637_COM_SET_ADR | position;
-  cmd[1] = rawByte;
-  if (position == 1) {
-    cmd[1] |= (_colonOn) ? TM1637_COLON_BIT : 0;
-  };
-  command(cmd, 2);
+  _scrolling = false;
+  sendRaw(&rawByte, 1, position);
 };
 
 void  TM1637::printRaw(const uint8_t* rawBytes, size_t length, uint8_t position) {
+  _scrolling = false;
 
   // if fits on display
   if ( (length + position) <= _numCols) {
-    uint8_t cmd[5] = {0, };
-    cmd[0] = TM1637_COM_SET_ADR | (position & B111);  // sets address
-    memcpy(&cmd[1], rawBytes, length);       // copy bytes
-
-    // do we have to print a colon?
-    if ( position < 2 ) { // printing after position 2 has never a colon
-      if ( position == 0 && length >= 2) {
-        // second index is the colon
-        cmd[2] |= (_colonOn) ? TM1637_COLON_BIT : 0;
-      } else {
-        // first index is the colon
-        cmd[1] |= (_colonOn) ? TM1637_COLON_BIT : 0;
-      }
+    sendRaw(rawBytes, length, position);
+  }
+  // does not fit on display, print the first 1-4 characters and scroll from poll()
+  else if ( position < _numCols ) {
+    if ( length > TM1637_PRINT_BUFFER_SIZE ) {
+      scrollNow(rawBytes, length, position, false);
+      return;
     }
-    TM1637_DEBUG_PRINT(F("ADDR :\t")); TM1637_DEBUG_PRINTLN(cmd[0], BIN);
-    TM1637_DEBUG_PRINT(F("DATA0:\t")); TM1637_DEBUG_PRINTLN(cmd[1], BIN);
-    command(cmd, length + 1);                         // send to display
+    if ( rawBytes != _scrollBuffer ) { // write() encodes into the buffer
+      memcpy(_scrollBuffer, rawBytes, length);
+    }
+    _scrollLength = length;
+    _scrollPos = 0;
+    sendRaw(_scrollBuffer, _numCols - position, position);
+    _scrollTime = millis();
+    _scrolling = true;
   }
-  // does not fit on display, need to print with delay
-  else {
-    // First print 1-4 characters
-    uint8_t numtoPrint = _numCols - position;
-    printRaw(rawBytes, numtoPrint, position);
-    delay(_printDelay);
 
-    // keep printing 4 characters till done
-    uint8_t remaining = length - numtoPrint + 3;
-    uint8_t i         = 1;
-    while ( remaining >= _numCols) {
-      printRaw(&rawBytes[i], _numCols, 0);
-      delay(_printDelay);
-      remaining--;
-      i++;
-    };
+};
+
+void  TM1637::sendRaw(const uint8_t* rawBytes, size_t length, uint8_t position) {
+  uint8_t first = TM1637_MAX_COLOM;
+  uint8_t last = 0;
+
+  for (uint8_t i = 0; i < length && position + i < TM1637_MAX_COLOM; i++) {
+    uint8_t pos = position + i;
+    uint8_t data = rawBytes[i];
+    if ( pos == 1 ) { // second digit holds the colon
+      data |= (_colonOn) ? TM1637_COLON_BIT : 0;
+    }
+    if ( (_shownMask & (1 << pos)) && _shownBytes[pos] == data ) {
+      continue;
+    }
+    _shownBytes[pos] = data;
+    _shownMask |= 1 << pos;
+    if ( pos < first ) {
+      first = pos;
+    }
+    last = pos;
+  }
+  if ( first > last ) { // nothing changed
+    return;
   }
 
+  // unchanged digits between the changes are sent again, a new address costs more
+  uint8_t cmd[TM1637_MAX_COLOM + 1];
+  uint8_t count = last - first + 1;
+  cmd[0] = TM1637_COM_SET_ADR | first;  // sets address
+  memcpy(&cmd[1], &_shownBytes[first], count);
+  TM1637_DEBUG_PRINT(F("ADDR :\t")); TM1637_DEBUG_PRINTLN(cmd[0], BIN);
+  TM1637_DEBUG_PRINT(F("DATA0:\t")); TM1637_DEBUG_PRINTLN(cmd[1], BIN);
+  if ( !command(cmd, count + 1) ) {     // send to display
+    _shownMask = 0;                     // not acknowledged, resend everything next time
+  }
+};
+
+void  TM1637::scrollNow(const uint8_t* bytes, size_t length, uint8_t position, bool ascii) {
+  uint8_t frame[TM1637_MAX_COLOM];
+  uint8_t count = _numCols - position;
+  size_t pos = 0;
+
+  for (;;) {
+    for (uint8_t i = 0; i < count; i++) {
+      frame[i] = ascii ? encode( (char)bytes[pos + i] ) : bytes[pos + i];
+    }
+    sendRaw(frame, count, position);
+    delay(_printDelay);
+    if ( pos + _numCols >= length ) {
+      return;
+    }
+    pos++;
+    position = 0;
+    count = _numCols;
+  }
 };
 
 // Helpers
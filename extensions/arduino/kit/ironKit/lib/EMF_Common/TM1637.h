@@ -31,7 +31,9 @@
 // COMPILE TIME USER CONFIG ////////////////////////////////////////////////////
 #define TM1637_DEBUG                  false   // true for serial debugging
 #define TM1637_BEGIN_DELAY            500     // ms
-#define TM1637_PRINT_BUFFER_SIZE      128     // lower if you don't need it
+#ifndef TM1637_PRINT_BUFFER_SIZE
+#define TM1637_PRINT_BUFFER_SIZE      32      // longest text that scrolls from poll(), up to 255, longer text scrolls before print returns
+#endif
 
 // Default values //////////////////////////////////////////////////////////////
 #define TM1637_DEFAULT_PRINT_DELAY    300 // 300 ms delay between characters
@@ -194,6 +196,12 @@ class TM1637 : public Print {
       @param [in] printDelay    the print delay in ms
     */
     void    setPrintDelay(uint16_t printDelay);
+    /* Scrolls text that does not fit on the display
+      Printing more characters than the display has starts scrolling, call this from loop() to move it on every print delay
+      Text longer than TM1637_PRINT_BUFFER_SIZE is not kept, it scrolls before print returns
+      @return scrolling         true while text is scrolling
+    */
+    bool    poll(void);
 
     // helpers //////////////////////////////////////////////////////////////////
     /* Encodes a character to sevensegment binairy
@@ -299,7 +307,22 @@ class TM1637 : public Print {
     uint16_t  _printDelay;              // print delay in ms (multiple chars)
     uint8_t   _colonOn;                 // colon bit if set
     uint8_t   _rawBuffer[TM1637_MAX_COLOM];// hold the last chars printed to display
+    uint8_t   _shownBytes[TM1637_MAX_COLOM];// bytes the IC holds, colon included
+    uint8_t   _shownMask;               // bit per digit, set when _shownBytes is known
+
+    uint8_t   _scrollBuffer[TM1637_PRINT_BUFFER_SIZE];// raw bytes of scrolling text
+    uint8_t   _scrollLength;
+    uint8_t   _scrollPos;               // index shown on the first digit
+    unsigned long _scrollTime;          // millis() when the current step was shown
+    bool      _scrolling;
 
+    /* Sends the raw bytes that differ from what the IC holds, in one auto increment transfer
+    */
+    void    sendRaw(const uint8_t* rawBytes, size_t length, uint8_t position);
+    /* Scrolls text too long for the scroll buffer with delay(), in the steps poll() takes
+      @param [in] ascii         the bytes are characters to encode, else raw bytes
+    */
+    void    scrollNow(const uint8_t* bytes, size_t length, uint8_t position, bool ascii);
 };
 
 
@@ -66,6 +66,34 @@ void MS_PWMServoDriver::setPWM(uint8_t num, uint16_t on, uint16_t off) {
   WIRE.endTransmission();
 }
 
+// write count consecutive channels in one transaction,
+// values are 0..4095 duty or 4096 for fully on
+void MS_PWMServoDriver::setPWMRun(uint8_t num, uint8_t count, const uint16_t *values) {
+  WIRE.beginTransmission(_i2caddr);
+#if ARDUINO >= 100
+  WIRE.write(LED0_ON_L+4*num);
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t on = values[i] >= 4096 ? 4096 : 0;
+    uint16_t off = values[i] >= 4096 ? 0 : values[i];
+    WIRE.write(on);
+    WIRE.write(on>>8);
+    WIRE.write(off);
+    WIRE.write(off>>8);
+  }
+#else
+  WIRE.send(LED0_ON_L+4*num);
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t on = values[i] >= 4096 ? 4096 : 0;
+    uint16_t off = values[i] >= 4096 ? 0 : values[i];
+    WIRE.send((uint8_t)on);
+    WIRE.send((uint8_t)(on>>8));
+    WIRE.send((uint8_t)off);
+    WIRE.send((uint8_t)(off>>8));
+  }
+#endif
+  WIRE.endTransmission();
+}
+
 uint8_t MS_PWMServoDriver::read8(uint8_t addr) {
   WIRE.beginTransmission(_i2caddr);
 #if ARDUINO >= 100
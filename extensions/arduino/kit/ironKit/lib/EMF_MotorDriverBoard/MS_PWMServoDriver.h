@@ -24,6 +24,9 @@
 #define ALLLED_OFF_L 0xFC
 #define ALLLED_OFF_H 0xFD
 
+// channels per auto-increment write, 1 + 4 * 7 bytes fit the 32 byte Wire buffer
+#define PCA9685_BATCH_MAX 7
+
 
 class MS_PWMServoDriver {
  public:
@@ -32,6 +35,7 @@ class MS_PWMServoDriver {
   void reset(void);
   void setPWMFreq(float freq);
   void setPWM(uint8_t num, uint16_t on, uint16_t off);
+  void setPWMRun(uint8_t num, uint8_t count, const uint16_t *values);
 
  private:
   uint8_t _i2caddr;
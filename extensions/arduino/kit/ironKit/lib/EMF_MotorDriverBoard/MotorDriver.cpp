@@ -24,6 +24,10 @@ MotorDriver::MotorDriver(uint8_t addr, uint8_t version)
     _version = version;
     _addr = addr;
     _pwm = MS_PWMServoDriver(_addr);
+    _valid = _dirty = 0;
+    _batching = false;
+    _encoderSync = false;
+    _syncGain = 0;
 }
 
 void MotorDriver::begin(uint16_t freq)
@@ -34,24 +38,124 @@ void MotorDriver::begin(uint16_t freq)
     _freq = freq;
     _pwm.setPWMFreq(_freq); // This is the maximum PWM frequency
     for (uint8_t i = 0; i < 16; i++)
+    {
         _pwm.setPWM(i, 0, 0);
+        _chan[i] = 0;
+    }
+    _valid = 0xFFFF;
+    _dirty = 0;
 }
 
 void MotorDriver::setPWM(uint8_t pin, uint16_t value)
 {
+    uint16_t mask = 1U << pin;
     if (value > 4095)
+        value = 4096;
+    if (_batching)
+    {
+        // only channels that really change go out in endBatch()
+        if ((_valid & mask) && _chan[pin] == value && !(_dirty & mask))
+            return;
+        _chan[pin] = value;
+        _dirty |= mask;
+        return;
+    }
+    if (value == 4096)
     {
         _pwm.setPWM(pin, 4096, 0);
     }
     else
         _pwm.setPWM(pin, 0, value);
+    _chan[pin] = value;
+    _valid |= mask;
 }
 void MotorDriver::setPin(uint8_t pin, boolean value)
 {
-    if (value == LOW)
-        _pwm.setPWM(pin, 0, 0);
-    else
-        _pwm.setPWM(pin, 4096, 0);
+    setPWM(pin, value == LOW ? 0 : 4096);
+}
+
+// collect setPWM()/setPin() calls until endBatch()
+void MotorDriver::beginBatch(void)
+{
+    _batching = true;
+}
+
+// Write the collected channels with as few transactions as possible.
+// A run may span channels that did not change as long as their value
+// is known, so the coils of one stepper usually go out in one write.
+void MotorDriver::endBatch(void)
+{
+    uint8_t ch = 0;
+    _batching = false;
+    while (_dirty)
+    {
+        while (!(_dirty & (1U << ch)))
+            ch++;
+        uint8_t first = ch, last = ch;
+        for (uint8_t c = ch + 1; c < 16 && c - first < PCA9685_BATCH_MAX; c++)
+        {
+            if (_dirty & (1U << c))
+                last = c;
+            else if (!(_valid & (1U << c)))
+                break;
+        }
+        _pwm.setPWMRun(first, last - first + 1, &_chan[first]);
+        for (uint8_t c = first; c <= last; c++)
+        {
+            _dirty &= ~(1U << c);
+            _valid |= 1U << c;
+        }
+        ch = last + 1;
+    }
+}
+
+// advance every stepper in use, returns true while any of them moves
+bool MotorDriver::runSteppers(void)
+{
+    bool running = false;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (steppers[i].MC != NULL && steppers[i].run())
+            running = true;
+    }
+    return running;
+}
+
+// Start both steppers towards their targets so that they arrive about together.
+// Each profile is slowed down to the duration of the longest move, both
+// steppers should be at rest when this is called.
+void MotorDriver::moveSteppersTo(long pos1, long pos2)
+{
+    long target[2] = {pos1, pos2};
+    float duration[2] = {0, 0}, longest = 0;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        StepperMotor *s = &steppers[i];
+        if (s->MC == NULL || s->_maxSpeed <= 0)
+            continue;
+        // trapezoid duration: cruise time plus one ramp time
+        duration[i] = abs(target[i] - s->_currentPos) / s->_maxSpeed;
+        if (s->_acceleration > 0)
+            duration[i] += s->_maxSpeed / s->_acceleration;
+        if (duration[i] > longest)
+            longest = duration[i];
+    }
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        StepperMotor *s = &steppers[i];
+        if (s->MC == NULL || s->_maxSpeed <= 0)
+            continue;
+        float ramp = s->_acceleration > 0 ? s->_maxSpeed / s->_acceleration : 0;
+        float scale = 1.0;
+        if (duration[i] < longest && longest > ramp)
+            scale = (abs(target[i] - s->_currentPos) / s->_maxSpeed) / (longest - ramp);
+        if (scale <= 0 || scale > 1.0)
+            scale = 1.0;
+        s->_scale = scale;
+        s->updateProfile();
+        s->_targetPos = target[i];
+        s->computeNewSpeed();
+    }
 }
 
 DCMotor *MotorDriver::getMotor(uint8_t num)
@@ -151,14 +255,46 @@ DCMotor *MotorDriver::getMotor(uint8_t num)
     return &dcmotors[num];
 }
 
+FuncPtr EncoderMotor::CallBack[2] = {NULL, NULL};
+EncoderMotor *EncoderMotor::Instance[2] = {NULL, NULL};
+
 void EncoderMotor::EncoderCallback1(void)
 {
-    (CallBack[0])();
+    if (CallBack[0] != NULL)
+        (CallBack[0])();
 }
 
 void EncoderMotor::EncoderCallback2(void)
 {
-    (CallBack[1])();
+    if (CallBack[1] != NULL)
+        (CallBack[1])();
+}
+
+// pin change interrupts, count the edge then run the user callback
+void EncoderMotor::EncoderIsr1(void)
+{
+    Instance[0]->countEdge();
+    if (CallBack[0] != NULL)
+        (CallBack[0])();
+}
+
+void EncoderMotor::EncoderIsr2(void)
+{
+    Instance[1]->countEdge();
+    if (CallBack[1] != NULL)
+        (CallBack[1])();
+}
+
+void EncoderMotor::countEdge(void)
+{
+    unsigned long now = micros();
+    // phase B tells the direction, A and B are equal on one edge of A
+    // when turning forward and differ when turning backward
+    int8_t dir = digitalRead(ENCODER1pin) == digitalRead(ENCODER2pin) ? _sign : -_sign;
+    _count += dir;
+    _edgeDir = dir;
+    _edgePeriod = now - _lastEdge;
+    _lastEdge = now;
 }
 
 EncoderMotor::EncoderMotor(void)
@@ -167,27 +303,233 @@ EncoderMotor::EncoderMotor(void)
     encodernum = 0;
     ENCODER1pin = ENCODER2pin = 0;
     PWMpin = IN1pin = IN2pin = 0;
+    _count = _windowCount = 0;
+    _lastEdge = _edgePeriod = _lastUpdate = 0;
+    _edgeDir = 1;
+    _resolution = ENCODER_DEFAULT_RESOLUTION;
+    _kp = 2048;
+    _ki = 512;
+    _kd = 0;
+    _kff = 4096;
+    _targetRpm = _trim = _rpm = _lastError = _tripError = 0;
+    _integral = 0;
+    _saturatedPeriods = 0;
+    _sign = 1;
+    _closedLoop = _tripped = false;
 }
 
 void EncoderMotor::init(FuncPtr encoder_fun)
 {
     pinMode(ENCODER1pin, INPUT);
+    pinMode(ENCODER2pin, INPUT);
     CallBack[encodernum] = encoder_fun;
+    Instance[encodernum] = this;
+    _lastUpdate = millis();
     if (encodernum == 0)
     {
-#if ARDUINO > 10609
-        attachPinChangeInterrupt(ENCODER1pin, *(FuncPtr)(&EncoderCallback1), CHANGE);
-#else
-        attachPinChangeInterrupt(ENCODER1pin, *(FuncPtr)(&EncoderMotor::EncoderCallback1), CHANGE);
-#endif
+        attachPinChangeInterrupt(ENCODER1pin, EncoderIsr1, CHANGE);
     }
     else if (encodernum == 1)
     {
-#if ARDUINO > 10609
-        attachPinChangeInterrupt(ENCODER1pin, *(FuncPtr)(&EncoderCallback2), CHANGE);
-#else
-        attachPinChangeInterrupt(ENCODER1pin, *(FuncPtr)(&EncoderMotor::EncoderCallback2), CHANGE);
-#endif
+        attachPinChangeInterrupt(ENCODER1pin, EncoderIsr2, CHANGE);
+    }
+}
+
+void EncoderMotor::setEncoderResolution(uint16_t counts)
+{
+    if (counts > 0)
+        _resolution = counts;
+}
+
+void EncoderMotor::setPid(int16_t kp, int16_t ki, int16_t kd)
+{
+    _kp = kp;
+    _ki = ki;
+    _kd = kd;
+    _integral = 0;
+}
+
+void EncoderMotor::setFeedForward(int16_t kff)
+{
+    _kff = kff;
+}
+
+// for motors wired so that phase B leads on forward turns
+void EncoderMotor::setEncoderReversed(bool reversed)
+{
+    noInterrupts();
+    _sign = reversed ? -1 : 1;
+    interrupts();
+}
+
+// negative rpm turns backward, 0 releases the motor
+void EncoderMotor::setTargetRpm(int16_t rpm)
+{
+    if (!_closedLoop || (rpm ^ _targetRpm) < 0)
+    {
+        _integral = 0;
+        _lastError = 0;
+    }
+    _targetRpm = rpm;
+    _closedLoop = true;
+    _tripped = false;
+    _saturatedPeriods = 0;
+}
+
+bool EncoderMotor::tripped(void)
+{
+    return _tripped;
+}
+
+int16_t EncoderMotor::getRpm(void)
+{
+    return _rpm;
+}
+
+long EncoderMotor::getCount(void)
+{
+    long count;
+    noInterrupts();
+    count = _count;
+    interrupts();
+    return count;
+}
+
+// Measure the speed and, under closed loop control, correct the drive.
+// Runs once every ENCODER_PID_PERIOD ms, returns true when it did.
+bool EncoderMotor::update(void)
+{
+    unsigned long now = millis();
+    unsigned long dt = now - _lastUpdate;
+    if (dt < ENCODER_PID_PERIOD)
+        return false;
+    _lastUpdate = now;
+
+    long count;
+    unsigned long lastEdge, period;
+    int8_t dir;
+    noInterrupts();
+    count = _count;
+    lastEdge = _lastEdge;
+    period = _edgePeriod;
+    dir = _edgeDir;
+    interrupts();
+
+    // count the window at speed, time single edges when slow
+    long delta = count - _windowCount;
+    _windowCount = count;
+    if (labs(delta) >= ENCODER_MIN_COUNTS)
+        _rpm = delta * 60000L / ((long)_resolution * (long)dt);
+    else if (period == 0 || micros() - lastEdge > ENCODER_STALL_TIME)
+        _rpm = 0;
+    else
+        _rpm = dir * (long)(60000000UL / (period * _resolution));
+
+    if (!_closedLoop || _tripped)
+        return true;
+    if (_targetRpm == 0)
+    {
+        _integral = 0;
+        _lastError = 0;
+        drive(0);
+        return true;
+    }
+
+    int16_t target = _targetRpm + (_targetRpm > 0 ? _trim : -_trim);
+    int16_t error = target - _rpm;
+    long out = (long)_kff * target + (long)_kp * error + _integral + (long)_kd * (error - _lastError);
+    out /= 256;
+    _lastError = error;
+    // anti-windup: stop integrating while saturated in the direction of the error
+    bool saturated = false;
+    if (out > ENCODER_PWM_MAX)
+    {
+        out = ENCODER_PWM_MAX;
+        saturated = error > 0;
+    }
+    else if (out < -ENCODER_PWM_MAX)
+    {
+        out = -ENCODER_PWM_MAX;
+        saturated = error < 0;
+    }
+    if (!saturated)
+    {
+        _integral += (long)_ki * error;
+        _integral = constrain(_integral, -(long)ENCODER_PWM_MAX * 256, (long)ENCODER_PWM_MAX * 256);
+        _saturatedPeriods = 0;
+    }
+    else if (_saturatedPeriods == 0)
+    {
+        _tripError = error;
+        _saturatedPeriods = 1;
+    }
+    else if (_saturatedPeriods < ENCODER_TRIP_PERIODS)
+    {
+        _saturatedPeriods++;
+    }
+    else if (abs(error) > abs(_tripError) + abs(target) / 2)
+    {
+        // full drive for a while and the wheel moves further away from the
+        // target: a reversed encoder or a broken feedback, stop instead of
+        // running away. A wheel that is only too slow or stalled keeps
+        // its error and is left alone.
+        _tripped = true;
+        _integral = 0;
+        drive(0);
+        return true;
+    }
+    // never reverse the motor to slow down, just let it coast
+    if ((out ^ target) < 0)
+        out = 0;
+    drive(out);
+    return true;
+}
+
+void EncoderMotor::drive(int16_t pwm)
+{
+    uint16_t speed = pwm < 0 ? -pwm : pwm;
+    MC->beginBatch();
+    if (MC->_version == 5)
+        DcSpeed = speed;
+    else
+        MC->setPWM(PWMpin, speed);
+    if (speed == 0)
+        run(RELEASE);
+    else
+        run(pwm < 0 ? BACKWARD : FORWARD);
+    MC->endBatch();
+}
+
+// Update both encoder motors. With synchronisation on, the wheel that
+// has travelled further is slowed and the other sped up until they match.
+bool MotorDriver::updateEncoderMotors(void)
+{
+    bool updated = false;
+    if (_encoderSync && encoder[0].MC != NULL && encoder[1].MC != NULL)
+    {
+        long drift = labs(encoder[0].getCount() - _syncBase[0]) - labs(encoder[1].getCount() - _syncBase[1]);
+        long trim = drift * _syncGain / 256;
+        trim = constrain(trim, -ENCODER_SYNC_TRIM_MAX, ENCODER_SYNC_TRIM_MAX);
+        encoder[0]._trim = -trim;
+        encoder[1]._trim = trim;
+    }
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (encoder[i].MC != NULL && encoder[i].update())
+            updated = true;
+    }
+    return updated;
+}
+
+// start counting the distance of both wheels from here
+void MotorDriver::syncEncoderMotors(bool enable, int16_t gain)
+{
+    _encoderSync = enable;
+    _syncGain = gain;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        _syncBase[i] = encoder[i].getCount();
+        encoder[i]._trim = 0;
     }
 }
 
@@ -325,6 +667,7 @@ void EncoderMotor::run(uint8_t cmd)
 
 void EncoderMotor::setSpeed(uint8_t speed)
 {
+    _closedLoop = false;
     if (MC->_version == 5)
     {
         DcSpeed = (speed * 16);
@@ -644,17 +987,227 @@ void DCMotor::setSpeed(int16_t speed)
 StepperMotor::StepperMotor(void)
 {
     revsteps = steppernum = currentstep = 0;
+    MC = NULL;
+    _currentPos = _targetPos = 0;
+    _maxSpeed = 1.0;
+    _acceleration = 0;
+    _scale = 1.0;
+    _n = 0;
+    _cn = 0;
+    _stepInterval = _lastStepTime = 0;
+    _style = SINGLE;
+    _direction = FORWARD;
+    updateProfile();
 }
 void StepperMotor::setSpeed(uint16_t rpm)
 {
     //Serial.println("steps per rev: "); Serial.println(revsteps);
     //Serial.println("RPM: "); Serial.println(rpm);
     usperstep = 60000000 / ((uint32_t)revsteps * (uint32_t)rpm);
+    setMaxSpeed((float)revsteps * rpm / 60.0);
 }
 
-void StepperMotor::release(void)
+void StepperMotor::updateProfile(void)
+{
+    _cmin = 1000000.0 / (_maxSpeed * _scale);
+    // first step interval of the ramp, Austin's approximation of the
+    // constant acceleration profile with the 0.676 correction factor
+    if (_acceleration > 0)
+        _c0 = 0.676 * sqrt(2.0 / (_acceleration * _scale)) * 1000000.0;
+    else
+        _c0 = _cmin;
+}
+
+// back to the full profile once a coordinated move is over, the scale of
+// moveSteppersTo() only applies to that move
+void StepperMotor::resetScale(void)
+{
+    if (_scale == 1.0)
+        return;
+    _scale = 1.0;
+    updateProfile();
+}
+
+void StepperMotor::setMaxSpeed(float speed)
+{
+    if (speed <= 0)
+        return;
+    _maxSpeed = speed;
+    _scale = 1.0;
+    updateProfile();
+    // already past the new top speed: start decelerating from here
+    if (_n > 0 && _acceleration > 0)
+        _n = (long)((speed * speed) / (2.0 * _acceleration));
+}
+
+void StepperMotor::setAcceleration(float accel)
+{
+    if (accel < 0)
+        return;
+    if (_n != 0 && _acceleration > 0 && accel > 0)
+        _n = _n * (_acceleration / accel);
+    _acceleration = accel;
+    _scale = 1.0;
+    updateProfile();
+}
+
+void StepperMotor::setStyle(uint8_t style)
 {
+    _style = style;
+}
+
+void StepperMotor::moveTo(long absolute)
+{
+    // a new target while still moving keeps the scale so the ramp stays
+    // consistent, the stop at the end resets it
+    if (_stepInterval == 0)
+        resetScale();
+    if (_targetPos != absolute)
+    {
+        _targetPos = absolute;
+        computeNewSpeed();
+    }
+}
+
+void StepperMotor::move(long relative)
+{
+    moveTo(_currentPos + relative);
+}
 
+long StepperMotor::distanceToGo(void)
+{
+    return _targetPos - _currentPos;
+}
+
+long StepperMotor::targetPosition(void)
+{
+    return _targetPos;
+}
+
+long StepperMotor::currentPosition(void)
+{
+    return _currentPos;
+}
+
+// also stops the motor where it is
+void StepperMotor::setCurrentPosition(long position)
+{
+    _targetPos = _currentPos = position;
+    _n = 0;
+    _stepInterval = 0;
+    resetScale();
+}
+
+bool StepperMotor::isRunning(void)
+{
+    return _stepInterval != 0;
+}
+
+// decelerate to a stop as fast as the acceleration allows
+void StepperMotor::stop(void)
+{
+    if (_stepInterval == 0)
+        return;
+    long stepsToStop = 0;
+    if (_acceleration > 0)
+    {
+        float speed = 1000000.0 / _cn;
+        stepsToStop = (long)((speed * speed) / (2.0 * _acceleration)) + 1;
+    }
+    move(_direction == FORWARD ? stepsToStop : -stepsToStop);
+}
+
+// Work out the interval to the next step, accelerating from rest, cruising
+// at the top speed and decelerating so that the motor stops on the target.
+void StepperMotor::computeNewSpeed(void)
+{
+    long distanceTo = distanceToGo();
+    long stepsToStop = _n > 0 ? _n : -_n;
+
+    if (_acceleration <= 0)
+    {
+        // constant speed, no ramp
+        if (distanceTo == 0)
+        {
+            _stepInterval = 0;
+            resetScale();
+            return;
+        }
+        _direction = distanceTo > 0 ? FORWARD : BACKWARD;
+        _cn = _cmin;
+        _stepInterval = _cmin;
+        return;
+    }
+    if (distanceTo == 0 && stepsToStop <= 1)
+    {
+        _stepInterval = 0;
+        _n = 0;
+        resetScale();
+        return;
+    }
+    if (distanceTo > 0)
+    {
+        // too close to stop or moving away: decelerate
+        if (_n > 0)
+        {
+            if (stepsToStop >= distanceTo || _direction == BACKWARD)
+                _n = -stepsToStop;
+        }
+        else if (_n < 0)
+        {
+            if (stepsToStop < distanceTo && _direction == FORWARD)
+                _n = -_n;
+        }
+    }
+    else if (distanceTo < 0)
+    {
+        if (_n > 0)
+        {
+            if (stepsToStop >= -distanceTo || _direction == FORWARD)
+                _n = -stepsToStop;
+        }
+        else if (_n < 0)
+        {
+            if (stepsToStop < -distanceTo && _direction == BACKWARD)
+                _n = -_n;
+        }
+    }
+    if (_n == 0)
+    {
+        _cn = _c0;
+        _direction = distanceTo > 0 ? FORWARD : BACKWARD;
+    }
+    else
+    {
+        _cn = _cn - ((2.0 * _cn) / ((4.0 * _n) + 1));
+        if (_cn < _cmin)
+            _cn = _cmin;
+    }
+    _n++;
+    _stepInterval = _cn;
+}
+
+// make at most one step when it is due, returns true while moving
+bool StepperMotor::run(void)
+{
+    if (_stepInterval == 0)
+        return false;
+    unsigned long now = micros();
+    if (now - _lastStepTime < _stepInterval)
+        return true;
+    onestep(_direction, _style);
+    if (_direction == FORWARD)
+        _currentPos++;
+    else
+        _currentPos--;
+    _lastStepTime = now;
+    computeNewSpeed();
+    return _stepInterval != 0;
+}
+
+void StepperMotor::release(void)
+{
+    MC->beginBatch();
     MC->setPin(AIN1pin, LOW);
     MC->setPin(BIN1pin, LOW);
     if (MC->_version != 4)
@@ -667,6 +1220,7 @@ void StepperMotor::release(void)
         MC->setPWM(PWMApin, 0);
         MC->setPWM(PWMBpin, 0);
     }
+    MC->endBatch();
 }
 
 void StepperMotor::step(uint16_t steps, uint8_t dir, uint8_t style)
@@ -812,6 +1366,8 @@ uint8_t StepperMotor::onestep(uint8_t dir, uint8_t style)
     Serial.print(" pwmB = ");
     Serial.println(ocrb, DEC);
 #endif
+    // all coil writes of this step go out together in endBatch()
+    MC->beginBatch();
     if (MC->_version != 5)
     {
         MC->setPWM(PWMApin, ocra * 16);
@@ -954,6 +1510,7 @@ uint8_t StepperMotor::onestep(uint8_t dir, uint8_t style)
             MC->setPWM(BIN2pin, ocrb * 16);
         }
     }
+    MC->endBatch();
     return currentstep;
 }
 
@@ -987,127 +1544,111 @@ void Sensor::SetRgbColor(E_RGB_INDEX index, long Color)
     mRgb->show();
 }
 
-void Sensor::Sing(byte songName)
+// The sounds as Buzzer sequences. _tone() used to wait the note length
+// twice, the silences below include that wait to keep the old timing.
+static const BuzzerSegment sing_connection[] PROGMEM = {BUZZER_NOTE(659, 50, 80), BUZZER_NOTE(1318, 55, 80), BUZZER_NOTE(1760, 60, 70)};
+static const BuzzerSegment sing_disconnection[] PROGMEM = {BUZZER_NOTE(659, 50, 80), BUZZER_NOTE(1760, 55, 80), BUZZER_NOTE(1318, 50, 60)};
+static const BuzzerSegment sing_buttonPushed[] PROGMEM = {BUZZER_SWEEP(1318, 1568, 3, 20, 22), BUZZER_REST(30), BUZZER_SWEEP(1318, 2350, 4, 10, 12)};
+static const BuzzerSegment sing_mode1[] PROGMEM = {BUZZER_SWEEP(1318, 1760, 2, 30, 40)};
+static const BuzzerSegment sing_mode2[] PROGMEM = {BUZZER_SWEEP(1567, 2350, 3, 30, 40)};
+static const BuzzerSegment sing_mode3[] PROGMEM = {BUZZER_NOTE(1318, 50, 150), BUZZER_NOTE(1567, 50, 130), BUZZER_NOTE(2349, 300, 301)};
+static const BuzzerSegment sing_surprise[] PROGMEM = {BUZZER_SWEEP(800, 2150, 2, 10, 11), BUZZER_SWEEP(2149, 800, 3, 7, 8)};
+static const BuzzerSegment sing_OhOoh[] PROGMEM = {BUZZER_SWEEP(880, 2000, 4, 8, 11), BUZZER_REST(200), BUZZER_REPEAT(987, 22, 5, 15)};
+static const BuzzerSegment sing_OhOoh2[] PROGMEM = {BUZZER_SWEEP(1880, 3000, 3, 8, 11), BUZZER_REST(200), BUZZER_REPEAT(1046, 16, 10, 20)};
+static const BuzzerSegment sing_cuddly[] PROGMEM = {BUZZER_SWEEP(700, 900, 3, 16, 20), BUZZER_SWEEP(899, 650, 1, 18, 25)};
+static const BuzzerSegment sing_sleeping[] PROGMEM = {BUZZER_SWEEP(100, 500, 4, 10, 20), BUZZER_REST(500), BUZZER_SWEEP(400, 100, 4, 10, 11)};
+static const BuzzerSegment sing_happy[] PROGMEM = {BUZZER_SWEEP(1500, 2500, 5, 20, 28), BUZZER_SWEEP(2499, 1500, 5, 25, 33)};
+static const BuzzerSegment sing_superHappy[] PROGMEM = {BUZZER_SWEEP(2000, 6000, 5, 8, 11), BUZZER_REST(50), BUZZER_SWEEP(5999, 2000, 5, 13, 15)};
+static const BuzzerSegment sing_happy_short[] PROGMEM = {BUZZER_SWEEP(1500, 2000, 5, 15, 23), BUZZER_REST(100), BUZZER_SWEEP(1900, 2500, 5, 10, 18)};
+static const BuzzerSegment sing_sad[] PROGMEM = {BUZZER_SWEEP(880, 669, 2, 20, 220)};
+static const BuzzerSegment sing_confused[] PROGMEM = {BUZZER_SWEEP(1000, 1700, 3, 8, 10), BUZZER_SWEEP(1699, 500, 4, 8, 11), BUZZER_SWEEP(1000, 1700, 5, 9, 19)};
+static const BuzzerSegment sing_fart1[] PROGMEM = {BUZZER_SWEEP(1600, 3000, 2, 2, 17)};
+static const BuzzerSegment sing_fart2[] PROGMEM = {BUZZER_SWEEP(2000, 6000, 2, 2, 22)};
+static const BuzzerSegment sing_fart3[] PROGMEM = {BUZZER_SWEEP(1600, 4000, 2, 2, 22), BUZZER_SWEEP(4000, 3000, 2, 2, 22)};
+static const BuzzerSegment sing_didi[] PROGMEM = {BUZZER_NOTE(2093, 50, 150), BUZZER_REST(110), BUZZER_NOTE(1046, 50, 150)};
+
+#define SING(song) mBuzzer->play(song, sizeof(song) / sizeof(BuzzerSegment), done)
+
+// start a sound and return, SingPoll() plays it to the end
+void Sensor::SingAsync(byte songName, FuncPtr done)
 {
     switch (songName)
     {
     case S_connection:
-        mBuzzer->_tone(note_E5, 50, 30);
-        mBuzzer->_tone(note_E6, 55, 25);
-        mBuzzer->_tone(note_A6, 60, 10);
-        //  _tone(9, 394);
+        SING(sing_connection);
         break;
-
     case S_disconnection:
-        mBuzzer->_tone(note_E5, 50, 30);
-        mBuzzer->_tone(note_A6, 55, 25);
-        mBuzzer->_tone(note_E6, 50, 10);
+        SING(sing_disconnection);
         break;
-
     case S_buttonPushed:
-        mBuzzer->bendTones(note_E6, note_G6, 1.03, 20, 2);
-        delay(30);
-        mBuzzer->bendTones(note_E6, note_D7, 1.04, 10, 2);
+        SING(sing_buttonPushed);
         break;
-
     case S_mode1:
-        mBuzzer->bendTones(note_E6, note_A6, 1.02, 30, 10); //1318.51 to 1760
+        SING(sing_mode1);
         break;
-
     case S_mode2:
-        mBuzzer->bendTones(note_G6, note_D7, 1.03, 30, 10); //1567.98 to 2349.32
+        SING(sing_mode2);
         break;
-
     case S_mode3:
-        mBuzzer->_tone(note_E6, 50, 100); //D6
-        mBuzzer->_tone(note_G6, 50, 80);  //E6
-        mBuzzer->_tone(note_D7, 300, 0);  //G6
+        SING(sing_mode3);
         break;
-
     case S_surprise:
-        mBuzzer->bendTones(800, 2150, 1.02, 10, 1);
-        mBuzzer->bendTones(2149, 800, 1.03, 7, 1);
+        SING(sing_surprise);
         break;
-
     case S_OhOoh:
-        mBuzzer->bendTones(880, 2000, 1.04, 8, 3); //A5 = 880
-        delay(200);
-
-        for (int i = 880; i < 2000; i = i * 1.04)
-        {
-            mBuzzer->_tone(note_B5, 5, 10);
-        }
+        SING(sing_OhOoh);
         break;
-
     case S_OhOoh2:
-        mBuzzer->bendTones(1880, 3000, 1.03, 8, 3);
-        delay(200);
-
-        for (int i = 1880; i < 3000; i = i * 1.03)
-        {
-            mBuzzer->_tone(note_C6, 10, 10);
-        }
+        SING(sing_OhOoh2);
         break;
-
     case S_cuddly:
-        mBuzzer->bendTones(700, 900, 1.03, 16, 4);
-        mBuzzer->bendTones(899, 650, 1.01, 18, 7);
+        SING(sing_cuddly);
         break;
-
     case S_sleeping:
-        mBuzzer->bendTones(100, 500, 1.04, 10, 10);
-        delay(500);
-        mBuzzer->bendTones(400, 100, 1.04, 10, 1);
+        SING(sing_sleeping);
         break;
-
     case S_happy:
-        mBuzzer->bendTones(1500, 2500, 1.05, 20, 8);
-        mBuzzer->bendTones(2499, 1500, 1.05, 25, 8);
+        SING(sing_happy);
         break;
-
     case S_superHappy:
-        mBuzzer->bendTones(2000, 6000, 1.05, 8, 3);
-        delay(50);
-        mBuzzer->bendTones(5999, 2000, 1.05, 13, 2);
+        SING(sing_superHappy);
         break;
-
     case S_happy_short:
-        mBuzzer->bendTones(1500, 2000, 1.05, 15, 8);
-        delay(100);
-        mBuzzer->bendTones(1900, 2500, 1.05, 10, 8);
+        SING(sing_happy_short);
         break;
-
     case S_sad:
-        mBuzzer->bendTones(880, 669, 1.02, 20, 200);
+        SING(sing_sad);
         break;
-
     case S_confused:
-        mBuzzer->bendTones(1000, 1700, 1.03, 8, 2);
-        mBuzzer->bendTones(1699, 500, 1.04, 8, 3);
-        mBuzzer->bendTones(1000, 1700, 1.05, 9, 10);
+        SING(sing_confused);
         break;
-
     case S_fart1:
-        mBuzzer->bendTones(1600, 3000, 1.02, 2, 15);
+        SING(sing_fart1);
         break;
-
     case S_fart2:
-        mBuzzer->bendTones(2000, 6000, 1.02, 2, 20);
+        SING(sing_fart2);
         break;
-
     case S_fart3:
-        mBuzzer->bendTones(1600, 4000, 1.02, 2, 20);
-        mBuzzer->bendTones(4000, 3000, 1.02, 2, 20);
+        SING(sing_fart3);
         break;
-
     case S_didi:
-        mBuzzer->_tone(note_C7, 50, 100);
-        delay(110);
-        mBuzzer->_tone(note_C6, 50, 100);
+        SING(sing_didi);
         break;
     }
 }
 
+bool Sensor::SingPoll(void)
+{
+    return mBuzzer->poll();
+}
+
+void Sensor::Sing(byte songName)
+{
+    SingAsync(songName);
+    while (mBuzzer->poll())
+        ;
+}
+
 uint16_t Sensor::GetUltrasonicDistance(void)
 {
     uint16_t FrontDistance;
@@ -69,6 +69,14 @@
 #define UL_LIMIT_MID 20
 #define UL_LIMIT_MAX 500
 
+#define ENCODER_PID_PERIOD 20           // ms between speed control updates
+#define ENCODER_MIN_COUNTS 4            // fewer edges per period: use the edge period
+#define ENCODER_STALL_TIME 200000UL     // us without an edge reads as stopped
+#define ENCODER_DEFAULT_RESOLUTION 1248 // phase A edges per wheel turn, 13 line hall on a 1:48 gearbox
+#define ENCODER_PWM_MAX 4095
+#define ENCODER_SYNC_TRIM_MAX 30        // rpm the synchronisation may add or take
+#define ENCODER_TRIP_PERIODS 25         // saturated periods with a growing error before the loop gives up
+
 typedef enum
 {
     E_RGB = 0,
@@ -97,6 +105,8 @@ public:
   Nrf24l *mNrf24L01;
   void SetRgbColor(E_RGB_INDEX index, long Color);
   void Sing(byte songName);
+  void SingAsync(byte songName, FuncPtr done = NULL);
+  bool SingPoll(void);
   uint16_t GetUltrasonicDistance(void);
   int  GetNrf24L01(char *RxaddrName);
   void sendNrf24l01(char *TxaddrName,int SendNrfData);
@@ -134,10 +144,23 @@ class EncoderMotor {
   void run(uint8_t);
   void setSpeed(uint8_t);
   void release(void);
-  void init(FuncPtr encoder_fun);
+  void init(FuncPtr encoder_fun = NULL);
   void EncoderCallback1(void);
   void EncoderCallback2(void);
   static FuncPtr CallBack[2];
+
+  // closed loop speed control, call update() from loop()
+  void setEncoderResolution(uint16_t counts);      // encoder edges per wheel turn
+  void setPid(int16_t kp, int16_t ki, int16_t kd); // 1/256 pwm steps per rpm
+  void setFeedForward(int16_t kff);                // 1/256 pwm steps per rpm
+  void setEncoderReversed(bool reversed);          // encoder counts backward when the motor turns forward
+  void setTargetRpm(int16_t rpm);                  // also clears a trip
+  bool tripped(void);                              // loop stopped, the encoder does not follow the drive
+  int16_t getRpm(void);
+  long getCount(void);
+  bool update(void);
+  static void EncoderIsr1(void);
+  static void EncoderIsr2(void);
  private:
   uint8_t PWMpin, IN1pin, IN2pin;
   uint8_t ENCODER1pin, ENCODER2pin;
@@ -145,6 +168,22 @@ class EncoderMotor {
   int DcSpeed;
   MotorDriver *MC;
   uint8_t encodernum;
+
+  void countEdge(void);
+  void drive(int16_t pwm);
+  static EncoderMotor *Instance[2];
+  volatile long _count;
+  volatile unsigned long _lastEdge, _edgePeriod;
+  volatile int8_t _edgeDir;
+  long _windowCount;
+  unsigned long _lastUpdate;
+  uint16_t _resolution;
+  int16_t _kp, _ki, _kd, _kff;
+  int16_t _targetRpm, _trim, _rpm, _lastError, _tripError;
+  long _integral;
+  uint8_t _saturatedPeriods;
+  int8_t _sign;
+  bool _closedLoop, _tripped;
 };
 
 class StepperMotor {
@@ -157,6 +196,21 @@ class StepperMotor {
   void release(void);
   uint32_t usperstep;
 
+  // non-blocking moves, call run() from loop() as often as possible.
+  // Coil writes go over I2C so run() must not be called from an interrupt.
+  void setMaxSpeed(float speed);      // steps per second
+  void setAcceleration(float accel);  // steps per second per second, 0 = no ramp
+  void setStyle(uint8_t style);
+  void moveTo(long absolute);
+  void move(long relative);
+  bool run(void);
+  void stop(void);
+  bool isRunning(void);
+  long distanceToGo(void);
+  long targetPosition(void);
+  long currentPosition(void);
+  void setCurrentPosition(long position);
+
  private:
   uint8_t PWMApin, AIN1pin, AIN2pin;
   uint8_t PWMBpin, BIN1pin, BIN2pin;
@@ -164,6 +218,16 @@ class StepperMotor {
   uint8_t currentstep;
   MotorDriver *MC;
   uint8_t steppernum;
+
+  void computeNewSpeed(void);
+  void updateProfile(void);
+  void resetScale(void);
+  long _currentPos, _targetPos;
+  float _maxSpeed, _acceleration, _scale;
+  float _c0, _cn, _cmin;       // step intervals in us
+  long _n;                     // ramp step, negative while decelerating
+  unsigned long _stepInterval, _lastStepTime;
+  uint8_t _style, _direction;
 };
 
 class Servo
@@ -188,6 +252,12 @@ class MotorDriver
     void begin(uint16_t freq = 1600);
     void setPWM(uint8_t pin, uint16_t val);
     void setPin(uint8_t pin, boolean val);
+    void beginBatch(void);
+    void endBatch(void);
+    bool runSteppers(void);
+    void moveSteppersTo(long pos1, long pos2);
+    bool updateEncoderMotors(void);
+    void syncEncoderMotors(bool enable, int16_t gain = 64);
     DCMotor *getMotor(uint8_t n);
     StepperMotor *getStepper(uint16_t steps, uint8_t n);
     EncoderMotor *getEncoderMotor(uint8_t num);
@@ -202,6 +272,12 @@ class MotorDriver
     EncoderMotor encoder[2];
     StepperMotor steppers[2];
     MS_PWMServoDriver _pwm;
+    uint16_t _chan[16];       // last value written to each channel, 4096 = fully on
+    uint16_t _valid, _dirty;  // channel masks
+    bool _batching;
+    bool _encoderSync;
+    int16_t _syncGain;       // 1/256 rpm per count of drift
+    long _syncBase[2];
 #if (MOTOR_DRIVER_BOARD_VER == 3)
     Servo servos[4];
 #else
@@ -25,6 +25,9 @@ APDS9960::APDS9960(TwoWire& wire, int intPin) :
   _gestureEnabled(false),
   _proximityEnabled(false),
   _colorEnabled(false),
+  _continuous(false),
+  _enable(0),
+  _pers(0),
   _gestureIn(false),
   _gestureDirectionX(0),
   _gestureDirectionY(0),
@@ -49,6 +52,7 @@ bool APDS9960::begin() {
     
   // Disable everything
   if (!setENABLE(0x00)) return false;
+  _enable = 0x00;
   if (!setWTIME(0xFF)) return false;
   if (!setGPULSE(0x8F)) return false; // 16us, 16 pulses // default is: 0x40 = 8us, 1 pulse
   if (!setPPULSE(0x8F)) return false; // 16us, 16 pulses // default is: 0x40 = 8us, 1 pulse
@@ -74,8 +78,12 @@ bool APDS9960::begin() {
 void APDS9960::end() {
   // Disable everything
   setENABLE(0x00);
+  _enable = 0x00;
 
   _gestureEnabled = false;
+  _proximityEnabled = false;
+  _colorEnabled = false;
+  _continuous = false;
 
   _wire.end();
 }
@@ -122,114 +130,97 @@ bool APDS9960::setGestureMode(bool en)
     return setGCONF4(r);
 }
 
+// ENABLE is only ever written by this library, so it is kept in _enable and
+// switching an engine costs at most one write instead of a read-modify-write.
+bool APDS9960::updateEnable(uint8_t set, uint8_t clear) {
+  uint8_t r = (_enable | set) & ~clear;
+  if (r == _enable) return true;
+  if (!setENABLE(r)) return false;
+  _enable = r;
+  return true;
+}
+
 bool APDS9960::enablePower() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000001) != 0) return true;
-  r |= 0b00000001;
-  return setENABLE(r);
+  return updateEnable(0b00000001, 0);
 }
 
 bool APDS9960::disablePower() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000001) == 0) return true;
-  r &= 0b11111110;
-  return setENABLE(r);
+  return updateEnable(0, 0b00000001);
 }
 
 bool APDS9960::enableColor() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000010) != 0) {
-    _colorEnabled = true;
-    return true;
-  }
-  r |= 0b00000010;
-  bool res = setENABLE(r);
+  bool res = updateEnable(0b00000010, 0);
   _colorEnabled = res;
   return res;
 }
 
 bool APDS9960::disableColor() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000010) == 0) {
-    _colorEnabled = false;
-    return true;
-  }
-  r &= 0b11111101;
-  bool res = setENABLE(r);
+  bool res = updateEnable(0, 0b00000010);
   _colorEnabled = !res; // (res == true) if succesfully disabled
   return res;
 }
 
 bool APDS9960::enableProximity() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000100) != 0) {
-    _proximityEnabled = true;
-    return true;
-  }
-  r |= 0b00000100;
-  bool res = setENABLE(r);
+  bool res = updateEnable(0b00000100, 0);
   _proximityEnabled = res;
   return res;
 }
 
 bool APDS9960::disableProximity() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00000100) == 0) {
-    _proximityEnabled = false;
-    return true;
-  }
-  r &= 0b11111011;
-  bool res = setENABLE(r);
+  bool res = updateEnable(0, 0b00000100);
   _proximityEnabled = !res; // (res == true) if succesfully disabled
   return res;
 }
 
 bool APDS9960::enableWait() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00001000) != 0) return true;
-  r |= 0b00001000;
-  return setENABLE(r);
+  return updateEnable(0b00001000, 0);
 }
 
 bool APDS9960::disableWait() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b00001000) == 0) return true;
-  r &= 0b11110111;
-  return setENABLE(r);
+  return updateEnable(0, 0b00001000);
 }
 
 bool APDS9960::enableGesture() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b01000000) != 0) {
-    _gestureEnabled = true;
-    return true;
-  }
-  r |= 0b01000000;
-  bool res = setENABLE(r);
+  bool res = updateEnable(0b01000000, 0);
   _gestureEnabled = res;
   return res;
 }
 
 bool APDS9960::disableGesture() {
-  uint8_t r;
-  if (!getENABLE(&r)) return false;
-  if ((r & 0b01000000) == 0) {
+  bool res = updateEnable(0, 0b01000000);
+  _gestureEnabled = !res; // (res == true) if successfully disabled
+  return res;
+}
+
+// Keeps color, proximity and gesture running together instead of starting
+// an engine for each reading, so a new color sample is ready every
+// integration period rather than one integration after every request.
+// Every ALS and proximity cycle raises AINT and PINT (and the INT pin when
+// set), which the *Available() functions check and the read*() ones clear.
+// The persistence filter is put back when continuous mode ends.
+bool APDS9960::setContinuousMode(bool en) {
+  const uint8_t engines = 0b01110110; // GEN, PIEN, AIEN, PEN, AEN
+
+  if (!en) {
+    if (!updateEnable(0, engines)) return false;
+    if (_continuous && !setPERS(_pers)) return false;
+    _continuous = false;
+    _colorEnabled = false;
+    _proximityEnabled = false;
     _gestureEnabled = false;
     return true;
   }
-  r &= 0b10111111;
-  bool res = setENABLE(r);
-  _gestureEnabled = !res; // (res == true) if successfully disabled
-  return res;
+
+  // interrupt on every cycle rather than on thresholds
+  if (!_continuous && !getPERS(&_pers)) return false;
+  if (!setPERS(0x00)) return false;
+  if (!updateEnable(engines | 0b00001001, 0)) return false; // with PON and WEN
+  write(0xE7); // AICLEAR, clear all pending non-gesture interrupts
+  _continuous = true;
+  _colorEnabled = true;
+  _proximityEnabled = true;
+  _gestureEnabled = true;
+  return true;
 }
 
 #define APDS9960_ADDR 0x39
@@ -274,63 +265,81 @@ int APDS9960::gestureFIFOAvailable() {
   return r;
 }
 
+// The Wire buffer limits a single read, 32 bytes on AVR, so the FIFO is
+// drained in chunks of whole datasets whatever its fill level.
+#if defined(BUFFER_LENGTH)
+#define APDS9960_FIFO_CHUNK (BUFFER_LENGTH & ~3)
+#elif defined(I2C_BUFFER_LENGTH)
+#define APDS9960_FIFO_CHUNK (I2C_BUFFER_LENGTH & ~3)
+#else
+#define APDS9960_FIFO_CHUNK 32
+#endif
+
 int APDS9960::handleGesture() {
-  const int gestureThreshold = 30;
   while (true) {
     int available = gestureFIFOAvailable();
     if (available <= 0) return 0;
 
-    uint8_t fifo_data[128];
-    uint8_t bytes_read = readGFIFO_U(fifo_data, available * 4);
-    if (bytes_read == 0) return 0;
-
-    for (int i = 0; i+3 < bytes_read; i+=4) {
-      uint8_t u,d,l,r;
-      u = fifo_data[i];
-      d = fifo_data[i+1];
-      l = fifo_data[i+2];
-      r = fifo_data[i+3];
-      // Serial.print(u);
-      // Serial.print(",");
-      // Serial.print(d);
-      // Serial.print(",");
-      // Serial.print(l);
-      // Serial.print(",");
-      // Serial.println(r);
-
-      if (u<gestureThreshold && d<gestureThreshold && l<gestureThreshold && r<gestureThreshold) {
-        _gestureIn = true;
-        if (_gestureDirInX != 0 || _gestureDirInY != 0) {
-          int totalX = _gestureDirInX - _gestureDirectionX;
-          int totalY = _gestureDirInY - _gestureDirectionY;
-          // Serial.print("OUT ");
-          // Serial.print(totalX);
-          // Serial.print(",");
-          // Serial.println(totalY);
-          if (totalX < -_gestureSensitivity) { _detectedGesture = GESTURE_LEFT; }
-          if (totalX > _gestureSensitivity) { _detectedGesture = GESTURE_RIGHT; }
-          if (totalY < -_gestureSensitivity) { _detectedGesture = GESTURE_DOWN; }
-          if (totalY > _gestureSensitivity) { _detectedGesture = GESTURE_UP; }
-          _gestureDirectionX = 0;
-          _gestureDirectionY = 0;
-          _gestureDirInX = 0;
-          _gestureDirInY = 0;
-        }
-        continue;
-      }
+    while (available > 0) {
+      uint8_t fifo_data[APDS9960_FIFO_CHUNK];
+      int chunk = min(available * 4, APDS9960_FIFO_CHUNK);
+      int bytes_read = readGFIFO_U(fifo_data, chunk);
+      if (bytes_read == 0) return 0;
+
+      processGesture(fifo_data, bytes_read);
+      available -= chunk / 4;
+    }
+  }
+}
 
-      _gestureDirectionX = r - l;
-      _gestureDirectionY = u - d;
-      if (_gestureIn) {
-        _gestureIn = false;
-        _gestureDirInX = _gestureDirectionX;
-        _gestureDirInY = _gestureDirectionY;
-        // Serial.print("IN ");
-        // Serial.print(_gestureDirInX);
+void APDS9960::processGesture(const uint8_t *fifo_data, int bytes_read) {
+  const int gestureThreshold = 30;
+  for (int i = 0; i+3 < bytes_read; i+=4) {
+    uint8_t u,d,l,r;
+    u = fifo_data[i];
+    d = fifo_data[i+1];
+    l = fifo_data[i+2];
+    r = fifo_data[i+3];
+    // Serial.print(u);
+    // Serial.print(",");
+    // Serial.print(d);
+    // Serial.print(",");
+    // Serial.print(l);
+    // Serial.print(",");
+    // Serial.println(r);
+
+    if (u<gestureThreshold && d<gestureThreshold && l<gestureThreshold && r<gestureThreshold) {
+      _gestureIn = true;
+      if (_gestureDirInX != 0 || _gestureDirInY != 0) {
+        int totalX = _gestureDirInX - _gestureDirectionX;
+        int totalY = _gestureDirInY - _gestureDirectionY;
+        // Serial.print("OUT ");
+        // Serial.print(totalX);
         // Serial.print(",");
-        // Serial.print(_gestureDirInY);
-        // Serial.print(" ");
+        // Serial.println(totalY);
+        if (totalX < -_gestureSensitivity) { _detectedGesture = GESTURE_LEFT; }
+        if (totalX > _gestureSensitivity) { _detectedGesture = GESTURE_RIGHT; }
+        if (totalY < -_gestureSensitivity) { _detectedGesture = GESTURE_DOWN; }
+        if (totalY > _gestureSensitivity) { _detectedGesture = GESTURE_UP; }
+        _gestureDirectionX = 0;
+        _gestureDirectionY = 0;
+        _gestureDirInX = 0;
+        _gestureDirInY = 0;
       }
+      continue;
+    }
+
+    _gestureDirectionX = r - l;
+    _gestureDirectionY = u - d;
+    if (_gestureIn) {
+      _gestureIn = false;
+      _gestureDirInX = _gestureDirectionX;
+      _gestureDirInY = _gestureDirectionY;
+      // Serial.print("IN ");
+      // Serial.print(_gestureDirInX);
+      // Serial.print(",");
+      // Serial.print(_gestureDirInY);
+      // Serial.print(" ");
     }
   }
 }
@@ -364,6 +373,16 @@ int APDS9960::readGesture() {
 int APDS9960::colorAvailable() {
   uint8_t r;
 
+  if (_continuous) {
+    if (_intPin > -1 && digitalRead(_intPin) != LOW) {
+      return 0;
+    }
+    if (!getSTATUS(&r)) {
+      return 0;
+    }
+    return (r & 0b00010000) ? 1 : 0; // AINT, set by every ALS cycle
+  }
+
   enableColor();
 
   if (!getSTATUS(&r)) {
@@ -400,7 +419,11 @@ bool APDS9960::readColor(int& r, int& g, int& b, int& c) {
   g = colors[2];
   b = colors[3];
 
-  disableColor();
+  if (_continuous) {
+    write(0xE6); // CICLEAR, address only
+  } else {
+    disableColor();
+  }
 
   return true;
 }
@@ -408,6 +431,16 @@ bool APDS9960::readColor(int& r, int& g, int& b, int& c) {
 int APDS9960::proximityAvailable() {
   uint8_t r;
 
+  if (_continuous) {
+    if (_intPin > -1 && digitalRead(_intPin) != LOW) {
+      return 0;
+    }
+    if (!getSTATUS(&r)) {
+      return 0;
+    }
+    return (r & 0b00100000) ? 1 : 0; // PINT, set by every proximity cycle
+  }
+
   enableProximity();
 
   if (!getSTATUS(&r)) {
@@ -428,7 +461,11 @@ int APDS9960::readProximity() {
     return -1;
   }
 
-  disableProximity();
+  if (_continuous) {
+    write(0xE5); // PICLEAR, address only
+  } else {
+    disableProximity();
+  }
 
   return (255 - r);
 }
@@ -55,6 +55,8 @@ public:
 
   bool setLEDBoost(uint8_t boost);
 
+  bool setContinuousMode(bool en);
+
 private:
   bool setGestureIntEnable(bool en);
   bool setGestureMode(bool en);
@@ -71,6 +73,8 @@ private:
   bool disableWait();
   bool enableGesture();
   bool disableGesture();
+  bool updateEnable(uint8_t set, uint8_t clear);
+  void processGesture(const uint8_t *fifo_data, int bytes_read);
 
 private:
   TwoWire& _wire;
@@ -79,6 +83,9 @@ private:
   bool _gestureEnabled;
   bool _proximityEnabled;
   bool _colorEnabled;
+  bool _continuous;
+  uint8_t _enable; // shadow of the ENABLE register
+  uint8_t _pers;   // PERS before continuous mode
   bool _gestureIn;
   int _gestureDirectionX;
   int _gestureDirectionY;
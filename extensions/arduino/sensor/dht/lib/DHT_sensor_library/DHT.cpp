@@ -6,11 +6,25 @@ written by Adafruit Industries
 
 #include "DHT.h"
 
+#ifndef NOT_AN_INTERRUPT
+ #define NOT_AN_INTERRUPT -1
+#endif
+
+#define DHT_STATE_IDLE 0
+#define DHT_STATE_START 1     // start signal, line held low
+#define DHT_STATE_CAPTURE 2   // interrupt is timing the bits
+
+volatile uint16_t DHT::_edges[DHT_EDGES];
+volatile uint8_t DHT::_edgeCount;
+DHT *DHT::_capturing = NULL;
+
 DHT::DHT(uint8_t pin, uint8_t type, uint8_t count) {
   _pin = pin;
   _type = type;
   _count = count;
   firstreading = true;
+  _state = DHT_STATE_IDLE;
+  _status = DHT_ERROR_TIMEOUT;
 }
 
 void DHT::begin(void) {
@@ -92,9 +106,6 @@ float DHT::computeHeatIndex(float tempFahrenheit, float percentHumidity) {
 
 
 boolean DHT::read(void) {
-  uint8_t laststate = HIGH;
-  uint8_t counter = 0;
-  uint8_t j = 0, i;
   unsigned long currenttime;
 
   // Check if sensor was read less than two seconds ago and return early
@@ -113,18 +124,117 @@ boolean DHT::read(void) {
     Serial.print("Currtime: "); Serial.print(currenttime);
     Serial.print(" Lasttime: "); Serial.print(_lastreadtime);
   */
+  if (!startRead()) {
+    return false;
+  }
+
+  uint8_t status;
+  while ((status = poll()) == DHT_BUSY) {
+#if defined(ESP8266)
+    yield();
+#endif
+  }
+  return status == DHT_OK;
+}
+
+boolean DHT::startRead(void) {
+  if (_state != DHT_STATE_IDLE || _capturing != NULL) {
+    return false;
+  }
+  firstreading = false;
   _lastreadtime = millis();
 
   data[0] = data[1] = data[2] = data[3] = data[4] = 0;
-  
-  // pull the pin high and wait 250 milliseconds
-  digitalWrite(_pin, HIGH);
-  delay(250);
 
-  // now pull it low for ~20 milliseconds
+  // pull it low for ~20 milliseconds, the line was left high by the pull-up
   pinMode(_pin, OUTPUT);
   digitalWrite(_pin, LOW);
-  delay(20);
+  _starttime = micros();
+  _state = DHT_STATE_START;
+  _status = DHT_BUSY;
+  return true;
+}
+
+uint8_t DHT::poll(void) {
+  if (_state == DHT_STATE_START) {
+    if (micros() - _starttime < 20000) {
+      return DHT_BUSY;
+    }
+    int irq = digitalPinToInterrupt(_pin);
+    if (irq == NOT_AN_INTERRUPT) {
+      _state = DHT_STATE_IDLE;
+      _status = readPulses();
+      return _status;
+    }
+    _capturing = this;
+    attachInterrupt(irq, captureEdge, FALLING);
+    // A flag left from the falling edge of the start signal fires right
+    // after attaching on AVR. The sensor answers 20-40us after the release,
+    // so forget what was captured while releasing the line.
+    noInterrupts();
+    digitalWrite(_pin, HIGH);
+    pinMode(_pin, INPUT);
+    _edgeCount = 0;
+    _starttime = micros();
+    interrupts();
+    _state = DHT_STATE_CAPTURE;
+    return DHT_BUSY;
+  }
+
+  if (_state == DHT_STATE_CAPTURE) {
+    if (_edgeCount < DHT_EDGES && micros() - _starttime < DHT_CAPTURE_TIMEOUT) {
+      return DHT_BUSY;
+    }
+    detachInterrupt(digitalPinToInterrupt(_pin));
+    _capturing = NULL;
+    _state = DHT_STATE_IDLE;
+    _status = decode(_edges, _edgeCount, data);
+    return _status;
+  }
+
+  return _status;
+}
+
+void DHT_ISR_ATTR DHT::captureEdge(void) {
+  if (_edgeCount < DHT_EDGES) {
+    _edges[_edgeCount] = micros();
+    _edgeCount++;
+  }
+}
+
+// The sensor answers with 80us low and 80us high, then sends each bit as
+// 50us low followed by 26-28us high for 0 or 70us high for 1, and ends with
+// 50us low. Falling edges are 160us apart after the answer and then a bit
+// period apart, so the 41 gaps after the first edge hold the 40 bits.
+uint8_t DHT::decode(const volatile uint16_t *edges, uint8_t count, uint8_t *bytes) {
+  if (count < DHT_EDGES) {
+    return DHT_ERROR_TIMEOUT;
+  }
+
+  bytes[0] = bytes[1] = bytes[2] = bytes[3] = bytes[4] = 0;
+  for (uint8_t i = 0; i < 40; i++) {
+    uint16_t period = edges[i + 2] - edges[i + 1];
+    if (period < DHT_BIT_MIN || period > DHT_BIT_MAX) {
+      return DHT_ERROR_PULSE;
+    }
+    bytes[i / 8] <<= 1;
+    if (period > DHT_BIT_ONE) {
+      bytes[i / 8] |= 1;
+    }
+  }
+
+  if (bytes[4] != ((bytes[0] + bytes[1] + bytes[2] + bytes[3]) & 0xFF)) {
+    return DHT_ERROR_CHECKSUM;
+  }
+  return DHT_OK;
+}
+
+// bit timing with interrupts off, for pins without an external interrupt
+uint8_t DHT::readPulses(void) {
+  uint8_t laststate = HIGH;
+  uint8_t counter = 0;
+  uint8_t j = 0, i;
+
   noInterrupts();
   digitalWrite(_pin, HIGH);
   delayMicroseconds(40);
@@ -168,12 +278,12 @@ boolean DHT::read(void) {
   */
 
   // check we read 40 bits and that the checksum matches
-  if ((j >= 40) && 
-      (data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) ) {
-    return true;
+  if (j < 40) {
+    return DHT_ERROR_TIMEOUT;
   }
-  
-
-  return false;
+  if (data[4] != ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) {
+    return DHT_ERROR_CHECKSUM;
+  }
+  return DHT_OK;
 
 }
@@ -20,12 +20,44 @@ written by Adafruit Industries
 #define DHT21 21
 #define AM2301 21
 
+// poll() results
+#define DHT_OK 0
+#define DHT_BUSY 1
+#define DHT_ERROR_TIMEOUT 2   // fewer edges than a reading has
+#define DHT_ERROR_PULSE 3     // an edge was missed or the line glitched
+#define DHT_ERROR_CHECKSUM 4
+
+// falling edges of a reading: response, start of each of the 40 bits, end
+#define DHT_EDGES 42
+// a bit is 50us low then 26-28us high for 0 or 70us high for 1
+#define DHT_BIT_MIN 60
+#define DHT_BIT_ONE 100
+#define DHT_BIT_MAX 140   // two bits merged by a missed edge are longer
+// a whole reading takes less than 5ms after the start signal
+#define DHT_CAPTURE_TIMEOUT 10000
+
+#if defined(ESP32) || defined(ESP8266)
+ #define DHT_ISR_ATTR IRAM_ATTR
+#else
+ #define DHT_ISR_ATTR
+#endif
+
 class DHT {
  private:
   uint8_t data[6];
   uint8_t _pin, _type, _count;
   unsigned long _lastreadtime;
   boolean firstreading;
+  uint8_t _state, _status;
+  unsigned long _starttime;
+
+  // timestamps (micros) taken by the pin interrupt, one reading at a time
+  static volatile uint16_t _edges[DHT_EDGES];
+  static volatile uint8_t _edgeCount;
+  static DHT *_capturing;
+  static void DHT_ISR_ATTR captureEdge(void);
+
+  uint8_t readPulses(void);
 
  public:
   DHT(uint8_t pin, uint8_t type, uint8_t count=6);
@@ -37,5 +69,15 @@ class DHT {
   float readHumidity(void);
   boolean read(void);
 
+  // Non-blocking reading: startRead() sends the start signal, poll() returns
+  // DHT_BUSY until the reading is done and then its result. On pins with an
+  // external interrupt the bits are timed by the interrupt with interrupts
+  // left on, on other pins poll() reads them the blocking way.
+  boolean startRead(void);
+  uint8_t poll(void);
+
+  // decode falling edge timestamps into 5 bytes, returns a poll() result
+  static uint8_t decode(const volatile uint16_t *edges, uint8_t count, uint8_t *bytes);
+
 };
 #endif
@@ -52,6 +52,8 @@ SharpIR::SharpIR(int irPin, long sensorModel) {
   
     _irPin=irPin;
     _model=sensorModel;
+    _count=0;
+    _next=0;
     
     // Define pin as Input
     pinMode (_irPin, INPUT);
@@ -81,9 +83,6 @@ void SharpIR::sort(int a[], int size) {
 int SharpIR::distance() {
 
     int ir_val[NB_SAMPLE];
-    int distanceCM;
-    float current;
-
 
     for (int i=0; i<NB_SAMPLE; i++){
         // Read analog value
@@ -93,59 +92,140 @@ int SharpIR::distance() {
     // Sort it 
     sort(ir_val,NB_SAMPLE);
 
-    
-    if (_model==1080) {
-        
-        // Different expressions required as the Photon has 12 bit ADCs vs 10 bit for Arduinos
-        #ifdef ARDUINO
-          distanceCM = 27.728 * pow(map(ir_val[NB_SAMPLE / 2], 0, 1023, 0, 5000)/1000.0, -1.2045);
-        #elif defined(SPARK)
-          distanceCM = 27.728 * pow(map(ir_val[NB_SAMPLE / 2], 0, 4095, 0, 5000)/1000.0, -1.2045);
-        #endif
+    return toDistance(ir_val[NB_SAMPLE / 2]);
+}
 
-    } else if (_model==20150){
+// Take a single sample into the sliding median, cheap enough to call every loop.
+// The window is kept sorted: the oldest sample is taken out and the new one
+// inserted in place, instead of sorting NB_SAMPLE readings for each distance.
+void SharpIR::update() {
+
+    int value = analogRead(_irPin);
+    int i;
+
+    if (_count == SHARPIR_WINDOW) {
+        int oldest = _window[_next];
+        for (i=0; _sorted[i] != oldest; i++);
+        for (; i<_count-1; i++) _sorted[i] = _sorted[i+1];
+        _count--;
+    }
+    for (i=_count; i>0 && _sorted[i-1] > value; i--) _sorted[i] = _sorted[i-1];
+    _sorted[i] = value;
+    _count++;
+
+    _window[_next] = value;
+    _next = (_next + 1) % SHARPIR_WINDOW;
+}
+
+// Distance of the median of the last SHARPIR_WINDOW samples taken by update()
+int SharpIR::filteredDistance() {
+
+    if (_count == 0) update();
+
+    return toDistance(_sorted[_count / 2]);
+}
+
+// Distance curves sampled every SHARPIR_LUT_SIZE-th of the ADC range, in quarter cm,
+// from the formulas below (the former pow() expressions, V = 5 * raw / 1023).
+// Linear interpolation between them stays within a centimetre of the formulas
+// over each sensor's range, for a fraction of the time pow() takes on AVR.
+#define SHARPIR_LUT_SIZE 128
+
+#if defined(SPARK)
+  // The Photon has 12 bit ADCs vs 10 bit for Arduinos
+  #define SHARPIR_ADC_MAX 4095
+  #define SHARPIR_LUT_SHIFT 5
+#else
+  #define SHARPIR_ADC_MAX 1023
+  #define SHARPIR_LUT_SHIFT 3
+#endif
+
+#ifndef PROGMEM
+  #define PROGMEM
+#endif
+#ifndef pgm_read_word
+  #define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
 
+// GP2Y0A21YK0F: 27.728 * V^-1.2045
+static const uint16_t lut1080[SHARPIR_LUT_SIZE + 1] PROGMEM = {
+    65535, 5504, 2388, 1466, 1036, 792, 636, 528, 450, 390, 344, 306, 276, 251, 229, 211,
+    195, 181, 169, 159, 149, 141, 133, 126, 120, 114, 109, 104, 99, 95, 92, 88,
+    85, 82, 79, 76, 73, 71, 69, 67, 65, 63, 61, 59, 58, 56, 55, 53,
+    52, 51, 49, 48, 47, 46, 45, 44, 43, 42, 41, 41, 40, 39, 38, 37,
+    37, 36, 35, 35, 34, 34, 33, 32, 32, 31, 31, 30, 30, 29, 29, 29,
+    28, 28, 27, 27, 26, 26, 26, 25, 25, 25, 24, 24, 24, 23, 23, 23,
+    23, 22, 22, 22, 21, 21, 21, 21, 20, 20, 20, 20, 20, 19, 19, 19,
+    19, 19, 18, 18, 18, 18, 18, 17, 17, 17, 17, 17, 17, 16, 16, 16,
+    16
+};
+
+// GP2Y0A02YK0F: 60.374 * V^-1.16
+static const uint16_t lut20150[SHARPIR_LUT_SIZE + 1] PROGMEM = {
+    65535, 10375, 4643, 2901, 2078, 1604, 1298, 1086, 930, 811, 718, 643, 581, 529, 486, 448,
+    416, 388, 363, 341, 321, 304, 288, 273, 260, 248, 237, 227, 217, 209, 201, 193,
+    186, 180, 174, 168, 162, 157, 153, 148, 144, 140, 136, 132, 129, 125, 122, 119,
+    116, 114, 111, 108, 106, 104, 101, 99, 97, 95, 93, 92, 90, 88, 86, 85,
+    83, 82, 80, 79, 78, 76, 75, 74, 73, 72, 70, 69, 68, 67, 66, 65,
+    64, 63, 63, 62, 61, 60, 59, 58, 58, 57, 56, 55, 55, 54, 53, 53,
+    52, 51, 51, 50, 50, 49, 49, 48, 47, 47, 46, 46, 45, 45, 44, 44,
+    44, 43, 43, 42, 42, 41, 41, 41, 40, 40, 39, 39, 39, 38, 38, 38,
+    37
+};
+
+// 430: 12.08 * V^-1.058
+static const uint16_t lut430[SHARPIR_LUT_SIZE + 1] PROGMEM = {
+    65535, 1491, 716, 466, 344, 272, 224, 190, 165, 146, 130, 118, 108, 99, 91, 85,
+    79, 74, 70, 66, 63, 60, 57, 54, 52, 49, 47, 46, 44, 42, 41, 39,
+    38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 29, 28, 27, 27, 26, 25,
+    25, 24, 24, 23, 23, 22, 22, 21, 21, 21, 20, 20, 20, 19, 19, 19,
+    18, 18, 18, 17, 17, 17, 17, 16, 16, 16, 16, 15, 15, 15, 15, 15,
+    14, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 13, 12, 12, 12, 12,
+    12, 12, 12, 12, 11, 11, 11, 11, 11, 11, 11, 11, 11, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9
+};
+
+// Convert a raw analog value to cm
+int SharpIR::toDistance(int raw) {
+
+    const uint16_t *lut;
+
+    if (_model==1080) {
+        lut = lut1080;
+    } else if (_model==20150){
         // Previous formula used by  Dr. Marcal Casas-Cartagena
         // puntualDistance=61.573*pow(voltFromRaw/1000, -1.1068);
-        
-        // Different expressions required as the Photon has 12 bit ADCs vs 10 bit for Arduinos
-        #ifdef ARDUINO
-          distanceCM = 60.374 * pow(map(ir_val[NB_SAMPLE / 2], 0, 1023, 0, 5000)/1000.0, -1.16);
-        #elif defined(SPARK)
-          distanceCM = 60.374 * pow(map(ir_val[NB_SAMPLE / 2], 0, 4095, 0, 5000)/1000.0, -1.16);
-        #endif
-
+        lut = lut20150;
     } else if (_model==430){
-
-        // Different expressions required as the Photon has 12 bit ADCs vs 10 bit for Arduinos
-        #ifdef ARDUINO
-          distanceCM = 12.08 * pow(map(ir_val[NB_SAMPLE / 2], 0, 1023, 0, 5000)/1000.0, -1.058);
-        #elif defined(SPARK)
-          distanceCM = 12.08 * pow(map(ir_val[NB_SAMPLE / 2], 0, 4095, 0, 5000)/1000.0, -1.058);
-        #endif
-        
+        lut = lut430;
     } else if (_model==100500){
-        
-        #ifdef ARDUINO
-          current = map(ir_val[NB_SAMPLE / 2], 0, 1023, 0, 5000);
-        #elif defined(SPARK)
-          current = map(ir_val[NB_SAMPLE / 2], 0, 4095, 0, 5000);
-        #endif
+
+        long current = map(raw, 0, SHARPIR_ADC_MAX, 0, 5000);
         // use the inverse number of distance like in the datasheet (1/L)
         // y = mx + b = 137500*x + 1125 
         // x = (y - 1125) / 137500
-        // Different expressions required as the Photon has 12 bit ADCs vs 10 bit for Arduinos
         if (current < 1400 || current > 3300) {
           //false data
-          distanceCM = 0;
-        } else {
-          distanceCM = 1.0 / (((current - 1125.0) / 1000.0) / 137.5);
+          return 0;
         }
+        return 137500L / (current - 1125);
+    } else {
+        return 0;
     }
 
-    return distanceCM;
+    // a wider ADC (ESP32 reads 12 bits) must not index past the table
+    if (raw < 0) {
+        raw = 0;
+    } else if (raw > SHARPIR_ADC_MAX) {
+        raw = SHARPIR_ADC_MAX;
+    }
+    uint8_t index = raw >> SHARPIR_LUT_SHIFT;
+    uint8_t frac = raw & ((1 << SHARPIR_LUT_SHIFT) - 1);
+    uint16_t a = pgm_read_word(&lut[index]);
+    uint16_t b = pgm_read_word(&lut[index + 1]);
+    // curves only fall, so a >= b
+    long quarters = a - (((long)(a - b) * frac) >> SHARPIR_LUT_SHIFT);
+
+    return (quarters + 2) >> 2;
 }
-
-
-
-
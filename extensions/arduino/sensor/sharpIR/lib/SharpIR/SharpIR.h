@@ -20,6 +20,11 @@
 
 #define NB_SAMPLE 25
 
+// Samples in the sliding median used by update() and filteredDistance()
+#ifndef SHARPIR_WINDOW
+  #define SHARPIR_WINDOW 9
+#endif
+
 #ifdef ARDUINO
   #include "Arduino.h"
 #elif defined(SPARK)
@@ -32,13 +37,21 @@ class SharpIR
 
     SharpIR (int irPin, long sensorModel);
     int distance();
+    void update();
+    int filteredDistance();
 
   private:
 
     void sort(int a[], int size);
+    int toDistance(int raw);
 
     int _irPin;
     long _model;
+
+    int _window[SHARPIR_WINDOW];
+    int _sorted[SHARPIR_WINDOW];
+    uint8_t _count;
+    uint8_t _next;
 };
 
 #endif
@@ -13,16 +13,28 @@ See main header file for complete comments
  * \brief Main class definition file for the MD_TCS230 library
  */
 
+#ifndef DEBUG_TCS230
 #define  DEBUG_TCS230 0   ///< Debug flag. Set to 1 to enable debug output to Serial.
+#endif
 
 #if  DEBUG_TCS230
-#define DUMP(s, v)  { Serial.print(F(s)); Serial.print(v); }  ///< Debug label + value
-#define DUMPS(s)    { Serial.print(F(s)); }                   ///< Debug label only
+#define DUMP(s, v)  do { Serial.print(F(s)); Serial.print(v); } while (0)  ///< Debug label + value
+#define DUMPS(s)    do { Serial.print(F(s)); } while (0)                   ///< Debug label only
 #else
 #define DUMP(s, v)  ///< Debug label + value
 #define DUMPS(s)    ///< Debug label only
 #endif
 
+#if defined(ESP8266) || defined(ESP32)
+#define TCS230_ISR_ATTR IRAM_ATTR ///< Keep interrupt code in RAM
+#else
+#define TCS230_ISR_ATTR           ///< Keep interrupt code in RAM
+#endif
+
+#define TCS230_CAPTURE_MAX 4000   ///< Periods closing a window early, keeps count * 1000000 in 32 bits
+
+MD_TCS230 *MD_TCS230::_capture = NULL;
+
 void MD_TCS230::initialise(void)
 // initialize all object variables
 {
@@ -33,6 +45,11 @@ void MD_TCS230::initialise(void)
   _S3 = NO_PIN;
   _readDiv = 10;
   _freqSet = TCS230_FREQ_HI;
+  _OUT = NO_PIN;
+  _capPeriods = 8;
+  _capTime = 2000;
+  _lastSeq = 0;
+  _pubSeq = 0;
 
   for (uint8_t i=0; i<RGB_SIZE; i++)
   {
@@ -103,12 +120,28 @@ void MD_TCS230::setFilter(uint8_t f)
   DUMPS("\nsetFilter ");
   switch (f)
   {
-  case TCS230_RGB_R:  DUMPS("R"); digitalWrite(_S2, LOW);   digitalWrite(_S3, LOW);   break;
-  case TCS230_RGB_G:  DUMPS("G"); digitalWrite(_S2, HIGH);  digitalWrite(_S3, HIGH);  break;
-  case TCS230_RGB_B:  DUMPS("B"); digitalWrite(_S2, LOW);   digitalWrite(_S3, HIGH);  break;
-  case TCS230_RGB_X:  DUMPS("X"); digitalWrite(_S2, HIGH);  digitalWrite(_S3, LOW);   break;
+  case TCS230_RGB_R:  DUMPS("R");  break;
+  case TCS230_RGB_G:  DUMPS("G");  break;
+  case TCS230_RGB_B:  DUMPS("B");  break;
+  case TCS230_RGB_X:  DUMPS("X");  break;
   default:  DUMP("Unknown filter option", f); break;
   }
+  selectFilter(f);
+}
+
+void TCS230_ISR_ATTR MD_TCS230::selectFilter(uint8_t f)
+// set the filter pins (also in interrupt context, so no debug output)
+{
+  if ((_S2 == NO_PIN) || (_S3 == NO_PIN))
+    return;
+
+  switch (f)
+  {
+  case TCS230_RGB_R:  digitalWrite(_S2, LOW);   digitalWrite(_S3, LOW);   break;
+  case TCS230_RGB_G:  digitalWrite(_S2, HIGH);  digitalWrite(_S3, HIGH);  break;
+  case TCS230_RGB_B:  digitalWrite(_S2, LOW);   digitalWrite(_S3, HIGH);  break;
+  case TCS230_RGB_X:  digitalWrite(_S2, HIGH);  digitalWrite(_S3, LOW);   break;
+  }
 }
 
 void MD_TCS230::setFrequency2(uint8_t f)
@@ -238,12 +271,48 @@ uint32_t MD_TCS230::readSingle(void)
 void MD_TCS230::read(void)
 // initiate the finite state machine for reading a value
 {
+  if (_OUT != NO_PIN)   // background capture is always reading
+    return;
+
   _readState = readFSM(0);
 }
 
 bool MD_TCS230::available(void)
 // check if a value is ready. Called repeatedly until it is!
 {
+  if (_OUT != NO_PIN)
+  {
+    uint16_t count[RGB_SIZE];
+    uint32_t span[RGB_SIZE];
+    uint16_t seq;
+
+    noInterrupts();
+    // a dark filter may not produce the edges to close its window
+    uint32_t now = micros();
+    if (now - _capStart > 1000000UL / _readDiv)
+      captureNext(now);
+    seq = _pubSeq;
+    for (uint8_t i=0; i<RGB_SIZE; i++)
+    {
+      count[i] = _pubCount[i];
+      span[i] = _pubSpan[i];
+    }
+    interrupts();
+
+    if (seq == _lastSeq)
+      return(false);
+    _lastSeq = seq;
+
+    DUMP("\nCapture ", seq);
+    for (uint8_t i=0; i<RGB_SIZE; i++)
+    {
+      _Fo.value[i] = (span[i] == 0 ? 0 : (count[i] * 1000000UL + span[i] / 2) / span[i]);
+      DUMP(" ", _Fo.value[i]);
+    }
+    RGBTransformation();
+    return(true);
+  }
+
   _readState = readFSM(_readState);
 
   return(_readState == 0);
@@ -299,6 +368,129 @@ uint8_t MD_TCS230::readFSM(uint8_t s)
   return(s);
 }
 
+bool MD_TCS230::beginCapture(uint8_t out)
+// start measuring R, G and B periods in the background
+{
+#ifdef NOT_AN_INTERRUPT
+  if (digitalPinToInterrupt(out) == NOT_AN_INTERRUPT)
+    return(false);
+#endif
+
+  if (_capture != NULL)
+    _capture->endCapture();   // only one OUT interrupt handler
+
+  DUMP("\nbeginCapture ", out);
+  pinMode(out, INPUT);
+  setEnable(true);
+
+  noInterrupts();
+  _OUT = out;
+  _capChannel = TCS230_RGB_R;
+  selectFilter(TCS230_RGB_R);
+  _capEdges = 0;
+  _capStart = micros();
+  _lastSeq = _pubSeq;
+  _capture = this;
+  interrupts();
+  attachInterrupt(digitalPinToInterrupt(out), captureISR, RISING);
+
+  return(true);
+}
+
+void MD_TCS230::endCapture(void)
+// stop the background measurement
+{
+  if (_OUT == NO_PIN)
+    return;
+
+  DUMPS("\nendCapture");
+  detachInterrupt(digitalPinToInterrupt(_OUT));
+  _capture = NULL;
+  _OUT = NO_PIN;
+  setEnable(false);
+}
+
+void MD_TCS230::setCaptureWindow(uint16_t periods, uint16_t us)
+// set the minimum periods and time measured for each filter
+{
+  _capPeriods = (periods > 0 ? min(periods, (uint16_t)TCS230_CAPTURE_MAX) : _capPeriods);
+  _capTime = us;
+}
+
+uint16_t MD_TCS230::getSequence(void)
+// sequence number of the last complete capture
+{
+  uint16_t seq;
+
+  noInterrupts();
+  seq = _pubSeq;
+  interrupts();
+
+  return(seq);
+}
+
+void TCS230_ISR_ATTR MD_TCS230::captureISR(void)
+// OUT pin rising edge
+{
+  if (_capture != NULL)
+    _capture->captureEdge(micros());
+}
+
+void TCS230_ISR_ATTR MD_TCS230::captureEdge(uint32_t now)
+// time one period of the sensor output (interrupt context)
+{
+  uint16_t e = _capEdges + 1;
+
+  _capEdges = e;
+  _capLast = now;
+
+  // the first edge after a filter change may still be at the old frequency,
+  // the window opens on the second one
+  if (e == 2)
+    _capFirst = now;
+  else if (e > 2)
+  {
+    uint16_t periods = e - 2;
+
+    if (periods >= _capPeriods && (now - _capFirst >= _capTime || periods >= TCS230_CAPTURE_MAX))
+      captureNext(now);
+  }
+}
+
+void TCS230_ISR_ATTR MD_TCS230::captureNext(uint32_t now)
+// store the window of the current filter and move to the next one,
+// publishing R, G and B together once B is done (interrupts disabled)
+{
+  uint8_t ch = _capChannel;
+
+  if (_capEdges > 2)
+  {
+    _capCount[ch] = _capEdges - 2;
+    _capSpan[ch] = _capLast - _capFirst;
+  }
+  else
+  {
+    _capCount[ch] = 0;
+    _capSpan[ch] = 0;
+  }
+
+  if (++ch == RGB_SIZE)
+  {
+    for (uint8_t i=0; i<RGB_SIZE; i++)
+    {
+      _pubCount[i] = _capCount[i];
+      _pubSpan[i] = _capSpan[i];
+    }
+    _pubSeq++;
+    ch = TCS230_RGB_R;
+  }
+
+  _capChannel = ch;
+  selectFilter(ch); // TCS230_RGB_R, _G and _B are the channel indices
+  _capEdges = 0;
+  _capStart = now;
+}
+
 void MD_TCS230::RGBTransformation(void)
 // Exploiting linear relationship to remap the range 
 {
@@ -236,6 +236,9 @@ library; if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fi
 Boston, MA 02110-1301  USA
 
 \page pageVersion Revision History
+Oct 2026 version 1.3.0
+- Added background period capture from pin change interrupts.
+
 Jul 2018 version 1.2.3
 - Updated various text files and documentation
 
@@ -540,6 +543,64 @@ class MD_TCS230
    */
   uint32_t readSingle(void);
   /** @} */
+
+  //--------------------------------------------------------------
+  /** \name Methods for background period capture.
+   * @{
+   */
+  /**
+   * Start measuring in the background from pin change interrupts.
+   *
+   * Instead of counting cycles over a FreqCount gate, each filter is measured
+   * by timing whole output periods on the OUT pin, which must support
+   * attachInterrupt(). The window lasts at least the number of periods and 
+   * the time set by setCaptureWindow(), so bright colors are measured in a 
+   * short time and dark ones over more time, and the R, G and B filters are 
+   * cycled by the interrupt itself. No timer is used, so FreqCount pins and 
+   * PWM stay available.
+   *
+   * Every edge is an interrupt, so use the TCS230_FREQ_LO (2%) or
+   * TCS230_FREQ_MID (20%) prescaler. While capturing, read() does nothing and 
+   * available() returns true once for each new complete RGB result.
+   *
+   * \param out  Arduino input pin connected to sensor OUT output.
+   * \return false if the pin has no external interrupt.
+   */
+  bool beginCapture(uint8_t out);
+
+  /**
+   * Stop the background period capture.
+   *
+   * Detaches the interrupt and disables the sensor. read() and available()
+   * go back to FreqCount measurements.
+   */
+  void endCapture(void);
+
+  /**
+   * Set the background capture window.
+   *
+   * Each filter is measured over at least the given number of output periods
+   * and at least the given time, whichever takes longer. A filter showing 
+   * no output for the sampling period set with setSampling() reads 0.
+   *
+   * The default is 8 periods and 2000us.
+   *
+   * \param periods  Minimum number of output periods.
+   * \param us       Minimum window length in microseconds.
+   */
+  void setCaptureWindow(uint16_t periods, uint16_t us);
+
+  /**
+   * Get the sequence number of the last capture.
+   *
+   * The number is incremented by the interrupt each time a complete R, G and 
+   * B capture is published, and tells which capture the values returned by 
+   * getRGB() and getRaw() after available() belong to.
+   *
+   * \return the sequence number of the last published capture.
+   */
+  uint16_t getSequence(void);
+  /** @} */
   
   private:
   uint8_t _OE;      ///< output enable pin
@@ -561,6 +622,27 @@ class MD_TCS230
   uint8_t readFSM(uint8_t s);     ///< reading values fsm
   void  RGBTransformation(void);  ///< convert raw data to RGB
   void  setFrequency2(uint8_t f); ///< internal function for frequency prescaler
+
+  uint8_t  _OUT;                    ///< capture input pin or NO_PIN when not capturing
+  uint16_t _capPeriods;             ///< minimum periods in a capture window
+  uint16_t _capTime;                ///< minimum capture window in us
+  uint16_t _lastSeq;                ///< sequence number last returned by available()
+  volatile uint8_t  _capChannel;    ///< index of the filter being captured
+  volatile uint16_t _capEdges;      ///< edges seen since the filter was selected
+  volatile uint32_t _capStart;      ///< time the filter was selected
+  volatile uint32_t _capFirst;      ///< time of the edge opening the window
+  volatile uint32_t _capLast;       ///< time of the latest edge
+  volatile uint16_t _capCount[RGB_SIZE]; ///< periods in the window, per filter
+  volatile uint32_t _capSpan[RGB_SIZE];  ///< window length in us, per filter
+  volatile uint16_t _pubCount[RGB_SIZE]; ///< last published periods
+  volatile uint32_t _pubSpan[RGB_SIZE];  ///< last published window lengths
+  volatile uint16_t _pubSeq;        ///< sequence number of the published capture
+
+  static MD_TCS230 *_capture;       ///< instance owning the capture interrupt
+  static void captureISR(void);     ///< OUT pin interrupt handler
+  void  captureEdge(uint32_t now);  ///< time one edge of the OUT signal
+  void  captureNext(uint32_t now);  ///< close the window and select the next filter
+  void  selectFilter(uint8_t f);    ///< set the S2 and S3 pins, no debug output so it is safe in the interrupt
 };
 
 #endif
@@ -0,0 +1,212 @@
+/*
+ * UltrasonicScheduler.cpp
+ *
+ * Non-blocking ranging for several ultrasonic modules.
+ *
+ * Released into the MIT License.
+ */
+
+#if ARDUINO >= 100
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+
+#include "UltrasonicScheduler.h"
+
+#if defined(ESP8266) || defined(ESP32)
+  #define ULTRASONIC_ISR_ATTR IRAM_ATTR
+#else
+  #define ULTRASONIC_ISR_ATTR
+#endif
+
+#define STATE_IDLE 0
+#define STATE_WAIT_RISE 1
+#define STATE_WAIT_FALL 2
+#define STATE_DONE 3
+
+UltrasonicScheduler *UltrasonicScheduler::active = NULL;
+
+UltrasonicScheduler::UltrasonicScheduler(unsigned long timeOut) {
+  timeout = timeOut;
+  state = STATE_IDLE;
+}
+
+/*
+ * Returns the index used to read the sensor back, or -1 when
+ * ULTRASONIC_MAX_SENSORS are already registered.
+ */
+int UltrasonicScheduler::add(uint8_t trigPin, uint8_t echoPin) {
+  if (sensorCount >= ULTRASONIC_MAX_SENSORS)
+    return -1;
+
+  Sensor &s = sensors[sensorCount];
+  s.trig = trigPin;
+  s.echo = echoPin;
+  s.interrupt = digitalPinToInterrupt(echoPin) != NOT_AN_INTERRUPT;
+  s.filled = 0;
+  s.next = 0;
+  s.stamp = 0;
+  pinMode(trigPin, OUTPUT);
+  pinMode(echoPin, INPUT);
+  return sensorCount++;
+}
+
+/*
+ * Only one scheduler can own the echo interrupt, starting another one
+ * stops this one.
+ */
+void UltrasonicScheduler::begin() {
+  if (active != NULL && active != this)
+    active->end();
+  active = this;
+  running = true;
+  current = 0;
+  state = STATE_IDLE;
+  lastEnd = micros() - pingGap;
+}
+
+void UltrasonicScheduler::end() {
+  if (running && state != STATE_IDLE && sensors[current].interrupt)
+    detachInterrupt(digitalPinToInterrupt(sensors[current].echo));
+  running = false;
+  state = STATE_IDLE;
+  if (active == this)
+    active = NULL;
+}
+
+/*
+ * Call as often as possible from loop(). Finishes the pending measurement
+ * and starts the next one, never waiting for an echo. Echo pins without an
+ * external interrupt are sampled here instead, so their resolution is the
+ * loop period.
+ */
+void UltrasonicScheduler::update() {
+  if (!running || sensorCount == 0)
+    return;
+
+  if (state == STATE_IDLE) {
+    if (micros() - lastEnd >= pingGap)
+      ping();
+    return;
+  }
+
+  Sensor &s = sensors[current];
+  if (!s.interrupt)
+    edge(micros());
+
+  uint8_t st = state;
+  if (st == STATE_DONE) {
+    finish(fallMicros - riseMicros);
+  } else if (st == STATE_WAIT_RISE) {
+    if (micros() - pingMicros > timeout)
+      finish(timeout);
+  } else if (micros() - riseMicros > timeout) {
+    finish(timeout);
+  }
+}
+
+void UltrasonicScheduler::ping() {
+  Sensor &s = sensors[current];
+
+  if (s.trig == s.echo)
+    pinMode(s.trig, OUTPUT);
+  digitalWrite(s.trig, LOW);
+  delayMicroseconds(2);
+  digitalWrite(s.trig, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(s.trig, LOW);
+  if (s.trig == s.echo)
+    pinMode(s.trig, INPUT);
+
+  pingMicros = micros();
+  state = STATE_WAIT_RISE;
+  if (s.interrupt)
+    attachInterrupt(digitalPinToInterrupt(s.echo), echoChange, CHANGE);
+}
+
+/*
+ * A timed out echo is stored as the timeout, like Ultrasonic::read() does.
+ */
+void UltrasonicScheduler::finish(unsigned long duration) {
+  Sensor &s = sensors[current];
+
+  if (s.interrupt)
+    detachInterrupt(digitalPinToInterrupt(s.echo));
+  if (duration > timeout)
+    duration = timeout;
+
+  s.history[s.next] = duration;
+  s.next = (s.next + 1) % ULTRASONIC_MEDIAN_SIZE;
+  if (s.filled < ULTRASONIC_MEDIAN_SIZE)
+    s.filled++;
+  s.stamp = millis();
+
+  state = STATE_IDLE;
+  lastEnd = micros();
+  current = (current + 1) % sensorCount;
+}
+
+/*
+ * The pin level rather than the interrupt tells a rising edge from a
+ * falling one, so a stale interrupt flag raised before the ping is harmless.
+ */
+void ULTRASONIC_ISR_ATTR UltrasonicScheduler::edge(unsigned long now) {
+  bool high = digitalRead(sensors[current].echo);
+
+  if (state == STATE_WAIT_RISE && high) {
+    riseMicros = now;
+    state = STATE_WAIT_FALL;
+  } else if (state == STATE_WAIT_FALL && !high) {
+    fallMicros = now;
+    state = STATE_DONE;
+  }
+}
+
+void ULTRASONIC_ISR_ATTR UltrasonicScheduler::echoChange() {
+  if (active != NULL)
+    active->edge(micros());
+}
+
+/*
+ * Filters the newest readings with a median of up to size values,
+ * 1 turns the filter off.
+ */
+void UltrasonicScheduler::setMedian(uint8_t size) {
+  medianSize = constrain(size, 1, ULTRASONIC_MEDIAN_SIZE);
+}
+
+/*
+ * Echo duration in microseconds of the latest readings, median filtered
+ * when enabled, or 0 before the first reading.
+ */
+unsigned int UltrasonicScheduler::timing(uint8_t index) {
+  if (index >= sensorCount || sensors[index].filled == 0)
+    return 0;
+
+  Sensor &s = sensors[index];
+  uint8_t n = min(medianSize, s.filled);
+  unsigned int window[ULTRASONIC_MEDIAN_SIZE];
+  for (uint8_t i = 0; i < n; i++) {
+    unsigned int v = s.history[(s.next + ULTRASONIC_MEDIAN_SIZE - 1 - i) % ULTRASONIC_MEDIAN_SIZE];
+    uint8_t j = i;
+    for (; j > 0 && window[j - 1] > v; j--)
+      window[j] = window[j - 1];
+    window[j] = v;
+  }
+  return window[n / 2];
+}
+
+unsigned int UltrasonicScheduler::read(uint8_t index, uint8_t und) {
+  return timing(index) / und / 2;
+}
+
+/*
+ * Milliseconds since the latest reading of the sensor finished,
+ * or ULTRASONIC_NEVER before the first one.
+ */
+unsigned long UltrasonicScheduler::age(uint8_t index) {
+  if (index >= sensorCount || sensors[index].filled == 0)
+    return ULTRASONIC_NEVER;
+  return millis() - sensors[index].stamp;
+}
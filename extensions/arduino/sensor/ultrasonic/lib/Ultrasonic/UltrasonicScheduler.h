@@ -0,0 +1,75 @@
+/*
+ * UltrasonicScheduler.h
+ *
+ * Non-blocking ranging for several ultrasonic modules. Sensors are pinged
+ * one at a time in the order they were added, so one module never hears the
+ * echo of another, and the echo edges are timestamped from a pin change
+ * interrupt while loop() keeps running.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef UltrasonicScheduler_h
+#define UltrasonicScheduler_h
+
+#include "Ultrasonic.h"
+
+#ifndef ULTRASONIC_MAX_SENSORS
+#define ULTRASONIC_MAX_SENSORS 4
+#endif
+
+/*
+ * Largest median filter window, in readings
+ */
+#define ULTRASONIC_MEDIAN_SIZE 5
+
+#define ULTRASONIC_NEVER 0xFFFFFFFFUL
+
+class UltrasonicScheduler {
+  public:
+    UltrasonicScheduler(unsigned long timeOut = 20000UL);
+    int add(uint8_t sigPin) {return add(sigPin, sigPin);}
+    int add(uint8_t trigPin, uint8_t echoPin);
+    void begin();
+    void end();
+    void update();
+    unsigned int read(uint8_t index, uint8_t und = CM);
+    unsigned int timing(uint8_t index);
+    unsigned long age(uint8_t index);
+    uint8_t count() {return sensorCount;}
+    void setTimeout(unsigned long timeOut) {timeout = timeOut;}
+    void setPingGap(unsigned long gap) {pingGap = gap;}
+    void setMedian(uint8_t size);
+
+  private:
+    struct Sensor {
+      uint8_t trig;
+      uint8_t echo;
+      bool interrupt;
+      uint8_t filled;
+      uint8_t next;
+      unsigned long stamp;
+      unsigned int history[ULTRASONIC_MEDIAN_SIZE];
+    };
+
+    Sensor sensors[ULTRASONIC_MAX_SENSORS];
+    uint8_t sensorCount = 0;
+    uint8_t current = 0;
+    uint8_t medianSize = 1;
+    bool running = false;
+    unsigned long timeout;
+    unsigned long pingGap = 0;
+    unsigned long lastEnd = 0;
+    volatile uint8_t state;
+    volatile unsigned long riseMicros;
+    volatile unsigned long fallMicros;
+    unsigned long pingMicros;
+
+    void ping();
+    void finish(unsigned long duration);
+    void edge(unsigned long now);
+    static void echoChange();
+    static UltrasonicScheduler *active;
+};
+
+#endif // UltrasonicScheduler_h
@@ -0,0 +1,176 @@
+/*
+ * Arduino.h
+ *
+ * Host build of the Arduino core API, enough for the libraries in this tree
+ * to compile unmodified with g++ and run against the virtual clock, pins and
+ * device models of HostSim.h. It behaves like an AVR board with 64 bit
+ * unsigned long, without __AVR__ so libraries take their portable paths.
+ * Build with -DESP32 for the ESP32 additions (ESP, attachInterruptArg,
+ * timers), with -D__AVR__ for the ATmega328 registers of HostAvr.h.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#include "avr/pgmspace.h"
+#include "binary.h"
+
+#ifndef ARDUINO
+#define ARDUINO 10819
+#endif
+
+#ifndef F_CPU
+#define F_CPU 16000000L
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define EULER 2.718281828459045235360287471352
+
+#define SERIAL  0x0
+#define DISPLAY 0x1
+
+// an enum as in the ArduinoCore-API cores, libraries pass it as BitOrder
+typedef enum {
+  LSBFIRST = 0,
+  MSBFIRST = 1
+} BitOrder;
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define NOT_AN_INTERRUPT -1
+
+#define DEFAULT 1
+#define EXTERNAL 0
+
+#define LED_BUILTIN 13
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+// pins of the host board
+#define NUM_DIGITAL_PINS 64
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+
+#define interrupts() host_interrupts()
+#define noInterrupts() host_noInterrupts()
+
+#define clockCyclesPerMicrosecond() ( F_CPU / 1000000L )
+#define clockCyclesToMicroseconds(a) ( (a) / clockCyclesPerMicrosecond() )
+#define microsecondsToClockCycles(a) ( (a) * clockCyclesPerMicrosecond() )
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitToggle(value, bit) ((value) ^= (1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+
+#ifndef _BV
+#define _BV(b) (1 << (b))
+#endif
+
+typedef unsigned int word;
+typedef bool boolean;
+typedef uint8_t byte;
+
+void host_interrupts(void);
+void host_noInterrupts(void);
+
+void init(void);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void analogWrite(uint8_t pin, int val);
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+unsigned long pulseInLong(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val);
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+uint16_t makeWord(uint16_t w);
+uint16_t makeWord(byte h, byte l);
+#define word(...) makeWord(__VA_ARGS__)
+
+/*
+ * min() and max() as functions, the AVR macros break the C++ headers the
+ * tests include after Arduino.h
+ */
+template<class T, class L>
+auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+
+template<class T, class L>
+auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+
+#include "WCharacter.h"
+#include "WString.h"
+#include "HardwareSerial.h"
+
+#ifdef ESP32
+#include "HostEsp.h"
+#endif
+
+#ifdef __AVR__
+#include "HostAvr.h"
+#endif
+
+#endif // Arduino_h
@@ -0,0 +1,42 @@
+/*
+ * HardwareSerial.h
+ *
+ * Serial of the host core. What the sketch writes is kept for
+ * host::serialOutput() and echoed to stdout with host::setSerialEcho().
+ * Writes are buffered as on the boards, so they cost no virtual time.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <inttypes.h>
+#include "Stream.h"
+
+#define SERIAL_8N1 0x06
+#define SERIAL_8E1 0x26
+#define SERIAL_8O1 0x36
+#define SERIAL_8N2 0x0E
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) {begin(baud, SERIAL_8N1);}
+    void begin(unsigned long baud, uint8_t config) {(void)config; _baud = baud;}
+    void end() {_baud = 0;}
+    virtual int available(void);
+    virtual int peek(void);
+    virtual int read(void);
+    virtual int availableForWrite(void) {return 64;}
+    virtual void flush(void) {}
+    virtual size_t write(uint8_t);
+    using Print::write;
+    operator bool() {return true;}
+
+  private:
+    unsigned long _baud = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HardwareSerial_h
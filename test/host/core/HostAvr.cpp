@@ -0,0 +1,98 @@
+/*
+ * HostAvr.cpp
+ *
+ * Built into the AVR variant of the host core only.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "HostSim.h"
+
+extern "C" void TIMER1_COMPA_vect(void) __attribute__((weak));
+
+namespace host {
+
+static void timer1Written();
+static void timer1CountWritten();
+
+AvrStatusRegister avrSreg;
+volatile uint8_t avrPorts[3];
+AvrRegister avrTccr1a(timer1Written);
+AvrRegister avrTccr1b(timer1Written);
+AvrRegister avrTcnt1(timer1CountWritten);
+AvrRegister avrOcr1a(timer1Written);
+AvrRegister avrTifr1;
+AvrRegister avrTimsk1(timer1Written);
+
+// when TCNT1 was 0, in ns
+static uint64_t timer1Origin = 0;
+// bumped on every write, a match scheduled before it is stale
+static uint64_t timer1Generation = 0;
+static std::function<void(uint16_t)> timer1Watcher;
+
+AvrStatusRegister::operator uint8_t() const {
+  return interruptsEnabled() ? 0x80 : 0;
+}
+
+AvrStatusRegister &AvrStatusRegister::operator=(uint8_t v) {
+  if (v & 0x80)
+    host_interrupts();
+  else
+    host_noInterrupts();
+  return *this;
+}
+
+static unsigned timer1Prescaler() {
+  static const unsigned prescalers[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+  return prescalers[avrTccr1b & 7];
+}
+
+static uint64_t timer1Ns(uint64_t counts) {
+  return counts * timer1Prescaler() * 1000000000ULL / F_CPU;
+}
+
+static void scheduleTimer1();
+
+/*
+ * In CTC mode the counter clears at the match, the interrupt runs after and
+ * an OCR1A it writes is the top of the period that just began
+ */
+static void timer1Match() {
+  timer1Origin = nowNs();
+  interrupt([]() {
+    if (TIMER1_COMPA_vect != NULL)
+      TIMER1_COMPA_vect();
+    if (timer1Watcher)
+      timer1Watcher(avrOcr1a);
+    scheduleTimer1();
+  });
+}
+
+static void scheduleTimer1() {
+  uint64_t generation = ++timer1Generation;
+  if (timer1Prescaler() == 0 || !(avrTimsk1 & _BV(OCIE1A)))
+    return;
+  uint64_t at = timer1Origin + timer1Ns((uint64_t)avrOcr1a + 1);
+  if (at < nowNs())
+    at = nowNs();
+  scheduleNs(at, [generation]() {
+    if (timer1Generation == generation)
+      timer1Match();
+  });
+}
+
+static void timer1Written() {
+  scheduleTimer1();
+}
+
+static void timer1CountWritten() {
+  timer1Origin = nowNs() - timer1Ns(avrTcnt1);
+  scheduleTimer1();
+}
+
+void watchTimer1(std::function<void(uint16_t)> fn) {
+  timer1Watcher = fn;
+}
+
+}
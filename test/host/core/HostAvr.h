@@ -0,0 +1,88 @@
+/*
+ * HostAvr.h
+ *
+ * The ATmega328 additions of the host core, included by Arduino.h with
+ * -D__AVR__: the status register, the port registers of an Uno and Timer1.
+ * cli() and SREG turn the interrupts of the host core off and on. Writes to
+ * the port registers stay in them, they do not reach the pins. Timer1
+ * counts F_CPU through its prescaler in CTC mode and runs TIMER1_COMPA_vect
+ * at the compare match.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HostAvr_h
+#define HostAvr_h
+
+#include <stdint.h>
+#include <functional>
+
+namespace host {
+
+// an I/O register, a write reaches the peripheral it belongs to
+class AvrRegister {
+  public:
+    explicit AvrRegister(void (*onWrite)(void) = NULL) : value(0), written(onWrite) {}
+    operator uint16_t() const {return value;}
+    AvrRegister &operator=(uint16_t v) {
+      value = v;
+      if (written != NULL)
+        written();
+      return *this;
+    }
+    AvrRegister &operator|=(uint16_t v) {return *this = value | v;}
+    AvrRegister &operator&=(uint16_t v) {return *this = value & v;}
+
+  private:
+    AvrRegister(const AvrRegister &);
+    uint16_t value;
+    void (*written)(void);
+};
+
+// the I bit is whether the host core takes interrupts
+class AvrStatusRegister {
+  public:
+    operator uint8_t() const;
+    AvrStatusRegister &operator=(uint8_t v);
+};
+
+extern AvrStatusRegister avrSreg;
+extern volatile uint8_t avrPorts[3];
+extern AvrRegister avrTccr1a, avrTccr1b, avrTcnt1, avrOcr1a, avrTifr1, avrTimsk1;
+
+// called after each TIMER1_COMPA_vect, with the OCR1A it left
+void watchTimer1(std::function<void(uint16_t ocr1a)> fn);
+
+}
+
+#define SREG host::avrSreg
+#define cli() host_noInterrupts()
+#define sei() host_interrupts()
+
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+// Uno pins: 0 to 7 on port D, 8 to 13 on port B, A0 to A5 on port C
+#define digitalPinToPort(P) ((P) < 8 ? PD : (P) < 14 ? PB : (P) < 20 ? PC : NOT_A_PORT)
+#define digitalPinToBitMask(P) ((uint8_t)_BV((P) < 8 ? (P) : (P) < 14 ? (P) - 8 : (P) - 14))
+#define portOutputRegister(P) (&host::avrPorts[(P) - PB])
+
+#define TCCR1A host::avrTccr1a
+#define TCCR1B host::avrTccr1b
+#define TCNT1 host::avrTcnt1
+#define OCR1A host::avrOcr1a
+#define TIFR1 host::avrTifr1
+#define TIMSK1 host::avrTimsk1
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define OCIE1A 1
+#define OCF1A 1
+
+#endif // HostAvr_h
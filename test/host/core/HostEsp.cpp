@@ -0,0 +1,141 @@
+/*
+ * HostEsp.cpp
+ *
+ * Built into the ESP32 variant of the host core only.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "HostSim.h"
+
+EspClass ESP;
+
+uint32_t EspClass::getCycleCount() {
+  uint32_t cycles = (uint32_t)(host::nowNs() * getCpuFreqMHz() / 1000);
+  host::tick();
+  return cycles;
+}
+
+void attachInterruptArg(uint8_t pin, void (*userFunc)(void *), void *arg, int mode) {
+  host::attachIsr(digitalPinToInterrupt(pin), NULL, userFunc, arg, mode);
+}
+
+void optimistic_yield(uint32_t interval_us) {
+  (void)interval_us;
+}
+
+/*
+ * Takes the time of an analog conversion, the IDF default measurement is
+ * of the same order
+ */
+uint16_t touchRead(uint8_t pin) {
+  return analogRead(pin);
+}
+
+struct hw_timer_s {
+  uint8_t num;
+  uint16_t divider;
+  bool started;
+  // when the counter was 0, in ns
+  uint64_t origin;
+  uint64_t alarm;
+  bool autoreload;
+  bool alarmEnabled;
+  void (*fn)(void);
+  // bumped on every change, an alarm scheduled before it is stale
+  uint64_t generation;
+};
+
+static hw_timer_t timers[4];
+
+static uint64_t timerNs(hw_timer_t *timer, uint64_t ticks) {
+  return ticks * timer->divider * 1000000000ULL / APB_CLK_FREQ;
+}
+
+static void scheduleAlarm(hw_timer_t *timer);
+
+/*
+ * The counter restarts from 0 at an autoreload alarm, the interrupt runs
+ * after and an alarm it writes applies to the period that just began
+ */
+static void alarm(hw_timer_t *timer) {
+  if (timer->autoreload)
+    timer->origin = host::nowNs();
+  else
+    timer->alarmEnabled = false;
+  host::interrupt([timer]() {
+    if (timer->fn != NULL)
+      timer->fn();
+    scheduleAlarm(timer);
+  });
+}
+
+static void scheduleAlarm(hw_timer_t *timer) {
+  uint64_t generation = ++timer->generation;
+  if (!timer->started || !timer->alarmEnabled)
+    return;
+  uint64_t at = timer->origin + timerNs(timer, timer->alarm);
+  if (at < host::nowNs())
+    at = host::nowNs();
+  host::scheduleNs(at, [timer, generation]() {
+    if (timer->generation == generation)
+      alarm(timer);
+  });
+}
+
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+  (void)countUp;
+  if (num >= 4 || divider < 2)
+    return NULL;
+  hw_timer_t *timer = &timers[num];
+  *timer = hw_timer_t();
+  timer->num = num;
+  timer->divider = divider;
+  timer->started = true;
+  timer->origin = host::nowNs();
+  return timer;
+}
+
+void timerEnd(hw_timer_t *timer) {
+  timer->started = false;
+  scheduleAlarm(timer);
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*fn)(void), bool edge) {
+  (void)edge;
+  timer->fn = fn;
+}
+
+void timerDetachInterrupt(hw_timer_t *timer) {
+  timer->fn = NULL;
+}
+
+void timerWrite(hw_timer_t *timer, uint64_t val) {
+  timer->origin = host::nowNs() - timerNs(timer, val);
+  scheduleAlarm(timer);
+}
+
+uint64_t timerRead(hw_timer_t *timer) {
+  return (host::nowNs() - timer->origin) * APB_CLK_FREQ / timer->divider / 1000000000ULL;
+}
+
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarm_value, bool autoreload) {
+  timer->alarm = alarm_value;
+  timer->autoreload = autoreload;
+  scheduleAlarm(timer);
+}
+
+void timerAlarmEnable(hw_timer_t *timer) {
+  timer->alarmEnabled = true;
+  scheduleAlarm(timer);
+}
+
+void timerAlarmDisable(hw_timer_t *timer) {
+  timer->alarmEnabled = false;
+  scheduleAlarm(timer);
+}
+
+bool timerAlarmEnabled(hw_timer_t *timer) {
+  return timer->alarmEnabled;
+}
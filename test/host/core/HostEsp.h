@@ -0,0 +1,50 @@
+/*
+ * HostEsp.h
+ *
+ * The ESP32 additions of the host core, included by Arduino.h with -DESP32.
+ * The CPU runs at 240 MHz of virtual time, reading the cycle counter ticks
+ * the clock like micros() does. The four hardware timers count the 80 MHz
+ * APB clock through their divider and run their interrupt at the alarm.
+ * touchRead() reads the value set with host::setAnalog().
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HostEsp_h
+#define HostEsp_h
+
+#include <stdint.h>
+#include "esp_attr.h"
+
+#define APB_CLK_FREQ 80000000
+
+#define _min(a, b) ((a) < (b) ? (a) : (b))
+#define _max(a, b) ((a) > (b) ? (a) : (b))
+
+class EspClass {
+  public:
+    uint32_t getCpuFreqMHz() {return 240;}
+    uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+void attachInterruptArg(uint8_t pin, void (*userFunc)(void *), void *arg, int mode);
+void optimistic_yield(uint32_t interval_us);
+// the value host::setAnalog() sets on the pin, lower while touched
+uint16_t touchRead(uint8_t pin);
+
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t *timer);
+void timerAttachInterrupt(hw_timer_t *timer, void (*fn)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t *timer);
+void timerWrite(hw_timer_t *timer, uint64_t val);
+uint64_t timerRead(hw_timer_t *timer);
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarm_value, bool autoreload);
+void timerAlarmEnable(hw_timer_t *timer);
+void timerAlarmDisable(hw_timer_t *timer);
+bool timerAlarmEnabled(hw_timer_t *timer);
+
+#endif // HostEsp_h
@@ -0,0 +1,697 @@
+/*
+ * HostSim.cpp
+ *
+ * The virtual clock, pins, interrupts and device registries of the host
+ * core, and the Arduino functions built on them.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "HostSim.h"
+#include "Profiler.h"
+#include "SoftwareSerial.h"
+
+#include <deque>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace host {
+
+struct Event {
+  uint64_t at;
+  uint64_t seq;
+  std::function<void()> fn;
+};
+
+struct Later {
+  bool operator()(const Event &a, const Event &b) const {
+    return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+  }
+};
+
+struct Pin {
+  uint8_t mode = INPUT;
+  int out = LOW;
+  int drv = FLOATING;
+  int pull = FLOATING;
+  int level = LOW;
+  int analog = 0;
+  int pwm = 0;
+  // tone() frequency, and when its duration ends in ns, 0 for never
+  unsigned int tone = 0;
+  uint64_t toneEnd = 0;
+  std::vector<std::function<void(uint8_t, int)> > watchers;
+  std::vector<uint8_t> links;
+};
+
+struct Isr {
+  void (*fn)(void) = NULL;
+  void (*argFn)(void *) = NULL;
+  void *arg = NULL;
+  // the mode it was last attached for, flags latch on it while detached
+  int mode = CHANGE;
+  bool attached = false;
+  bool flag = false;
+  bool pending = false;
+};
+
+static std::priority_queue<Event, std::vector<Event>, Later> events;
+static uint64_t clockNs = 0;
+static uint64_t eventSeq = 0;
+static uint32_t autoTick = 1000;
+static bool advancing = false;
+
+static Pin pins[NUM_DIGITAL_PINS];
+static Isr isrs[NUM_DIGITAL_PINS];
+static int pinIsr[NUM_DIGITAL_PINS];
+static bool irqEnabled = true;
+static bool irqLatch = false;
+static bool inIsr = false;
+// interrupts of timers and other peripherals waiting for interrupts()
+static std::deque<std::function<void()> > pendingIsrs;
+
+static std::map<uint8_t, I2CDevice *> i2cDevices;
+static uint64_t i2cStart = 0;
+static uint64_t i2cBit = 0;
+static std::map<uint8_t, SPIDevice *> spiDevices;
+static std::map<uint8_t, UARTDevice *> uartDevices;
+
+static std::string serialOut;
+static std::deque<uint8_t> serialIn;
+static bool serialEcho = false;
+
+static void defaultInterruptPins() {
+  for (int i = 0; i < NUM_DIGITAL_PINS; i++)
+    pinIsr[i] = i;
+}
+
+static struct Init {
+  Init() {defaultInterruptPins();}
+} defaults;
+
+/*
+ * Events may read the clock and so tick it, a nested advance only moves the
+ * clock and leaves the events to the outer loop
+ */
+static void advanceToNs(uint64_t target) {
+  if (advancing) {
+    if (target > clockNs)
+      clockNs = target;
+    return;
+  }
+  advancing = true;
+  while (!events.empty() && events.top().at <= target) {
+    Event e = events.top();
+    events.pop();
+    if (e.at > clockNs)
+      clockNs = e.at;
+    e.fn();
+  }
+  if (target > clockNs)
+    clockNs = target;
+  advancing = false;
+}
+
+uint64_t now() {
+  return clockNs / 1000;
+}
+
+uint64_t nowNs() {
+  return clockNs;
+}
+
+void advance(uint64_t us) {
+  advanceToNs(clockNs + us * 1000);
+}
+
+void advanceNs(uint64_t ns) {
+  advanceToNs(clockNs + ns);
+}
+
+void advanceTo(uint64_t us) {
+  advanceToNs(us * 1000);
+}
+
+void schedule(uint64_t atUs, std::function<void()> fn) {
+  scheduleNs(atUs * 1000, fn);
+}
+
+void scheduleNs(uint64_t atNs, std::function<void()> fn) {
+  events.push(Event{atNs, eventSeq++, fn});
+}
+
+void setAutoTick(uint32_t ns) {
+  autoTick = ns;
+}
+
+void tick() {
+  if (autoTick != 0)
+    advanceNs(autoTick);
+}
+
+/*
+ * Blocks until the pin reads the level, false at the deadline
+ */
+static bool waitLevel(uint8_t pin, int lvl, uint64_t deadline) {
+  while (level(pin) != lvl) {
+    if (clockNs >= deadline)
+      return false;
+    uint64_t next = deadline;
+    if (!events.empty() && events.top().at < next)
+      next = events.top().at > clockNs ? events.top().at : clockNs + 1;
+    advanceToNs(next);
+  }
+  return true;
+}
+
+static void runHandler(const std::function<void()> &fn) {
+  bool was = irqEnabled;
+  inIsr = true;
+  irqEnabled = false;
+  fn();
+  irqEnabled = was;
+  inIsr = false;
+}
+
+static void runIsr(int n) {
+  Isr &q = isrs[n];
+  runHandler([&q]() {
+    if (q.argFn != NULL)
+      q.argFn(q.arg);
+    else if (q.fn != NULL)
+      q.fn();
+  });
+}
+
+static void runPending() {
+  for (int n = 0; n < NUM_DIGITAL_PINS && irqEnabled && !inIsr; n++) {
+    if (isrs[n].pending && isrs[n].attached) {
+      isrs[n].pending = false;
+      runIsr(n);
+    }
+  }
+  while (!pendingIsrs.empty() && irqEnabled && !inIsr) {
+    std::function<void()> fn = pendingIsrs.front();
+    pendingIsrs.pop_front();
+    runHandler(fn);
+  }
+}
+
+static void fire(int n) {
+  if (!irqEnabled || inIsr) {
+    isrs[n].pending = true;
+    return;
+  }
+  runIsr(n);
+  runPending();
+}
+
+static void edge(uint8_t pin, int lvl) {
+  int n = pinIsr[pin];
+  if (n < 0)
+    return;
+  Isr &q = isrs[n];
+  bool match = q.mode == CHANGE || (q.mode == RISING && lvl == HIGH)
+    || ((q.mode == FALLING || q.mode == LOW) && lvl == LOW);
+  if (!match)
+    return;
+  if (!q.attached) {
+    if (irqLatch)
+      q.flag = true;
+    return;
+  }
+  fire(n);
+}
+
+static int compute(const Pin &p) {
+  if (p.mode == OUTPUT)
+    return p.out;
+  if (p.drv != FLOATING)
+    return p.drv;
+  if (p.mode == INPUT_PULLUP)
+    return HIGH;
+  if (p.pull != FLOATING)
+    return p.pull;
+  return LOW;
+}
+
+static void update(uint8_t pin) {
+  Pin &p = pins[pin];
+  int lvl = compute(p);
+  if (lvl == p.level)
+    return;
+  p.level = lvl;
+
+  std::map<uint8_t, SPIDevice *>::iterator spi = spiDevices.find(pin);
+  if (spi != spiDevices.end())
+    spi->second->spiSelect(lvl == LOW);
+  std::vector<uint8_t> links = p.links;
+  for (size_t i = 0; i < links.size(); i++)
+    drive(links[i], lvl);
+  std::vector<std::function<void(uint8_t, int)> > watchers = p.watchers;
+  for (size_t i = 0; i < watchers.size(); i++)
+    watchers[i](pin, lvl);
+  edge(pin, lvl);
+}
+
+void drive(uint8_t pin, int lvl) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  pins[pin].drv = lvl == FLOATING ? FLOATING : (lvl ? HIGH : LOW);
+  update(pin);
+}
+
+void setPull(uint8_t pin, int lvl) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  pins[pin].pull = lvl == FLOATING ? FLOATING : (lvl ? HIGH : LOW);
+  update(pin);
+}
+
+int level(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? pins[pin].level : LOW;
+}
+
+uint8_t mode(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? pins[pin].mode : INPUT;
+}
+
+bool isOutput(uint8_t pin) {
+  return mode(pin) == OUTPUT;
+}
+
+void watch(uint8_t pin, std::function<void(uint8_t, int)> fn) {
+  if (pin < NUM_DIGITAL_PINS)
+    pins[pin].watchers.push_back(fn);
+}
+
+void connect(uint8_t from, uint8_t to) {
+  if (from >= NUM_DIGITAL_PINS || to >= NUM_DIGITAL_PINS)
+    return;
+  pins[from].links.push_back(to);
+  drive(to, pins[from].level);
+}
+
+void setAnalog(uint8_t pin, int value) {
+  if (pin < NUM_DIGITAL_PINS)
+    pins[pin].analog = value;
+}
+
+int analogOut(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? pins[pin].pwm : 0;
+}
+
+unsigned int toneOut(uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return 0;
+  if (pins[pin].toneEnd != 0 && clockNs >= pins[pin].toneEnd)
+    return 0;
+  return pins[pin].tone;
+}
+
+void setInterruptPins(std::initializer_list<uint8_t> list) {
+  int n = 0;
+  for (int i = 0; i < NUM_DIGITAL_PINS; i++)
+    pinIsr[i] = NOT_AN_INTERRUPT;
+  for (std::initializer_list<uint8_t>::const_iterator i = list.begin(); i != list.end(); ++i) {
+    if (*i < NUM_DIGITAL_PINS)
+      pinIsr[*i] = n++;
+  }
+}
+
+void setInterruptFlagLatch(bool on) {
+  irqLatch = on;
+}
+
+bool interruptsEnabled() {
+  return irqEnabled && !inIsr;
+}
+
+void interrupt(std::function<void()> fn) {
+  if (!irqEnabled || inIsr) {
+    pendingIsrs.push_back(fn);
+    return;
+  }
+  runHandler(fn);
+  runPending();
+}
+
+void attachIsr(int n, void (*fn)(void), void (*argFn)(void *), void *arg, int mode) {
+  if (n < 0 || n >= NUM_DIGITAL_PINS)
+    return;
+  Isr &q = isrs[n];
+  q.fn = fn;
+  q.argFn = argFn;
+  q.arg = arg;
+  q.mode = mode;
+  q.attached = true;
+  q.pending = false;
+  if (q.flag) {
+    q.flag = false;
+    fire(n);
+  }
+}
+
+void attachI2C(uint8_t address, I2CDevice *dev) {
+  i2cDevices[address] = dev;
+}
+
+void detachI2C(uint8_t address) {
+  i2cDevices.erase(address);
+}
+
+I2CDevice *i2cDevice(uint8_t address) {
+  std::map<uint8_t, I2CDevice *>::iterator i = i2cDevices.find(address);
+  return i == i2cDevices.end() ? NULL : i->second;
+}
+
+/*
+ * The start bit, then 9 bits each for the address and the bytes before
+ */
+uint64_t i2cByteNs(size_t i) {
+  return i2cStart + (1 + 9 * (2 + i)) * i2cBit;
+}
+
+void i2cTransfer(uint64_t startNs, uint64_t bitNs) {
+  i2cStart = startNs;
+  i2cBit = bitNs;
+}
+
+void attachSPI(uint8_t csPin, SPIDevice *dev) {
+  spiDevices[csPin] = dev;
+  dev->spiSelect(level(csPin) == LOW);
+}
+
+void detachSPI(uint8_t csPin) {
+  spiDevices.erase(csPin);
+}
+
+/*
+ * The selected devices share MISO, their outputs are ANDed like open lines
+ */
+uint8_t spiExchange(uint8_t out) {
+  uint8_t in = 0xFF;
+  for (std::map<uint8_t, SPIDevice *>::iterator i = spiDevices.begin(); i != spiDevices.end(); ++i) {
+    if (level(i->first) == LOW)
+      in &= i->second->spiTransfer(out);
+  }
+  return in;
+}
+
+void attachUART(uint8_t txPin, UARTDevice *dev) {
+  uartDevices[txPin] = dev;
+}
+
+void detachUART(uint8_t txPin) {
+  uartDevices.erase(txPin);
+}
+
+void uartDeliver(uint8_t txPin, uint8_t b) {
+  std::map<uint8_t, UARTDevice *>::iterator i = uartDevices.find(txPin);
+  if (i != uartDevices.end())
+    i->second->uartReceive(b);
+}
+
+void uartSend(uint8_t rxPin, const uint8_t *data, size_t len, uint32_t delayUs, uint32_t baud) {
+  uint64_t byteNs = 10 * 1000000000ULL / (baud != 0 ? baud : 9600);
+  uint64_t t = clockNs + delayUs * 1000ULL;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b = data[i];
+    t += byteNs;
+    scheduleNs(t, [rxPin, b]() {SoftwareSerial::receive(rxPin, b);});
+  }
+}
+
+void uartSend(uint8_t rxPin, const char *text, uint32_t delayUs, uint32_t baud) {
+  uartSend(rxPin, (const uint8_t *)text, strlen(text), delayUs, baud);
+}
+
+std::string serialOutput(bool clear) {
+  std::string s = serialOut;
+  if (clear)
+    serialOut.clear();
+  return s;
+}
+
+void serialInput(const char *text) {
+  while (*text)
+    serialIn.push_back((uint8_t)*text++);
+}
+
+void setSerialEcho(bool on) {
+  serialEcho = on;
+}
+
+void reset() {
+  while (!events.empty())
+    events.pop();
+  clockNs = 0;
+  eventSeq = 0;
+  autoTick = 1000;
+  for (int i = 0; i < NUM_DIGITAL_PINS; i++) {
+    pins[i] = Pin();
+    isrs[i] = Isr();
+  }
+  defaultInterruptPins();
+  irqEnabled = true;
+  irqLatch = false;
+  inIsr = false;
+  pendingIsrs.clear();
+  i2cDevices.clear();
+  spiDevices.clear();
+  uartDevices.clear();
+  serialOut.clear();
+  serialIn.clear();
+  Profiler::reset();
+}
+
+}
+
+using host::clockNs;
+using host::pins;
+
+HardwareSerial Serial;
+
+int HardwareSerial::available(void) {
+  return host::serialIn.size();
+}
+
+int HardwareSerial::peek(void) {
+  return host::serialIn.empty() ? -1 : host::serialIn.front();
+}
+
+int HardwareSerial::read(void) {
+  if (host::serialIn.empty())
+    return -1;
+  int c = host::serialIn.front();
+  host::serialIn.pop_front();
+  return c;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  host::serialOut += (char)c;
+  if (host::serialEcho)
+    putchar(c);
+  return 1;
+}
+
+void host_interrupts(void) {
+  host::irqEnabled = true;
+  host::runPending();
+}
+
+void host_noInterrupts(void) {
+  host::irqEnabled = false;
+}
+
+void init(void) {}
+
+void yield(void) {}
+
+/*
+ * As on AVR, writing an input switches its pull-up and pinMode(INPUT)
+ * clears it
+ */
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  host::Pin &p = pins[pin];
+  p.mode = mode;
+  if (mode == INPUT_PULLUP)
+    p.out = HIGH;
+  else if (mode == INPUT)
+    p.out = LOW;
+  host::update(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  host::Pin &p = pins[pin];
+  p.out = val ? HIGH : LOW;
+#ifndef ESP32
+  if (p.mode != OUTPUT)
+    p.mode = val ? INPUT_PULLUP : INPUT;
+#endif
+  host::update(pin);
+}
+
+int digitalRead(uint8_t pin) {
+  int lvl = host::level(pin);
+  host::tick();
+  return lvl;
+}
+
+/*
+ * Takes the conversion time of an AVR
+ */
+int analogRead(uint8_t pin) {
+  host::advance(112);
+  return pin < NUM_DIGITAL_PINS ? pins[pin].analog : 0;
+}
+
+void analogReference(uint8_t mode) {
+  (void)mode;
+}
+
+void analogWrite(uint8_t pin, int val) {
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  pins[pin].pwm = val;
+  pinMode(pin, OUTPUT);
+  if (val <= 0)
+    digitalWrite(pin, LOW);
+  else if (val >= 255)
+    digitalWrite(pin, HIGH);
+}
+
+unsigned long millis(void) {
+  unsigned long t = clockNs / 1000000;
+  host::tick();
+  return t;
+}
+
+unsigned long micros(void) {
+  unsigned long t = clockNs / 1000;
+  host::tick();
+  return t;
+}
+
+void delay(unsigned long ms) {
+  uint64_t start = clockNs;
+  host::advanceNs(ms * 1000000ULL);
+  host::Profiler::record(host::PROFILE_DELAY, 0, 0, start, clockNs - start);
+}
+
+void delayMicroseconds(unsigned int us) {
+  uint64_t start = clockNs;
+  host::advanceNs(us * 1000ULL);
+  host::Profiler::record(host::PROFILE_DELAY, 0, 0, start, clockNs - start);
+}
+
+/*
+ * Waits for the pin to leave the state, then for the pulse, all within the
+ * timeout. Counted as a delay, the sketch blocks all the time.
+ */
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+  uint64_t start = clockNs;
+  uint64_t deadline = start + timeout * 1000ULL;
+  int lvl = state ? HIGH : LOW;
+  unsigned long width = 0;
+
+  if (host::waitLevel(pin, !lvl, deadline) && host::waitLevel(pin, lvl, deadline)) {
+    uint64_t rise = clockNs;
+    if (host::waitLevel(pin, !lvl, deadline))
+      width = (clockNs - rise) / 1000;
+  }
+  host::Profiler::record(host::PROFILE_DELAY, 0, 0, start, clockNs - start);
+  return width;
+}
+
+unsigned long pulseInLong(uint8_t pin, uint8_t state, unsigned long timeout) {
+  return pulseIn(pin, state, timeout);
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
+  for (uint8_t i = 0; i < 8; i++) {
+    if (bitOrder == LSBFIRST)
+      digitalWrite(dataPin, !!(val & (1 << i)));
+    else
+      digitalWrite(dataPin, !!(val & (1 << (7 - i))));
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    digitalWrite(clockPin, HIGH);
+    if (bitOrder == LSBFIRST)
+      value |= digitalRead(dataPin) << i;
+    else
+      value |= digitalRead(dataPin) << (7 - i);
+    digitalWrite(clockPin, LOW);
+  }
+  return value;
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS ? host::pinIsr[pin] : NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
+  host::attachIsr(interruptNum, userFunc, NULL, NULL, mode);
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+  if (interruptNum < NUM_DIGITAL_PINS) {
+    host::isrs[interruptNum].attached = false;
+    host::isrs[interruptNum].pending = false;
+  }
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+  pinMode(pin, OUTPUT);
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  pins[pin].tone = frequency;
+  pins[pin].toneEnd = duration ? clockNs + duration * 1000000ULL : 0;
+}
+
+void noTone(uint8_t pin) {
+  if (pin < NUM_DIGITAL_PINS)
+    pins[pin].tone = 0;
+  digitalWrite(pin, LOW);
+}
+
+long random(long howbig) {
+  if (howbig == 0)
+    return 0;
+  return rand() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig)
+    return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0)
+    srand(seed);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+uint16_t makeWord(uint16_t w) {
+  return w;
+}
+
+uint16_t makeWord(byte h, byte l) {
+  return (h << 8) | l;
+}
@@ -0,0 +1,141 @@
+/*
+ * HostSim.h
+ *
+ * Controls for the host Arduino core: the virtual clock, the pins seen by
+ * device models and the buses the models attach to. Tests include this next
+ * to the library under test, libraries only see Arduino.h, Wire.h and SPI.h.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HostSim_h
+#define HostSim_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+namespace host {
+
+/*
+ * Virtual clock. Time only moves when the code under test waits (delay(),
+ * a bus transfer, a byte on a serial line) or reads the clock, so busy loops
+ * on millis() or micros() end. Scheduled events run when the clock passes
+ * their time, in time order, like interrupts.
+ */
+uint64_t now();
+uint64_t nowNs();
+void advance(uint64_t us);
+void advanceNs(uint64_t ns);
+void advanceTo(uint64_t us);
+void schedule(uint64_t atUs, std::function<void()> fn);
+void scheduleNs(uint64_t atNs, std::function<void()> fn);
+// nanoseconds each micros(), millis() and digitalRead() call adds, 1000 by
+// default, 0 keeps the clock still between waits
+void setAutoTick(uint32_t ns);
+
+/*
+ * Pins. A pin reads what the sketch drives when it is an OUTPUT, else what
+ * a model drives, else its pull-up or pull-down.
+ */
+const int FLOATING = -1;
+void drive(uint8_t pin, int level);   // level or FLOATING to release
+void setPull(uint8_t pin, int level); // board resistor, FLOATING for none
+int level(uint8_t pin);
+uint8_t mode(uint8_t pin);
+bool isOutput(uint8_t pin);
+// called after every level change of the pin, with the new level
+void watch(uint8_t pin, std::function<void(uint8_t pin, int level)> fn);
+// the level of from drives to, like a wire between the two pins
+void connect(uint8_t from, uint8_t to);
+void setAnalog(uint8_t pin, int value);
+int analogOut(uint8_t pin);
+// the frequency tone() plays on the pin now, 0 when silent
+unsigned int toneOut(uint8_t pin);
+
+/*
+ * Interrupts. By default every pin has its own interrupt, as on ESP32.
+ * Restrict them to match a board, e.g. {2, 3} for an Uno.
+ */
+void setInterruptPins(std::initializer_list<uint8_t> pins);
+// AVR keeps an edge seen while the interrupt was off in its flag, and the
+// interrupt fires as soon as it is attached
+void setInterruptFlagLatch(bool on);
+bool interruptsEnabled();
+// runs fn as the interrupt of a timer or other peripheral, at once or when
+// interrupts() turns them back on
+void interrupt(std::function<void()> fn);
+
+/*
+ * I2C devices answer at their 7 bit address on every TwoWire
+ */
+class I2CDevice {
+  public:
+    virtual ~I2CDevice() {}
+    // one write, after the address was acked, false NACKs the data
+    virtual bool i2cWrite(const uint8_t *data, size_t len, bool stop) = 0;
+    // fills up to len bytes, the rest read as 0xFF
+    virtual size_t i2cRead(uint8_t *buf, size_t len) = 0;
+};
+
+void attachI2C(uint8_t address, I2CDevice *dev);
+void detachI2C(uint8_t address);
+I2CDevice *i2cDevice(uint8_t address);
+// while a device is called: when byte i of its write or read was acked, the
+// whole transfer is handed over at its start
+uint64_t i2cByteNs(size_t i);
+
+/*
+ * SPI devices are selected while their chip select pin is low
+ */
+class SPIDevice {
+  public:
+    virtual ~SPIDevice() {}
+    virtual void spiSelect(bool selected) {(void)selected;}
+    virtual uint8_t spiTransfer(uint8_t out) = 0;
+};
+
+void attachSPI(uint8_t csPin, SPIDevice *dev);
+void detachSPI(uint8_t csPin);
+uint8_t spiExchange(uint8_t out);
+
+/*
+ * Serial lines. A device on the TX pin of a SoftwareSerial receives every
+ * byte the sketch sends, uartSend() delivers bytes to the SoftwareSerial
+ * listening on the pin, one byte time apart.
+ */
+class UARTDevice {
+  public:
+    virtual ~UARTDevice() {}
+    virtual void uartReceive(uint8_t b) = 0;
+};
+
+void attachUART(uint8_t txPin, UARTDevice *dev);
+void detachUART(uint8_t txPin);
+void uartSend(uint8_t rxPin, const uint8_t *data, size_t len,
+              uint32_t delayUs = 0, uint32_t baud = 9600);
+void uartSend(uint8_t rxPin, const char *text, uint32_t delayUs = 0, uint32_t baud = 9600);
+
+// what the sketch wrote to Serial, and input for Serial to read
+std::string serialOutput(bool clear = true);
+void serialInput(const char *text);
+void setSerialEcho(bool on);
+
+/*
+ * Used by the core
+ */
+void tick();
+void uartDeliver(uint8_t txPin, uint8_t b);
+void i2cTransfer(uint64_t startNs, uint64_t bitNs);
+void attachIsr(int num, void (*fn)(void), void (*argFn)(void *), void *arg, int mode);
+
+/*
+ * Back to time 0 with no devices, events or pin states
+ */
+void reset();
+
+}
+
+#endif // HostSim_h
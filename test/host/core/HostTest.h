@@ -0,0 +1,43 @@
+/*
+ * HostTest.h
+ *
+ * Checks for the host tests. A failed CHECK prints the line and counts,
+ * the test returns testResult() from main().
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HostTest_h
+#define HostTest_h
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      testFailures++; \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long long checkA = (long long)(a), checkB = (long long)(b); \
+    if (checkA != checkB) { \
+      testFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+              __FILE__, __LINE__, #a, #b, checkA, checkB); \
+    } \
+  } while (0)
+
+static inline int testResult(const char *name) {
+  if (testFailures != 0)
+    fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures);
+  else
+    printf("%s: ok\n", name);
+  return testFailures != 0;
+}
+
+#endif // HostTest_h
@@ -0,0 +1,40 @@
+/*
+ * IPAddress.h
+ *
+ * The IPv4 address of the AVR core, without printing.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+class IPAddress {
+  public:
+    IPAddress() : address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : address((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t address) : address(address) {}
+
+    operator uint32_t() const {return address;}
+    bool operator==(const IPAddress &other) const {return address == other.address;}
+    bool operator!=(const IPAddress &other) const {return address != other.address;}
+    uint8_t operator[](int index) const {return address >> (8 * index);}
+
+    String toString() const {
+      char text[16];
+      snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+      return String(text);
+    }
+
+  private:
+    uint32_t address;
+};
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+#endif // IPAddress_h
@@ -0,0 +1,90 @@
+/*
+ * Print.h
+ *
+ * Same interface as the Arduino AVR core.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Print_h
+#define Print_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "WString.h"
+#include "Printable.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#ifdef BIN
+#undef BIN
+#endif
+#define BIN 2
+
+class Print {
+  private:
+    int write_error = 0;
+    size_t printNumber(unsigned long long n, uint8_t base);
+    size_t printFloat(double number, uint8_t digits);
+
+  protected:
+    void setWriteError(int err = 1) {write_error = err;}
+
+  public:
+    Print() {}
+    virtual ~Print() {}
+
+    int getWriteError() {return write_error;}
+    void clearWriteError() {setWriteError(0);}
+
+    virtual size_t write(uint8_t) = 0;
+    size_t write(const char *str) {
+      if (str == NULL)
+        return 0;
+      return write((const uint8_t *)str, strlen(str));
+    }
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *buffer, size_t size) {
+      return write((const uint8_t *)buffer, size);
+    }
+
+    virtual int availableForWrite() {return 0;}
+
+    size_t print(const __FlashStringHelper *);
+    size_t print(const String &);
+    size_t print(const char[]);
+    size_t print(char);
+    size_t print(unsigned char, int = DEC);
+    size_t print(int, int = DEC);
+    size_t print(unsigned int, int = DEC);
+    size_t print(long, int = DEC);
+    size_t print(unsigned long, int = DEC);
+    size_t print(long long, int = DEC);
+    size_t print(unsigned long long, int = DEC);
+    size_t print(double, int = 2);
+    size_t print(const Printable &);
+
+    size_t println(const __FlashStringHelper *);
+    size_t println(const String &s);
+    size_t println(const char[]);
+    size_t println(char);
+    size_t println(unsigned char, int = DEC);
+    size_t println(int, int = DEC);
+    size_t println(unsigned int, int = DEC);
+    size_t println(long, int = DEC);
+    size_t println(unsigned long, int = DEC);
+    size_t println(long long, int = DEC);
+    size_t println(unsigned long long, int = DEC);
+    size_t println(double, int = 2);
+    size_t println(const Printable &);
+    size_t println(void);
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    virtual void flush() {}
+};
+
+#endif // Print_h
@@ -0,0 +1,125 @@
+/*
+ * Profiler.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Profiler.h"
+#include "HostSim.h"
+
+#include <string.h>
+
+namespace host {
+
+std::vector<Profiler::Site> Profiler::sites;
+std::vector<Profiler::Frame> Profiler::stack;
+std::vector<ProfileRecord> Profiler::log;
+bool Profiler::keep = false;
+
+static const char *const OUTSIDE = "(no scope)";
+
+size_t Profiler::find(const char *name) {
+  for (size_t i = 0; i < sites.size(); i++) {
+    if (sites[i].name == name)
+      return i;
+  }
+  Site s;
+  s.name = name;
+  memset(&s.sum, 0, sizeof(s.sum));
+  sites.push_back(s);
+  return sites.size() - 1;
+}
+
+void Profiler::enter(const char *name) {
+  size_t i = find(name);
+  sites[i].sum.calls++;
+  stack.push_back(Frame{i, nowNs()});
+}
+
+void Profiler::leave() {
+  if (stack.empty())
+    return;
+  Frame f = stack.back();
+  stack.pop_back();
+  sites[f.site].sum.totalUs += (nowNs() - f.start) / 1000.0;
+}
+
+const char *Profiler::site() {
+  return stack.empty() ? OUTSIDE : sites[stack.back().site].name.c_str();
+}
+
+void Profiler::record(ProfileKind kind, uint8_t target, uint32_t bytes,
+                      uint64_t startNs, uint64_t durationNs, bool failed) {
+  size_t i = stack.empty() ? find(OUTSIDE) : stack.back().site;
+  ProfileSummary &s = sites[i].sum;
+
+  if (kind == PROFILE_DELAY) {
+    s.delays++;
+    s.delayUs += durationNs / 1000.0;
+  } else {
+    if (kind == PROFILE_I2C)
+      s.i2c++;
+    else if (kind == PROFILE_SPI)
+      s.spi++;
+    else
+      s.uart++;
+    if (failed)
+      s.errors++;
+    s.bytes += bytes;
+    s.busUs += durationNs / 1000.0;
+  }
+  if (keep)
+    log.push_back(ProfileRecord{sites[i].name, kind, target, bytes,
+                                failed, startNs, durationNs});
+}
+
+ProfileSummary Profiler::summary(const char *name) {
+  for (size_t i = 0; i < sites.size(); i++) {
+    if (sites[i].name == name)
+      return sites[i].sum;
+  }
+  ProfileSummary s;
+  memset(&s, 0, sizeof(s));
+  return s;
+}
+
+/*
+ * Everything recorded, the time inside scopes is left out as scopes nest
+ */
+ProfileSummary Profiler::total() {
+  ProfileSummary t;
+  memset(&t, 0, sizeof(t));
+  for (size_t i = 0; i < sites.size(); i++) {
+    const ProfileSummary &s = sites[i].sum;
+    t.calls += s.calls;
+    t.i2c += s.i2c;
+    t.spi += s.spi;
+    t.uart += s.uart;
+    t.errors += s.errors;
+    t.bytes += s.bytes;
+    t.delays += s.delays;
+    t.busUs += s.busUs;
+    t.delayUs += s.delayUs;
+  }
+  return t;
+}
+
+void Profiler::print(FILE *out) {
+  fprintf(out, "%-24s %6s %6s %6s %6s %5s %8s %6s %11s %11s %11s\n",
+          "site", "calls", "i2c", "spi", "uart", "err", "bytes", "delays",
+          "bus us", "delay us", "total us");
+  for (size_t i = 0; i < sites.size(); i++) {
+    const ProfileSummary &s = sites[i].sum;
+    fprintf(out, "%-24s %6u %6u %6u %6u %5u %8u %6u %11.1f %11.1f %11.1f\n",
+            sites[i].name.c_str(), s.calls, s.i2c, s.spi, s.uart, s.errors,
+            s.bytes, s.delays, s.busUs, s.delayUs, s.totalUs);
+  }
+}
+
+void Profiler::reset() {
+  sites.clear();
+  stack.clear();
+  log.clear();
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Profiler.h
+ *
+ * Records every bus transaction, serial byte and delay of the host core with
+ * the call site it happened in. A call site is the innermost HOST_PROFILE()
+ * scope, so a test wraps each driver call it wants to measure:
+ *
+ *   { HOST_PROFILE("display"); oled.display(); }
+ *   host::Profiler::print();
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Profiler_h
+#define Profiler_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace host {
+
+enum ProfileKind {
+  PROFILE_I2C,
+  PROFILE_SPI,
+  PROFILE_UART,
+  PROFILE_DELAY
+};
+
+struct ProfileRecord {
+  std::string site;
+  ProfileKind kind;
+  // I2C address or UART TX pin, 0 for SPI and delays
+  uint8_t target;
+  uint32_t bytes;
+  bool failed;
+  uint64_t start;     // ns
+  uint64_t duration;  // ns
+};
+
+struct ProfileSummary {
+  uint32_t calls;
+  uint32_t i2c;
+  uint32_t spi;
+  uint32_t uart;
+  uint32_t errors;
+  uint32_t bytes;
+  uint32_t delays;
+  double busUs;
+  double delayUs;
+  // time spent inside the scope, nested scopes included
+  double totalUs;
+};
+
+class Profiler {
+  public:
+    static void record(ProfileKind kind, uint8_t target, uint32_t bytes,
+                       uint64_t startNs, uint64_t durationNs, bool failed = false);
+    static void enter(const char *site);
+    static void leave();
+    static const char *site();
+
+    static ProfileSummary summary(const char *site);
+    static ProfileSummary total();
+    static const std::vector<ProfileRecord> &records() {return log;}
+    // keep every record, off by default, summaries are always kept
+    static void keepRecords(bool on) {keep = on;}
+    static void print(FILE *out = stdout);
+    static void reset();
+
+  private:
+    struct Site {
+      std::string name;
+      ProfileSummary sum;
+    };
+    struct Frame {
+      size_t site;
+      uint64_t start;
+    };
+
+    static std::vector<Site> sites;
+    static std::vector<Frame> stack;
+    static std::vector<ProfileRecord> log;
+    static bool keep;
+
+    static size_t find(const char *name);
+};
+
+class ProfileScope {
+  public:
+    ProfileScope(const char *site) {Profiler::enter(site);}
+    ~ProfileScope() {Profiler::leave();}
+};
+
+}
+
+#define HOST_PROFILE_CAT2(a, b) a##b
+#define HOST_PROFILE_CAT(a, b) HOST_PROFILE_CAT2(a, b)
+#define HOST_PROFILE(name) host::ProfileScope HOST_PROFILE_CAT(hostProfile, __LINE__)(name)
+
+#endif // Profiler_h
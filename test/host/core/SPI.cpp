@@ -0,0 +1,97 @@
+/*
+ * SPI.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "SPI.h"
+#include "HostSim.h"
+#include "Profiler.h"
+
+SPIClass SPI;
+
+void SPIClass::beginTransaction(SPISettings s) {
+  settings = s;
+  inTransaction = true;
+  transactionBytes = 0;
+  transactionBus = 0;
+  transactionStart = host::nowNs();
+}
+
+void SPIClass::endTransaction(void) {
+  if (!inTransaction)
+    return;
+  inTransaction = false;
+  if (transactionBytes != 0)
+    host::Profiler::record(host::PROFILE_SPI, 0, transactionBytes,
+                           transactionStart, transactionBus);
+}
+
+/*
+ * The divider of a 16 MHz AVR
+ */
+void SPIClass::setClockDivider(uint8_t clockDiv) {
+  static const uint8_t divider[] = {4, 16, 64, 128, 2, 8, 32, 64};
+  settings.clock = 16000000UL / divider[clockDiv & 7];
+}
+
+uint8_t SPIClass::exchange(uint8_t data) {
+  uint64_t t = 8 * 1000000000ULL / (settings.clock != 0 ? settings.clock : 4000000);
+  bool lsb = settings.bitOrder == LSBFIRST;
+  uint8_t out = data;
+
+  if (lsb) {
+    out = 0;
+    for (uint8_t i = 0; i < 8; i++)
+      out |= ((data >> i) & 1) << (7 - i);
+  }
+  uint8_t in = host::spiExchange(out);
+  if (lsb) {
+    uint8_t r = 0;
+    for (uint8_t i = 0; i < 8; i++)
+      r |= ((in >> i) & 1) << (7 - i);
+    in = r;
+  }
+  host::advanceNs(t);
+  transactionBytes++;
+  transactionBus += t;
+  return in;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  bool own = !inTransaction;
+  if (own)
+    beginTransaction(settings);
+  uint8_t in = exchange(data);
+  if (own)
+    endTransaction();
+  return in;
+}
+
+uint16_t SPIClass::transfer16(uint16_t data) {
+  bool own = !inTransaction;
+  uint8_t hi, lo;
+  if (own)
+    beginTransaction(settings);
+  if (settings.bitOrder == LSBFIRST) {
+    lo = exchange(data & 0xFF);
+    hi = exchange(data >> 8);
+  } else {
+    hi = exchange(data >> 8);
+    lo = exchange(data & 0xFF);
+  }
+  if (own)
+    endTransaction();
+  return (uint16_t)hi << 8 | lo;
+}
+
+void SPIClass::transfer(void *buf, size_t count) {
+  bool own = !inTransaction;
+  uint8_t *p = (uint8_t *)buf;
+  if (own)
+    beginTransaction(settings);
+  for (size_t i = 0; i < count; i++)
+    p[i] = exchange(p[i]);
+  if (own)
+    endTransaction();
+}
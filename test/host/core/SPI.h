@@ -0,0 +1,78 @@
+/*
+ * SPI.h
+ *
+ * SPIClass of the host core. Each byte goes to the host::SPIDevice whose
+ * chip select pin is low and takes 8 clocks of the transaction's clock. A
+ * beginTransaction()/endTransaction() pair is one profiled transaction,
+ * transfers outside a transaction are one each.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <Arduino.h>
+
+#define SPI_HAS_TRANSACTION 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define SPI_CLOCK_DIV4 0x00
+#define SPI_CLOCK_DIV16 0x01
+#define SPI_CLOCK_DIV64 0x02
+#define SPI_CLOCK_DIV128 0x03
+#define SPI_CLOCK_DIV2 0x04
+#define SPI_CLOCK_DIV8 0x05
+#define SPI_CLOCK_DIV32 0x06
+
+#ifdef ESP32
+#define SPI_LSBFIRST 0
+#define SPI_MSBFIRST 1
+#endif
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+      : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    SPISettings() : SPISettings(4000000, MSBFIRST, SPI_MODE0) {}
+
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+  public:
+    void begin() {}
+    void end() {}
+    void usingInterrupt(uint8_t interruptNumber) {(void)interruptNumber;}
+    void notUsingInterrupt(uint8_t interruptNumber) {(void)interruptNumber;}
+    void beginTransaction(SPISettings settings);
+    void endTransaction(void);
+
+    uint8_t transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data);
+    void transfer(void *buf, size_t count);
+
+    void setBitOrder(uint8_t bitOrder) {settings.bitOrder = bitOrder;}
+    void setDataMode(uint8_t dataMode) {settings.dataMode = dataMode;}
+    void setClockDivider(uint8_t clockDiv);
+    void setFrequency(uint32_t freq) {settings.clock = freq;}
+
+  private:
+    SPISettings settings;
+    bool inTransaction = false;
+    uint32_t transactionBytes = 0;
+    uint64_t transactionStart = 0;
+    uint64_t transactionBus = 0;
+
+    uint8_t exchange(uint8_t data);
+};
+
+extern SPIClass SPI;
+
+#endif // _SPI_H_INCLUDED
@@ -0,0 +1,96 @@
+/*
+ * SoftwareSerial.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "SoftwareSerial.h"
+#include "HostSim.h"
+#include "Profiler.h"
+
+SoftwareSerial *SoftwareSerial::active = NULL;
+
+SoftwareSerial::SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverse_logic)
+  : receivePin(receivePin), transmitPin(transmitPin) {
+  (void)inverse_logic;
+}
+
+SoftwareSerial::~SoftwareSerial() {
+  end();
+}
+
+void SoftwareSerial::begin(long speed) {
+  this->speed = speed;
+  pinMode(transmitPin, OUTPUT);
+  digitalWrite(transmitPin, HIGH);
+  pinMode(receivePin, INPUT_PULLUP);
+  listen();
+}
+
+bool SoftwareSerial::listen() {
+  if (active == this)
+    return false;
+  head = tail = 0;
+  bufferOverflow = false;
+  active = this;
+  return true;
+}
+
+bool SoftwareSerial::stopListening() {
+  if (active != this)
+    return false;
+  active = NULL;
+  return true;
+}
+
+void SoftwareSerial::end() {
+  stopListening();
+}
+
+/*
+ * Only the listening port receives, as on AVR
+ */
+void SoftwareSerial::receive(uint8_t pin, uint8_t byte) {
+  SoftwareSerial *s = active;
+  if (s == NULL || s->receivePin != pin)
+    return;
+  uint8_t next = (s->tail + 1) % _SS_MAX_RX_BUFF;
+  if (next == s->head) {
+    s->bufferOverflow = true;
+    return;
+  }
+  s->buffer[s->tail] = byte;
+  s->tail = next;
+}
+
+int SoftwareSerial::read() {
+  if (head == tail)
+    return -1;
+  uint8_t d = buffer[head];
+  head = (head + 1) % _SS_MAX_RX_BUFF;
+  return d;
+}
+
+int SoftwareSerial::peek() {
+  if (head == tail)
+    return -1;
+  return buffer[head];
+}
+
+int SoftwareSerial::available() {
+  return (tail + _SS_MAX_RX_BUFF - head) % _SS_MAX_RX_BUFF;
+}
+
+size_t SoftwareSerial::write(uint8_t byte) {
+  if (speed == 0) {
+    setWriteError();
+    return 0;
+  }
+  uint64_t start = host::nowNs();
+  uint64_t t = 10 * 1000000000ULL / speed;
+  host::advanceNs(t);
+  host::Profiler::record(host::PROFILE_UART, transmitPin, 1, start, t);
+  host::uartDeliver(transmitPin, byte);
+  return 1;
+}
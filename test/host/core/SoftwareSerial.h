@@ -0,0 +1,59 @@
+/*
+ * SoftwareSerial.h
+ *
+ * SoftwareSerial of the host core. Sending blocks for 10 bit times per byte
+ * as the AVR library does with interrupts off, and hands the byte to the
+ * host::UARTDevice on the TX pin. Bytes from host::uartSend() arrive in the
+ * 64 byte buffer of the listening port.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef SoftwareSerial_h
+#define SoftwareSerial_h
+
+#include <inttypes.h>
+#include <Stream.h>
+
+#ifndef _SS_MAX_RX_BUFF
+#define _SS_MAX_RX_BUFF 64
+#endif
+
+class SoftwareSerial : public Stream {
+  public:
+    SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverse_logic = false);
+    ~SoftwareSerial();
+    void begin(long speed);
+    bool listen();
+    void end();
+    bool isListening() {return this == active;}
+    bool stopListening();
+    bool overflow() {bool ret = bufferOverflow; if (ret) bufferOverflow = false; return ret;}
+    int peek();
+
+    virtual size_t write(uint8_t byte);
+    virtual int read();
+    virtual int available();
+    virtual void flush() {}
+    operator bool() {return true;}
+
+    using Print::write;
+
+    // called by the host core for a byte arriving on the pin
+    static void receive(uint8_t pin, uint8_t byte);
+    uint8_t rxPin() {return receivePin;}
+    long baud() {return speed;}
+
+  private:
+    uint8_t receivePin;
+    uint8_t transmitPin;
+    long speed = 0;
+    uint8_t buffer[_SS_MAX_RX_BUFF];
+    volatile uint8_t head = 0;
+    volatile uint8_t tail = 0;
+    bool bufferOverflow = false;
+
+    static SoftwareSerial *active;
+};
+
+#endif // SoftwareSerial_h
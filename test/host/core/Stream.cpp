@@ -0,0 +1,177 @@
+/*
+ * Stream.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "Stream.h"
+
+int Stream::timedRead() {
+  int c;
+  _startMillis = millis();
+  do {
+    c = read();
+    if (c >= 0)
+      return c;
+    yield();
+  } while (millis() - _startMillis < _timeout);
+  return -1;
+}
+
+int Stream::timedPeek() {
+  int c;
+  _startMillis = millis();
+  do {
+    c = peek();
+    if (c >= 0)
+      return c;
+    yield();
+  } while (millis() - _startMillis < _timeout);
+  return -1;
+}
+
+int Stream::peekNextDigit(LookaheadMode lookahead, bool detectDecimal) {
+  int c;
+  for (;;) {
+    c = timedPeek();
+    if (c < 0 || c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.'))
+      return c;
+    switch (lookahead) {
+      case SKIP_NONE:
+        return -1;
+      case SKIP_WHITESPACE:
+        switch (c) {
+          case ' ':
+          case '\t':
+          case '\r':
+          case '\n':
+            break;
+          default:
+            return -1;
+        }
+      case SKIP_ALL:
+        break;
+    }
+    read();
+  }
+}
+
+bool Stream::findUntil(const char *target, size_t targetLen, const char *terminator, size_t termLen) {
+  size_t index = 0;
+  size_t termIndex = 0;
+  int c;
+
+  if (*target == 0)
+    return true;
+  while ((c = timedRead()) > 0) {
+    if (c == target[index]) {
+      if (++index >= targetLen)
+        return true;
+    } else {
+      index = c == target[0] ? 1 : 0;
+    }
+    if (termLen > 0 && c == terminator[termIndex]) {
+      if (++termIndex >= termLen)
+        return false;
+    } else {
+      termIndex = 0;
+    }
+  }
+  return false;
+}
+
+long Stream::parseInt(LookaheadMode lookahead, char ignore) {
+  bool isNegative = false;
+  long value = 0;
+  int c;
+
+  c = peekNextDigit(lookahead, false);
+  if (c < 0)
+    return 0;
+  do {
+    if (c == ignore)
+      ;
+    else if (c == '-')
+      isNegative = true;
+    else if (c >= '0' && c <= '9')
+      value = value * 10 + c - '0';
+    read();
+    c = timedPeek();
+  } while ((c >= '0' && c <= '9') || c == ignore);
+  return isNegative ? -value : value;
+}
+
+float Stream::parseFloat(LookaheadMode lookahead, char ignore) {
+  bool isNegative = false;
+  bool isFraction = false;
+  double value = 0.0;
+  int c;
+  double fraction = 1.0;
+
+  c = peekNextDigit(lookahead, true);
+  if (c < 0)
+    return 0;
+  do {
+    if (c == ignore)
+      ;
+    else if (c == '-')
+      isNegative = true;
+    else if (c == '.')
+      isFraction = true;
+    else if (c >= '0' && c <= '9') {
+      value = value * 10 + c - '0';
+      if (isFraction)
+        fraction *= 0.1;
+    }
+    read();
+    c = timedPeek();
+  } while ((c >= '0' && c <= '9') || (c == '.' && !isFraction) || c == ignore);
+  if (isNegative)
+    value = -value;
+  return isFraction ? value * fraction : value;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0)
+      break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+  size_t index = 0;
+  while (index < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator)
+      break;
+    *buffer++ = (char)c;
+    index++;
+  }
+  return index;
+}
+
+String Stream::readString() {
+  String ret;
+  int c = timedRead();
+  while (c >= 0) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return ret;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String ret;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return ret;
+}
@@ -0,0 +1,65 @@
+/*
+ * Stream.h
+ *
+ * Same interface as the Arduino AVR core. Timed reads wait on the virtual
+ * clock, so a read timeout costs no real time.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Stream_h
+#define Stream_h
+
+#include <inttypes.h>
+#include "Print.h"
+
+enum LookaheadMode {
+  SKIP_ALL,
+  SKIP_NONE,
+  SKIP_WHITESPACE
+};
+
+#define NO_IGNORE_CHAR '\x01'
+
+class Stream : public Print {
+  protected:
+    unsigned long _timeout;
+    unsigned long _startMillis;
+    int timedRead();
+    int timedPeek();
+    int peekNextDigit(LookaheadMode lookahead, bool detectDecimal);
+
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    Stream() {_timeout = 1000; _startMillis = 0;}
+
+    void setTimeout(unsigned long timeout) {_timeout = timeout;}
+    unsigned long getTimeout(void) {return _timeout;}
+
+    bool find(const char *target) {return findUntil(target, strlen(target), NULL, 0);}
+    bool find(const uint8_t *target) {return find((const char *)target);}
+    bool find(const char *target, size_t length) {return findUntil(target, length, NULL, 0);}
+    bool find(const uint8_t *target, size_t length) {return find((const char *)target, length);}
+    bool find(char target) {return find(&target, 1);}
+    bool findUntil(const char *target, const char *terminator)
+      {return findUntil(target, strlen(target), terminator, strlen(terminator));}
+    bool findUntil(const char *target, size_t targetLen, const char *terminate, size_t termLen);
+
+    long parseInt(LookaheadMode lookahead = SKIP_ALL, char ignore = NO_IGNORE_CHAR);
+    float parseFloat(LookaheadMode lookahead = SKIP_ALL, char ignore = NO_IGNORE_CHAR);
+
+    // virtual as in the ESP32 core, the AVR core does not care
+    virtual size_t readBytes(char *buffer, size_t length);
+    virtual size_t readBytes(uint8_t *buffer, size_t length) {return readBytes((char *)buffer, length);}
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+    size_t readBytesUntil(char terminator, uint8_t *buffer, size_t length)
+      {return readBytesUntil(terminator, (char *)buffer, length);}
+
+    String readString();
+    String readStringUntil(char terminator);
+};
+
+#endif // Stream_h
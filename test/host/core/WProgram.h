@@ -0,0 +1,9 @@
+/*
+ * WProgram.h
+ *
+ * Pre 1.0 name of Arduino.h.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
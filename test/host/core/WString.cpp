@@ -0,0 +1,148 @@
+/*
+ * WString.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+
+#include <algorithm>
+
+static std::string inBase(unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36)
+    base = 10;
+  std::string out;
+  do {
+    int digit = value % base;
+    out.insert(out.begin(), (char)(digit < 10 ? '0' + digit : 'a' + digit - 10));
+    value /= base;
+  } while (value != 0);
+  if (negative)
+    out.insert(out.begin(), '-');
+  return out;
+}
+
+static std::string signedInBase(long long value, unsigned char base) {
+  // only base 10 prints a sign, as in the Arduino core
+  if (base == 10 && value < 0)
+    return inBase(0ULL - (unsigned long long)value, true, base);
+  return inBase((unsigned long)value, false, base);
+}
+
+static std::string fixed(double value, unsigned char decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  return buf;
+}
+
+String::String(unsigned char value, unsigned char base) : s(inBase(value, false, base)) {}
+String::String(int value, unsigned char base) : s(signedInBase(value, base)) {}
+String::String(unsigned int value, unsigned char base) : s(inBase(value, false, base)) {}
+String::String(long value, unsigned char base) : s(signedInBase(value, base)) {}
+String::String(unsigned long value, unsigned char base) : s(inBase(value, false, base)) {}
+String::String(float value, unsigned char decimalPlaces) : s(fixed(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : s(fixed(value, decimalPlaces)) {}
+
+unsigned char String::equalsIgnoreCase(const String &str) const {
+  if (s.size() != str.s.size())
+    return 0;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (tolower((unsigned char)s[i]) != tolower((unsigned char)str.s[i]))
+      return 0;
+  }
+  return 1;
+}
+
+unsigned char String::endsWith(const String &suffix) const {
+  return s.size() >= suffix.s.size()
+    && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+char &String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= s.size()) {
+    dummy = 0;
+    return dummy;
+  }
+  return s[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const {
+  if (bufsize == 0 || buf == NULL)
+    return;
+  if (index >= s.size()) {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = std::min<size_t>(bufsize - 1, s.size() - index);
+  memcpy(buf, s.data() + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  size_t i = s.find(ch, fromIndex);
+  return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+  size_t i = s.find(str.s, fromIndex);
+  return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::lastIndexOf(char ch) const {
+  size_t i = s.rfind(ch);
+  return i == std::string::npos ? -1 : (int)i;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, s.size());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex)
+    std::swap(beginIndex, endIndex);
+  if (beginIndex >= s.size())
+    return String();
+  if (endIndex > s.size())
+    endIndex = s.size();
+  return String(s.substr(beginIndex, endIndex - beginIndex).c_str());
+}
+
+void String::replace(char find, char replace) {
+  std::replace(s.begin(), s.end(), find, replace);
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (find.s.empty())
+    return;
+  size_t i = 0;
+  while ((i = s.find(find.s, i)) != std::string::npos) {
+    s.replace(i, find.s.size(), replace.s);
+    i += replace.s.size();
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < s.size())
+    s.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (size_t i = 0; i < s.size(); i++)
+    s[i] = tolower((unsigned char)s[i]);
+}
+
+void String::toUpperCase() {
+  for (size_t i = 0; i < s.size(); i++)
+    s[i] = toupper((unsigned char)s[i]);
+}
+
+void String::trim() {
+  size_t b = 0;
+  while (b < s.size() && isspace((unsigned char)s[b]))
+    b++;
+  size_t e = s.size();
+  while (e > b && isspace((unsigned char)s[e - 1]))
+    e--;
+  s = s.substr(b, e - b);
+}
@@ -0,0 +1,109 @@
+/*
+ * WString.h
+ *
+ * Arduino String on top of std::string.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef String_class_h
+#define String_class_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+#include "avr/pgmspace.h"
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
+
+class String {
+  public:
+    String(const char *cstr = "") : s(cstr != NULL ? cstr : "") {}
+    String(const String &str) = default;
+    String(const __FlashStringHelper *str) : s(reinterpret_cast<const char *>(str)) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    String &operator=(const String &rhs) = default;
+    String &operator=(const char *cstr) {s = cstr != NULL ? cstr : ""; return *this;}
+
+    unsigned char reserve(unsigned int size) {s.reserve(size); return 1;}
+    unsigned int length() const {return s.size();}
+    const char *c_str() const {return s.c_str();}
+
+    unsigned char concat(const String &str) {s += str.s; return 1;}
+    unsigned char concat(const char *cstr) {if (cstr != NULL) s += cstr; return 1;}
+    unsigned char concat(char c) {s += c; return 1;}
+    unsigned char concat(unsigned char num) {return concat(String(num));}
+    unsigned char concat(int num) {return concat(String(num));}
+    unsigned char concat(unsigned int num) {return concat(String(num));}
+    unsigned char concat(long num) {return concat(String(num));}
+    unsigned char concat(unsigned long num) {return concat(String(num));}
+    unsigned char concat(float num) {return concat(String(num));}
+    unsigned char concat(double num) {return concat(String(num));}
+
+    template<class T>
+    String &operator+=(const T &rhs) {concat(rhs); return *this;}
+
+    int compareTo(const String &str) const {return s.compare(str.s);}
+    unsigned char equals(const String &str) const {return s == str.s;}
+    unsigned char equals(const char *cstr) const {return s == cstr;}
+    unsigned char equalsIgnoreCase(const String &str) const;
+    unsigned char startsWith(const String &prefix) const {return s.compare(0, prefix.s.size(), prefix.s) == 0;}
+    unsigned char endsWith(const String &suffix) const;
+    bool operator==(const String &rhs) const {return s == rhs.s;}
+    bool operator==(const char *cstr) const {return s == cstr;}
+    bool operator!=(const String &rhs) const {return s != rhs.s;}
+    bool operator!=(const char *cstr) const {return s != cstr;}
+    bool operator<(const String &rhs) const {return s < rhs.s;}
+
+    char charAt(unsigned int index) const {return index < s.size() ? s[index] : 0;}
+    void setCharAt(unsigned int index, char c) {if (index < s.size()) s[index] = c;}
+    char operator[](unsigned int index) const {return charAt(index);}
+    char &operator[](unsigned int index);
+    void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const
+      {getBytes((unsigned char *)buf, bufsize, index);}
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const String &str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(char find, char replace);
+    void replace(const String &find, const String &replace);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const {return atol(s.c_str());}
+    float toFloat() const {return (float)atof(s.c_str());}
+    double toDouble() const {return atof(s.c_str());}
+
+  private:
+    std::string s;
+};
+
+inline String operator+(const String &lhs, const String &rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, const char *rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const char *lhs, const String &rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, char rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, int rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, unsigned int rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, long rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, unsigned long rhs) {String r(lhs); r.concat(rhs); return r;}
+inline String operator+(const String &lhs, double rhs) {String r(lhs); r.concat(rhs); return r;}
+
+#endif // String_class_h
@@ -0,0 +1,109 @@
+/*
+ * Wire.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "HostSim.h"
+#include "Profiler.h"
+
+TwoWire Wire;
+
+uint64_t TwoWire::bitTime() {
+  return 1000000000ULL / (frequency != 0 ? frequency : 100000);
+}
+
+uint64_t TwoWire::busTime(unsigned bytes, bool stop) {
+  return (1 + 9 * (1 + bytes) + (stop ? 1 : 0)) * bitTime();
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  transmitting = true;
+  txAddress = address;
+  txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!transmitting)
+    return 0;
+  if (txLength >= BUFFER_LENGTH) {
+    setWriteError();
+    return 0;
+  }
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+  for (size_t i = 0; i < quantity; i++) {
+    if (!write(data[i]))
+      return i;
+  }
+  return quantity;
+}
+
+/*
+ * 0 success, 2 address NACK, 3 data NACK, as on AVR
+ */
+uint8_t TwoWire::endTransmission(uint8_t sendStop) {
+  host::I2CDevice *dev = host::i2cDevice(txAddress);
+  uint8_t ret = 0;
+  uint64_t start = host::nowNs();
+  uint64_t t;
+
+  if (dev == NULL) {
+    ret = 2;
+    t = busTime(0, true);
+  } else {
+    host::i2cTransfer(start, bitTime());
+    if (!dev->i2cWrite(txBuffer, txLength, sendStop))
+      ret = 3;
+    t = busTime(txLength, sendStop);
+  }
+  host::advanceNs(t);
+  host::Profiler::record(host::PROFILE_I2C, txAddress, txLength, start, t, ret != 0);
+  txLength = 0;
+  transmitting = false;
+  return ret;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop) {
+  host::I2CDevice *dev = host::i2cDevice(address);
+  uint64_t start = host::nowNs();
+  uint64_t t;
+
+  if (quantity > BUFFER_LENGTH)
+    quantity = BUFFER_LENGTH;
+  rxIndex = 0;
+  rxLength = 0;
+  if (dev == NULL) {
+    t = busTime(0, true);
+  } else {
+    host::i2cTransfer(start, bitTime());
+    size_t n = dev->i2cRead(rxBuffer, quantity);
+    for (size_t i = n; i < quantity; i++)
+      rxBuffer[i] = 0xFF;
+    rxLength = quantity;
+    t = busTime(quantity, sendStop);
+  }
+  host::advanceNs(t);
+  host::Profiler::record(host::PROFILE_I2C, address, rxLength, start, t, dev == NULL);
+  return rxLength;
+}
+
+/*
+ * Writes the internal address first, without a stop, like the AVR core
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddress, uint8_t isize, uint8_t sendStop) {
+  if (isize > 0) {
+    beginTransmission(address);
+    if (isize > 3)
+      isize = 3;
+    while (isize-- > 0)
+      write((uint8_t)(iaddress >> (isize * 8)));
+    endTransmission(false);
+  }
+  return requestFrom(address, quantity, sendStop);
+}
@@ -0,0 +1,79 @@
+/*
+ * Wire.h
+ *
+ * TwoWire of the host core, with the AVR buffer size and return codes.
+ * Transfers go to the host::I2CDevice attached at the address and take the
+ * bus time of their bits at the set clock: a start, 9 bits per byte with
+ * the address byte, and a stop when one is sent.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <inttypes.h>
+#include "Stream.h"
+
+#define BUFFER_LENGTH 32
+
+// the Wire has end() and the I2C clock can be set
+#define WIRE_HAS_END 1
+
+class TwoWire : public Stream {
+  public:
+    TwoWire() {}
+    void begin() {rxLength = rxIndex = 0; txLength = 0;}
+    void begin(uint8_t address) {(void)address; begin();}
+    void begin(int address) {begin((uint8_t)address);}
+    void end() {}
+    void setClock(uint32_t clock) {frequency = clock;}
+    uint32_t getClock() {return frequency;}
+    void setWireTimeout(uint32_t timeout = 25000, bool reset = false) {(void)timeout; (void)reset;}
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) {beginTransmission((uint8_t)address);}
+    uint8_t endTransmission(void) {return endTransmission(true);}
+    uint8_t endTransmission(uint8_t sendStop);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) {return requestFrom(address, quantity, (uint8_t)true);}
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddress, uint8_t isize, uint8_t sendStop);
+    uint8_t requestFrom(int address, int quantity) {return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)true);}
+    uint8_t requestFrom(int address, int quantity, int sendStop)
+      {return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)sendStop);}
+
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *, size_t);
+    virtual int available(void) {return rxLength - rxIndex;}
+    virtual int read(void) {return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;}
+    virtual int peek(void) {return rxIndex < rxLength ? rxBuffer[rxIndex] : -1;}
+    virtual void flush(void) {}
+    void onReceive(void (*fn)(int)) {onReceiveFn = fn;}
+    void onRequest(void (*fn)(void)) {onRequestFn = fn;}
+
+    inline size_t write(unsigned long n) {return write((uint8_t)n);}
+    inline size_t write(long n) {return write((uint8_t)n);}
+    inline size_t write(unsigned int n) {return write((uint8_t)n);}
+    inline size_t write(int n) {return write((uint8_t)n);}
+    using Print::write;
+
+  private:
+    uint8_t rxBuffer[BUFFER_LENGTH];
+    uint8_t rxIndex = 0;
+    uint8_t rxLength = 0;
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[BUFFER_LENGTH];
+    uint8_t txLength = 0;
+    bool transmitting = false;
+    uint32_t frequency = 100000;
+    void (*onReceiveFn)(int) = NULL;
+    void (*onRequestFn)(void) = NULL;
+
+    uint64_t bitTime();
+    uint64_t busTime(unsigned bytes, bool stop);
+};
+
+extern TwoWire Wire;
+
+#endif // TwoWire_h
@@ -0,0 +1,13 @@
+/*
+ * interrupt.h
+ *
+ * Lets headers that include it compile, cli() and sei() come with the
+ * registers of HostAvr.h.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef interrupt_h
+#define interrupt_h
+
+#endif // interrupt_h
@@ -0,0 +1,15 @@
+/*
+ * io.h
+ *
+ * The host core has no AVR registers, this lets headers that include it
+ * compile. Build with -D__AVR__ for the registers of HostAvr.h.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef io_h
+#define io_h
+
+#include <stdint.h>
+
+#endif // io_h
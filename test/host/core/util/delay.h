@@ -0,0 +1,17 @@
+/*
+ * delay.h
+ *
+ * avr-libc busy waits, on the virtual clock.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef util_delay_h
+#define util_delay_h
+
+#include "Arduino.h"
+
+#define _delay_ms(ms) delay((unsigned long)(ms))
+#define _delay_us(us) delayMicroseconds((unsigned int)(us))
+
+#endif // util_delay_h
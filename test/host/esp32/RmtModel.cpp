@@ -0,0 +1,304 @@
+/*
+ * RmtModel.cpp
+ *
+ * Built into the ESP32 variant of the host core only.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Arduino.h"
+#include "HostSim.h"
+#include "Profiler.h"
+#include "RmtModel.h"
+#include "driver/rmt.h"
+
+#include <deque>
+#include <vector>
+
+namespace host {
+
+struct RmtChannel {
+  rmt_config_t cfg;
+  bool configured = false;
+  bool installed = false;
+  RmtStats stats = RmtStats();
+
+  // TX: the end of the items written so far, in ns
+  uint64_t busyUntil = 0;
+
+  // RX
+  bool running = false;
+  bool receiving = false;
+  bool overflowed = false;
+  int level = LOW;
+  uint64_t lastEdge = 0;
+  uint64_t edges = 0;
+  std::vector<rmt_item32_t> items;
+  bool half = false;
+  std::deque<std::vector<rmt_item32_t> > ring;
+  size_t ringSize = 0;
+  size_t ringUsed = 0;
+  bool held = false;
+};
+
+static RmtChannel channels[RMT_CHANNEL_MAX];
+static bool watched[NUM_DIGITAL_PINS];
+static uint32_t conflicts = 0;
+static uint32_t writeGap = 0;
+
+// one tick of the APB clock of 80 MHz divided by clk_div, in ns
+static uint64_t tickNs(const RmtChannel &c, uint32_t ticks) {
+  return (uint64_t)ticks * c.cfg.clk_div * 1000000000ULL / APB_CLK_FREQ;
+}
+
+static bool valid(rmt_channel_t channel) {
+  return channel >= RMT_CHANNEL_0 && channel < RMT_CHANNEL_MAX;
+}
+
+static void run(RmtChannel &c, bool level, uint32_t ticks) {
+  if (c.items.size() >= c.cfg.mem_block_num * 64U) {
+    c.overflowed = true;
+    return;
+  }
+  if (!c.half) {
+    rmt_item32_t item;
+    item.val = 0;
+    item.level0 = level;
+    item.duration0 = ticks;
+    c.items.push_back(item);
+  } else {
+    c.items.back().level1 = level;
+    c.items.back().duration1 = ticks;
+  }
+  c.half = !c.half;
+}
+
+/*
+ * A zero duration ends the items of a reception
+ */
+static void endReception(RmtChannel &c) {
+  run(c, c.level, 0);
+  c.receiving = false;
+  if (c.overflowed) {
+    c.stats.memoryOverflows++;
+    return;
+  }
+  size_t bytes = c.items.size() * sizeof(rmt_item32_t);
+  if (c.ringUsed + bytes > c.ringSize) {
+    c.stats.ringOverflows++;
+    return;
+  }
+  c.stats.receptions++;
+  if (c.items.size() > c.stats.maxReceptionItems)
+    c.stats.maxReceptionItems = c.items.size();
+  c.ringUsed += bytes;
+  c.ring.push_back(c.items);
+}
+
+static void rxEdge(uint8_t pin, int lvl) {
+  for (int ch = 0; ch < RMT_CHANNEL_MAX; ch++) {
+    RmtChannel &c = channels[ch];
+    if (!c.installed || !c.running || c.cfg.rmt_mode != RMT_MODE_RX || c.cfg.gpio_num != pin)
+      continue;
+    uint64_t now = nowNs();
+    if (!c.receiving) {
+      c.receiving = true;
+      c.overflowed = false;
+      c.items.clear();
+      c.half = false;
+    } else {
+      uint64_t ticks = ((now - c.lastEdge) * (APB_CLK_FREQ / 1000000) / c.cfg.clk_div + 500) / 1000;
+      run(c, c.level, ticks > 0x7FFF ? 0x7FFF : (uint32_t)ticks);
+    }
+    c.level = lvl;
+    c.lastEdge = now;
+    uint64_t edge = ++c.edges;
+    scheduleNs(now + tickNs(c, c.cfg.rx_config.idle_threshold), [ch, edge]() {
+      RmtChannel &c = channels[ch];
+      if (c.receiving && c.edges == edge)
+        endReception(c);
+    });
+  }
+}
+
+RmtStats rmtStats(int channel) {
+  return valid((rmt_channel_t)channel) ? channels[channel].stats : RmtStats();
+}
+
+uint32_t rmtMemoryConflicts() {
+  return conflicts;
+}
+
+void setRmtWriteGap(uint32_t ns) {
+  writeGap = ns;
+}
+
+void rmtReset() {
+  for (int ch = 0; ch < RMT_CHANNEL_MAX; ch++)
+    channels[ch] = RmtChannel();
+  for (int pin = 0; pin < NUM_DIGITAL_PINS; pin++)
+    watched[pin] = false;
+  conflicts = 0;
+  writeGap = 0;
+}
+
+}
+
+using host::RmtChannel;
+using host::channels;
+
+esp_err_t rmt_config(const rmt_config_t *config) {
+  if (config == NULL || !host::valid(config->channel) || config->clk_div == 0
+      || config->mem_block_num == 0 || config->channel + config->mem_block_num > RMT_CHANNEL_MAX
+      || config->gpio_num < 0 || config->gpio_num >= NUM_DIGITAL_PINS)
+    return ESP_ERR_INVALID_ARG;
+  RmtChannel &c = channels[config->channel];
+  c.cfg = *config;
+  c.configured = true;
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) {
+  (void)intr_alloc_flags;
+  if (!host::valid(channel) || !channels[channel].configured || channels[channel].installed)
+    return ESP_ERR_INVALID_STATE;
+  RmtChannel &c = channels[channel];
+  for (int ch = 0; ch < RMT_CHANNEL_MAX; ch++) {
+    RmtChannel &o = channels[ch];
+    if (o.installed && ch < channel + c.cfg.mem_block_num && channel < ch + o.cfg.mem_block_num)
+      host::conflicts++;
+  }
+  c.installed = true;
+  c.ringSize = rx_buf_size;
+  if (c.cfg.rmt_mode == RMT_MODE_TX) {
+    c.busyUntil = host::nowNs();
+    if (c.cfg.tx_config.idle_output_en)
+      host::drive(c.cfg.gpio_num, c.cfg.tx_config.idle_level == RMT_IDLE_LEVEL_HIGH);
+  } else if (!host::watched[c.cfg.gpio_num]) {
+    host::watched[c.cfg.gpio_num] = true;
+    host::watch(c.cfg.gpio_num, host::rxEdge);
+  }
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+  if (!host::valid(channel) || !channels[channel].installed)
+    return ESP_ERR_INVALID_STATE;
+  RmtChannel &c = channels[channel];
+  if (c.cfg.rmt_mode == RMT_MODE_TX)
+    host::drive(c.cfg.gpio_num, host::FLOATING);
+  c.installed = false;
+  c.running = false;
+  c.receiving = false;
+  c.ring.clear();
+  c.ringUsed = 0;
+  c.held = false;
+  return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *buf_handle) {
+  if (!host::valid(channel) || buf_handle == NULL)
+    return ESP_ERR_INVALID_ARG;
+  if (!channels[channel].installed || channels[channel].ringSize == 0)
+    return ESP_ERR_INVALID_STATE;
+  *buf_handle = &channels[channel];
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst) {
+  if (!host::valid(channel) || !channels[channel].installed)
+    return ESP_ERR_INVALID_STATE;
+  RmtChannel &c = channels[channel];
+  if (rx_idx_rst)
+    c.receiving = false;
+  c.running = true;
+  return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel) {
+  if (!host::valid(channel) || !channels[channel].installed)
+    return ESP_ERR_INVALID_STATE;
+  channels[channel].running = false;
+  channels[channel].receiving = false;
+  return ESP_OK;
+}
+
+/*
+ * The items play on the pin of the channel from now on. While the items of
+ * the previous write are still going out the call blocks, as the driver
+ * waits for the channel, and the new ones follow after the write gap.
+ */
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *rmt_item, int item_num, bool wait_tx_done) {
+  if (!host::valid(channel) || rmt_item == NULL || item_num <= 0)
+    return ESP_ERR_INVALID_ARG;
+  RmtChannel &c = channels[channel];
+  if (!c.installed || c.cfg.rmt_mode != RMT_MODE_TX)
+    return ESP_ERR_INVALID_STATE;
+
+  uint8_t pin = c.cfg.gpio_num;
+  uint64_t t = host::nowNs();
+  if (c.busyUntil > t) {
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+    t = host::nowNs() + host::writeGap;
+  }
+  c.stats.writes++;
+  c.stats.items += item_num;
+  if ((uint32_t)item_num > c.stats.maxWriteItems)
+    c.stats.maxWriteItems = item_num;
+  for (int i = 0; i < item_num; i++) {
+    const rmt_item32_t &item = rmt_item[i];
+    if (item.duration0 == 0)
+      break;
+    bool l0 = item.level0;
+    host::scheduleNs(t, [pin, l0]() {host::drive(pin, l0);});
+    t += host::tickNs(c, item.duration0);
+    if (item.duration1 == 0)
+      break;
+    bool l1 = item.level1;
+    host::scheduleNs(t, [pin, l1]() {host::drive(pin, l1);});
+    t += host::tickNs(c, item.duration1);
+  }
+  if (c.cfg.tx_config.idle_output_en) {
+    bool idle = c.cfg.tx_config.idle_level == RMT_IDLE_LEVEL_HIGH;
+    host::scheduleNs(t, [pin, idle]() {host::drive(pin, idle);});
+  }
+  c.busyUntil = t;
+  if (wait_tx_done)
+    return rmt_wait_tx_done(channel, portMAX_DELAY);
+  return ESP_OK;
+}
+
+/*
+ * Blocks until the items are out, recorded as a delay
+ */
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time) {
+  (void)wait_time;
+  if (!host::valid(channel) || !channels[channel].installed)
+    return ESP_ERR_INVALID_STATE;
+  uint64_t start = host::nowNs();
+  uint64_t until = channels[channel].busyUntil;
+  if (until > start) {
+    host::advanceNs(until - start);
+    host::Profiler::record(host::PROFILE_DELAY, 0, 0, start, until - start);
+  }
+  return ESP_OK;
+}
+
+void *xRingbufferReceive(RingbufHandle_t ring, size_t *size, TickType_t ticks) {
+  (void)ticks;
+  RmtChannel *c = static_cast<RmtChannel *>(ring);
+  if (c == NULL || c->held || c->ring.empty())
+    return NULL;
+  c->held = true;
+  *size = c->ring.front().size() * sizeof(rmt_item32_t);
+  return c->ring.front().data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ring, void *item) {
+  RmtChannel *c = static_cast<RmtChannel *>(ring);
+  if (c == NULL || !c->held || c->ring.front().data() != item)
+    return;
+  c->ringUsed -= c->ring.front().size() * sizeof(rmt_item32_t);
+  c->ring.pop_front();
+  c->held = false;
+}
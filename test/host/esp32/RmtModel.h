@@ -0,0 +1,45 @@
+/*
+ * RmtModel.h
+ *
+ * What the RMT model of the ESP32 variant saw, per channel. TX channels
+ * play their items on the pin in virtual time, RX channels turn the edges
+ * of their pin into items and hand a reception to the ring buffer once the
+ * line stayed at one level for the idle threshold. Receptions longer than
+ * the memory blocks of the channel are lost, as on the chip. The glitch
+ * filter is not modelled.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef RmtModel_h
+#define RmtModel_h
+
+#include <stdint.h>
+
+namespace host {
+
+struct RmtStats {
+  uint32_t writes;
+  uint32_t items;
+  // most items handed over by one rmt_write_items()
+  uint32_t maxWriteItems;
+  uint32_t receptions;
+  uint32_t maxReceptionItems;
+  // receptions that did not fit the memory blocks, or the ring buffer
+  uint32_t memoryOverflows;
+  uint32_t ringOverflows;
+};
+
+RmtStats rmtStats(int channel);
+// installed channels whose memory blocks overlap, their items corrupt
+// each other on the chip
+uint32_t rmtMemoryConflicts();
+// idle line the TX channel leaves between two rmt_write_items() while it
+// refills its memory, in ns
+void setRmtWriteGap(uint32_t ns);
+// with host::reset(), which drops the pin watchers of the RX channels
+void rmtReset();
+
+}
+
+#endif // RmtModel_h
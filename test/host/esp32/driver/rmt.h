@@ -0,0 +1,102 @@
+/*
+ * rmt.h
+ *
+ * The ESP-IDF 4 RMT driver calls Esp32SoftwareSerial makes, run by the
+ * model in RmtModel.cpp on the pins of the host core.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef driver_rmt_h
+#define driver_rmt_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/ringbuf.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+  RMT_CHANNEL_0,
+  RMT_CHANNEL_1,
+  RMT_CHANNEL_2,
+  RMT_CHANNEL_3,
+  RMT_CHANNEL_4,
+  RMT_CHANNEL_5,
+  RMT_CHANNEL_6,
+  RMT_CHANNEL_7,
+  RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum {
+  RMT_MODE_TX = 0,
+  RMT_MODE_RX,
+  RMT_MODE_MAX
+} rmt_mode_t;
+
+typedef enum {
+  RMT_IDLE_LEVEL_LOW = 0,
+  RMT_IDLE_LEVEL_HIGH,
+  RMT_IDLE_LEVEL_MAX
+} rmt_idle_level_t;
+
+typedef enum {
+  RMT_CARRIER_LEVEL_LOW = 0,
+  RMT_CARRIER_LEVEL_HIGH,
+  RMT_CARRIER_LEVEL_MAX
+} rmt_carrier_level_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t duration0 : 15;
+      uint32_t level0 : 1;
+      uint32_t duration1 : 15;
+      uint32_t level1 : 1;
+    };
+    uint32_t val;
+  };
+} rmt_item32_t;
+
+typedef struct {
+  uint32_t carrier_freq_hz;
+  rmt_carrier_level_t carrier_level;
+  rmt_idle_level_t idle_level;
+  uint8_t carrier_duty_percent;
+  bool carrier_en;
+  bool loop_en;
+  bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+  uint16_t idle_threshold;
+  uint8_t filter_ticks_thresh;
+  bool filter_en;
+} rmt_rx_config_t;
+
+typedef struct {
+  rmt_mode_t rmt_mode;
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  uint8_t mem_block_num;
+  uint32_t flags;
+  union {
+    rmt_tx_config_t tx_config;
+    rmt_rx_config_t rx_config;
+  };
+} rmt_config_t;
+
+esp_err_t rmt_config(const rmt_config_t *config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *buf_handle);
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst);
+esp_err_t rmt_rx_stop(rmt_channel_t channel);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *rmt_item, int item_num, bool wait_tx_done);
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time);
+
+#endif // driver_rmt_h
@@ -0,0 +1,17 @@
+/*
+ * esp_attr.h
+ *
+ * Placement attributes of ESP-IDF, empty on the host.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef esp_attr_h
+#define esp_attr_h
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif // esp_attr_h
@@ -0,0 +1,19 @@
+/*
+ * esp_err.h
+ *
+ * ESP-IDF error codes used by the driver models.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef esp_err_h
+#define esp_err_h
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+#endif // esp_err_h
@@ -0,0 +1,24 @@
+/*
+ * ringbuf.h
+ *
+ * The FreeRTOS ring buffer calls the RMT driver hands its receptions over
+ * with, see RmtModel.cpp. Only item receiving is modelled.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef freertos_ringbuf_h
+#define freertos_ringbuf_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef void *RingbufHandle_t;
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+void *xRingbufferReceive(RingbufHandle_t ring, size_t *size, TickType_t ticks);
+void vRingbufferReturnItem(RingbufHandle_t ring, void *item);
+
+#endif // freertos_ringbuf_h
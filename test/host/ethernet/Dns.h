@@ -0,0 +1,25 @@
+/*
+ * Dns.h
+ *
+ * DNSClient of the Arduino Ethernet library, answering from the hosts added
+ * with host::addHost().
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef DNSClient_h
+#define DNSClient_h
+
+#include "IPAddress.h"
+
+class DNSClient {
+  public:
+    void begin(const IPAddress &dnsServer) {server = dnsServer;}
+    // 1 with the address, TIMED_OUT (-1) for a name no host has
+    int getHostByName(const char *hostname, IPAddress &result, uint16_t timeout = 5000);
+
+  private:
+    IPAddress server;
+};
+
+#endif // DNSClient_h
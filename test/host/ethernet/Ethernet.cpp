@@ -0,0 +1,136 @@
+/*
+ * Ethernet.cpp
+ *
+ * Built into the Ethernet variant of the host core only.
+ *
+ * Released into the MIT License.
+ */
+
+#include "Ethernet.h"
+#include "Dns.h"
+#include "HostEthernet.h"
+#include "HostSim.h"
+
+#include <map>
+#include <string>
+#include <utility>
+
+EthernetClass Ethernet;
+
+typedef std::map<uint16_t, EthernetUDP *> Sockets;
+typedef std::map<std::pair<uint32_t, uint16_t>, host::UDPDevice *> Devices;
+
+// built on first use, a global device may attach from its constructor, and
+// never destroyed, a global socket may stop from its owner's destructor
+static Sockets &sockets() {
+  static Sockets *s = new Sockets;
+  return *s;
+}
+
+static Devices &devices() {
+  static Devices *d = new Devices;
+  return *d;
+}
+
+static std::map<std::string, IPAddress> &hosts() {
+  static std::map<std::string, IPAddress> *h = new std::map<std::string, IPAddress>;
+  return *h;
+}
+
+namespace host {
+
+void attachUDP(IPAddress ip, uint16_t port, UDPDevice *dev) {
+  devices()[std::make_pair((uint32_t)ip, port)] = dev;
+}
+
+void detachUDP(IPAddress ip, uint16_t port) {
+  devices().erase(std::make_pair((uint32_t)ip, port));
+}
+
+void udpSend(IPAddress from, uint16_t fromPort, uint16_t toPort, const uint8_t *data,
+             size_t len, uint64_t delayUs) {
+  EthernetUDP::Datagram datagram = {from, fromPort, std::vector<uint8_t>(data, data + len)};
+  schedule(now() + delayUs, [toPort, datagram]() {
+    Sockets::iterator socket = sockets().find(toPort);
+    if (socket != sockets().end())
+      socket->second->deliver(datagram);
+  });
+}
+
+void addHost(const char *name, IPAddress ip) {
+  hosts()[name] = ip;
+}
+
+}
+
+uint8_t EthernetUDP::begin(uint16_t port) {
+  stop();
+  this->port = port;
+  sockets()[port] = this;
+  return 1;
+}
+
+// the datagrams still queued are lost
+void EthernetUDP::stop() {
+  if (port != 0 && sockets().count(port) && sockets()[port] == this)
+    sockets().erase(port);
+  port = 0;
+  received.clear();
+  packet.clear();
+  packetIndex = 0;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port) {
+  txIP = ip;
+  txPort = port;
+  txData.clear();
+  return 1;
+}
+
+size_t EthernetUDP::write(uint8_t b) {
+  txData.push_back(b);
+  return 1;
+}
+
+size_t EthernetUDP::write(const uint8_t *buffer, size_t size) {
+  txData.insert(txData.end(), buffer, buffer + size);
+  return size;
+}
+
+// sent, whether a device listens or not
+int EthernetUDP::endPacket() {
+  Devices::iterator dev = devices().find(std::make_pair((uint32_t)txIP, txPort));
+  if (dev != devices().end())
+    dev->second->udpReceive(txData.data(), txData.size(), Ethernet.localIP(), port);
+  txData.clear();
+  return 1;
+}
+
+// drops what is left of the current datagram, the size of the next one or 0
+int EthernetUDP::parsePacket() {
+  packet.clear();
+  packetIndex = 0;
+  if (received.empty())
+    return 0;
+  packet = received.front().data;
+  packetIP = received.front().ip;
+  packetPort = received.front().port;
+  received.pop_front();
+  return (int)packet.size();
+}
+
+int EthernetUDP::read(unsigned char *buffer, size_t len) {
+  size_t n = 0;
+  while (n < len && packetIndex < packet.size())
+    buffer[n++] = packet[packetIndex++];
+  return n > 0 ? (int)n : -1;
+}
+
+int DNSClient::getHostByName(const char *hostname, IPAddress &result, uint16_t timeout) {
+  (void)timeout;
+  std::map<std::string, IPAddress>::iterator host = hosts().find(hostname);
+  if (host == hosts().end())
+    return -1;
+  result = host->second;
+  return 1;
+}
@@ -0,0 +1,30 @@
+/*
+ * Ethernet.h
+ *
+ * The Ethernet shield of the host core, already up with a fixed address.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef ethernet_h
+#define ethernet_h
+
+#include "IPAddress.h"
+#include "EthernetUdp.h"
+
+class EthernetClass {
+  public:
+    int begin(uint8_t *mac, unsigned long timeout = 60000, unsigned long responseTimeout = 4000) {
+      (void)mac;
+      (void)timeout;
+      (void)responseTimeout;
+      return 1;
+    }
+    IPAddress localIP() {return IPAddress(192, 168, 1, 177);}
+    IPAddress gatewayIP() {return IPAddress(192, 168, 1, 1);}
+    IPAddress dnsServerIP() {return IPAddress(192, 168, 1, 1);}
+};
+
+extern EthernetClass Ethernet;
+
+#endif // ethernet_h
@@ -0,0 +1,65 @@
+/*
+ * EthernetUdp.h
+ *
+ * EthernetUDP of the Arduino Ethernet library on the network of
+ * HostEthernet.h. A socket bound with begin() queues the datagrams sent to
+ * its port, parsePacket() moves to the next one.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef ethernetudp_h
+#define ethernetudp_h
+
+#include <deque>
+#include <vector>
+#include "IPAddress.h"
+#include "Stream.h"
+
+class EthernetUDP : public Stream {
+  public:
+    EthernetUDP() {}
+    virtual ~EthernetUDP() {stop();}
+
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    int endPacket();
+    virtual size_t write(uint8_t b);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+
+    int parsePacket();
+    virtual int available() {return (int)(packet.size() - packetIndex);}
+    virtual int read() {return packetIndex < packet.size() ? packet[packetIndex++] : -1;}
+    int read(unsigned char *buffer, size_t len);
+    int read(char *buffer, size_t len) {return read((unsigned char *)buffer, len);}
+    virtual int peek() {return packetIndex < packet.size() ? packet[packetIndex] : -1;}
+    virtual void flush() {}
+
+    IPAddress remoteIP() {return packetIP;}
+    uint16_t remotePort() {return packetPort;}
+    uint16_t localPort() {return port;}
+
+    // used by the network
+    struct Datagram {
+      IPAddress ip;
+      uint16_t port;
+      std::vector<uint8_t> data;
+    };
+    void deliver(const Datagram &datagram) {received.push_back(datagram);}
+
+  private:
+    uint16_t port = 0;
+    IPAddress txIP;
+    uint16_t txPort = 0;
+    std::vector<uint8_t> txData;
+    std::deque<Datagram> received;
+    std::vector<uint8_t> packet;
+    size_t packetIndex = 0;
+    IPAddress packetIP;
+    uint16_t packetPort = 0;
+};
+
+#endif // ethernetudp_h
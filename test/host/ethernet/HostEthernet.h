@@ -0,0 +1,39 @@
+/*
+ * HostEthernet.h
+ *
+ * The network behind the Ethernet shield of the host core. A UDP device
+ * attaches at an address and port and receives every datagram the sketch
+ * sends there, at endPacket(). It answers with host::udpSend() to the port
+ * of the sketch's socket, after the delay of the way back. Names resolve
+ * from the hosts added here, at once.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef HostEthernet_h
+#define HostEthernet_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "IPAddress.h"
+
+namespace host {
+
+class UDPDevice {
+  public:
+    virtual ~UDPDevice() {}
+    virtual void udpReceive(const uint8_t *data, size_t len, IPAddress from, uint16_t fromPort) = 0;
+};
+
+void attachUDP(IPAddress ip, uint16_t port, UDPDevice *dev);
+void detachUDP(IPAddress ip, uint16_t port);
+// queues the datagram on the socket bound to toPort delayUs from now, it is
+// lost when no socket is bound then
+void udpSend(IPAddress from, uint16_t fromPort, uint16_t toPort, const uint8_t *data,
+             size_t len, uint64_t delayUs = 0);
+
+void addHost(const char *name, IPAddress ip);
+
+}
+
+#endif // HostEthernet_h
@@ -0,0 +1,93 @@
+/*
+ * Apds9960Model.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Apds9960Model.h"
+#include "Arduino.h"
+
+static const uint8_t PON = 0x01, AEN = 0x02, PEN = 0x04, AIEN = 0x10, PIEN = 0x20;
+static const uint8_t AVALID = 0x01, PVALID = 0x02, AINT = 0x10, PINT = 0x20;
+
+Apds9960Model::Apds9960Model(uint8_t intPin) : RegisterModel(0x39), intPin(intPin) {
+  reg[0x92] = 0xAB; // ID
+  update();
+}
+
+bool Apds9960Model::i2cWrite(const uint8_t *data, size_t len, bool stop) {
+  RegisterModel::i2cWrite(data, len, stop);
+  // the clear registers act on their address alone
+  if (len == 1 && data[0] >= 0xE5 && data[0] <= 0xE7) {
+    if (data[0] != 0xE6)
+      reg[STATUS] &= ~PINT;
+    if (data[0] != 0xE5)
+      reg[STATUS] &= ~AINT;
+    clears++;
+    update();
+  }
+  return true;
+}
+
+size_t Apds9960Model::i2cRead(uint8_t *buf, size_t len) {
+  if (pointer < 0xFC)
+    return RegisterModel::i2cRead(buf, len);
+  // the FIFO pops whole datasets, an empty one reads 0
+  reads++;
+  if (len > longestFifoRead)
+    longestFifoRead = len;
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = fifo.empty() ? 0 : fifo.front();
+    if (!fifo.empty())
+      fifo.pop_front();
+  }
+  reg[GFLVL] = fifo.size() / 4;
+  reg[GSTATUS] = fifo.empty() ? 0 : 1;
+  return len;
+}
+
+void Apds9960Model::colorCycle(uint16_t c, uint16_t r, uint16_t g, uint16_t b) {
+  if ((reg[ENABLE] & (PON | AEN)) != (PON | AEN))
+    return;
+  const uint16_t counts[] = {c, r, g, b};
+  for (int i = 0; i < 4; i++) {
+    reg[0x94 + 2 * i] = counts[i] & 0xFF;
+    reg[0x95 + 2 * i] = counts[i] >> 8;
+  }
+  reg[STATUS] |= AVALID | AINT;
+  update();
+}
+
+void Apds9960Model::proximityCycle(uint8_t p) {
+  if ((reg[ENABLE] & (PON | PEN)) != (PON | PEN))
+    return;
+  reg[0x9C] = p;
+  reg[STATUS] |= PVALID | PINT;
+  update();
+}
+
+void Apds9960Model::pushGesture(uint8_t u, uint8_t d, uint8_t l, uint8_t r) {
+  fifo.push_back(u);
+  fifo.push_back(d);
+  fifo.push_back(l);
+  fifo.push_back(r);
+  reg[GFLVL] = fifo.size() / 4;
+  reg[GSTATUS] = 1;
+}
+
+void Apds9960Model::written(uint8_t r) {
+  if (r == ENABLE)
+    enableWrites++;
+  if (r == PERS)
+    persWrites++;
+  update();
+}
+
+// INT is open drain, low while an enabled interrupt is pending
+void Apds9960Model::update() {
+  if (intPin == 0xFF)
+    return;
+  bool pending = ((reg[STATUS] & AINT) && (reg[ENABLE] & AIEN)) ||
+                 ((reg[STATUS] & PINT) && (reg[ENABLE] & PIEN));
+  host::drive(intPin, pending ? LOW : HIGH);
+}
@@ -0,0 +1,53 @@
+/*
+ * Apds9960Model.h
+ *
+ * APDS-9960 register map: the STATUS interrupt flags an ALS or proximity
+ * cycle raises, the address-only clears, the INT pin and the gesture FIFO
+ * read four bytes a dataset at 0xFC.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Apds9960Model_h
+#define Apds9960Model_h
+
+#include <deque>
+
+#include "RegisterModel.h"
+
+class Apds9960Model : public RegisterModel {
+  public:
+    // intPin 0xFF for none
+    Apds9960Model(uint8_t intPin = 0xFF);
+
+    virtual bool i2cWrite(const uint8_t *data, size_t len, bool stop);
+    virtual size_t i2cRead(uint8_t *buf, size_t len);
+
+    // an ALS cycle ends with these counts, only while AEN is set
+    void colorCycle(uint16_t c, uint16_t r, uint16_t g, uint16_t b);
+    // a proximity cycle ends with this count, only while PEN is set
+    void proximityCycle(uint8_t p);
+    void pushGesture(uint8_t u, uint8_t d, uint8_t l, uint8_t r);
+
+    static const uint8_t ENABLE = 0x80;
+    static const uint8_t PERS = 0x8C;
+    static const uint8_t STATUS = 0x93;
+    static const uint8_t GFLVL = 0xAE;
+    static const uint8_t GSTATUS = 0xAF;
+
+    uint32_t enableWrites = 0;
+    uint32_t persWrites = 0;
+    uint32_t clears = 0;
+    size_t longestFifoRead = 0;
+    std::deque<uint8_t> fifo;
+
+  protected:
+    virtual void written(uint8_t r);
+
+  private:
+    void update();
+
+    uint8_t intPin;
+};
+
+#endif // Apds9960Model_h
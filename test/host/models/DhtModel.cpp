@@ -0,0 +1,84 @@
+/*
+ * DhtModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "DhtModel.h"
+#include "Arduino.h"
+
+#include <math.h>
+#include <string.h>
+
+DhtModel::DhtModel(uint8_t pin, uint8_t type) : pin(pin), type(type) {
+  setReading(50.0, 20.0);
+  host::setPull(pin, HIGH);
+  host::watch(pin, [this](uint8_t, int level) {change(level);});
+}
+
+void DhtModel::setReading(float humidity, float temperature) {
+  if (type == 11) {
+    bytes[0] = (uint8_t)humidity;
+    bytes[1] = (uint8_t)lroundf((humidity - bytes[0]) * 10);
+    bytes[2] = (uint8_t)temperature;
+    bytes[3] = (uint8_t)lroundf((temperature - bytes[2]) * 10);
+  } else {
+    uint16_t h = (uint16_t)lroundf(humidity * 10);
+    uint16_t t = (uint16_t)lroundf(fabsf(temperature) * 10);
+    bytes[0] = h >> 8;
+    bytes[1] = h & 0xFF;
+    bytes[2] = (t >> 8) | (temperature < 0 ? 0x80 : 0);
+    bytes[3] = t & 0xFF;
+  }
+  bytes[4] = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+}
+
+void DhtModel::setBytes(const uint8_t *b) {
+  memcpy(bytes, b, sizeof(bytes));
+}
+
+/*
+ * The start signal is the sketch driving the line low for at least 18ms on
+ * a DHT11 and about 1ms on the others
+ */
+void DhtModel::change(int level) {
+  if (answering)
+    return;
+  if (level == LOW && host::isOutput(pin)) {
+    holding = true;
+    lowSince = host::nowNs();
+  } else if (level == HIGH && holding) {
+    holding = false;
+    uint64_t minimum = type == 11 ? 18000000ULL : 800000ULL;
+    if (host::nowNs() - lowSince >= minimum) {
+      starts++;
+      if (!silent)
+        answer();
+    }
+  }
+}
+
+void DhtModel::answer() {
+  uint64_t t = host::nowNs() + 30000;
+  uint8_t p = pin;
+
+  answering = true;
+  answers++;
+  host::scheduleNs(t, [p]() {host::drive(p, LOW);});
+  t += 80000;
+  host::scheduleNs(t, [p]() {host::drive(p, HIGH);});
+  t += 80000;
+  for (int i = 0; i < 40; i++) {
+    bool one = bytes[i / 8] & (0x80 >> (i % 8));
+    host::scheduleNs(t, [p]() {host::drive(p, LOW);});
+    t += 50000;
+    host::scheduleNs(t, [p]() {host::drive(p, HIGH);});
+    t += one ? 70000 : 26000;
+  }
+  host::scheduleNs(t, [p]() {host::drive(p, LOW);});
+  t += 50000;
+  host::scheduleNs(t, [this, p]() {
+    host::drive(p, host::FLOATING);
+    answering = false;
+  });
+}
@@ -0,0 +1,42 @@
+/*
+ * DhtModel.h
+ *
+ * DHT11/DHT22 on one data line. Once the sketch has held the line low for
+ * the start signal and released it, the sensor answers 30us later with 80us
+ * low, 80us high and 40 bits, each 50us low then 26us (0) or 70us (1) high,
+ * and a final 50us low.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef DhtModel_h
+#define DhtModel_h
+
+#include "HostSim.h"
+
+class DhtModel {
+  public:
+    DhtModel(uint8_t pin, uint8_t type);
+
+    void setReading(float humidity, float temperature);
+    void setBytes(const uint8_t *bytes);
+    // a silent sensor never answers
+    void setSilent(bool silent) {this->silent = silent;}
+
+    uint32_t starts = 0;
+    uint32_t answers = 0;
+    uint8_t bytes[5];
+
+  private:
+    uint8_t pin;
+    uint8_t type;
+    bool silent = false;
+    bool answering = false;
+    bool holding = false;
+    uint64_t lowSince = 0;
+
+    void change(int level);
+    void answer();
+};
+
+#endif // DhtModel_h
@@ -0,0 +1,40 @@
+/*
+ * EchoModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "EchoModel.h"
+#include "Arduino.h"
+
+EchoModel::EchoModel(uint8_t trigPin, uint8_t echoPin) : trig(trigPin), echo(echoPin) {
+  host::drive(echo, LOW);
+  host::watch(trig, [this](uint8_t, int level) {change(level);});
+}
+
+/*
+ * Only edges the sketch drives are triggers, not the echo on a shared pin
+ */
+void EchoModel::change(int level) {
+  if (!host::isOutput(trig))
+    return;
+  if (level == HIGH) {
+    triggered = true;
+    riseAt = host::nowNs();
+    return;
+  }
+  if (!triggered)
+    return;
+  triggered = false;
+  if (host::nowNs() - riseAt < 10000)
+    return;
+
+  pings++;
+  uint64_t t = host::nowNs() + 450000;
+  uint8_t e = echo;
+  if (echoUs == 0 && !stuck)
+    return;
+  host::scheduleNs(t, [e]() {host::drive(e, HIGH);});
+  if (!stuck)
+    host::scheduleNs(t + echoUs * 1000ULL, [e]() {host::drive(e, LOW);});
+}
@@ -0,0 +1,39 @@
+/*
+ * EchoModel.h
+ *
+ * HC-SR04 style ultrasonic module. The falling edge of a trigger pulse of
+ * at least 10us starts the burst, the echo line rises 450us later and stays
+ * high for the round trip time. Trigger and echo may be the same pin, as on
+ * three pin modules.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef EchoModel_h
+#define EchoModel_h
+
+#include "HostSim.h"
+
+class EchoModel {
+  public:
+    EchoModel(uint8_t trigPin, uint8_t echoPin);
+
+    // round trip in microseconds, 0 for no echo
+    void setEcho(uint32_t us) {echoUs = us;}
+    // the echo line stays high after a ping
+    void setStuck(bool stuck) {this->stuck = stuck;}
+
+    uint32_t pings = 0;
+
+  private:
+    uint8_t trig;
+    uint8_t echo;
+    uint32_t echoUs = 1000;
+    bool stuck = false;
+    bool triggered = false;
+    uint64_t riseAt = 0;
+
+    void change(int level);
+};
+
+#endif // EchoModel_h
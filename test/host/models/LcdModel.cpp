@@ -0,0 +1,114 @@
+/*
+ * LcdModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "LcdModel.h"
+
+#include <string.h>
+
+// execution times of the data sheet, in ns
+#define LCD_CLEAR_TIME 1520000ULL
+#define LCD_COMMAND_TIME 37000ULL
+
+LcdModel::LcdModel(uint8_t address, uint8_t cols, uint8_t rows)
+  : address(address), cols(cols), rows(rows) {
+  memset(ddram, ' ', sizeof(ddram));
+  host::attachI2C(address, this);
+}
+
+LcdModel::~LcdModel() {
+  if (host::i2cDevice(address) == this)
+    host::detachI2C(address);
+}
+
+bool LcdModel::i2cWrite(const uint8_t *data, size_t len, bool stop) {
+  (void)stop;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t old = port;
+    port = data[i];
+    if ((old & 0x04) && !(port & 0x04))
+      latch(old, host::i2cByteNs(i));
+  }
+  return true;
+}
+
+size_t LcdModel::i2cRead(uint8_t *buf, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    buf[i] = port;
+  return len;
+}
+
+/*
+ * Until the function set switches to 4 bits, each nibble is a whole byte
+ * with the low data lines left unconnected
+ */
+void LcdModel::latch(uint8_t p, uint64_t at) {
+  bool rs = p & 0x01;
+  uint8_t nibble = p >> 4;
+
+  if (p & 0x02)
+    return;
+  if (!fourBit) {
+    byte(rs, nibble << 4, at);
+    return;
+  }
+  if (!haveHigh) {
+    high = nibble;
+    haveHigh = true;
+    return;
+  }
+  haveHigh = false;
+  byte(rs, high << 4 | nibble, at);
+}
+
+void LcdModel::byte(bool rs, uint8_t b, uint64_t at) {
+  if (at < busyUntil)
+    tooEarly++;
+  busyUntil = at + LCD_COMMAND_TIME;
+
+  if (!rs) {
+    command(b, at);
+    return;
+  }
+  characters++;
+  if (cgram)
+    return;
+  ddram[addr & 0x7F] = b;
+  addr = increment ? addr + 1 : addr - 1;
+}
+
+void LcdModel::command(uint8_t c, uint64_t at) {
+  commands++;
+  if (c == 0x01) {
+    memset(ddram, ' ', sizeof(ddram));
+    addr = 0;
+    cgram = false;
+    increment = true;
+    busyUntil = at + LCD_CLEAR_TIME;
+  } else if ((c & 0xFE) == 0x02) {
+    addr = 0;
+    cgram = false;
+    busyUntil = at + LCD_CLEAR_TIME;
+  } else if ((c & 0xFC) == 0x04) {
+    increment = c & 0x02;
+  } else if ((c & 0xF8) == 0x08) {
+    display = c & 0x07;
+  } else if ((c & 0xE0) == 0x20) {
+    fourBit = !(c & 0x10);
+    haveHigh = false;
+  } else if ((c & 0xC0) == 0x40) {
+    cgram = true;
+  } else if (c & 0x80) {
+    addr = c & 0x7F;
+    cgram = false;
+  }
+}
+
+std::string LcdModel::line(uint8_t row) {
+  static const uint8_t offsets[] = {0x00, 0x40, 0x14, 0x54};
+  if (row >= rows || row >= 4)
+    return "";
+  return std::string((const char *)ddram + offsets[row], cols);
+}
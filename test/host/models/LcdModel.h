@@ -0,0 +1,56 @@
+/*
+ * LcdModel.h
+ *
+ * HD44780 character display behind a PCF8574 I2C backpack, wired as
+ * LiquidCrystal_I2C expects: P0 RS, P1 RW, P2 EN, P3 backlight, P4-P7 the
+ * data nibble. The controller latches a nibble on the falling edge of EN.
+ * Commands sent before the previous one finished are counted as too early.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef LcdModel_h
+#define LcdModel_h
+
+#include "HostSim.h"
+
+#include <string>
+
+class LcdModel : public host::I2CDevice {
+  public:
+    LcdModel(uint8_t address = 0x27, uint8_t cols = 16, uint8_t rows = 2);
+    virtual ~LcdModel();
+
+    virtual bool i2cWrite(const uint8_t *data, size_t len, bool stop);
+    virtual size_t i2cRead(uint8_t *buf, size_t len);
+
+    // the visible characters of a row
+    std::string line(uint8_t row);
+    bool backlight() {return port & 0x08;}
+    bool displayOn() {return display & 0x04;}
+
+    uint32_t commands = 0;
+    uint32_t characters = 0;
+    uint32_t tooEarly = 0;
+
+  private:
+    uint8_t address;
+    uint8_t cols, rows;
+    uint8_t port = 0xFF;
+    bool fourBit = false;
+    bool haveHigh = false;
+    uint8_t high = 0;
+    uint8_t ddram[128];
+    uint8_t addr = 0;
+    bool increment = true;
+    bool cgram = false;
+    uint8_t display = 0;
+    uint64_t busyUntil = 0;
+
+    // at is the time the expander set the port, in ns
+    void latch(uint8_t port, uint64_t at);
+    void byte(bool rs, uint8_t b, uint64_t at);
+    void command(uint8_t c, uint64_t at);
+};
+
+#endif // LcdModel_h
@@ -0,0 +1,57 @@
+/*
+ * RegisterModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "RegisterModel.h"
+
+#include <string.h>
+
+RegisterModel::RegisterModel(uint8_t address) : address(address) {
+  memset(reg, 0, sizeof(reg));
+  host::attachI2C(address, this);
+}
+
+RegisterModel::~RegisterModel() {
+  if (host::i2cDevice(address) == this)
+    host::detachI2C(address);
+}
+
+bool RegisterModel::i2cWrite(const uint8_t *data, size_t len, bool stop) {
+  (void)stop;
+  writes++;
+  if (len == 0)
+    return true;
+  pointer = data[0];
+  for (size_t i = 1; i < len; i++) {
+    reg[pointer] = data[i];
+    written(pointer);
+    pointer++;
+  }
+  return true;
+}
+
+size_t RegisterModel::i2cRead(uint8_t *buf, size_t len) {
+  reads++;
+  for (size_t i = 0; i < len; i++)
+    buf[i] = reg[pointer++];
+  return len;
+}
+
+Mpu6050Model::Mpu6050Model(uint8_t address) : RegisterModel(address) {
+  reg[0x6B] = 0x40; // PWR_MGMT_1, asleep after reset
+  reg[0x75] = 0x68; // WHO_AM_I
+}
+
+void Mpu6050Model::setAccel(int16_t x, int16_t y, int16_t z) {
+  set16(0x3B, x);
+  set16(0x3D, y);
+  set16(0x3F, z);
+}
+
+void Mpu6050Model::setGyro(int16_t x, int16_t y, int16_t z) {
+  set16(0x43, x);
+  set16(0x45, y);
+  set16(0x47, z);
+}
@@ -0,0 +1,51 @@
+/*
+ * RegisterModel.h
+ *
+ * I2C device with 256 byte registers behind an address pointer, the first
+ * byte of a write sets the pointer and every byte moves it on. Most sensors
+ * work this way.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef RegisterModel_h
+#define RegisterModel_h
+
+#include "HostSim.h"
+
+class RegisterModel : public host::I2CDevice {
+  public:
+    RegisterModel(uint8_t address);
+    virtual ~RegisterModel();
+
+    virtual bool i2cWrite(const uint8_t *data, size_t len, bool stop);
+    virtual size_t i2cRead(uint8_t *buf, size_t len);
+
+    uint8_t reg[256];
+    uint8_t pointer = 0;
+    uint32_t writes = 0;
+    uint32_t reads = 0;
+
+    // big endian 16 bit register pair
+    void set16(uint8_t r, int16_t v) {reg[r] = (uint16_t)v >> 8; reg[(uint8_t)(r + 1)] = v & 0xFF;}
+
+  protected:
+    // called after a register was written
+    virtual void written(uint8_t r) {(void)r;}
+
+  private:
+    uint8_t address;
+};
+
+/*
+ * MPU-6050 as MPU6050_tockn reads it
+ */
+class Mpu6050Model : public RegisterModel {
+  public:
+    Mpu6050Model(uint8_t address = 0x68);
+    void setAccel(int16_t x, int16_t y, int16_t z);
+    void setGyro(int16_t x, int16_t y, int16_t z);
+    void setTemp(int16_t raw) {set16(0x41, raw);}
+};
+
+#endif // RegisterModel_h
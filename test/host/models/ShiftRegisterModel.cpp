@@ -0,0 +1,25 @@
+/*
+ * ShiftRegisterModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "ShiftRegisterModel.h"
+#include "Arduino.h"
+
+ShiftRegisterModel::ShiftRegisterModel(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t registers)
+    : data(dataPin), mask((uint32_t)((1ULL << (8 * registers)) - 1)) {
+  host::watch(clockPin, [this](uint8_t, int level) {
+    if (level != HIGH)
+      return;
+    chain = (chain << 1 | (host::level(data) == HIGH)) & mask;
+    clocks++;
+  });
+  host::watch(latchPin, [this](uint8_t, int level) {
+    if (level != HIGH)
+      return;
+    outputs = chain;
+    latches.push_back(Latch{host::nowNs(), outputs, clocks});
+    clocks = 0;
+  });
+}
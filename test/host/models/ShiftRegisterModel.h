@@ -0,0 +1,39 @@
+/*
+ * ShiftRegisterModel.h
+ *
+ * A chain of up to four 74HC595 shift registers. A rising clock shifts the
+ * data pin into the first stage, a rising latch copies the chain to the
+ * outputs. Bit 0 of the outputs is the last bit shifted in.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef ShiftRegisterModel_h
+#define ShiftRegisterModel_h
+
+#include <vector>
+
+#include "HostSim.h"
+
+class ShiftRegisterModel {
+  public:
+    ShiftRegisterModel(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t registers);
+
+    struct Latch {
+      uint64_t ns;
+      uint32_t outputs;
+      // clocks since the previous latch
+      uint32_t clocks;
+    };
+
+    uint32_t outputs = 0;
+    std::vector<Latch> latches;
+
+  private:
+    uint8_t data;
+    uint32_t mask;
+    uint32_t chain = 0;
+    uint32_t clocks = 0;
+};
+
+#endif // ShiftRegisterModel_h
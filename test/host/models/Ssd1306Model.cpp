@@ -0,0 +1,122 @@
+/*
+ * Ssd1306Model.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Ssd1306Model.h"
+
+#include <string.h>
+
+Ssd1306Model::Ssd1306Model(uint8_t address) : address(address) {
+  memset(ram, 0, sizeof(ram));
+  host::attachI2C(address, this);
+}
+
+Ssd1306Model::~Ssd1306Model() {
+  if (host::i2cDevice(address) == this)
+    host::detachI2C(address);
+}
+
+/*
+ * The control byte after the address selects commands (0x00) or display
+ * data (0x40) for the rest of the write
+ */
+bool Ssd1306Model::i2cWrite(const uint8_t *data, size_t len, bool stop) {
+  (void)stop;
+  if (len == 0)
+    return true;
+  bool isData = data[0] & 0x40;
+  for (size_t i = 1; i < len; i++) {
+    if (isData)
+      dataByte(data[i]);
+    else
+      commandByte(data[i]);
+  }
+  return true;
+}
+
+/*
+ * Reads the status byte, display off sets bit 6
+ */
+size_t Ssd1306Model::i2cRead(uint8_t *buf, size_t len) {
+  for (size_t i = 0; i < len; i++)
+    buf[i] = on ? 0x00 : 0x40;
+  return len;
+}
+
+/*
+ * Number of argument bytes after each command
+ */
+static uint8_t arguments(uint8_t c) {
+  switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22: case 0xA3:
+      return 2;
+    case 0x29: case 0x2A:
+      return 5;
+    case 0x26: case 0x27:
+      return 6;
+    default:
+      return 0;
+  }
+}
+
+void Ssd1306Model::commandByte(uint8_t b) {
+  command[commandLength++] = b;
+  if (commandLength > arguments(command[0])) {
+    run();
+    commandLength = 0;
+  }
+}
+
+void Ssd1306Model::run() {
+  uint8_t c = command[0];
+
+  commands++;
+  if (c == 0xAE) {
+    on = false;
+  } else if (c == 0xAF) {
+    on = true;
+  } else if (c == 0x81) {
+    contrast = command[1];
+  } else if (c == 0x20) {
+    addressing = command[1] & 3;
+  } else if (c == 0x21) {
+    columnStart = command[1] & 0x7F;
+    columnEnd = command[2] & 0x7F;
+    column = columnStart;
+  } else if (c == 0x22) {
+    pageStart = command[1] & 7;
+    pageEnd = command[2] & 7;
+    page = pageStart;
+  } else if (c >= 0xB0 && c <= 0xB7) {
+    page = c & 7;
+  } else if (c <= 0x0F) {
+    column = (column & 0xF0) | c;
+  } else if (c >= 0x10 && c <= 0x1F) {
+    column = (column & 0x0F) | (c & 0x0F) << 4;
+  }
+}
+
+void Ssd1306Model::dataByte(uint8_t b) {
+  dataBytes++;
+  ram[page][column] = b;
+  if (addressing == 2) {
+    column = (column + 1) & 0x7F;
+    return;
+  }
+  if (addressing == 0) {
+    if (column++ >= columnEnd) {
+      column = columnStart;
+      page = page >= pageEnd ? pageStart : page + 1;
+    }
+  } else {
+    if (page++ >= pageEnd) {
+      page = pageStart;
+      column = column >= columnEnd ? columnStart : column + 1;
+    }
+  }
+}
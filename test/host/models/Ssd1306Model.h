@@ -0,0 +1,46 @@
+/*
+ * Ssd1306Model.h
+ *
+ * SSD1306 controller on I2C: decodes the command stream and keeps the
+ * display RAM, so a test can compare it with the library's buffer.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Ssd1306Model_h
+#define Ssd1306Model_h
+
+#include "HostSim.h"
+
+class Ssd1306Model : public host::I2CDevice {
+  public:
+    Ssd1306Model(uint8_t address = 0x3C);
+    virtual ~Ssd1306Model();
+
+    virtual bool i2cWrite(const uint8_t *data, size_t len, bool stop);
+    virtual size_t i2cRead(uint8_t *buf, size_t len);
+
+    // 8 pages of 128 columns, one byte is 8 rows of a column
+    uint8_t ram[8][128];
+    bool on = false;
+    uint8_t contrast = 0x7F;
+    uint32_t commands = 0;
+    uint32_t dataBytes = 0;
+
+    bool pixel(int x, int y) {return (ram[y / 8][x] >> (y & 7)) & 1;}
+
+  private:
+    uint8_t address;
+    uint8_t command[8];
+    uint8_t commandLength = 0;
+    uint8_t column = 0, page = 0;
+    uint8_t columnStart = 0, columnEnd = 127;
+    uint8_t pageStart = 0, pageEnd = 7;
+    uint8_t addressing = 2;
+
+    void commandByte(uint8_t b);
+    void run();
+    void dataByte(uint8_t b);
+};
+
+#endif // Ssd1306Model_h
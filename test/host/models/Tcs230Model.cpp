@@ -0,0 +1,50 @@
+/*
+ * Tcs230Model.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Tcs230Model.h"
+#include "Arduino.h"
+
+Tcs230Model::Tcs230Model(uint8_t s2Pin, uint8_t s3Pin, uint8_t outPin) : s2(s2Pin), s3(s3Pin), out(outPin) {
+  host::drive(out, LOW);
+  host::watch(s2, [this](uint8_t, int) {start();});
+  host::watch(s3, [this](uint8_t, int) {start();});
+}
+
+// S2 S3: L L red, H H green, L H blue, H L clear
+uint8_t Tcs230Model::filter() const {
+  static const uint8_t filters[4] = {0, 2, 3, 1};
+  return filters[(host::level(s2) == HIGH) << 1 | (host::level(s3) == HIGH)];
+}
+
+void Tcs230Model::setFrequency(uint8_t f, uint32_t frequency) {
+  hz[f & 3] = frequency;
+  start();
+}
+
+void Tcs230Model::start() {
+  if (running || hz[filter()] == 0)
+    return;
+  running = true;
+  nextNs = host::nowNs() + 500000000ULL / hz[filter()];
+  host::scheduleNs(nextNs, [this]() {toggle();});
+}
+
+void Tcs230Model::toggle() {
+  uint32_t f = hz[filter()];
+  if (f == 0) {
+    level = LOW;
+    host::drive(out, LOW);
+    running = false;
+    return;
+  }
+  level = !level;
+  if (level)
+    edges++;
+  host::drive(out, level);
+  // from the edge time, an interrupt reading the clock does not delay it
+  nextNs += 500000000ULL / f;
+  host::scheduleNs(nextNs, [this]() {toggle();});
+}
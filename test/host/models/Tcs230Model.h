@@ -0,0 +1,40 @@
+/*
+ * Tcs230Model.h
+ *
+ * TCS230 light to frequency converter: OUT is a 50% duty square wave at the
+ * frequency set for the filter S2 and S3 select. A new filter takes effect
+ * at the next half period, 0 Hz holds OUT low.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Tcs230Model_h
+#define Tcs230Model_h
+
+#include "HostSim.h"
+
+class Tcs230Model {
+  public:
+    Tcs230Model(uint8_t s2Pin, uint8_t s3Pin, uint8_t outPin);
+
+    // filter 0 red, 1 green, 2 blue, 3 clear, as S2 and S3 select them
+    void setFrequency(uint8_t filter, uint32_t hz);
+    uint8_t filter() const;
+
+    // rising edges on OUT
+    uint32_t edges = 0;
+
+  private:
+    uint8_t s2;
+    uint8_t s3;
+    uint8_t out;
+    uint32_t hz[4] = {0, 0, 0, 0};
+    int level = 0;
+    bool running = false;
+    uint64_t nextNs = 0;
+
+    void start();
+    void toggle();
+};
+
+#endif // Tcs230Model_h
@@ -0,0 +1,85 @@
+/*
+ * Tm1637Model.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "Tm1637Model.h"
+#include "Arduino.h"
+
+Tm1637Model::Tm1637Model(uint8_t clkPin, uint8_t dioPin) : clk(clkPin), dio(dioPin) {
+  host::setPull(dio, HIGH);
+  host::watch(clk, [this](uint8_t, int level) {clock(level);});
+  host::watch(dio, [this](uint8_t, int level) {data(level);});
+}
+
+/*
+ * The ninth clock is the ack, while it lasts the data line belongs to the
+ * driver and its edges are no start or stop
+ */
+void Tm1637Model::clock(int level) {
+  if (level == HIGH) {
+    clocks++;
+    if (!inTransfer || acking || bits == 8)
+      return;
+    if (host::level(dio) == HIGH)
+      byte |= 1 << bits;
+    bits++;
+    return;
+  }
+  if (acking) {
+    acking = false;
+    host::drive(dio, host::FLOATING);
+    return;
+  }
+  if (inTransfer && bits == 8) {
+    received(byte);
+    bits = 0;
+    byte = 0;
+    acking = true;
+    if (!silent)
+      host::drive(dio, LOW);
+  }
+}
+
+void Tm1637Model::data(int level) {
+  if (acking || host::level(clk) != HIGH)
+    return;
+  if (level == LOW) {
+    inTransfer = true;
+    transfers++;
+    bits = 0;
+    byte = 0;
+    index = 0;
+  } else {
+    inTransfer = false;
+  }
+}
+
+void Tm1637Model::received(uint8_t b) {
+  if (index++ == 0) {
+    addressed = (b & 0xC0) == 0xC0;
+    switch (b & 0xC0) {
+      case 0x40:
+        dataCommands++;
+        autoIncrement = !(b & 0x04);
+        break;
+      case 0x80:
+        controls++;
+        control = b;
+        break;
+      case 0xC0:
+        address = b & 0x07;
+        break;
+    }
+    return;
+  }
+  if (!addressed)
+    return;
+  if (address < sizeof(ram)) {
+    ram[address] = b;
+    digitWrites++;
+  }
+  if (autoIncrement)
+    address++;
+}
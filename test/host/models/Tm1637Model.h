@@ -0,0 +1,53 @@
+/*
+ * Tm1637Model.h
+ *
+ * TM1637 LED driver on a clock and a data line. A start is the data line
+ * falling while the clock is high, a stop the data line rising. Bytes come
+ * LSB first on the rising clock, the driver pulls the data line low from
+ * the eighth falling clock to the ninth to ack them. The first byte of a
+ * transfer is the data command, an address followed by display data, or
+ * the display control.
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef Tm1637Model_h
+#define Tm1637Model_h
+
+#include "HostSim.h"
+
+class Tm1637Model {
+  public:
+    Tm1637Model(uint8_t clkPin, uint8_t dioPin);
+
+    // a driver that does not ack
+    void setSilent(bool silent) {this->silent = silent;}
+
+    uint8_t ram[6] = {0, 0, 0, 0, 0, 0};
+    uint8_t control = 0;
+    bool autoIncrement = true;
+
+    uint32_t clocks = 0;       // rising clock edges
+    uint32_t transfers = 0;    // start to stop
+    uint32_t dataCommands = 0;
+    uint32_t controls = 0;
+    uint32_t digitWrites = 0;
+
+  private:
+    uint8_t clk;
+    uint8_t dio;
+    bool silent = false;
+    bool inTransfer = false;
+    bool acking = false;
+    uint8_t bits = 0;
+    uint8_t byte = 0;
+    uint8_t index = 0;         // byte of the transfer
+    bool addressed = false;    // the transfer began with an address
+    uint8_t address = 0;
+
+    void clock(int level);
+    void data(int level);
+    void received(uint8_t b);
+};
+
+#endif // Tm1637Model_h
@@ -0,0 +1,48 @@
+/*
+ * TtsModel.cpp
+ *
+ * Released into the MIT License.
+ */
+
+#include "TtsModel.h"
+
+#define TTS_MESSAGE_GAP 3000000ULL
+
+TtsModel::TtsModel(uint8_t rxPin, uint8_t txPin, uint32_t baud)
+  : rxPin(rxPin), txPin(txPin), baud(baud) {
+  host::attachUART(txPin, this);
+}
+
+TtsModel::~TtsModel() {
+  host::detachUART(txPin);
+}
+
+void TtsModel::uartReceive(uint8_t b) {
+  pending += (char)b;
+  lastByte = host::nowNs();
+  host::scheduleNs(lastByte + TTS_MESSAGE_GAP, [this]() {
+    if (!pending.empty() && host::nowNs() - lastByte >= TTS_MESSAGE_GAP)
+      end();
+  });
+}
+
+void TtsModel::end() {
+  std::string m = pending;
+  pending.clear();
+  messages.push_back(m);
+  if (silent)
+    return;
+
+  if (m.size() >= 3 && m[0] == '<' && m[2] == '>' && m[1] != 'Z') {
+    reply(5, "OK");
+    return;
+  }
+  uint32_t ms = m.compare(0, 3, "<Z>") == 0 ? soundMs : msPerByte * m.size();
+  reply(10, "\x41");
+  if (!loseFinish)
+    reply(10 + ms, "\x4F");
+}
+
+void TtsModel::reply(uint32_t delayMs, const char *bytes) {
+  host::uartSend(rxPin, bytes, delayMs * 1000, baud);
+}
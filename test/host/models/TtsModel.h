@@ -0,0 +1,47 @@
+/*
+ * TtsModel.h
+ *
+ * Serial Chinese TTS module as Openblock_chineseTTS drives it. A message is
+ * the bytes sent without a pause of 3ms. Text and <Z> sounds answer 0x41
+ * when they start and 0x4F when done, settings such as <V>5 answer "OK".
+ *
+ * Released into the MIT License.
+ */
+
+#ifndef TtsModel_h
+#define TtsModel_h
+
+#include "HostSim.h"
+
+#include <string>
+#include <vector>
+
+class TtsModel : public host::UARTDevice {
+  public:
+    // the pins of the sketch: it receives on rxPin and sends on txPin
+    TtsModel(uint8_t rxPin, uint8_t txPin, uint32_t baud = 9600);
+    virtual ~TtsModel();
+
+    virtual void uartReceive(uint8_t b);
+
+    // time to speak one byte of text, and to play a sound, in ms
+    uint32_t msPerByte = 100;
+    uint32_t soundMs = 500;
+    // drop the finish byte, or every answer
+    bool loseFinish = false;
+    bool silent = false;
+
+    std::vector<std::string> messages;
+
+  private:
+    uint8_t rxPin;
+    uint8_t txPin;
+    uint32_t baud;
+    std::string pending;
+    uint64_t lastByte = 0;
+
+    void end();
+    void reply(uint32_t delayMs, const char *bytes);
+};
+
+#endif // TtsModel_h
@@ -0,0 +1,114 @@
+/*
+ * Arduino_APDS9960 on the register map: the ENABLE shadow saves a read per
+ * call, continuous mode restores the persistence filter it cleared, a color
+ * sample takes five transactions and none while INT is high, and a full
+ * gesture FIFO drains in Wire sized chunks.
+ */
+
+#include <Arduino_APDS9960.h>
+
+#include "Apds9960Model.h"
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+static const uint8_t INT_PIN = 2;
+
+int main() {
+  Apds9960Model sensor(INT_PIN);
+  APDS9960 apds(Wire, -1);
+  CHECK(apds.begin());
+
+  // one-shot color: the engine starts with one write, the status polls do
+  // not read ENABLE back
+  sensor.enableWrites = 0;
+  {
+    HOST_PROFILE("first colorAvailable");
+    CHECK_EQ(apds.colorAvailable(), 0);
+  }
+  CHECK_EQ(sensor.enableWrites, 1);
+  CHECK_EQ(host::Profiler::summary("first colorAvailable").i2c, 3);
+  {
+    HOST_PROFILE("colorAvailable");
+    CHECK_EQ(apds.colorAvailable(), 0);
+  }
+  CHECK_EQ(sensor.enableWrites, 1);
+  CHECK_EQ(host::Profiler::summary("colorAvailable").i2c, 2);
+  sensor.colorCycle(400, 100, 200, 300);
+  CHECK_EQ(apds.colorAvailable(), 1);
+  int r, g, b, c;
+  CHECK(apds.readColor(r, g, b, c));
+  CHECK(r == 100 && g == 200 && b == 300 && c == 400);
+  CHECK_EQ(sensor.reg[Apds9960Model::ENABLE] & 0x02, 0);
+
+  // continuous mode clears PERS for an interrupt every cycle and puts the
+  // sketch's filter back when it ends, also when enabled twice
+  sensor.reg[Apds9960Model::PERS] = 0x31;
+  CHECK(apds.setContinuousMode(true));
+  CHECK_EQ(sensor.reg[Apds9960Model::PERS], 0);
+  CHECK_EQ(sensor.reg[Apds9960Model::ENABLE], 0x7F);
+  CHECK(apds.setContinuousMode(true));
+  CHECK_EQ(sensor.reg[Apds9960Model::PERS], 0);
+  CHECK(apds.setContinuousMode(false));
+  CHECK_EQ(sensor.reg[Apds9960Model::PERS], 0x31);
+  CHECK_EQ(sensor.reg[Apds9960Model::ENABLE] & 0x76, 0);
+  uint32_t persWrites = sensor.persWrites;
+  CHECK(apds.setContinuousMode(false));
+  CHECK_EQ(sensor.persWrites, persWrites);
+  CHECK_EQ(sensor.reg[Apds9960Model::PERS], 0x31);
+
+  // with the INT pin nothing is read until a cycle ends, a sample is the
+  // status, the 8 byte burst and the clear
+  apds.setInterruptPin(INT_PIN);
+  CHECK(apds.setContinuousMode(true));
+  {
+    HOST_PROFILE("idle");
+    for (int i = 0; i < 100; i++) {
+      CHECK_EQ(apds.colorAvailable(), 0);
+      CHECK_EQ(apds.proximityAvailable(), 0);
+    }
+  }
+  CHECK_EQ(host::Profiler::summary("idle").i2c, 0);
+  for (int i = 0; i < 10; i++) {
+    sensor.colorCycle(1000 + i, 10 + i, 20 + i, 30 + i);
+    CHECK_EQ(digitalRead(INT_PIN), LOW);
+    HOST_PROFILE("color sample");
+    CHECK_EQ(apds.colorAvailable(), 1);
+    CHECK(apds.readColor(r, g, b, c));
+    CHECK(r == 10 + i && g == 20 + i && b == 30 + i && c == 1000 + i);
+    CHECK_EQ(digitalRead(INT_PIN), HIGH);
+  }
+  CHECK_EQ(host::Profiler::summary("color sample").i2c, 10 * 5);
+  // the engines stay on between samples
+  CHECK_EQ(sensor.reg[Apds9960Model::ENABLE], 0x7F);
+
+  // reading the color leaves a pending proximity interrupt
+  sensor.colorCycle(1, 2, 3, 4);
+  sensor.proximityCycle(55);
+  CHECK(apds.readColor(r, g, b, c));
+  CHECK_EQ(digitalRead(INT_PIN), LOW);
+  CHECK_EQ(apds.colorAvailable(), 0);
+  CHECK_EQ(apds.proximityAvailable(), 1);
+  CHECK_EQ(apds.readProximity(), 200);
+  CHECK_EQ(digitalRead(INT_PIN), HIGH);
+
+  // a full FIFO of 32 datasets, the gesture ends in the last one
+  apds.setInterruptPin(-1);
+  sensor.pushGesture(0, 0, 0, 0);
+  for (int i = 0; i < 15; i++)
+    sensor.pushGesture(100, 100, 200, 50);
+  for (int i = 0; i < 15; i++)
+    sensor.pushGesture(100, 100, 50, 200);
+  sensor.pushGesture(0, 0, 0, 0);
+  CHECK_EQ(sensor.reg[Apds9960Model::GFLVL], 32);
+  CHECK_EQ(apds.gestureAvailable(), 1);
+  CHECK_EQ(apds.readGesture(), GESTURE_LEFT);
+  CHECK(sensor.fifo.empty());
+  CHECK(sensor.longestFifoRead > 0 && sensor.longestFifoRead <= BUFFER_LENGTH);
+
+  CHECK(apds.setContinuousMode(false));
+  CHECK_EQ(sensor.reg[Apds9960Model::PERS], 0x31);
+
+  host::Profiler::print();
+  return testResult("apds9960");
+}
@@ -0,0 +1,108 @@
+/*
+ * OB_ChineseTTS queue against a module model on SoftwareSerial: items go
+ * out one at a time in order, poll() only blocks for the bytes it sends,
+ * and lost status bytes end an item by timeout instead of hanging.
+ */
+
+#include <Openblock_chineseTTS.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "TtsModel.h"
+
+static int finished = 0;
+static uint8_t lastRemaining = 0;
+
+static void onFinish(uint8_t remaining) {
+  finished++;
+  lastRemaining = remaining;
+}
+
+// calls poll() every 10ms for the given time, as loop() would
+static void loopFor(OB_ChineseTTS &tts, uint32_t ms) {
+  uint32_t start = millis();
+  while (millis() - start < ms) {
+    {
+      HOST_PROFILE("poll");
+      tts.poll();
+    }
+    host::advance(10000);
+  }
+}
+
+int main() {
+  TtsModel module(2, 3);
+  OB_ChineseTTS tts(2, 3);
+
+  tts.begin();
+  tts.onFinish(onFinish);
+
+  // a setting is answered with OK, the call waits for it
+  tts.setVolume(5);
+  CHECK(!tts.busy());
+  CHECK(!tts.timedOut());
+  CHECK_EQ(finished, 1);
+  CHECK_EQ(module.messages.size(), 1);
+  CHECK(module.messages[0] == "<V>5");
+
+  // three items in order, the sound keeps its 1s gap
+  CHECK(tts.enqueue("ni hao"));
+  CHECK(tts.enqueueSound(3));
+  CHECK(tts.enqueue("zai jian"));
+  CHECK_EQ(tts.queueDepth(), 2);
+  loopFor(tts, 4000);
+  CHECK(!tts.busy());
+  CHECK_EQ(finished, 4);
+  CHECK_EQ(lastRemaining, 0);
+  CHECK_EQ(module.messages.size(), 4);
+  CHECK(module.messages[1] == "ni hao");
+  CHECK(module.messages[2] == "<Z>3");
+  CHECK(module.messages[3] == "zai jian");
+  // enqueue() sent the first item, poll() the others, blocking for the
+  // 1.04ms a byte takes at 9600 baud and no longer
+  host::ProfileSummary p = host::Profiler::summary("poll");
+  CHECK_EQ(p.uart, 4 + 8);
+  CHECK(p.totalUs < p.calls * 10 + p.uart * 1050);
+
+  // the finish byte is lost: the item ends after TTS_FINISH_TIMEOUT
+  module.loseFinish = true;
+  CHECK(tts.enqueue("a"));
+  CHECK(tts.enqueue("b"));
+  loopFor(tts, TTS_FINISH_TIMEOUT + 500);
+  CHECK(tts.timedOut());
+  CHECK_EQ(finished, 5);
+  CHECK_EQ(module.messages.size(), 6);
+  module.loseFinish = false;
+  loopFor(tts, TTS_FINISH_TIMEOUT);
+  CHECK(!tts.busy());
+
+  // nothing answers: TTS_START_TIMEOUT
+  module.silent = true;
+  tts.setSpeechRate(3);
+  loopFor(tts, TTS_START_TIMEOUT + 100);
+  CHECK(!tts.busy());
+  CHECK(tts.timedOut());
+  module.silent = false;
+
+  // the blocking call waits for the whole utterance
+  {
+    HOST_PROFILE("sayUnitllFinish");
+    tts.sayUnitllFinish((char *)"hao");
+  }
+  CHECK(!tts.timedOut());
+  CHECK(host::Profiler::summary("sayUnitllFinish").totalUs > 300000);
+
+  // as generator.js emits it: the text goes out after the setting was
+  // answered, not in the same message
+  size_t sent = module.messages.size();
+  tts.setVolume(3);
+  tts.say((char *)"ni hao");
+  loopFor(tts, 1000);
+  CHECK_EQ(module.messages.size(), sent + 2);
+  CHECK(module.messages[sent] == "<V>3");
+  CHECK(module.messages[sent + 1] == "ni hao");
+
+  host::Profiler::print();
+  return testResult("chinese_tts");
+}
@@ -0,0 +1,120 @@
+/*
+ * DHT22 read through the pin interrupt against a sensor model, with the
+ * AVR interrupt flag that remembers the falling edge of the start signal.
+ * Built against both copies of the library, see the Makefile.
+ */
+
+#include <DHT.h>
+#include <string.h>
+
+#include "DhtModel.h"
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+// falling edges of an answer carrying b, starting at t0 in us
+static void answerEdges(uint16_t *edges, const uint8_t *b, uint16_t t0) {
+  uint16_t t = t0 + 30;
+  int n = 0;
+  edges[n++] = t;
+  t += 160;
+  edges[n++] = t;
+  for (int i = 0; i < 40; i++) {
+    t += 50 + (b[i / 8] & (0x80 >> (i % 8)) ? 70 : 26);
+    edges[n++] = t;
+  }
+}
+
+static void checkDecode() {
+  uint8_t ok[5] = {0x02, 0x8C, 0x01, 0x5F, 0};
+  uint8_t bad[5];
+  uint8_t out[5];
+  uint16_t edges[DHT_EDGES];
+
+  ok[4] = ok[0] + ok[1] + ok[2] + ok[3];
+  // micros() wraps in the middle of the reading
+  answerEdges(edges, ok, 65500);
+  CHECK_EQ(DHT::decode(edges, DHT_EDGES, out), DHT_OK);
+  CHECK(memcmp(out, ok, 5) == 0);
+
+  memcpy(bad, ok, 5);
+  bad[4] ^= 1;
+  answerEdges(edges, bad, 0);
+  CHECK_EQ(DHT::decode(edges, DHT_EDGES, out), DHT_ERROR_CHECKSUM);
+
+  // one edge missed, a two bit gap
+  answerEdges(edges, ok, 0);
+  memmove(edges + 20, edges + 21, (DHT_EDGES - 21) * sizeof(edges[0]));
+  edges[DHT_EDGES - 1] = edges[DHT_EDGES - 2] + 77;
+  CHECK_EQ(DHT::decode(edges, DHT_EDGES, out), DHT_ERROR_PULSE);
+  CHECK_EQ(DHT::decode(edges, 30, out), DHT_ERROR_TIMEOUT);
+}
+
+// polls every 100us as a busy loop() would, returns the result
+static uint8_t pollUntilDone(DHT &dht) {
+  for (;;) {
+    uint8_t status;
+    {
+      HOST_PROFILE("poll");
+      status = dht.poll();
+    }
+    if (status != DHT_BUSY)
+      return status;
+    host::advance(100);
+  }
+}
+
+int main() {
+  checkDecode();
+
+  host::setInterruptPins({2, 3});
+  host::setInterruptFlagLatch(true);
+  host::advance(5000);
+
+  DhtModel sensor(2, DHT22);
+  DHT dht(2, DHT22);
+
+  dht.begin();
+  sensor.setReading(65.2, -3.5);
+  CHECK(dht.startRead());
+  CHECK(!dht.startRead());
+  CHECK_EQ(pollUntilDone(dht), DHT_OK);
+  CHECK_EQ(sensor.starts, 1);
+  CHECK(dht.readHumidity() > 65.15f && dht.readHumidity() < 65.25f);
+  CHECK(dht.readTemperature() < -3.45f && dht.readTemperature() > -3.55f);
+  // the line is let go for the sensor, a poll never blocks on it
+  CHECK(!host::isOutput(2));
+  host::ProfileSummary p = host::Profiler::summary("poll");
+  CHECK(p.totalUs < p.calls * 10);
+
+  // a changed reading after the 2s the sensor needs
+  host::advance(2000000);
+  sensor.setReading(40.0, 25.0);
+  CHECK(dht.startRead());
+  CHECK_EQ(pollUntilDone(dht), DHT_OK);
+  CHECK(dht.readTemperature() > 24.95f && dht.readTemperature() < 25.05f);
+
+  uint8_t bad[5] = {1, 2, 3, 4, 0};
+  host::advance(2000000);
+  sensor.setBytes(bad);
+  CHECK(dht.startRead());
+  CHECK_EQ(pollUntilDone(dht), DHT_ERROR_CHECKSUM);
+
+  host::advance(2000000);
+  sensor.setSilent(true);
+  CHECK(dht.startRead());
+  CHECK_EQ(pollUntilDone(dht), DHT_ERROR_TIMEOUT);
+  CHECK_EQ(sensor.answers, 3);
+
+  // without the flag latch, as on cores that do not keep it
+  host::advance(2000000);
+  host::setInterruptFlagLatch(false);
+  sensor.setSilent(false);
+  sensor.setReading(50.0, 20.0);
+  CHECK(dht.startRead());
+  CHECK_EQ(pollUntilDone(dht), DHT_OK);
+  CHECK(dht.readHumidity() > 49.95f && dht.readHumidity() < 50.05f);
+
+  host::Profiler::print();
+  return testResult("dht");
+}
@@ -0,0 +1,179 @@
+/*
+ * Adafruit_GrayOLED: the byte wise primitives must draw what the per pixel
+ * ones of Adafruit_GFX draw and mark every change dirty, and a display()
+ * that sends only the dirty spans keeps an SSD1306 in step with the buffer.
+ */
+
+#include <Adafruit_GrayOLED.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "Ssd1306Model.h"
+
+/*
+ * 1 bpp panels are laid out as an SSD1306, display() sends each dirty span
+ * with a page and column window
+ */
+class Panel : public Adafruit_GrayOLED {
+  public:
+    Panel(uint8_t bpp, int w, int h) : Adafruit_GrayOLED(bpp, w, h, &Wire) {}
+    bool begin() {return _init(0x3C, false);}
+
+    void display() {
+      uint8_t x1, x2;
+      for (uint8_t row = 0; row < dirtyRows(); row++) {
+        if (!getDirtySpan(row, &x1, &x2))
+          continue;
+        const uint8_t window[] = {0x22, row, row, 0x21, x1, x2};
+        oled_commandList(window, sizeof(window));
+        uint8_t control = 0x40;
+        const uint8_t *p = buffer + row * WIDTH + x1;
+        size_t left = x2 - x1 + 1;
+        while (left > 0) {
+          size_t n = left < 31 ? left : 31;
+          i2c_dev->write(p, n, true, &control, 1);
+          p += n;
+          left -= n;
+        }
+      }
+      clearDirty();
+    }
+
+    size_t bufferSize() {return _bpp * WIDTH * ((HEIGHT + 7) / 8);}
+
+    using Adafruit_GrayOLED::clearDirty;
+    using Adafruit_GrayOLED::dirtyRows;
+    using Adafruit_GrayOLED::getDirtySpan;
+};
+
+/*
+ * The same panel drawing through the Adafruit_GFX per pixel primitives
+ */
+class Reference : public Panel {
+  public:
+    Reference(uint8_t bpp, int w, int h) : Panel(bpp, w, h) {}
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) {Adafruit_GFX::drawFastHLine(x, y, w, c);}
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) {Adafruit_GFX::drawFastVLine(x, y, h, c);}
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) {Adafruit_GFX::fillRect(x, y, w, h, c);}
+};
+
+// a changed buffer byte outside the dirty span of its row
+static bool undirty(Panel &p, const std::vector<uint8_t> &before, uint8_t bpp, int width) {
+  const uint8_t *now = p.getBuffer();
+  for (size_t i = 0; i < before.size(); i++) {
+    if (now[i] == before[i])
+      continue;
+    int row, col;
+    if (bpp == 1) {
+      row = i / width;
+      col = i % width;
+    } else {
+      row = i / (width / 2);
+      col = (i % (width / 2)) * 2;
+    }
+    uint8_t x1, x2;
+    if (!p.getDirtySpan(row, &x1, &x2) || col + (bpp == 4) < x1 || col > x2)
+      return true;
+  }
+  return false;
+}
+
+static void compare(uint8_t bpp, int width, int height) {
+  for (int rot = 0; rot < 4; rot++) {
+    Panel p(bpp, width, height);
+    Reference r(bpp, width, height);
+    CHECK(p.begin() && r.begin());
+    p.setRotation(rot);
+    r.setRotation(rot);
+    for (int i = 0; i < 1000; i++) {
+      int x = rand() % (width + 40) - 20, y = rand() % (height + 40) - 20;
+      int w = rand() % 70 + 1, h = rand() % 70 + 1;
+      uint16_t c = bpp == 1 ? rand() % 3 : rand() % 16;
+      p.clearDirty();
+      std::vector<uint8_t> before(p.getBuffer(), p.getBuffer() + p.bufferSize());
+      switch (rand() % 4) {
+        case 0: p.fillRect(x, y, w, h, c); r.fillRect(x, y, w, h, c); break;
+        case 1: p.drawFastHLine(x, y, w, c); r.drawFastHLine(x, y, w, c); break;
+        case 2: p.drawFastVLine(x, y, h, c); r.drawFastVLine(x, y, h, c); break;
+        default:
+          p.fillCircle(x, y, w / 3, c);
+          r.fillCircle(x, y, w / 3, c);
+          p.drawLine(x, y, x + w, y + h, c);
+          r.drawLine(x, y, x + w, y + h, c);
+      }
+      if (memcmp(p.getBuffer(), r.getBuffer(), p.bufferSize()) != 0) {
+        CHECK(!"fast primitive differs");
+        memcpy(p.getBuffer(), r.getBuffer(), p.bufferSize());
+      }
+      CHECK(!undirty(p, before, bpp, width));
+    }
+  }
+}
+
+// the model has no rotation, compare unrotated
+static bool sameAsBuffer(Panel &p, Ssd1306Model &model) {
+  uint8_t rot = p.getRotation();
+  bool same = true;
+  p.setRotation(0);
+  for (int y = 0; y < p.height(); y++) {
+    for (int x = 0; x < p.width(); x++) {
+      if (p.getPixel(x, y) != model.pixel(x, y))
+        same = false;
+    }
+  }
+  p.setRotation(rot);
+  return same;
+}
+
+int main() {
+  // begin() probes the address
+  Ssd1306Model model(0x3C);
+
+  srand(1);
+  compare(1, 128, 64);
+  compare(1, 128, 32);
+  compare(1, 64, 48);
+  compare(4, 128, 128);
+  compare(4, 96, 64);
+
+  Panel oled(1, 128, 64);
+  CHECK(oled.begin());
+  oled.clearDisplay();
+  oled.fillRect(10, 10, 50, 30, MONOOLED_WHITE);
+  {
+    HOST_PROFILE("display full");
+    oled.display();
+  }
+  CHECK(sameAsBuffer(oled, model));
+
+  // two pixels in opposite corners: two one byte spans
+  oled.drawPixel(0, 0, MONOOLED_WHITE);
+  oled.drawPixel(127, 63, MONOOLED_WHITE);
+  {
+    HOST_PROFILE("display 2 pixels");
+    oled.display();
+  }
+  CHECK(sameAsBuffer(oled, model));
+  host::ProfileSummary s = host::Profiler::summary("display 2 pixels");
+  CHECK_EQ(s.i2c, 4);
+  CHECK_EQ(s.bytes, 2 * (7 + 2));
+  CHECK(s.busUs * 20 < host::Profiler::summary("display full").busUs);
+
+  oled.setRotation(1);
+  oled.drawFastHLine(5, 20, 40, MONOOLED_INVERSE);
+  oled.drawFastVLine(30, 2, 100, MONOOLED_BLACK);
+  {
+    HOST_PROFILE("display lines");
+    oled.display();
+  }
+  CHECK(sameAsBuffer(oled, model));
+  CHECK_EQ(oled.dirtyRows(), 8);
+
+  host::Profiler::print();
+  return testResult("grayoled");
+}
@@ -0,0 +1,97 @@
+/*
+ * I2CBus queue order, cancel, time budget and statistics, and MPU6050
+ * requestUpdate() reading the same as update().
+ */
+
+#include <I2CBus.h>
+#include <MPU6050_tockn.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "RegisterModel.h"
+
+static int order[16];
+static int finished = 0;
+
+static void done(I2CTransaction &t) {
+  order[finished++] = (int)(intptr_t)t.arg;
+}
+
+int main() {
+  RegisterModel dev(0x29);
+  Mpu6050Model mpuModel;
+  I2CBus bus;
+  uint8_t r = 0x10;
+  uint8_t buf[5][4];
+  I2CTransaction t[5];
+
+  for (int i = 0; i < 256; i++)
+    dev.reg[i] = i * 7;
+  Wire.begin();
+  for (int i = 0; i < 5; i++)
+    t[i] = I2CTransaction(0x29, &r, 1, buf[i], 4, i == 3 ? 9 : i % 2, done, (void *)(intptr_t)i);
+
+  CHECK(!bus.submit(t[0]));
+  bus.begin();
+  for (int i = 0; i < 5; i++)
+    CHECK(bus.submit(t[i]));
+  CHECK(!bus.submit(t[0]));
+  CHECK(bus.cancel(t[4]));
+  {
+    HOST_PROFILE("poll 4");
+    bus.poll();
+  }
+  // priority 9, then 1, then the two of 0 in submit order
+  CHECK_EQ(finished, 4);
+  CHECK(order[0] == 3 && order[1] == 1 && order[2] == 0 && order[3] == 2);
+  CHECK(t[4].done() && t[4].error == I2CBUS_CANCELLED);
+  CHECK(t[0].ok() && buf[0][2] == (uint8_t)(0x12 * 7));
+  CHECK_EQ(host::Profiler::summary("poll 4").i2c, 8);
+
+  // the address write fails, nothing is read
+  I2CTransaction missing(0x40, &r, 1, buf[0], 2);
+  bus.submit(missing);
+  bus.poll();
+  CHECK(missing.done() && missing.error == 2);
+
+  // a transaction takes 660us at 100kHz, so a 100us budget runs one per poll
+  bus.setTimeBudget(100);
+  finished = 0;
+  for (int i = 0; i < 4; i++)
+    bus.submit(t[i]);
+  bus.poll();
+  CHECK_EQ(finished, 1);
+  while (bus.busy())
+    bus.poll();
+  CHECK_EQ(finished, 4);
+
+  I2CBusStats s;
+  CHECK(bus.stats(0x29, s));
+  CHECK_EQ(s.transactions, 8);
+  CHECK_EQ(s.bytes, 8 * 5);
+  // micros() moves a little on every call besides the bus time
+  CHECK(s.busTime >= 8 * 660 && s.busTime < 8 * 660 + 8 * 4);
+  CHECK(s.maxLatency > s.maxBusTime);
+  CHECK(bus.stats(0x40, s) && s.errors == 1);
+
+  // the queued read of the MPU6050 gives what update() gives
+  bus.setTimeBudget(0);
+  mpuModel.setAccel(1200, -3400, 15000);
+  mpuModel.setGyro(10, 20, -30);
+  MPU6050 a(Wire), b(Wire);
+  a.setGyroOffsets(0, 0, 0);
+  b.setGyroOffsets(0, 0, 0);
+  a.update();
+  CHECK(b.requestUpdate(bus));
+  CHECK(!b.requestUpdate(bus));
+  CHECK(b.updatePending());
+  bus.poll();
+  CHECK(!b.updatePending());
+  CHECK_EQ(a.getRawAccX(), b.getRawAccX());
+  CHECK_EQ(a.getRawGyroZ(), b.getRawGyroZ());
+  CHECK(a.getAccAngleY() == b.getAccAngleY());
+
+  host::Profiler::print();
+  return testResult("i2cbus");
+}
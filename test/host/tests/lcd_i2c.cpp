@@ -0,0 +1,83 @@
+/*
+ * LiquidCrystal_I2C against a PCF8574 + HD44780 model: the text must reach
+ * the display without a command sent before the previous one finished, and
+ * a shadow flush only sends what changed.
+ */
+
+#include <LiquidCrystal_I2C.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "LcdModel.h"
+#include "Profiler.h"
+
+int main() {
+  LcdModel model(0x27, 16, 2);
+  LiquidCrystal_I2C lcd(0x27, 16, 2);
+
+  {
+    HOST_PROFILE("init");
+    lcd.init();
+  }
+  lcd.backlight();
+  CHECK(model.displayOn());
+  CHECK(model.backlight());
+  // the power up waits are most of it
+  CHECK(host::Profiler::summary("init").delayUs > 1050000);
+
+  {
+    HOST_PROFILE("print 16");
+    lcd.setCursor(0, 0);
+    lcd.print("hello, host core");
+  }
+  CHECK(model.line(0) == "hello, host core");
+  // one set address, then 5 characters of 6 bytes per transaction
+  host::ProfileSummary p = host::Profiler::summary("print 16");
+  CHECK_EQ(p.i2c, 1 + 4);
+  CHECK_EQ(p.bytes, 6 + 16 * 6);
+
+  lcd.setCursor(3, 1);
+  lcd.print(1234);
+  CHECK(model.line(1) == "   1234         ");
+
+  {
+    HOST_PROFILE("clear");
+    lcd.clear();
+  }
+  CHECK(model.line(0) == std::string(16, ' '));
+
+  // the same frame twice: the second flush has nothing to send
+  CHECK(lcd.beginShadow());
+  lcd.setCursor(0, 0);
+  lcd.print("T 21.5C H 40%");
+  lcd.setCursor(0, 1);
+  lcd.print("fan on");
+  {
+    HOST_PROFILE("flush full");
+    lcd.flush();
+  }
+  CHECK(model.line(0) == "T 21.5C H 40%   ");
+  CHECK(model.line(1) == "fan on          ");
+  lcd.home();
+  lcd.print("T 21.5C H 40%");
+  {
+    HOST_PROFILE("flush same");
+    lcd.flush();
+  }
+  CHECK_EQ(host::Profiler::summary("flush same").i2c, 0);
+
+  // one digit changed: an address and one character
+  lcd.home();
+  lcd.print("T 21.6C H 40%");
+  {
+    HOST_PROFILE("flush 1 cell");
+    lcd.flush();
+  }
+  CHECK(model.line(0) == "T 21.6C H 40%   ");
+  CHECK_EQ(host::Profiler::summary("flush 1 cell").i2c, 2);
+  lcd.endShadow();
+
+  CHECK_EQ(model.tooEarly, 0);
+  host::Profiler::print();
+  return testResult("lcd_i2c");
+}
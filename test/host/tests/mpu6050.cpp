@@ -0,0 +1,82 @@
+/*
+ * MPU6050_tockn against a register model: begin() configures the chip,
+ * update() is one 14 byte burst, calcGyroOffsets() is 3000 reads.
+ */
+
+#include <MPU6050_tockn.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "RegisterModel.h"
+
+// bus time of a register pointer write and a read of n bytes, in us
+static double readUs(unsigned n, uint32_t clock) {
+  return ((1 + 9 * 2) + (1 + 9 * (1 + n) + 1)) * 1e6 / clock;
+}
+
+int main() {
+  Mpu6050Model model;
+  MPU6050 mpu(Wire);
+
+  model.setAccel(0, 0, 16384);
+  model.setGyro(655, -655, 0);
+  model.setTemp(-12412 + 340 * 2);
+  Wire.begin();
+  mpu.setGyroOffsets(0, 0, 0);
+  {
+    HOST_PROFILE("begin");
+    mpu.begin();
+  }
+  CHECK_EQ(model.reg[0x6B], 0x01);
+  CHECK_EQ(model.reg[0x1B], 0x08);
+  CHECK_EQ(host::Profiler::summary("begin").i2c, 5 + 2);
+
+  {
+    HOST_PROFILE("update");
+    mpu.update();
+  }
+  CHECK_EQ(mpu.getRawAccZ(), 16384);
+  CHECK(mpu.getGyroX() > 9.99f && mpu.getGyroX() < 10.01f);
+  CHECK(mpu.getTemp() > 1.99f && mpu.getTemp() < 2.01f);
+  CHECK(mpu.getAccAngleX() > -0.01f && mpu.getAccAngleX() < 0.01f);
+  host::ProfileSummary u = host::Profiler::summary("update");
+  CHECK_EQ(u.i2c, 2);
+  CHECK_EQ(u.bytes, 1 + 14);
+  CHECK(u.busUs > readUs(14, 100000) - 1 && u.busUs < readUs(14, 100000) + 1);
+
+  model.setAccel(16384, 0, 0);
+  Wire.setClock(400000);
+  {
+    HOST_PROFILE("update 400kHz");
+    mpu.update();
+  }
+  CHECK(mpu.getAccAngleY() < -89.9f && mpu.getAccAngleY() > -90.1f);
+  CHECK(host::Profiler::summary("update 400kHz").busUs < u.busUs / 3.9);
+
+  // the offsets are the mean of 3000 gyro reads, after a second of rest
+  Wire.setClock(100000);
+  {
+    HOST_PROFILE("calcGyroOffsets");
+    mpu.calcGyroOffsets(false, 1000, 0);
+  }
+  CHECK(mpu.getGyroXoffset() > 9.99f && mpu.getGyroXoffset() < 10.01f);
+  CHECK(mpu.getGyroYoffset() < -9.99f && mpu.getGyroYoffset() > -10.01f);
+  host::ProfileSummary c = host::Profiler::summary("calcGyroOffsets");
+  CHECK_EQ(c.i2c, 2 * 3000);
+  CHECK_EQ(c.delays, 1);
+  CHECK_EQ((long)c.delayUs, 1000000L);
+  CHECK(c.busUs > 3000 * readUs(6, 100000) - 1 && c.busUs < 3000 * readUs(6, 100000) + 1);
+
+  // nothing answers without the chip
+  host::detachI2C(0x68);
+  {
+    HOST_PROFILE("update missing");
+    mpu.update();
+  }
+  CHECK_EQ(host::Profiler::summary("update missing").errors, 2);
+  CHECK_EQ(mpu.getRawAccX(), -1);
+
+  host::Profiler::print();
+  return testResult("mpu6050");
+}
@@ -0,0 +1,151 @@
+/*
+ * NoiselessTouchESP32 running statistics against the full scan they
+ * replaced, for every window length: ramps longer than the window, noise
+ * and steps. Then three pads drifting with periodic touches.
+ */
+
+#include <NoiselessTouchESP32.h>
+#include <NoiselessTouchPads.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdlib.h>
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+static const uint8_t PIN = 4;
+
+// the filtered value of the window as the library computed it before the
+// running statistics, from a scan of every sample
+static int fullScan(const std::deque<uint8_t> &window, uint8_t hysteresis) {
+  uint8_t minimum = *std::min_element(window.begin(), window.end());
+  uint8_t maximum = *std::max_element(window.begin(), window.end());
+  uint32_t sum = 0;
+  for (size_t i = 0; i < window.size(); i++)
+    sum += window[i];
+  uint8_t mean = sum / window.size();
+  while (mean - minimum > hysteresis || maximum - mean > hysteresis) {
+    uint8_t ldelta = abs(mean - minimum);
+    uint8_t udelta = abs(maximum - mean);
+    uint8_t lbound = minimum + (ldelta / 2);
+    uint8_t ubound = maximum - (udelta / 2);
+    if (ldelta < udelta)
+      lbound = minimum;
+    else
+      ubound = maximum;
+    sum = 0;
+    uint8_t count = 0;
+    minimum = ubound;
+    maximum = lbound;
+    for (size_t i = 0; i < window.size(); i++) {
+      if (lbound <= window[i] && window[i] <= ubound) {
+        minimum = std::min(minimum, window[i]);
+        maximum = std::max(maximum, window[i]);
+        sum += window[i];
+        count++;
+      }
+    }
+    if (count == 0)
+      return mean;
+    mean = sum / count;
+  }
+  return mean;
+}
+
+// feeds the trace after the window filled with its first sample, counts
+// the samples that differ from the full scan
+static int mismatches(uint8_t length, uint8_t hysteresis, const std::vector<uint8_t> &trace) {
+  host::setAnalog(PIN, trace[0]);
+  NoiselessTouchESP32 touch(PIN, length, hysteresis);
+  std::deque<uint8_t> window(length, trace[0]);
+  int wrong = 0;
+  for (size_t i = 0; i < trace.size(); i++) {
+    host::setAnalog(PIN, trace[i]);
+    int value = touch.read_raw_mean();
+    window.pop_front();
+    window.push_back(trace[i]);
+    if (value != fullScan(window, hysteresis)) {
+      if (wrong == 0)
+        printf("  window %d: sample %d reads %d, the scan %d\n", length, (int)i, value,
+               fullScan(window, hysteresis));
+      wrong++;
+    }
+  }
+  return wrong;
+}
+
+int main() {
+  // ramps up and down, each run longer than the largest window, with
+  // plateaus between them
+  std::vector<uint8_t> ramp;
+  for (int v = 20; v < 120; v++)
+    ramp.push_back(v);
+  ramp.insert(ramp.end(), 20, 120);
+  for (int v = 120; v > 10; v--)
+    ramp.push_back(v);
+  ramp.insert(ramp.end(), 20, 10);
+  for (int v = 10; v < 250; v += 3)
+    ramp.push_back(v);
+
+  // noise around a level with spikes and touches
+  std::vector<uint8_t> noise;
+  uint32_t seed = 7;
+  for (int i = 0; i < 2000; i++) {
+    seed = seed * 1103515245 + 12345;
+    int v = 60 + (int)((seed >> 16) % 9) - 4;
+    if (i % 37 == 0)
+      v = 5;
+    if ((i / 150) % 2)
+      v -= 25;
+    noise.push_back(v);
+  }
+
+  for (uint8_t length = 1; length <= 16; length++) {
+    CHECK_EQ(mismatches(length, 3, ramp), 0);
+    CHECK_EQ(mismatches(length, 3, noise), 0);
+    CHECK_EQ(mismatches(length, 1, noise), 0);
+  }
+
+  // a window of 16 on a ramp that never turns, the case that filled the
+  // queues, also across the sequence number wrapping
+  std::vector<uint8_t> longRamp;
+  for (int i = 0; i < 70000; i++)
+    longRamp.push_back(i % 200 < 100 ? i % 100 + 50 : 150 - i % 100);
+  CHECK_EQ(mismatches(16, 3, longRamp), 0);
+
+  // three pads drifting from 70 down to 45 with a touch every 400 samples,
+  // every press and release is reported once
+  const uint8_t pins[] = {12, 13, 14};
+  for (int p = 0; p < 3; p++)
+    host::setAnalog(pins[p], 70);
+  NoiselessTouchPads pads(pins, 3);
+  int presses[3] = {0, 0, 0}, releases[3] = {0, 0, 0};
+  for (int i = 0; i < 4000; i++) {
+    for (int p = 0; p < 3; p++) {
+      int level = 70 - 25 * i / 4000;
+      bool touched = (i + 130 * p) % 400 >= 300;
+      host::setAnalog(pins[p], touched ? level / 2 : level);
+    }
+    pads.scan();
+    uint8_t index;
+    int e;
+    while ((e = pads.next_event(&index)) != 0) {
+      CHECK(index < 3);
+      if (e == TOUCH_EVENT_PRESSED)
+        presses[index]++;
+      else
+        releases[index]++;
+    }
+  }
+  for (int p = 0; p < 3; p++) {
+    CHECK_EQ(presses[p], 10);
+    CHECK(releases[p] == presses[p] || releases[p] == presses[p] - 1);
+    CHECK(abs(pads.pad(p).baseline() - 45) <= 3);
+  }
+
+  host::Profiler::print();
+  return testResult("noiselesstouch");
+}
@@ -0,0 +1,237 @@
+/*
+ * NtpClientLib on its W5100 path against a scripted NTP server on the
+ * Ethernet shield: the offset and delay from the four timestamps, the
+ * shortest round trip of a burst wins, a late reply to an older request is
+ * ignored, then twelve hours of jittered replies with the local clock 80 ppm
+ * slow, an outage and the recovery, with the Time library following.
+ */
+
+#include <NtpClientLib.h>
+#include <TimeLib.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "HostEthernet.h"
+#include "HostSim.h"
+#include "HostTest.h"
+
+static const IPAddress SERVER_IP(192, 168, 1, 10);
+static const uint16_t NTP_PORT = 123;
+// UTC at time 0 of the virtual clock, in us
+static const int64_t EPOCH = 1790000000LL * 1000000;
+static const uint32_t PROCESSING = 300;
+
+/*
+ * The server keeps UTC from the virtual clock, faster by ppm, and answers
+ * each request after the delay of the way there with T2 and T3, sent back
+ * after the delay of the way back
+ */
+class NtpServer : public host::UDPDevice {
+  public:
+    int ppm = 80;
+    bool answering = true;
+    uint32_t upUs = 20000;
+    uint32_t downUs = 20000;
+    // random extra delay each way, up to this
+    uint32_t jitterUs = 0;
+    // delays of the next requests, before upUs and downUs
+    std::deque<std::pair<uint32_t, uint32_t> > script;
+    // the next reply comes back this late and 5 s off, when set
+    uint32_t staleUs = 0;
+    std::vector<uint64_t> requests;
+
+    NtpServer() {host::attachUDP(SERVER_IP, NTP_PORT, this);}
+
+    int64_t utcUs(uint64_t hostUs) {
+      return EPOCH + (int64_t)hostUs + (int64_t)hostUs * ppm / 1000000;
+    }
+
+    void udpReceive(const uint8_t *data, size_t len, IPAddress from, uint16_t fromPort) {
+      (void)from;
+      requests.push_back(host::now());
+      if (!answering || len < NTP_PACKET_SIZE)
+        return;
+      uint32_t up = upUs, down = downUs;
+      int64_t skew = 0;
+      if (!script.empty()) {
+        up = script.front().first;
+        down = script.front().second;
+        script.pop_front();
+      } else if (jitterUs != 0) {
+        up += random() % jitterUs;
+        down += random() % jitterUs;
+      }
+      if (staleUs != 0) {
+        down = staleUs;
+        skew = 5000000;
+        staleUs = 0;
+      }
+      std::vector<uint8_t> request(data, data + len);
+      host::schedule(host::now() + up, [this, request, fromPort, down, skew]() {
+        uint8_t reply[NTP_PACKET_SIZE] = {0};
+        reply[0] = 0x24; // LI 0, version 4, server
+        reply[1] = 2;    // stratum
+        memcpy(reply + 24, request.data() + 40, 8);
+        stamp(reply + 32, utcUs(host::now()) + skew);
+        stamp(reply + 40, utcUs(host::now()) + PROCESSING + skew);
+        host::udpSend(SERVER_IP, NTP_PORT, fromPort, reply, sizeof(reply), PROCESSING + down);
+      });
+    }
+
+  private:
+    uint32_t random() {
+      seed = seed * 1103515245 + 12345;
+      return seed >> 8;
+    }
+
+    static void stamp(uint8_t *p, int64_t us) {
+      uint32_t secs = (uint32_t)(us / 1000000 + 2208988800LL);
+      uint32_t frac = (uint32_t)(((uint64_t)(us % 1000000) << 32) / 1000000);
+      for (int i = 0; i < 4; i++) {
+        p[i] = secs >> (24 - 8 * i);
+        p[4 + i] = frac >> (24 - 8 * i);
+      }
+    }
+
+    uint32_t seed = 1;
+};
+
+static NtpServer server;
+
+// the library's UTC against the server's, in ms
+static int64_t errorMs() {
+  return NTP.getUTCTimeMs() - server.utcUs(host::now()) / 1000;
+}
+
+static int64_t worstError = 0;
+static int wrongSeconds = 0;
+
+/*
+ * Calls handle() every ms around a request and every 100ms between bursts,
+ * with track the error of the library's clock and of now() is recorded
+ */
+static void run(uint64_t us, bool track = false) {
+  uint64_t end = host::now() + us;
+  while (host::now() < end) {
+    bool busy = server.requests.empty() || host::now() - server.requests.back() < 2000000;
+    host::advance(busy ? 1000 : 100000);
+    NTP.handle();
+    if (!track)
+      continue;
+    int64_t e = llabs(errorMs());
+    if (e > worstError)
+      worstError = e;
+    // now() keeps the phase of the library's clock, between the minutes it
+    // is set it runs on millis(), 80 ppm slow
+    int64_t utc = NTP.getUTCTimeMs();
+    int64_t phase = utc % 1000;
+    if (phase > 10 && phase < 990 && (int64_t)now() != utc / 1000)
+      wrongSeconds++;
+  }
+}
+
+static void restart() {
+  NTP.stop();
+  run(2000000);
+  server.requests.clear();
+  CHECK(NTP.begin("pool.ntp.org", 0, false, 0, NULL));
+}
+
+int main() {
+  host::addHost("pool.ntp.org", SERVER_IP);
+
+  // 20ms each way: the clock is set to the server's within the resolution
+  // of millis(), the delay is the round trip less the server's time
+  CHECK(NTP.begin("pool.ntp.org", 0, false, 0, NULL));
+  run(1000000);
+  CHECK_EQ(server.requests.size(), NTP_BURST_SAMPLES);
+  CHECK(llabs(errorMs()) <= 2);
+  CHECK(NTP.getLastDelay() >= 39000 && NTP.getLastDelay() <= 42000);
+  CHECK_EQ(NTP.getPollInterval(), NTP_MIN_POLL);
+  CHECK_EQ(timeStatus(), timeSet);
+  run(1000000, true);
+  CHECK(worstError <= 2);
+  CHECK_EQ(wrongSeconds, 0);
+
+  // 10ms there and 30ms back: the clock is off by half the difference,
+  // which no client can see
+  server.upUs = 10000;
+  server.downUs = 30000;
+  restart();
+  run(1000000);
+  CHECK(errorMs() >= -12 && errorMs() <= -8);
+  CHECK(NTP.getLastDelay() >= 39000 && NTP.getLastDelay() <= 42000);
+
+  // the reply with the shortest round trip of the burst is applied, not the
+  // last one
+  server.script.push_back(std::make_pair(40000u, 20000u));
+  server.script.push_back(std::make_pair(3000u, 5000u));
+  server.script.push_back(std::make_pair(50000u, 10000u));
+  server.script.push_back(std::make_pair(20000u, 40000u));
+  restart();
+  run(1000000);
+  CHECK(NTP.getLastDelay() >= 7000 && NTP.getLastDelay() <= 10000);
+  CHECK(errorMs() >= -3 && errorMs() <= 1);
+
+  // the reply to the first request comes after its timeout, while the second
+  // one waits, with a round trip shorter than the second's: it does not
+  // echo the second's transmit time and is dropped
+  server.upUs = server.downUs = 20000;
+  server.staleUs = 1500000;
+  restart();
+  run(8000000);
+  CHECK_EQ(server.requests.size(), NTP_BURST_SAMPLES);
+  CHECK(llabs(errorMs()) <= 2);
+  CHECK(NTP.getLastDelay() >= 39000 && NTP.getLastDelay() <= 42000);
+
+  // 0 to 30ms each way for twelve hours: the drift estimate finds the
+  // 80 ppm, the poll interval backs off to the sync interval and the clock
+  // and now() stay with the server's
+  server.upUs = server.downUs = 0;
+  server.jitterUs = 30000;
+  restart();
+  run(60000000);
+  worstError = 0;
+  wrongSeconds = 0;
+  run(12 * 3600 * 1000000ULL, true);
+  if (abs(NTP.getDrift() - 80000) > 5000 || worstError > 30)
+    printf("  drift %d ppb, worst error %lld ms\n", NTP.getDrift(), (long long)worstError);
+  CHECK(abs(NTP.getDrift() - 80000) <= 5000);
+  CHECK_EQ(NTP.getPollInterval(), DEFAULT_NTP_INTERVAL);
+  CHECK(worstError <= 30);
+  CHECK_EQ(wrongSeconds, 0);
+
+  // an hour without replies: a burst of timeouts every short interval, the
+  // clock keeps running at the corrected rate
+  server.answering = false;
+  server.requests.clear();
+  worstError = 0;
+  run(3600 * 1000000ULL, true);
+  // the first burst comes at the end of the poll interval, then one every
+  // short interval after the last timeout
+  CHECK(!server.requests.empty());
+  uint64_t failing = host::now() - server.requests[0];
+  CHECK(server.requests.size() >= 4 * (failing / ((DEFAULT_NTP_SHORTINTERVAL + 7) * 1000000ULL)));
+  uint64_t longestGap = 0;
+  for (size_t i = 1; i < server.requests.size(); i++)
+    longestGap = std::max(longestGap, server.requests[i] - server.requests[i - 1]);
+  CHECK(longestGap <= (DEFAULT_NTP_SHORTINTERVAL + 2) * 1000000ULL);
+  // what is left of the drift adds a few ms over the hour
+  CHECK(worstError <= 40);
+  CHECK_EQ(wrongSeconds, 0);
+
+  // the server is back, the next burst syncs
+  time_t lastSync = NTP.getLastNTPSync();
+  server.answering = true;
+  run((DEFAULT_NTP_SHORTINTERVAL + 8) * 1000000ULL, true);
+  CHECK(NTP.getLastNTPSync() != lastSync);
+  CHECK(worstError <= 30);
+  CHECK_EQ(wrongSeconds, 0);
+
+  return testResult("ntpclient");
+}
@@ -0,0 +1,141 @@
+/*
+ * QDPBuzzer: tone() and startMusic() return at once, the core tone() ends
+ * each note on time and poll() keeps the song on the timeline of the old
+ * blocking buzzer_music().
+ */
+
+#include <QDPBuzzer.h>
+
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+static const uint8_t PIN = 9;
+
+// song 2 of QDPBuzzer.cpp, as frequencies and beats
+static const unsigned int song2[] = {523, 587, 659, 523, 523, 587, 659, 523,
+                                     659, 698, 784, 659, 698, 784};
+static const float beats2[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 2};
+static const int NOTES = sizeof(song2) / sizeof(song2[0]);
+
+struct Change {
+  uint32_t ms;
+  unsigned int frequency;
+};
+
+static int finished = 0;
+
+// within the 1ms the tone is sampled at
+static bool near(uint32_t ms, uint32_t expected) {
+  return ms + 1 >= expected && ms <= expected + 1;
+}
+
+static void onDone() {
+  finished++;
+}
+
+// the tone heard from start on, polled every step ms
+static std::vector<Change> listen(QDPBuzzer &buzzer, uint32_t start, uint32_t step) {
+  std::vector<Change> heard;
+  unsigned int last = host::toneOut(PIN);
+  heard.push_back({0, last});
+  for (;;) {
+    bool playing;
+    {
+      HOST_PROFILE("poll");
+      playing = buzzer.poll();
+    }
+    if (!playing)
+      break;
+    // the tone is looked at every ms, whatever the poll rate
+    for (uint32_t i = 0; i < step; i++) {
+      unsigned int f = host::toneOut(PIN);
+      if (f != last)
+        heard.push_back({(uint32_t)(millis() - start), f});
+      last = f;
+      host::advance(1000);
+    }
+  }
+  heard.push_back({(uint32_t)(millis() - start), 0});
+  return heard;
+}
+
+static uint32_t songMs() {
+  uint32_t ms = 1000;
+  for (int i = 0; i < NOTES; i++)
+    ms += int(beats2[i] * 300) + 30;
+  return ms;
+}
+
+int main() {
+  QDPBuzzer buzzer;
+
+  // a tone returns at once and ends without a poll
+  uint32_t t0 = micros();
+  buzzer.tone(PIN, 440, 200);
+  CHECK(micros() - t0 < 100);
+  CHECK_EQ(host::toneOut(PIN), 440);
+  host::advance(199000);
+  CHECK_EQ(host::toneOut(PIN), 440);
+  host::advance(2000);
+  CHECK_EQ(host::toneOut(PIN), 0);
+  CHECK(buzzer.isPlaying());
+  CHECK(!buzzer.poll());
+
+  // the notes and gaps of the song, each note on its own beat
+  uint32_t start = millis();
+  t0 = micros();
+  buzzer.startMusic(PIN, 2, onDone);
+  CHECK(micros() - t0 < 100);
+  std::vector<Change> heard = listen(buzzer, start, 1);
+  CHECK_EQ(finished, 1);
+  // each note starts and ends, and the song ends after its last pause
+  CHECK_EQ(heard.size(), 2 * NOTES + 1);
+  uint32_t t = 0;
+  for (int i = 0; i < NOTES && 2 * i + 1 < (int)heard.size(); i++) {
+    CHECK(near(heard[2 * i].ms, t));
+    CHECK_EQ(heard[2 * i].frequency, song2[i]);
+    t += int(beats2[i] * 300);
+    CHECK(near(heard[2 * i + 1].ms, t));
+    CHECK_EQ(heard[2 * i + 1].frequency, 0);
+    t += 30;
+  }
+  CHECK(near(heard.back().ms, songMs()));
+  host::ProfileSummary p = host::Profiler::summary("poll");
+  CHECK(p.totalUs < p.calls * 10);
+
+  // polled every 50ms the notes still end on time, the song does not
+  // get longer
+  start = millis();
+  buzzer.startMusic(PIN, 2);
+  heard = listen(buzzer, start, 50);
+  CHECK(near(heard[1].ms, 300));
+  CHECK(heard.back().ms >= songMs() && heard.back().ms < songMs() + 50);
+
+  // a new tone replaces the song
+  buzzer.startMusic(PIN, 2, onDone);
+  buzzer.tone(PIN, 1000, 10);
+  CHECK_EQ(host::toneOut(PIN), 1000);
+  host::advance(20000);
+  CHECK(!buzzer.poll());
+  CHECK_EQ(finished, 1);
+
+  // the blocking call plays the whole song
+  {
+    HOST_PROFILE("buzzer_music");
+    buzzer.buzzer_music(PIN, 2);
+  }
+  CHECK(!buzzer.isPlaying());
+  double blocked = host::Profiler::summary("buzzer_music").totalUs;
+  // the deadlines count from the millis() the song started in
+  CHECK(near(blocked / 1000, songMs()));
+
+  // an unknown song plays nothing
+  buzzer.startMusic(PIN, 11);
+  CHECK(!buzzer.isPlaying());
+
+  host::Profiler::print();
+  return testResult("qdpbuzzer");
+}
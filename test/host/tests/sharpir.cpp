@@ -0,0 +1,117 @@
+/*
+ * SharpIR lookup tables against the pow() curves they replaced, over the
+ * whole 10 bit range, readings above it clamp to its top, and the sliding
+ * median of update() against a sorted window.
+ */
+
+#include <SharpIR.h>
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+static const uint8_t PIN = 14;
+
+struct Curve {
+  long model;
+  double factor;
+  double exponent;
+  double minCm;
+  double maxCm;
+};
+
+// the former formulas and the rated range of each sensor
+static const Curve curves[] = {
+  {GP2Y0A21YK0F, 27.728, -1.2045, 10, 80},
+  {GP2Y0A02YK0F, 60.374, -1.16, 20, 150},
+  {430, 12.08, -1.058, 4, 30},
+};
+
+static int distanceAt(SharpIR &sensor, int raw) {
+  host::setAnalog(PIN, raw);
+  return sensor.distance();
+}
+
+int main() {
+  for (size_t c = 0; c < sizeof(curves) / sizeof(curves[0]); c++) {
+    const Curve &curve = curves[c];
+    SharpIR sensor(PIN, curve.model);
+    double worst = 0;
+    int checked = 0;
+    int last = 0x7FFF;
+    for (int raw = 1; raw <= 1023; raw++) {
+      double cm = curve.factor * pow(map(raw, 0, 1023, 0, 5000) / 1000.0, curve.exponent);
+      int d = distanceAt(sensor, raw);
+      // the curves only fall
+      CHECK(d <= last);
+      last = d;
+      if (cm < curve.minCm || cm > curve.maxCm)
+        continue;
+      worst = std::max(worst, fabs(d - cm));
+      checked++;
+    }
+    printf("  model %ld: %d readings in range, worst %.2f cm\n", curve.model, checked, worst);
+    CHECK(checked > 50);
+    CHECK(worst <= 1.0);
+
+    // a wider ADC reads past 1023, it shows the nearest distance
+    int nearest = distanceAt(sensor, 1023);
+    CHECK_EQ(distanceAt(sensor, 1024), nearest);
+    CHECK_EQ(distanceAt(sensor, 4095), nearest);
+    CHECK_EQ(distanceAt(sensor, 32767), nearest);
+  }
+
+  // the 1/L line of the long range sensor in integer math matches the float
+  {
+    SharpIR sensor(PIN, GP2Y0A710K0F);
+    for (int raw = 0; raw <= 1023; raw++) {
+      float current = map(raw, 0, 1023, 0, 5000);
+      int expected = 0;
+      if (current >= 1400 && current <= 3300)
+        expected = 1.0 / (((current - 1125.0) / 1000.0) / 137.5);
+      CHECK_EQ(distanceAt(sensor, raw), expected);
+    }
+    CHECK_EQ(distanceAt(sensor, 4095), 0);
+  }
+
+  // update() reads once, filteredDistance() is the median of the window
+  {
+    SharpIR sensor(PIN, GP2Y0A21YK0F);
+    SharpIR reference(PIN, GP2Y0A21YK0F);
+    std::vector<int> readings;
+    uint32_t seed = 1;
+    for (int i = 0; i < 200; i++) {
+      seed = seed * 1103515245 + 12345;
+      int raw = 200 + (seed >> 16) % 400;
+      // an occasional spike the median drops
+      if (i % 17 == 5)
+        raw = 1023;
+      readings.push_back(raw);
+      host::setAnalog(PIN, raw);
+      {
+        HOST_PROFILE("update");
+        sensor.update();
+      }
+      size_t n = std::min(readings.size(), (size_t)SHARPIR_WINDOW);
+      std::vector<int> window(readings.end() - n, readings.end());
+      std::sort(window.begin(), window.end());
+      CHECK_EQ(sensor.filteredDistance(), distanceAt(reference, window[n / 2]));
+    }
+    host::ProfileSummary s = host::Profiler::summary("update");
+    CHECK_EQ(s.calls, 200);
+    // one 112us conversion each, distance() takes NB_SAMPLE
+    CHECK(s.totalUs < s.calls * 113);
+    {
+      HOST_PROFILE("distance");
+      sensor.distance();
+    }
+    CHECK(host::Profiler::summary("distance").totalUs >= NB_SAMPLE * 112);
+  }
+
+  host::Profiler::print();
+  return testResult("sharpir");
+}
@@ -0,0 +1,157 @@
+/*
+ * ShiftDisplay refreshed by the ESP32 timer model into two 74HC595: every
+ * iteration of the display shows one value whole, a new value waits for the
+ * iteration to end, brightness sets the duty cycle of each character and
+ * show() no longer blocks.
+ */
+
+#include <ShiftDisplay.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "ShiftRegisterModel.h"
+
+static const int DIGITS = 4;
+static const uint64_t PERIOD_NS = 1000000000ULL / (DEFAULT_REFRESH_RATE * DIGITS);
+
+typedef std::vector<uint32_t> Frame;
+
+// what one iteration of show() latched, character by character
+static Frame frameOf(ShiftDisplay &display, ShiftRegisterModel &chain) {
+  chain.latches.clear();
+  display.show();
+  Frame frame;
+  for (int i = 0; i < DIGITS && i < (int)chain.latches.size(); i++)
+    frame.push_back(chain.latches[i].outputs);
+  chain.latches.clear();
+  return frame;
+}
+
+// the frame a refreshed character belongs to, -1 for none
+static int frameAt(const std::vector<Frame> &frames, int index, uint32_t outputs) {
+  for (size_t f = 0; f < frames.size(); f++) {
+    if (frames[f][index] == outputs)
+      return f;
+  }
+  return -1;
+}
+
+/*
+ * The latches since the refresh started, one character each PERIOD_NS in
+ * display order, and every iteration of a single frame. Returns the frame of
+ * each iteration.
+ */
+static std::vector<int> iterations(const ShiftRegisterModel &chain, const std::vector<Frame> &frames) {
+  std::vector<int> shown;
+  const std::vector<ShiftRegisterModel::Latch> &l = chain.latches;
+  for (size_t i = 0; i < l.size(); i++) {
+    if (i > 0)
+      CHECK_EQ(l[i].ns - l[i - 1].ns, PERIOD_NS);
+    CHECK_EQ(l[i].clocks, 16);
+    int f = frameAt(frames, i % DIGITS, l[i].outputs);
+    CHECK(f >= 0);
+    if (i % DIGITS == 0)
+      shown.push_back(f);
+    else if (f != shown.back())
+      printf("  iteration %d mixes frames %d and %d\n", (int)(i / DIGITS), shown.back(), f);
+    CHECK_EQ(f, shown.back());
+  }
+  return shown;
+}
+
+int main() {
+  ShiftRegisterModel chain(DEFAULT_LATCH_PIN, DEFAULT_CLOCK_PIN, DEFAULT_DATA_PIN, 2);
+  ShiftDisplay display(COMMON_CATHODE, DIGITS);
+
+  std::vector<Frame> frames;
+  display.set("1234");
+  frames.push_back(frameOf(display, chain));
+  display.set("5678");
+  frames.push_back(frameOf(display, chain));
+  CHECK_EQ(frames[0].size(), DIGITS);
+  CHECK_EQ(frames[1].size(), DIGITS);
+
+  // a value set in the middle of an iteration shows from the next one
+  display.set("1234");
+  CHECK(display.startRefresh());
+  host::advance(13700);
+  uint64_t setAt = host::nowNs();
+  display.set("5678");
+  host::advance(30000);
+  std::vector<int> shown = iterations(chain, frames);
+  size_t changed = 0;
+  while (changed < shown.size() && shown[changed] == 0)
+    changed++;
+  CHECK(changed > 0 && changed < shown.size());
+  for (size_t i = changed; i < shown.size(); i++)
+    CHECK_EQ(shown[i], 1);
+  CHECK(chain.latches[changed * DIGITS].ns - setAt <= DIGITS * PERIOD_NS);
+
+  // values set faster than the display iterates never mix
+  display.stopRefresh();
+  chain.latches.clear();
+  CHECK(display.startRefresh());
+  for (int i = 0; i < 300; i++) {
+    display.set(i & 1 ? "5678" : "1234");
+    host::advance(700 + (i * 37) % 900);
+  }
+  shown = iterations(chain, frames);
+  CHECK(shown.size() > 30);
+  CHECK(std::count(shown.begin(), shown.end(), 0) > 5);
+  CHECK(std::count(shown.begin(), shown.end(), 1) > 5);
+
+  // while refreshing show() only returns, show(time) only waits
+  {
+    HOST_PROFILE("show");
+    display.show();
+  }
+  host::ProfileSummary s = host::Profiler::summary("show");
+  CHECK_EQ(s.delays, 0);
+  CHECK(s.totalUs < 10);
+
+  // a quarter brightness lights each character for a quarter of its period
+  display.setBrightness(64);
+  host::advance(10000);
+  chain.latches.clear();
+  host::advance(20000);
+  uint64_t on = 0, off = 0;
+  int lit = 0;
+  const std::vector<ShiftRegisterModel::Latch> &l = chain.latches;
+  for (size_t i = 1; i < l.size(); i++) {
+    if (l[i - 1].outputs != 0) {
+      CHECK_EQ(l[i].outputs, 0);
+      on = l[i].ns - l[i - 1].ns;
+      lit++;
+    } else {
+      off = l[i].ns - l[i - 1].ns;
+    }
+  }
+  CHECK(lit >= 7);
+  CHECK_EQ(on, PERIOD_NS * 64 / MAX_BRIGHTNESS / 1000 * 1000);
+  CHECK_EQ(on + off, PERIOD_NS);
+
+  // brightness 0 keeps the display dark
+  display.setBrightness(0);
+  host::advance(10000);
+  chain.latches.clear();
+  host::advance(10000);
+  CHECK(!chain.latches.empty());
+  for (size_t i = 0; i < chain.latches.size(); i++)
+    CHECK_EQ(chain.latches[i].outputs, 0);
+
+  // stopped, the display is dark and show() iterates again
+  display.setBrightness(MAX_BRIGHTNESS);
+  display.stopRefresh();
+  CHECK_EQ(chain.outputs, 0);
+  chain.latches.clear();
+  host::advance(10000);
+  CHECK(chain.latches.empty());
+  CHECK(frameOf(display, chain) == frames[1]);
+
+  host::Profiler::print();
+  return testResult("shiftdisplay");
+}
@@ -0,0 +1,121 @@
+/*
+ * ShiftDisplay refreshed by Timer1 of an Uno: the finest prescaler that
+ * fits a whole character period, the compare value of each on and off step
+ * and the time between compare matches.
+ */
+
+#include <ShiftDisplay.h>
+
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+struct Match {
+  uint64_t ns;
+  uint16_t ocr1a;
+};
+
+static std::vector<Match> matches;
+
+struct Timing {
+  int refreshRate;
+  int digits;
+  uint8_t clock;
+  uint16_t ocr1a;
+};
+
+static const uint8_t CLOCK_BITS = _BV(CS12) | _BV(CS11) | _BV(CS10);
+
+// ns of counts at the clock select bits
+static uint64_t countsNs(uint64_t counts, uint8_t clock) {
+  static const uint32_t prescalers[] = {0, 1, 8, 64, 256, 1024};
+  return counts * prescalers[clock] * 1000000000ULL / F_CPU;
+}
+
+int main() {
+  host::watchTimer1([](uint16_t ocr1a) {matches.push_back(Match{host::nowNs(), ocr1a});});
+
+  // 4 digits at 100 Hz take 2500us a character, 40000 counts at clk/1
+  const Timing timings[] = {
+    {100, 4, _BV(CS10), 39999},
+    {62, 4, _BV(CS10), 64511},
+    {61, 4, _BV(CS11), 8195},
+    {40, 1, _BV(CS11), 49999},
+    {4, 1, _BV(CS11) | _BV(CS10), 62499},
+    {1, 1, _BV(CS12), 62499},
+  };
+  for (size_t t = 0; t < sizeof(timings) / sizeof(timings[0]); t++) {
+    const Timing &timing = timings[t];
+    ShiftDisplay display(COMMON_CATHODE, timing.digits);
+    matches.clear();
+    CHECK(display.startRefresh(timing.refreshRate));
+    CHECK_EQ(TCCR1B, _BV(WGM12) | timing.clock);
+    CHECK_EQ(OCR1A, timing.ocr1a);
+    CHECK(TIMSK1 & _BV(OCIE1A));
+    uint64_t period = countsNs(timing.ocr1a + 1, timing.clock);
+    host::advanceNs(period * 5 + period / 2);
+    CHECK_EQ(matches.size(), 5);
+    for (size_t i = 0; i < matches.size(); i++) {
+      CHECK_EQ(matches[i].ocr1a, timing.ocr1a);
+      if (i > 0)
+        CHECK_EQ(matches[i].ns - matches[i - 1].ns, period);
+    }
+    display.stopRefresh();
+    CHECK_EQ(TCCR1B, 0);
+    CHECK(!(TIMSK1 & _BV(OCIE1A)));
+  }
+
+  // dimmed, the compare value alternates between the on and off steps and
+  // their sum is the character period
+  {
+    ShiftDisplay display(COMMON_CATHODE, 4);
+    display.setBrightness(64);
+    matches.clear();
+    CHECK(display.startRefresh(100));
+    host::advance(25000);
+    CHECK(matches.size() >= 16);
+    // 627us on and 1873us off at clk/1
+    for (size_t i = 1; i + 1 < matches.size(); i++) {
+      uint16_t expected = i % 2 ? 29967 : 10031;
+      CHECK_EQ(matches[i].ocr1a, expected);
+      CHECK_EQ(matches[i + 1].ns - matches[i].ns, countsNs(expected + 1, _BV(CS10)));
+    }
+    display.stopRefresh();
+  }
+
+  // the longest period fits the counter at clk/256, so do its shortest steps
+  {
+    ShiftDisplay display(COMMON_CATHODE, 1);
+    display.setBrightness(1);
+    matches.clear();
+    CHECK(display.startRefresh(1));
+    CHECK_EQ(TCCR1B & CLOCK_BITS, _BV(CS12));
+    host::advance(3000000);
+    CHECK(matches.size() >= 5);
+    for (size_t i = 1; i < matches.size(); i++)
+      CHECK_EQ(matches[i].ocr1a, i % 2 ? 62254 : 244);
+    display.stopRefresh();
+  }
+
+  // the refresh interrupt and the sketch leave interrupts on
+  {
+    ShiftDisplay display(COMMON_CATHODE, 4);
+    matches.clear();
+    CHECK(display.startRefresh(100));
+    display.set(1234);
+    CHECK(host::interruptsEnabled());
+    host::advance(10000);
+    CHECK_EQ(matches.size(), 4);
+    CHECK(host::interruptsEnabled());
+    display.stopRefresh();
+    CHECK(host::interruptsEnabled());
+    matches.clear();
+    host::advance(10000);
+    CHECK(matches.empty());
+  }
+
+  host::Profiler::print();
+  return testResult("shiftdisplay_avr");
+}
@@ -0,0 +1,83 @@
+/*
+ * Adafruit_SSD1306 on I2C: the display RAM of the model must match the
+ * library buffer after display(), and display() costs 36 transactions.
+ */
+
+#include <Adafruit_SSD1306.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "Ssd1306Model.h"
+
+static bool sameAsBuffer(Adafruit_SSD1306 &oled, Ssd1306Model &model) {
+  for (int y = 0; y < oled.height(); y++) {
+    for (int x = 0; x < oled.width(); x++) {
+      if (oled.getPixel(x, y) != model.pixel(x, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+// bus time of one write of n bytes after the address, in us
+static double writeUs(unsigned n, uint32_t clock) {
+  return (1 + 9 * (1 + n) + 1) * 1e6 / clock;
+}
+
+int main() {
+  Ssd1306Model model(0x3C);
+  Adafruit_SSD1306 oled(128, 64, &Wire, -1);
+
+  {
+    HOST_PROFILE("begin");
+    CHECK(oled.begin(SSD1306_SWITCHCAPVCC, 0x3C));
+  }
+  CHECK(model.on);
+  CHECK_EQ(Wire.getClock(), 100000);
+
+  oled.clearDisplay();
+  oled.setTextColor(SSD1306_WHITE);
+  oled.setCursor(4, 4);
+  oled.print("host");
+  oled.drawLine(0, 63, 127, 0, SSD1306_WHITE);
+  oled.fillRect(100, 40, 20, 10, SSD1306_INVERSE);
+  {
+    HOST_PROFILE("display");
+    oled.display();
+  }
+  CHECK(sameAsBuffer(oled, model));
+
+  // the page and column commands, then 1024 bytes, 31 per write
+  host::ProfileSummary s = host::Profiler::summary("display");
+  CHECK_EQ(s.i2c, 2 + 34);
+  CHECK_EQ(s.bytes, 6 + 2 + 1024 + 34);
+  CHECK_EQ(s.errors, 0);
+  double expect = writeUs(6, 400000) + writeUs(2, 400000)
+    + 33 * writeUs(32, 400000) + writeUs(1024 - 33 * 31 + 1, 400000);
+  CHECK(s.busUs > expect - 1 && s.busUs < expect + 1);
+
+  // without the faster clock during the transfer it takes 4 times longer
+  Adafruit_SSD1306 slow(128, 64, &Wire, -1, 100000UL, 100000UL);
+  CHECK(slow.begin(SSD1306_SWITCHCAPVCC, 0x3C));
+  slow.clearDisplay();
+  slow.drawCircle(64, 32, 20, SSD1306_WHITE);
+  {
+    HOST_PROFILE("display 100kHz");
+    slow.display();
+  }
+  CHECK(sameAsBuffer(slow, model));
+  host::ProfileSummary t = host::Profiler::summary("display 100kHz");
+  CHECK(t.busUs > 3.9 * s.busUs && t.busUs < 4.1 * s.busUs);
+
+  // no display at the address
+  Adafruit_SSD1306 missing(128, 32, &Wire, -1);
+  {
+    HOST_PROFILE("begin missing");
+    missing.begin(SSD1306_SWITCHCAPVCC, 0x3D);
+  }
+  CHECK(host::Profiler::summary("begin missing").errors > 0);
+
+  host::Profiler::print();
+  return testResult("ssd1306");
+}
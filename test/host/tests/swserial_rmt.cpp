@@ -0,0 +1,123 @@
+/*
+ * Esp32SoftwareSerial on the RMT model, TX looped back to RX: every frame
+ * format at low and high bitrates arrives as it was sent, the channels are
+ * checked against each other's memory blocks and a TX chunk never exceeds
+ * one block.
+ */
+
+#include <Esp32SoftwareSerial.h>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "RmtModel.h"
+
+static const uint8_t RX_PIN = 4;
+static const uint8_t TX_PIN = 5;
+static const int8_t TX_CHANNEL = 0;
+static const int8_t RX_CHANNEL = 2;
+
+static bool expectedParity(uint8_t b, int parity) {
+  switch (parity) {
+    case SWSERIAL_PARITY_EVEN: return Esp32SoftwareSerial::parityEven(b);
+    case SWSERIAL_PARITY_ODD: return Esp32SoftwareSerial::parityOdd(b);
+    case SWSERIAL_PARITY_MARK: return true;
+    default: return false;
+  }
+}
+
+// sends a burst of 20 bytes and reads them back after the line idled
+static void loopback(uint32_t baud, int config, bool invert) {
+  Esp32SoftwareSerial s;
+  CHECK(s.enableRmt(TX_CHANNEL, RX_CHANNEL));
+  s.begin(baud, static_cast<Esp32SoftwareSerialConfig>(config), RX_PIN, TX_PIN, invert);
+  CHECK(s);
+
+  uint8_t dataBits = 5 + (config & 07);
+  int parity = config & 070;
+  uint8_t sent[20];
+  for (size_t i = 0; i < sizeof(sent); i++)
+    sent[i] = (uint8_t)(rand() & ((1 << dataBits) - 1));
+  {
+    HOST_PROFILE("write");
+    CHECK_EQ(s.write(sent, sizeof(sent)), sizeof(sent));
+  }
+  // the idle threshold is two bits longer than a frame
+  host::advance(3 * 12 * 1000000ULL / baud + 10);
+
+  int got = 0;
+  while (s.available()) {
+    int b = s.read();
+    if (got < (int)sizeof(sent)) {
+      CHECK_EQ(b, sent[got]);
+      if (parity)
+        CHECK_EQ(s.readParity(), expectedParity(sent[got], parity));
+    }
+    got++;
+  }
+  if (got != (int)sizeof(sent))
+    printf("  %lu baud, config 0%o%s: %d of %d bytes\n", (unsigned long)baud,
+           config, invert ? " inverted" : "", got, (int)sizeof(sent));
+  CHECK_EQ(got, sizeof(sent));
+  CHECK(!s.overflow());
+}
+
+int main() {
+  srand(1);
+  host::connect(TX_PIN, RX_PIN);
+
+  // RX takes the memory blocks of the channels after its own
+  Esp32SoftwareSerial s;
+  CHECK(!s.enableRmt(3, 2));
+  CHECK(!s.enableRmt(5, 2));
+  CHECK(!s.enableRmt(0, 5));
+  CHECK(!s.enableRmt(8, -1));
+  CHECK(s.enableRmt(6, 2));
+  CHECK(s.enableRmt(-1, -1));
+
+  const uint32_t bauds[] = {9600, 115200, 460800};
+  const int parities[] = {SWSERIAL_PARITY_NONE, SWSERIAL_PARITY_EVEN, SWSERIAL_PARITY_ODD,
+                          SWSERIAL_PARITY_MARK, SWSERIAL_PARITY_SPACE};
+  for (size_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++) {
+    for (size_t p = 0; p < sizeof(parities) / sizeof(parities[0]); p++) {
+      for (int stop = 0; stop <= 0200; stop += 0200) {
+        for (int bits = 0; bits < 4; bits++) {
+          loopback(bauds[b], parities[p] | stop | bits, false);
+          loopback(bauds[b], parities[p] | stop | bits, true);
+        }
+      }
+    }
+  }
+  CHECK_EQ(host::rmtMemoryConflicts(), 0);
+  host::RmtStats tx = host::rmtStats(TX_CHANNEL);
+  host::RmtStats rx = host::rmtStats(RX_CHANNEL);
+  // one memory block less the end marker
+  CHECK(tx.maxWriteItems <= 63);
+  CHECK(tx.writes > rx.receptions);
+  CHECK(rx.maxReceptionItems <= 4 * 64);
+  CHECK_EQ(rx.memoryOverflows, 0);
+  CHECK_EQ(rx.ringOverflows, 0);
+
+  // the TX channel refills its memory between chunks, the idle gap only
+  // stretches a stop bit
+  host::setRmtWriteGap(3000);
+  loopback(115200, SWSERIAL_8E1, false);
+  loopback(460800, SWSERIAL_5N2, true);
+  host::setRmtWriteGap(0);
+
+  // a burst of more edges than the RX memory holds is lost
+  {
+    Esp32SoftwareSerial burst;
+    CHECK(burst.enableRmt(TX_CHANNEL, RX_CHANNEL));
+    burst.begin(115200, SWSERIAL_8N1, RX_PIN, TX_PIN, false);
+    uint8_t edges[64];
+    memset(edges, 0x55, sizeof(edges));
+    burst.write(edges, sizeof(edges));
+    host::advance(1000);
+    CHECK_EQ(burst.available(), 0);
+    CHECK_EQ(host::rmtStats(RX_CHANNEL).memoryOverflows, 1);
+  }
+
+  host::Profiler::print();
+  return testResult("swserial_rmt");
+}
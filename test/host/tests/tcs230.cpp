@@ -0,0 +1,169 @@
+/*
+ * MD_TCS230 background capture against a synthetic frequency source:
+ * accuracy from 400 Hz to 12 kHz, the time to a full RGB result against
+ * the FreqCount gates, a dark filter reads 0, and the capture interrupt
+ * stays silent with the debug output on.
+ */
+
+#include <MD_TCS230.h>
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "Tcs230Model.h"
+
+static const uint8_t S2 = 4;
+static const uint8_t S3 = 5;
+static const uint8_t OUT = 2;
+
+static Tcs230Model *source;
+
+/*
+ * FreqCount counts the edges of the source over a gate of msec
+ */
+FreqCountClass FreqCount;
+static uint32_t gateGeneration = 0;
+static uint32_t gateCount = 0;
+static bool gateDone = false;
+
+void FreqCountClass::begin(uint16_t msec) {
+  uint32_t generation = ++gateGeneration;
+  uint32_t first = source->edges;
+  gateDone = false;
+  host::schedule(host::now() + msec * 1000ULL, [generation, first]() {
+    if (generation != gateGeneration)
+      return;
+    gateCount = source->edges - first;
+    gateDone = true;
+  });
+}
+
+uint8_t FreqCountClass::available(void) {
+  return gateDone;
+}
+
+uint32_t FreqCountClass::read(void) {
+  return gateCount;
+}
+
+void FreqCountClass::end(void) {
+  gateGeneration++;
+}
+
+// polls available() every 100us, the time it took in us
+static uint64_t waitAvailable(MD_TCS230 &sensor, uint64_t timeoutUs = 2000000) {
+  uint64_t start = host::now();
+  while (!sensor.available() && host::now() - start < timeoutUs)
+    host::advance(100);
+  return host::now() - start;
+}
+
+static bool near(int32_t value, uint32_t expected, double tolerance) {
+  return abs(value - (int32_t)expected) <= expected * tolerance;
+}
+
+int main() {
+  Tcs230Model tcs(S2, S3, OUT);
+  source = &tcs;
+  MD_TCS230 sensor(S2, S3);
+  sensor.begin();
+  sensorData raw;
+
+  // every filter within 0.1% across the range, each at its own frequency
+  const uint32_t frequencies[] = {400, 1000, 3000, 7500, 12000};
+  for (size_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+    uint32_t f = frequencies[i];
+    tcs.setFrequency(TCS230_RGB_R, f);
+    tcs.setFrequency(TCS230_RGB_G, f * 3 / 4);
+    tcs.setFrequency(TCS230_RGB_B, f / 2);
+    CHECK(sensor.beginCapture(OUT));
+    // each window is 8 periods and 2ms at least, after the discarded edge
+    // and up to half a period of the previous filter
+    uint64_t windows = 0;
+    const uint32_t hz[] = {f, f * 3 / 4, f / 2};
+    for (int c = 0; c < 3; c++) {
+      uint64_t period = 1000000ULL / hz[c];
+      windows += std::max(8 * period, 2000 + period) + 3 * period;
+    }
+    uint64_t us = waitAvailable(sensor);
+    if (us >= windows)
+      printf("  %u Hz: %llu us, windows %llu us\n", f, (unsigned long long)us, (unsigned long long)windows);
+    CHECK(us < windows);
+    sensor.getRaw(&raw);
+    if (!near(raw.value[0], f, 0.001) || !near(raw.value[1], f * 3 / 4, 0.001) ||
+        !near(raw.value[2], f / 2, 0.001))
+      printf("  %u Hz: read %d %d %d\n", f, raw.value[0], raw.value[1], raw.value[2]);
+    CHECK(near(raw.value[0], f, 0.001));
+    CHECK(near(raw.value[1], f * 3 / 4, 0.001));
+    CHECK(near(raw.value[2], f / 2, 0.001));
+    sensor.endCapture();
+  }
+
+  // at 12/6/3 kHz a new result comes every few milliseconds, the FreqCount
+  // reading takes three 100ms gates
+  tcs.setFrequency(TCS230_RGB_R, 12000);
+  tcs.setFrequency(TCS230_RGB_G, 6000);
+  tcs.setFrequency(TCS230_RGB_B, 3000);
+  CHECK(sensor.beginCapture(OUT));
+  waitAvailable(sensor);
+  uint16_t seq = sensor.getSequence();
+  uint64_t longest = 0;
+  for (int i = 0; i < 20; i++) {
+    uint64_t us = waitAvailable(sensor);
+    if (us > longest)
+      longest = us;
+  }
+  CHECK_EQ(sensor.getSequence() - seq, 20);
+  CHECK(longest < 10000);
+  sensor.endCapture();
+
+  sensor.read();
+  uint64_t gated = waitAvailable(sensor);
+  CHECK(gated >= 300000);
+  sensor.getRaw(&raw);
+  // a gate counts whole edges, 10 Hz each
+  CHECK(near(raw.value[0], 12000, 0.001));
+  CHECK(near(raw.value[1], 6000, 0.002));
+  CHECK(near(raw.value[2], 3000, 0.004));
+
+  // a dark filter makes no edges, its window closes after the sampling
+  // period and reads 0
+  tcs.setFrequency(TCS230_RGB_B, 0);
+  CHECK(sensor.beginCapture(OUT));
+  uint64_t dark = waitAvailable(sensor);
+  CHECK(dark >= 100000 && dark < 110000);
+  sensor.getRaw(&raw);
+  CHECK(near(raw.value[0], 12000, 0.001));
+  CHECK(near(raw.value[1], 6000, 0.001));
+  CHECK_EQ(raw.value[2], 0);
+  sensor.endCapture();
+  tcs.setFrequency(TCS230_RGB_B, 3000);
+
+  // the debug output of setFilter() stays out of the interrupt that steps
+  // the filters
+  host::serialOutput();
+  sensor.setFilter(TCS230_RGB_G);
+  CHECK(host::serialOutput().find("setFilter") != std::string::npos);
+  CHECK_EQ(tcs.filter(), TCS230_RGB_G);
+  CHECK(sensor.beginCapture(OUT));
+  host::serialOutput();
+  seq = sensor.getSequence();
+  host::advance(50000);
+  CHECK(sensor.getSequence() - seq >= 5);
+  CHECK_EQ(host::serialOutput().size(), 0);
+
+  // stopped, the filters stay put
+  sensor.endCapture();
+  seq = sensor.getSequence();
+  uint8_t filter = tcs.filter();
+  host::advance(50000);
+  CHECK_EQ(sensor.getSequence(), seq);
+  CHECK_EQ(tcs.filter(), filter);
+
+  host::Profiler::print();
+  return testResult("tcs230");
+}
@@ -0,0 +1,138 @@
+/*
+ * Grove TM1637 on the driver model: clocks of each update, only changed
+ * digits are sent, text scrolls from poll() and any other display call
+ * ends the scroll.
+ */
+
+#include <TM1637.h>
+
+#include <string.h>
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "Tm1637Model.h"
+
+static const uint8_t CLK = 2;
+static const uint8_t DIO = 3;
+
+static const uint8_t DIGIT_1 = 0x06, DIGIT_2 = 0x5b, DIGIT_3 = 0x4f;
+static const uint8_t DIGIT_4 = 0x66, DIGIT_5 = 0x6d;
+static const uint8_t CHAR_H = 0x76, CHAR_E = 0x79, CHAR_L = 0x38;
+
+static bool shows(const Tm1637Model &tm, uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  return tm.ram[0] == a && tm.ram[1] == b && tm.ram[2] == c && tm.ram[3] == d;
+}
+
+// polls every 10ms until the scroll ends, the frames it showed
+static std::vector<uint32_t> scroll(TM1637 &disp, const Tm1637Model &tm) {
+  std::vector<uint32_t> frames;
+  uint32_t last = 0xFFFFFFFF;
+  for (;;) {
+    uint32_t frame = tm.ram[0] | tm.ram[1] << 8 | tm.ram[2] << 16 | (uint32_t)tm.ram[3] << 24;
+    if (frame != last)
+      frames.push_back(frame);
+    last = frame;
+    bool scrolling;
+    {
+      HOST_PROFILE("poll");
+      scrolling = disp.poll();
+    }
+    if (!scrolling)
+      break;
+    host::advance(10000);
+  }
+  return frames;
+}
+
+int main() {
+  Tm1637Model tm(CLK, DIO);
+  TM1637 disp(CLK, DIO);
+
+  // init() sends the data command, four blank digits and the control
+  disp.init();
+  CHECK_EQ(tm.dataCommands, 1);
+  CHECK_EQ(tm.control, 0x88 + BRIGHT_TYPICAL);
+  CHECK_EQ(tm.digitWrites, 4);
+  CHECK(shows(tm, 0, 0, 0, 0));
+
+  // a number sends its digits in one transfer, 5 bytes of 9 clocks and the
+  // stop
+  uint32_t clocks = tm.clocks;
+  disp.displayNum(1234);
+  CHECK(shows(tm, DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4));
+  CHECK_EQ(tm.clocks - clocks, 46);
+
+  // the same number sends nothing, one changed digit only that digit
+  clocks = tm.clocks;
+  uint32_t transfers = tm.transfers;
+  disp.displayNum(1234);
+  CHECK_EQ(tm.clocks - clocks, 0);
+  CHECK_EQ(tm.transfers, transfers);
+  clocks = tm.clocks;
+  disp.displayNum(1235);
+  CHECK(shows(tm, DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_5));
+  CHECK_EQ(tm.clocks - clocks, 19);
+
+  // a new brightness sends only the control
+  disp.set(BRIGHTEST);
+  clocks = tm.clocks;
+  disp.displayNum(1235);
+  CHECK_EQ(tm.control, 0x88 + BRIGHTEST);
+  CHECK_EQ(tm.clocks - clocks, 10);
+
+  // text longer than the display returns at once and scrolls in from the
+  // right and out to the left, one step each 500ms
+  char hello[] = "HELLO WORLD";
+  clocks = tm.clocks;
+  uint64_t start = host::now();
+  {
+    HOST_PROFILE("displayStr");
+    disp.displayStr(hello);
+  }
+  CHECK(host::Profiler::summary("displayStr").totalUs < 2000);
+  CHECK(shows(tm, 0, 0, 0, 0));
+  std::vector<uint32_t> frames = scroll(disp, tm);
+  uint32_t frameCount = strlen(hello) + 5;
+  CHECK_EQ(frames.size(), frameCount);
+  CHECK_EQ(frames[4], CHAR_H | CHAR_E << 8 | CHAR_L << 16 | (uint32_t)CHAR_L << 24);
+  CHECK(frames.back() == 0);
+  CHECK(host::now() - start >= frameCount * 500000ULL);
+  CHECK(host::now() - start < frameCount * 500000ULL + 20000);
+  CHECK(tm.clocks - clocks < 700);
+  host::ProfileSummary p = host::Profiler::summary("poll");
+  CHECK(p.totalUs < p.calls * 10 + frameCount * 2000);
+
+  // a digit or a number ends the scroll
+  disp.displayStr(hello);
+  host::advance(1200000);
+  disp.display(0, 5);
+  CHECK(!disp.poll());
+  disp.displayStr(hello);
+  disp.displayNum(42);
+  CHECK(!disp.poll());
+
+  // text longer than SCROLL_MAX scrolls whole before it returns
+  char text[] = "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOGS";
+  CHECK(strlen(text) > SCROLL_MAX);
+  {
+    HOST_PROFILE("long displayStr");
+    disp.displayStr(text, 100);
+  }
+  CHECK(!disp.poll());
+  CHECK(shows(tm, 0, 0, 0, 0));
+  CHECK_EQ(host::Profiler::summary("long displayStr").delayUs >= (strlen(text) + 5) * 100000.0, true);
+
+  // init() sends everything again
+  uint32_t commands = tm.dataCommands;
+  disp.displayNum(1234);
+  clocks = tm.clocks;
+  disp.init();
+  CHECK_EQ(tm.dataCommands, commands + 1);
+  CHECK(shows(tm, 0, 0, 0, 0));
+  CHECK_EQ(tm.clocks - clocks, 10 + 46 + 10);
+
+  host::Profiler::print();
+  return testResult("tm1637");
+}
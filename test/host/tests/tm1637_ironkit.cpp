@@ -0,0 +1,140 @@
+/*
+ * ironKit TM1637 on the driver model: only changed digits are sent, text
+ * scrolls from poll() out of the display's own buffer, text longer than the
+ * buffer scrolls before print returns, and a missing ack resends everything.
+ */
+
+#include <TM1637.h>
+
+#include <string.h>
+#include <vector>
+
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+#include "Tm1637Model.h"
+
+static const uint8_t CLK = 2;
+static const uint8_t DIO = 3;
+static const uint16_t PRINT_DELAY = 300;
+
+// the display shows text, padded with blanks
+static bool shows(TM1637 &disp, const Tm1637Model &tm, const char *text) {
+  for (int i = 0; i < 4; i++) {
+    uint8_t expected = i < (int)strlen(text) ? disp.encode(text[i]) : 0;
+    if (i == 1 && disp.getColonOn())
+      expected |= TM1637_COLON_BIT;
+    if (tm.ram[i] != expected)
+      return false;
+  }
+  return true;
+}
+
+// polls every 10ms until the scroll ends, the steps it showed
+static std::vector<uint32_t> scroll(TM1637 &disp, const Tm1637Model &tm) {
+  std::vector<uint32_t> frames;
+  uint32_t last = 0xFFFFFFFF;
+  for (;;) {
+    uint32_t frame = tm.ram[0] | tm.ram[1] << 8 | tm.ram[2] << 16 | (uint32_t)tm.ram[3] << 24;
+    if (frame != last)
+      frames.push_back(frame);
+    last = frame;
+    if (!disp.poll())
+      break;
+    host::advance(10000);
+  }
+  return frames;
+}
+
+static uint32_t frameOf(TM1637 &disp, const char *text) {
+  uint32_t frame = 0;
+  for (int i = 0; i < 4; i++)
+    frame |= (uint32_t)disp.encode(text[i]) << (8 * i);
+  return frame;
+}
+
+int main() {
+  Tm1637Model tm(CLK, DIO);
+  TM1637 disp(CLK, DIO);
+  CHECK_EQ(tm.dataCommands, 1);
+  CHECK(tm.control & 0x08);
+
+  disp.begin(4, 1);
+  disp.setPrintDelay(PRINT_DELAY);
+  CHECK_EQ(tm.digitWrites, 4);
+  CHECK(shows(disp, tm, ""));
+
+  // two digits in one transfer, the same again sends nothing
+  uint32_t clocks = tm.clocks;
+  disp.print("12");
+  CHECK(shows(disp, tm, "12"));
+  CHECK_EQ(tm.clocks - clocks, 3 * 9 + 1);
+  clocks = tm.clocks;
+  disp.print("12");
+  CHECK_EQ(tm.clocks - clocks, 0);
+
+  // text longer than the display shows its first four characters at once
+  // and moves on one character each print delay
+  uint64_t start = host::now();
+  {
+    HOST_PROFILE("write");
+    CHECK_EQ(disp.write("HELLO"), 5);
+  }
+  CHECK(host::Profiler::summary("write").delayUs < 1000);
+  CHECK(shows(disp, tm, "HELL"));
+  std::vector<uint32_t> frames = scroll(disp, tm);
+  CHECK_EQ(frames.size(), 2);
+  CHECK_EQ(frames[1], frameOf(disp, "ELLO"));
+  CHECK(host::now() - start >= 2 * PRINT_DELAY * 1000ULL);
+  CHECK(host::now() - start < 2 * PRINT_DELAY * 1000ULL + 20000);
+
+  // a number prints from a buffer gone when print() returns, the scroll
+  // keeps its own copy
+  CHECK_EQ(disp.print(123456L), 6);
+  frames = scroll(disp, tm);
+  CHECK_EQ(frames.size(), 3);
+  CHECK_EQ(frames[0], frameOf(disp, "1234"));
+  CHECK_EQ(frames[1], frameOf(disp, "2345"));
+  CHECK_EQ(frames[2], frameOf(disp, "3456"));
+
+  // text longer than the scroll buffer is not cut, it scrolls before
+  // print() returns in the same steps
+  const char *text = "THE QUICK BROWN FOX JUMPS OVER THE LAZY";
+  size_t length = strlen(text);
+  CHECK(length > TM1637_PRINT_BUFFER_SIZE);
+  {
+    HOST_PROFILE("long print");
+    CHECK_EQ(disp.print(text), length);
+  }
+  double delayUs = host::Profiler::summary("long print").delayUs;
+  CHECK(delayUs >= (length - 3) * PRINT_DELAY * 1000.0);
+  CHECK(delayUs < (length - 2) * PRINT_DELAY * 1000.0);
+  CHECK(shows(disp, tm, text + length - 4));
+  CHECK(!disp.poll());
+  CHECK_EQ(disp.write(text), length);
+  CHECK(shows(disp, tm, text + length - 4));
+
+  // a new print ends the scroll
+  disp.write("HELLO");
+  disp.print("7");
+  CHECK(!disp.poll());
+  CHECK(shows(disp, tm, "7ELL"));
+
+  // the colon goes on the second digit only
+  disp.setColonOn(true);
+  disp.print("1234");
+  CHECK(shows(disp, tm, "1234"));
+  disp.setColonOn(false);
+
+  // a missing ack resends all digits next time
+  tm.setSilent(true);
+  disp.print("5678");
+  tm.setSilent(false);
+  uint32_t writes = tm.digitWrites;
+  disp.print("5678");
+  CHECK_EQ(tm.digitWrites - writes, 4);
+  CHECK(shows(disp, tm, "5678"));
+
+  host::Profiler::print();
+  return testResult("tm1637_ironkit");
+}
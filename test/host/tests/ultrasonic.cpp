@@ -0,0 +1,114 @@
+/*
+ * Ultrasonic::read() busy waits for the whole echo, UltrasonicScheduler
+ * pings one module at a time and returns from update() at once. Three
+ * modules: one echo on an interrupt pin, one that never answers and a three
+ * pin module sampled from update().
+ */
+
+// the header leaves Arduino.h to the sketch
+#include <Arduino.h>
+#include <Ultrasonic.h>
+#include <UltrasonicScheduler.h>
+
+#include <vector>
+
+#include "EchoModel.h"
+#include "HostSim.h"
+#include "HostTest.h"
+#include "Profiler.h"
+
+static std::vector<int> triggers;
+
+static void recordTrigger(uint8_t pin, int level) {
+  if (level == HIGH && host::isOutput(pin))
+    triggers.push_back(pin);
+}
+
+// runs update() every 100us for the given time
+static void loopFor(UltrasonicScheduler &s, uint32_t us) {
+  uint32_t start = micros();
+  while (micros() - start < us) {
+    {
+      HOST_PROFILE("update");
+      s.update();
+    }
+    host::advance(100);
+  }
+}
+
+int main() {
+  host::setInterruptPins({2, 3});
+
+  EchoModel near(10, 2);
+  EchoModel silent(11, 3);
+  EchoModel three(12, 12);
+  near.setEcho(1000);
+  silent.setEcho(0);
+  three.setEcho(2000);
+
+  // the blocking read holds loop() for the 450us burst and the echo
+  Ultrasonic blocking(10, 2);
+  unsigned int cm;
+  {
+    HOST_PROFILE("Ultrasonic::read");
+    cm = blocking.read();
+  }
+  CHECK(cm >= 17 && cm <= 18);
+  host::ProfileSummary b = host::Profiler::summary("Ultrasonic::read");
+  CHECK(b.totalUs > 1450);
+  Ultrasonic blockingSilent(11, 3);
+  {
+    HOST_PROFILE("Ultrasonic::read timeout");
+    blockingSilent.read();
+  }
+  CHECK(host::Profiler::summary("Ultrasonic::read timeout").totalUs > 20000);
+
+  for (uint8_t pin = 10; pin <= 12; pin++)
+    host::watch(pin, recordTrigger);
+
+  UltrasonicScheduler s(20000);
+  CHECK_EQ(s.add(10, 2), 0);
+  CHECK_EQ(s.add(11, 3), 1);
+  CHECK_EQ(s.add(12), 2);
+  s.setMedian(3);
+  s.begin();
+  CHECK_EQ(s.age(0), ULTRASONIC_NEVER);
+  CHECK_EQ(s.read(0), 0);
+
+  loopFor(s, 100000);
+  // the interrupt times the echo, update() only samples the three pin one
+  CHECK(s.timing(0) >= 1000 && s.timing(0) <= 1004);
+  CHECK_EQ(s.timing(1), 20000);
+  CHECK(s.timing(2) >= 1900 && s.timing(2) <= 2100);
+  CHECK(s.age(0) < 100);
+  // one module at a time, in order
+  CHECK(triggers.size() >= 6);
+  for (size_t i = 0; i < triggers.size(); i++)
+    CHECK_EQ(triggers[i], 10 + (int)(i % 3));
+  host::ProfileSummary u = host::Profiler::summary("update");
+  CHECK(u.totalUs < u.calls * 20);
+
+  // a single outlier does not get through the median of 3
+  near.setEcho(9000);
+  size_t pinged = near.pings;
+  while (near.pings == pinged)
+    loopFor(s, 1000);
+  near.setEcho(1000);
+  loopFor(s, 30000);
+  CHECK(s.timing(0) >= 1000 && s.timing(0) <= 1004);
+  s.setMedian(1);
+  CHECK(s.timing(0) >= 9000 && s.timing(0) <= 9004);
+
+  // an echo stuck high times out after the rise
+  s.setMedian(1);
+  near.setStuck(true);
+  pinged = near.pings;
+  while (near.pings == pinged)
+    loopFor(s, 1000);
+  loopFor(s, 25000);
+  CHECK_EQ(s.timing(0), 20000);
+  s.end();
+
+  host::Profiler::print();
+  return testResult("ultrasonic");
+}